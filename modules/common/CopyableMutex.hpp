@@ -0,0 +1,14 @@
+#ifndef PROTOMESH_COPYABLEMUTEX_HPP
+#define PROTOMESH_COPYABLEMUTEX_HPP
+
+/// Mutex that may be a member of copyable classes.
+/// Copies get a mutex of their own, the lock state is never copied.
+template <class Mutex>
+class CopyableMutex : public Mutex {
+public:
+    CopyableMutex() = default;
+    CopyableMutex(const CopyableMutex &) : Mutex() {};
+    CopyableMutex &operator=(const CopyableMutex &) { return *this; };
+};
+
+#endif //PROTOMESH_COPYABLEMUTEX_HPP
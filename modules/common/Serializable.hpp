@@ -13,6 +13,7 @@ enum class DeserializationError {
     INVALID_PUB_KEY,
     INVALID_ORIGIN_KEY,
     SIGNATURE_SIZE_MISMATCH,
+    UNSUPPORTED_VERSION,
     UNIMPLEMENTED
 };
 
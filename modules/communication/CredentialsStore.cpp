@@ -1,5 +1,6 @@
 #ifdef UNIT_TESTING
 
+#include <thread>
 #include "catch.hpp"
 
 #endif
@@ -10,30 +11,141 @@ namespace ProtoMesh::communication {
 
     Result<void, CredentialsStore::CredentialsError>
     CredentialsStore::insertKey(cryptography::UUID deviceID, cryptography::asymmetric::PublicKey key) {
-        auto existingKeyResult = this->getKey(deviceID);
+        PUB_HASH_T hash = key.getHash();
 
-        if (existingKeyResult.isOk()) {
-            cryptography::asymmetric::PublicKey existingKey = existingKeyResult.unwrap();
+        Shard &shard = this->shardOf(deviceID);
+        unique_lock<shared_mutex> lock(shard.mutex);
 
-            if (existingKey == key) return Ok();
+        auto existingHash = shard.knownHashes.find(deviceID);
+        if (existingHash == shard.knownHashes.end() && this->restoreKeyFromSnapshot(shard, deviceID))
+            existingHash = shard.knownHashes.find(deviceID);
+
+        if (existingHash != shard.knownHashes.end()) {
+            if (existingHash->second == hash) return Ok();
             else return Err(CredentialsError::MismatchingKeyExists); // TODO Print a warning
         }
 
-        this->knownHosts.insert({deviceID, key});
+        shard.knownHosts.insert({deviceID, key});
+        shard.knownHashes.insert({deviceID, hash});
+        shard.unverifiedHosts.erase(deviceID);
 
         return Ok();
     }
 
+    void CredentialsStore::replaceKey(cryptography::UUID deviceID, cryptography::asymmetric::PublicKey key) {
+        PUB_HASH_T hash = key.getHash();
+
+        Shard &shard = this->shardOf(deviceID);
+        unique_lock<shared_mutex> lock(shard.mutex);
+
+        /// Restore the outdated key first so that it can not overwrite the new one once it is requested
+        this->restoreKeyFromSnapshot(shard, deviceID);
+
+        shard.knownHosts.erase(deviceID);
+        shard.knownHashes.erase(deviceID);
+        shard.knownHosts.insert({deviceID, key});
+        shard.knownHashes.insert({deviceID, hash});
+        shard.unverifiedHosts.erase(deviceID);
+    }
+
+    void CredentialsStore::insertUnverifiedKey(cryptography::UUID deviceID, cryptography::asymmetric::PublicKey key) {
+        Shard &shard = this->shardOf(deviceID);
+        unique_lock<shared_mutex> lock(shard.mutex);
+
+        if (this->restoreKeyFromSnapshot(shard, deviceID)) return;
+
+        /// The latest one wins since none of them is more trustworthy than the others
+        shard.unverifiedHosts.erase(deviceID);
+        shard.unverifiedHosts.insert({deviceID, key});
+    }
+
     Result<cryptography::asymmetric::PublicKey, CredentialsStore::CredentialsError>
-    CredentialsStore::getKey(cryptography::UUID deviceID) {
-        auto key = this->knownHosts.find(deviceID);
+    CredentialsStore::getUnverifiedKey(cryptography::UUID deviceID) {
+        Shard &shard = this->shardOf(deviceID);
+        shared_lock<shared_mutex> lock(shard.mutex);
 
-        if (key != this->knownHosts.end())
+        auto key = shard.unverifiedHosts.find(deviceID);
+        if (key != shard.unverifiedHosts.end())
             return Ok(key->second);
 
         return Err(CredentialsError::KeyNotFound);
     }
 
+    Result<cryptography::asymmetric::PublicKey, CredentialsStore::CredentialsError>
+    CredentialsStore::getKey(cryptography::UUID deviceID) {
+        Shard &shard = this->shardOf(deviceID);
+
+        {
+            shared_lock<shared_mutex> lock(shard.mutex);
+            auto key = shard.knownHosts.find(deviceID);
+
+            if (key != shard.knownHosts.end())
+                return Ok(key->second);
+        }
+
+        unique_lock<shared_mutex> lock(shard.mutex);
+        if (this->restoreKeyFromSnapshot(shard, deviceID))
+            return Ok(shard.knownHosts.at(deviceID));
+
+        return Err(CredentialsError::KeyNotFound);
+    }
+
+    Result<PUB_HASH_T, CredentialsStore::CredentialsError>
+    CredentialsStore::getKeyHash(cryptography::UUID deviceID) {
+        Shard &shard = this->shardOf(deviceID);
+
+        {
+            shared_lock<shared_mutex> lock(shard.mutex);
+            auto hash = shard.knownHashes.find(deviceID);
+
+            if (hash != shard.knownHashes.end())
+                return Ok(hash->second);
+        }
+
+        unique_lock<shared_mutex> lock(shard.mutex);
+        if (this->restoreKeyFromSnapshot(shard, deviceID))
+            return Ok(shard.knownHashes.at(deviceID));
+
+        return Err(CredentialsError::KeyNotFound);
+    }
+
+    bool CredentialsStore::restoreKeyFromSnapshot(Shard &shard, cryptography::UUID deviceID) {
+        /// Another thread might have inserted the key while the shard was unlocked
+        if (shard.knownHosts.find(deviceID) != shard.knownHosts.end()) return true;
+
+        auto snapshot = atomic_load(&this->snapshot);
+        if (!snapshot) return false;
+
+        auto key = snapshot->getKey(deviceID);
+        if (!key) return false;
+
+        shard.knownHosts.insert({deviceID, key.value()});
+        shard.knownHashes.insert({deviceID, key->getHash()});
+
+        return true;
+    }
+
+    vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> CredentialsStore::getAllKeys() const {
+        vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> keys;
+        for (const Shard &shard : this->shards) {
+            shared_lock<shared_mutex> lock(shard.mutex);
+            keys.insert(keys.end(), shard.knownHosts.begin(), shard.knownHosts.end());
+        }
+
+        /// Keys of the snapshot that have not been requested yet
+        auto snapshot = atomic_load(&this->snapshot);
+        if (snapshot) {
+            for (auto &key : snapshot->getKeys()) {
+                const Shard &shard = this->shardOf(key.first);
+                shared_lock<shared_mutex> lock(shard.mutex);
+                if (shard.knownHosts.find(key.first) == shard.knownHosts.end())
+                    keys.push_back(key);
+            }
+        }
+
+        return keys;
+    }
+
 #ifdef UNIT_TESTING
 
     SCENARIO("Storing and retrieving credentials", "[unit_test][module][communication]") {
@@ -61,6 +173,102 @@ namespace ProtoMesh::communication {
                         REQUIRE(retrievedKey1.unwrap() == key1);
                         REQUIRE(retrievedKey2.unwrap() == key2);
                     }
+
+                    AND_THEN("the hashes of both keys should be retrievable") {
+                        REQUIRE(credentials.getKeyHash(id1).unwrap() == key1.getHash());
+                        REQUIRE(credentials.getKeyHash(id2).unwrap() == key2.getHash());
+                    }
+
+                    AND_WHEN("a different key is inserted for the same device") {
+                        auto result = credentials.insertKey(id1, key2);
+
+                        THEN("the insertion should be rejected") {
+                            REQUIRE(result.isErr());
+                            REQUIRE(credentials.getKey(id1).unwrap() == key1);
+                        }
+                    }
+
+                    AND_WHEN("the key of the device is replaced") {
+                        credentials.replaceKey(id1, key2);
+
+                        THEN("the new key and its hash should be retrievable") {
+                            REQUIRE(credentials.getKey(id1).unwrap() == key2);
+                            REQUIRE(credentials.getKeyHash(id1).unwrap() == key2.getHash());
+                        }
+                    }
+                }
+            }
+
+            WHEN("an unverified key is inserted") {
+                credentials.insertUnverifiedKey(id1, key1);
+
+                THEN("it should only be retrievable as an unverified key") {
+                    REQUIRE(credentials.getUnverifiedKey(id1).unwrap() == key1);
+                    REQUIRE(credentials.getKey(id1).isErr());
+                    REQUIRE(credentials.getAllKeys().empty());
+                }
+
+                AND_WHEN("a different key is inserted for the same device") {
+                    auto result = credentials.insertKey(id1, key2);
+
+                    THEN("the inserted key should have superseded the unverified one") {
+                        REQUIRE(result.isOk());
+                        REQUIRE(credentials.getKey(id1).unwrap() == key2);
+                        REQUIRE(credentials.getUnverifiedKey(id1).isErr());
+                    }
+                }
+            }
+
+            WHEN("a snapshot containing the first correlation is attached") {
+                credentials.attachSnapshot(make_shared<NetworkSnapshot>(
+                        NetworkSnapshot::build(cryptography::UUID(), 0, {}, {}, {{id1, key1}})));
+
+                THEN("the key and its hash should be retrievable") {
+                    REQUIRE(credentials.getKeyHash(id1).unwrap() == key1.getHash());
+                    REQUIRE(credentials.getKey(id1).unwrap() == key1);
+                    REQUIRE(credentials.getKey(id2).isErr());
+                }
+
+                THEN("it should be listed with the other keys") {
+                    REQUIRE(credentials.insertKey(id2, key2).isOk());
+                    REQUIRE(credentials.getAllKeys().size() == 2);
+                }
+
+                THEN("a different key for the same device should be rejected") {
+                    REQUIRE(credentials.insertKey(id1, key2).isErr());
+                }
+
+                THEN("an unverified key for the same device should be ignored") {
+                    credentials.insertUnverifiedKey(id1, key2);
+                    REQUIRE(credentials.getUnverifiedKey(id1).isErr());
+                    REQUIRE(credentials.getKey(id1).unwrap() == key1);
+                }
+
+                THEN("replacing the key should take precedence over the snapshot") {
+                    credentials.replaceKey(id1, key2);
+                    REQUIRE(credentials.getKey(id1).unwrap() == key2);
+                    REQUIRE(credentials.getKeyHash(id1).unwrap() == key2.getHash());
+                }
+            }
+
+            WHEN("the keys of many devices are inserted and read by multiple threads at once") {
+                vector<thread> threads;
+                for (uint32_t t = 0; t < 4; t++)
+                    threads.emplace_back([&credentials, &key1, &key2, t]() {
+                        for (uint32_t i = 0; i < 1000; i++) {
+                            cryptography::UUID device = cryptography::UUID::fromNumber(t * 1000 + i);
+                            credentials.insertKey(device, i % 2 ? key1 : key2);
+                            credentials.getKey(cryptography::UUID::fromNumber(((t + 1) % 4) * 1000 + i));
+                        }
+                    });
+
+                for (thread &t : threads)
+                    t.join();
+
+                THEN("all of them should be retrievable") {
+                    REQUIRE(credentials.getAllKeys().size() == 4000);
+                    REQUIRE(credentials.getKey(cryptography::UUID::fromNumber(3999)).unwrap() == key1);
+                    REQUIRE(credentials.getKeyHash(cryptography::UUID::fromNumber(3998)).unwrap() == key2.getHash());
                 }
             }
         }
@@ -1,17 +1,53 @@
 #ifndef PROTOMESH_CREDENTIALSSTORE_HPP
 #define PROTOMESH_CREDENTIALSSTORE_HPP
 
-#include <unordered_map>
 #include <asymmetric.hpp>
 #include <uuid.hpp>
+#include <UUIDMap.hpp>
+#include <memory>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
 
 #include "result.h"
+#include "CopyableMutex.hpp"
+#include "NetworkSnapshot.hpp"
+
+/// The store is split into 2^CREDENTIALS_STORE_SHARD_BITS independently locked shards
+#define CREDENTIALS_STORE_SHARD_BITS 4
 
 namespace ProtoMesh::communication {
 
+    /// Known public keys of other devices.
+    /// Safe to use from multiple threads. Lookups only take a shared lock on the shard of the device
+    /// so that threads decrypting messages from different (or the same) senders don't block each other.
     class CredentialsStore {
-        // TODO Possibly store/cache shared secrets
-        unordered_map<cryptography::UUID, cryptography::asymmetric::PublicKey> knownHosts;
+        class Shard {
+        public:
+            // TODO Possibly store/cache shared secrets
+            cryptography::UUIDMap<cryptography::asymmetric::PublicKey> knownHosts;
+            /// Hashes of the known keys so that they don't have to be recalculated for every comparison
+            cryptography::UUIDMap<PUB_HASH_T> knownHashes;
+            /// Keys relayed to us that could not be verified, see insertUnverifiedKey
+            cryptography::UUIDMap<cryptography::asymmetric::PublicKey> unverifiedHosts;
+            mutable CopyableMutex<shared_mutex> mutex;
+        };
+
+        array<Shard, 1 << CREDENTIALS_STORE_SHARD_BITS> shards;
+        /// Snapshot of a previous run whose keys are moved into the store once they are first requested.
+        /// Only accessed through atomic_load and atomic_store since it may be attached while other threads read keys.
+        shared_ptr<const NetworkSnapshot> snapshot;
+
+        /// Picks the shard by the upper bits of the hash since UUIDMap places entries by the lower ones
+        Shard &shardOf(cryptography::UUID deviceID) {
+            return this->shards[deviceID.hash() >> (64 - CREDENTIALS_STORE_SHARD_BITS)];
+        }
+        const Shard &shardOf(cryptography::UUID deviceID) const {
+            return this->shards[deviceID.hash() >> (64 - CREDENTIALS_STORE_SHARD_BITS)];
+        }
+
+        /// Has to be called with the shard locked exclusively
+        bool restoreKeyFromSnapshot(Shard &shard, cryptography::UUID deviceID);
 
     public:
         enum class CredentialsError {
@@ -20,8 +56,22 @@ namespace ProtoMesh::communication {
         };
 
         Result<cryptography::asymmetric::PublicKey, CredentialsError> getKey(cryptography::UUID deviceID);
+        Result<PUB_HASH_T, CredentialsError> getKeyHash(cryptography::UUID deviceID);
 
         Result<void, CredentialsError> insertKey(cryptography::UUID deviceID, cryptography::asymmetric::PublicKey key);
+        /// Stores the key even if a different one is known, for devices that changed their key
+        void replaceKey(cryptography::UUID deviceID, cryptography::asymmetric::PublicKey key);
+
+        /// Keys that pass through us without any means to verify them, like the ones carried by relayed route
+        /// discoveries and acknowledgements. They are kept apart from the known keys so that they never verify a
+        /// signature or conflict with a known key, and are only used to encrypt messages over learned routes.
+        void insertUnverifiedKey(cryptography::UUID deviceID, cryptography::asymmetric::PublicKey key);
+        Result<cryptography::asymmetric::PublicKey, CredentialsError> getUnverifiedKey(cryptography::UUID deviceID);
+
+        /// Makes the keys of the snapshot available without decoding them up front
+        void attachSnapshot(shared_ptr<const NetworkSnapshot> snapshot) { atomic_store(&this->snapshot, std::move(snapshot)); }
+        /// All known keys including those of the attached snapshot
+        vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> getAllKeys() const;
     };
 
 }
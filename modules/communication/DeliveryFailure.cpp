@@ -0,0 +1,121 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "DeliveryFailure.hpp"
+
+namespace ProtoMesh::communication {
+
+    DeliveryFailure DeliveryFailure::build(cryptography::UUID reporter, const vector<cryptography::UUID> &messageRoute,
+                                           cryptography::UUID unreachableHop, SIGNATURE_T messageSignature) {
+        /// Walk back from the reporter to the origin of the message
+        vector<cryptography::UUID> route = {reporter};
+        auto reporterPosition = find(messageRoute.begin(), messageRoute.end(), reporter);
+        route.insert(route.end(), make_reverse_iterator(reporterPosition), messageRoute.rend());
+
+        return DeliveryFailure(route, messageRoute.back(), unreachableHop, messageSignature);
+    }
+
+    vector<uint8_t> DeliveryFailure::serialize() const {
+
+        using namespace scheme::communication;
+        flatbuffers::FlatBufferBuilder builder;
+
+        /// Serialize the route
+        vector<scheme::cryptography::UUID> routeEntries;
+        for (auto hop : this->route)
+            routeEntries.push_back(hop.toScheme());
+
+        auto routeVector = builder.CreateVectorOfStructs(routeEntries);
+
+        /// Serialize the signature
+        vector<uint8_t> signatureVector(this->messageSignature.begin(), this->messageSignature.end());
+        auto signature = builder.CreateVector(signatureVector);
+
+        scheme::cryptography::UUID originalRecipient = this->originalRecipient.toScheme();
+        scheme::cryptography::UUID unreachableHop = this->unreachableHop.toScheme();
+
+        auto deliveryFailure = CreateDeliveryFailureDatagram(builder, routeVector, &originalRecipient,
+                                                             &unreachableHop, signature);
+
+        /// Convert it to a byte array
+        builder.Finish(deliveryFailure, DeliveryFailureDatagramIdentifier());
+        uint8_t *buf = builder.GetBufferPointer();
+
+        return {buf, buf + builder.GetSize()};
+    }
+
+    Result<DeliveryFailure, DeserializationError> DeliveryFailure::fromBuffer(vector<uint8_t> buffer) {
+
+        using namespace scheme::communication;
+
+        /// Verify the buffer type
+        if (!flatbuffers::BufferHasIdentifier(buffer.data(), DeliveryFailureDatagramIdentifier()))
+            return Err(DeserializationError::INVALID_IDENTIFIER);
+
+        /// Verify buffer integrity
+        auto verifier = flatbuffers::Verifier(buffer.data(), buffer.size());
+        if (!VerifyDeliveryFailureDatagramBuffer(verifier))
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        auto failure = GetDeliveryFailureDatagram(buffer.data());
+        if (!failure->route() || !failure->originalRecipient() || !failure->unreachableHop() || !failure->messageSignature())
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        /// Deserialize route
+        vector<cryptography::UUID> route;
+        auto routeBuffer = failure->route();
+        for (uint i = 0; i < routeBuffer->Length(); i++)
+            route.emplace_back(routeBuffer->Get(i));
+
+        /// Deserialize signature
+        if (failure->messageSignature()->size() != SIGNATURE_SIZE)
+            return Err(DeserializationError::SIGNATURE_SIZE_MISMATCH);
+        SIGNATURE_T signature{};
+        copy(failure->messageSignature()->begin(), failure->messageSignature()->end(), signature.begin());
+
+        return Ok(DeliveryFailure(route, cryptography::UUID(failure->originalRecipient()),
+                                  cryptography::UUID(failure->unreachableHop()), signature));
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Delivery failures should be reported back to the sender",
+             "[unit_test][module][communication]") {
+
+        GIVEN("A message route and a relay that is unable to reach the next hop") {
+            cryptography::UUID origin, hop1, relay, unreachableHop, destination;
+            vector<cryptography::UUID> messageRoute = {origin, hop1, relay, unreachableHop, destination};
+            SIGNATURE_T signature{};
+            signature.fill(42);
+
+            DeliveryFailure failure = DeliveryFailure::build(relay, messageRoute, unreachableHop, signature);
+
+            THEN("the failure should travel back to the origin") {
+                vector<cryptography::UUID> expectedRoute = {relay, hop1, origin};
+                REQUIRE(failure.route == expectedRoute);
+                REQUIRE(failure.originalRecipient == destination);
+            }
+
+            WHEN("it is serialized and deserialized again") {
+                vector<uint8_t> serializedFailure = failure.serialize();
+                DeliveryFailure deserializedFailure = DeliveryFailure::fromBuffer(serializedFailure).unwrap();
+
+                THEN("both failures should contain the same data") {
+                    REQUIRE(deserializedFailure.route == failure.route);
+                    REQUIRE(deserializedFailure.originalRecipient == failure.originalRecipient);
+                    REQUIRE(deserializedFailure.unreachableHop == failure.unreachableHop);
+                    REQUIRE(deserializedFailure.messageSignature == failure.messageSignature);
+                }
+
+                THEN("the bytestream should be identical after reserializing") {
+                    REQUIRE(deserializedFailure.serialize() == serializedFailure);
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,45 @@
+#ifndef PROTOMESH_DELIVERYFAILURE_HPP
+#define PROTOMESH_DELIVERYFAILURE_HPP
+
+#include <utility>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+using namespace std;
+
+#include "uuid.hpp"
+#include "asymmetric.hpp"
+#include "Serializable.hpp"
+
+#include "flatbuffers/flatbuffers.h"
+#include "communication/deliveryFailure_generated.h"
+
+namespace ProtoMesh::communication {
+
+    /// Reports a message that could not be forwarded back to the node that sent it.
+    /// Travels along the reversed part of the failed message's route that has already been traversed.
+    class DeliveryFailure : public Serializable<DeliveryFailure> {
+    public:
+        vector<cryptography::UUID> route;
+        cryptography::UUID originalRecipient;
+        cryptography::UUID unreachableHop;
+        SIGNATURE_T messageSignature;
+
+        DeliveryFailure(vector<cryptography::UUID> route, cryptography::UUID originalRecipient,
+                        cryptography::UUID unreachableHop, SIGNATURE_T messageSignature)
+                : route(std::move(route)), originalRecipient(originalRecipient), unreachableHop(unreachableHop),
+                  messageSignature(messageSignature) {};
+
+        /// Builds a failure report for a message with the given route that could not be forwarded by the reporter
+        static DeliveryFailure build(cryptography::UUID reporter, const vector<cryptography::UUID> &messageRoute,
+                                     cryptography::UUID unreachableHop, SIGNATURE_T messageSignature);
+
+        /// Serializable overrides
+        static Result<DeliveryFailure, DeserializationError> fromBuffer(vector<uint8_t> buffer);
+        vector<uint8_t> serialize() const override;
+    };
+
+}
+
+#endif //PROTOMESH_DELIVERYFAILURE_HPP
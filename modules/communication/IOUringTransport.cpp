@@ -0,0 +1,550 @@
+#ifdef UNIT_TESTING
+
+#include <thread>
+#include <chrono>
+#include <poll.h>
+#include <ctime>
+#include "catch.hpp"
+
+#endif
+
+#include "IOUringTransport.hpp"
+
+#ifdef PROTOMESH_HAVE_IO_URING
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace ProtoMesh::communication::transmission {
+
+    /// Kinds of sockets a receive is submitted for, used as the user data of its completions
+    enum ReceiveSocket { UNICAST = 0, MULTICAST = 1 };
+
+    IOUring::~IOUring() {
+        this->close();
+    }
+
+    bool IOUring::setup(unsigned int entries, unsigned int completions) {
+        io_uring_params parameters{};
+        parameters.flags = IORING_SETUP_CQSIZE;
+        parameters.cq_entries = completions;
+
+        this->descriptor = (int) syscall(__NR_io_uring_setup, entries, &parameters);
+        if (this->descriptor < 0) return false;
+
+        /// Both features are available since Linux 5.11
+        if (!(parameters.features & IORING_FEAT_SINGLE_MMAP) || !(parameters.features & IORING_FEAT_EXT_ARG))
+            return false;
+
+        this->ringSize = max(parameters.sq_off.array + parameters.sq_entries * sizeof(uint32_t),
+                             parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe));
+        this->ringMemory = mmap(nullptr, this->ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                this->descriptor, IORING_OFF_SQ_RING);
+        if (this->ringMemory == MAP_FAILED) {
+            this->ringMemory = nullptr;
+            return false;
+        }
+
+        this->submissionEntriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+        void *submissionEntries = mmap(nullptr, this->submissionEntriesSize, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_POPULATE, this->descriptor, IORING_OFF_SQES);
+        if (submissionEntries == MAP_FAILED) return false;
+        this->submissionEntries = (io_uring_sqe *) submissionEntries;
+
+        auto memory = (uint8_t *) this->ringMemory;
+        this->submissionHead = (uint32_t *) (memory + parameters.sq_off.head);
+        this->submissionTail = (uint32_t *) (memory + parameters.sq_off.tail);
+        this->submissionMask = *(uint32_t *) (memory + parameters.sq_off.ring_mask);
+        this->submissionCount = parameters.sq_entries;
+        this->localSubmissionTail = *this->submissionTail;
+
+        /// Entries are always submitted in order thus the indirection array maps every slot to itself
+        auto submissionArray = (uint32_t *) (memory + parameters.sq_off.array);
+        for (uint32_t i = 0; i < parameters.sq_entries; i++)
+            submissionArray[i] = i;
+
+        this->completionHead = (uint32_t *) (memory + parameters.cq_off.head);
+        this->completionTail = (uint32_t *) (memory + parameters.cq_off.tail);
+        this->completionMask = *(uint32_t *) (memory + parameters.cq_off.ring_mask);
+        this->completionEntries = (io_uring_cqe *) (memory + parameters.cq_off.cqes);
+
+        return true;
+    }
+
+    void IOUring::close() {
+        if (this->submissionEntries) munmap(this->submissionEntries, this->submissionEntriesSize);
+        if (this->ringMemory) munmap(this->ringMemory, this->ringSize);
+        if (this->descriptor >= 0) ::close(this->descriptor);
+
+        this->submissionEntries = nullptr;
+        this->ringMemory = nullptr;
+        this->descriptor = -1;
+    }
+
+    io_uring_sqe *IOUring::nextSubmission() {
+        uint32_t head = __atomic_load_n(this->submissionHead, __ATOMIC_ACQUIRE);
+        if (this->localSubmissionTail - head >= this->submissionCount) return nullptr;
+
+        io_uring_sqe *entry = &this->submissionEntries[this->localSubmissionTail++ & this->submissionMask];
+        memset(entry, 0, sizeof(io_uring_sqe));
+        return entry;
+    }
+
+    int IOUring::submit(unsigned int completions, int timeout_ms) {
+        uint32_t submissions = this->localSubmissionTail - *this->submissionTail;
+        __atomic_store_n(this->submissionTail, this->localSubmissionTail, __ATOMIC_RELEASE);
+
+        if (submissions == 0 && completions == 0) return 0;
+
+        unsigned int flags = completions > 0 ? IORING_ENTER_GETEVENTS : 0;
+        __kernel_timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000ll};
+        io_uring_getevents_arg argument{};
+        argument.sigmask_sz = _NSIG / 8;
+        argument.ts = (uint64_t) &timeout;
+        if (completions > 0 && timeout_ms >= 0) flags |= IORING_ENTER_EXT_ARG;
+
+        return (int) syscall(__NR_io_uring_enter, this->descriptor, submissions, completions, flags,
+                             flags & IORING_ENTER_EXT_ARG ? &argument : nullptr,
+                             flags & IORING_ENTER_EXT_ARG ? sizeof(argument) : _NSIG / 8);
+    }
+
+    io_uring_cqe *IOUring::peekCompletion() {
+        uint32_t head = *this->completionHead;
+        if (head == __atomic_load_n(this->completionTail, __ATOMIC_ACQUIRE)) return nullptr;
+
+        return &this->completionEntries[head & this->completionMask];
+    }
+
+    void IOUring::consumeCompletion() {
+        __atomic_store_n(this->completionHead, *this->completionHead + 1, __ATOMIC_RELEASE);
+    }
+
+    IOUringTransport::IOUringTransport(UDPTransportConfiguration configuration, Sockets sockets)
+            : UDPTransport(std::move(configuration), sockets) {
+        this->receiveHeader.msg_namelen = sizeof(sockaddr_in);
+    }
+
+    IOUringTransport::~IOUringTransport() {
+        /// The kernel has to let go of the buffers before they are released
+        this->receiveRing.close();
+        this->sendRing.close();
+
+        if (this->bufferRing) munmap(this->bufferRing, IO_URING_TRANSPORT_BUFFER_COUNT * sizeof(io_uring_buf));
+        if (this->bufferMemory) munmap(this->bufferMemory, IO_URING_TRANSPORT_BUFFER_COUNT * IO_URING_TRANSPORT_BUFFER_SIZE);
+    }
+
+    Result<shared_ptr<IOUringTransport>, IOUringTransport::IOUringTransportError>
+    IOUringTransport::open(UDPTransportConfiguration configuration) {
+        auto sockets = UDPTransport::openSockets(configuration);
+        if (sockets.isErr())
+            return Err(sockets.unwrapErr() == UDPTransportError::INVALID_ADDRESS ? IOUringTransportError::INVALID_ADDRESS
+                                                                                 : IOUringTransportError::SOCKET_ERROR);
+
+        shared_ptr<IOUringTransport> transport(new IOUringTransport(std::move(configuration), sockets.unwrap()));
+
+        /// Every buffer may hold a completion at once thus the completion queue can't overflow
+        if (!transport->receiveRing.setup(4, IO_URING_TRANSPORT_BUFFER_COUNT * 2) ||
+            !transport->sendRing.setup(IO_URING_TRANSPORT_QUEUE_DEPTH, IO_URING_TRANSPORT_QUEUE_DEPTH * 2) ||
+            !transport->registerBuffers())
+            return Err(IOUringTransportError::UNSUPPORTED);
+
+        /// Kernels without multishot receives refuse them right away
+        transport->submitReceives();
+        io_uring_cqe *completion = transport->receiveRing.peekCompletion();
+        if (completion && completion->res == -EINVAL) return Err(IOUringTransportError::UNSUPPORTED);
+
+        return Ok(transport);
+    }
+
+    bool IOUringTransport::registerBuffers() {
+        void *memory = mmap(nullptr, IO_URING_TRANSPORT_BUFFER_COUNT * IO_URING_TRANSPORT_BUFFER_SIZE,
+                            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return false;
+        this->bufferMemory = (uint8_t *) memory;
+
+        /// The ring has to be page aligned
+        void *ring = mmap(nullptr, IO_URING_TRANSPORT_BUFFER_COUNT * sizeof(io_uring_buf), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ring == MAP_FAILED) return false;
+        this->bufferRing = (io_uring_buf *) ring;
+
+        io_uring_buf_reg registration{};
+        registration.ring_addr = (uint64_t) this->bufferRing;
+        registration.ring_entries = IO_URING_TRANSPORT_BUFFER_COUNT;
+        registration.bgid = 0;
+        if (syscall(__NR_io_uring_register, this->receiveRing.fileDescriptor(), IORING_REGISTER_PBUF_RING,
+                    &registration, 1) < 0)
+            return false;
+
+        for (uint16_t buffer = 0; buffer < IO_URING_TRANSPORT_BUFFER_COUNT; buffer++)
+            this->provideBuffer(buffer);
+        this->publishBuffers();
+
+        return true;
+    }
+
+    void IOUringTransport::provideBuffer(uint16_t buffer) {
+        io_uring_buf &entry = this->bufferRing[this->bufferRingTail++ & (IO_URING_TRANSPORT_BUFFER_COUNT - 1)];
+        entry.addr = (uint64_t) (this->bufferMemory + buffer * IO_URING_TRANSPORT_BUFFER_SIZE);
+        entry.len = IO_URING_TRANSPORT_BUFFER_SIZE;
+        entry.bid = buffer;
+    }
+
+    void IOUringTransport::publishBuffers() {
+        /// The tail of the ring overlays the reserved field of its first entry
+        __atomic_store_n(&this->bufferRing[0].resv, this->bufferRingTail, __ATOMIC_RELEASE);
+    }
+
+    void IOUringTransport::submitReceives() {
+        bool submitted = false;
+
+        for (ReceiveSocket socket : {UNICAST, MULTICAST}) {
+            if (this->receiving[socket]) continue;
+
+            io_uring_sqe *entry = this->receiveRing.nextSubmission();
+            if (!entry) break;
+
+            entry->opcode = IORING_OP_RECVMSG;
+            entry->fd = socket == UNICAST ? this->unicastSocket : this->multicastSocket;
+            entry->addr = (uint64_t) &this->receiveHeader;
+            entry->len = 1;
+            entry->flags = IOSQE_BUFFER_SELECT;
+            entry->buf_group = 0;
+            entry->ioprio = IORING_RECV_MULTISHOT;
+            entry->user_data = socket;
+
+            this->receiving[socket] = true;
+            submitted = true;
+        }
+
+        if (submitted) this->receiveRing.submit();
+    }
+
+    size_t IOUringTransport::receiveCompleted(vector<uint8_t> *buffers, size_t count) {
+        size_t received = 0;
+        bool providedBuffers = false;
+
+        /// Completions that don't fit into the buffers of the caller stay in the queue until the next call
+        for (io_uring_cqe *completion; received < count && (completion = this->receiveRing.peekCompletion());) {
+            if (completion->res >= 0 && completion->flags & IORING_CQE_F_BUFFER) {
+                auto buffer = (uint16_t) (completion->flags >> IORING_CQE_BUFFER_SHIFT);
+                uint8_t *memory = this->bufferMemory + buffer * IO_URING_TRANSPORT_BUFFER_SIZE;
+
+                /// The kernel places its header and the sender address in front of the datagram
+                auto header = (io_uring_recvmsg_out *) memory;
+                auto sender = (sockaddr_in *) (memory + sizeof(io_uring_recvmsg_out));
+                uint8_t *datagram = memory + sizeof(io_uring_recvmsg_out) + this->receiveHeader.msg_namelen;
+
+                if (!(header->flags & MSG_TRUNC) && !this->isOwnDatagram(*sender))
+                    buffers[received++].assign(datagram, datagram + header->payloadlen);
+
+                /// The datagram has been copied thus the kernel may reuse the buffer right away
+                this->provideBuffer(buffer);
+                providedBuffers = true;
+            }
+
+            /// The receive ended, e.g. because the kernel ran out of buffers
+            if (!(completion->flags & IORING_CQE_F_MORE))
+                this->receiving[completion->user_data] = false;
+
+            this->receiveRing.consumeCompletion();
+        }
+
+        if (providedBuffers) this->publishBuffers();
+        this->submitReceives();
+
+        return received;
+    }
+
+    size_t IOUringTransport::recvBatch(vector<uint8_t> *buffers, size_t count, unsigned int timeout_ms) {
+        size_t received = this->receiveCompleted(buffers, count);
+        if (received > 0 || timeout_ms == 0) return received;
+
+        this->receiveRing.submit(1, (int) timeout_ms);
+        return this->receiveCompleted(buffers, count);
+    }
+
+    void IOUringTransport::sendTo(const MessageTarget &target, vector<uint8_t> message) {
+        this->sendBatch({make_tuple(target, std::move(message))});
+    }
+
+    void IOUringTransport::sendBatch(const vector<tuple<MessageTarget, vector<uint8_t>>> &messages) {
+        this->prepareSends(messages);
+
+        /// Headers the kernel or the device refused to segment. The sends are not linked thus the ones after
+        /// a refused header have been sent regardless and must not be sent again.
+        vector<size_t> refusedHeaders;
+
+        for (size_t submitted = 0; submitted < this->sendHeaders.size();) {
+            unsigned int batchSize = 0;
+
+            for (io_uring_sqe *entry; submitted + batchSize < this->sendHeaders.size() &&
+                                      (entry = this->sendRing.nextSubmission()); batchSize++) {
+                entry->opcode = IORING_OP_SENDMSG;
+                entry->fd = this->unicastSocket;
+                entry->addr = (uint64_t) &this->sendHeaders[submitted + batchSize].msg_hdr;
+                entry->len = 1;
+                /// Datagrams that don't fit into the socket buffer are lost like any other UDP datagram
+                entry->msg_flags = MSG_DONTWAIT;
+                entry->user_data = submitted + batchSize;
+            }
+
+            /// The headers point into the messages of the caller thus all sends have to complete before returning
+            for (unsigned int completed = 0; completed < batchSize;) {
+                this->sendRing.submit(batchSize - completed);
+
+                for (io_uring_cqe *completion; (completion = this->sendRing.peekCompletion()); completed++) {
+                    size_t header = completion->user_data;
+                    if (completion->res < 0 &&
+                        UDPTransport::isSegmentationRefused(this->sendHeaders[header].msg_hdr, -completion->res))
+                        refusedHeaders.push_back(header);
+
+                    this->sendRing.consumeCompletion();
+                }
+            }
+
+            submitted += batchSize;
+        }
+
+        if (refusedHeaders.empty()) return;
+
+        /// Fall back to single datagrams for the messages of the refused headers in their original order
+        sort(refusedHeaders.begin(), refusedHeaders.end());
+        vector<tuple<MessageTarget, vector<uint8_t>>> refusedMessages;
+        for (size_t header : refusedHeaders) {
+            size_t end = header + 1 < this->sendOffsets.size() ? this->sendOffsets[header + 1] : messages.size();
+            refusedMessages.insert(refusedMessages.end(), messages.begin() + this->sendOffsets[header],
+                                   messages.begin() + end);
+        }
+
+        this->segmentationOffload = false;
+        this->sendBatch(refusedMessages);
+    }
+
+#ifdef UNIT_TESTING
+
+    /// Runs all transports on the loopback interface so that they don't interfere with the actual network
+    UDPTransportConfiguration loopbackRingConfiguration() {
+        UDPTransportConfiguration configuration;
+        configuration.multicastGroup = "239.255.42.97";
+        configuration.port = 42997;
+        configuration.interfaceAddress = "127.0.0.1";
+        configuration.receiveBufferSize = 1 << 20;
+        return configuration;
+    }
+
+    SCENARIO("Datagrams should be transmittable over io_uring", "[integration_test][module][communication][transmission]") {
+        GIVEN("an io_uring transport and a plain one on the loopback interface") {
+            UDPTransportConfiguration configuration = loopbackRingConfiguration();
+            auto a = IOUringTransport::open(configuration);
+            auto b = UDPTransport::open(configuration);
+
+            /// Kernels older than 6.0 can't run the transport
+            if (a.isErr() && a.unwrapErr() == IOUringTransport::IOUringTransportError::UNSUPPORTED) return;
+            REQUIRE(a.isOk());
+            REQUIRE(b.isOk());
+            shared_ptr<IOUringTransport> ring = a.unwrap();
+            shared_ptr<UDPTransport> plain = b.unwrap();
+
+            WHEN("the plain one broadcasts a datagram") {
+                plain->send({1, 2, 3});
+
+                THEN("the io_uring transport should become readable and receive it") {
+                    pollfd descriptor{ring->fileDescriptor(), POLLIN, 0};
+                    REQUIRE(poll(&descriptor, 1, 1000) == 1);
+
+                    vector<uint8_t> buffer;
+                    REQUIRE(ring->recv(&buffer, 0) == ReceiveResult::OK);
+                    REQUIRE(buffer == vector<uint8_t>({1, 2, 3}));
+                }
+            }
+
+            WHEN("the io_uring transport broadcasts a datagram") {
+                ring->send({4, 5, 6});
+
+                THEN("the plain one should receive it") {
+                    vector<uint8_t> buffer;
+                    REQUIRE(plain->recv(&buffer, 1000) == ReceiveResult::OK);
+                    REQUIRE(buffer == vector<uint8_t>({4, 5, 6}));
+                }
+
+                THEN("it should not receive it itself") {
+                    vector<uint8_t> buffer;
+                    REQUIRE(ring->recv(&buffer, 100) == ReceiveResult::Timeout);
+                }
+            }
+
+            WHEN("more datagrams than there are receive buffers are sent in batches") {
+                cryptography::UUID peer;
+                plain->setPeerAddress(peer, ring->getLocalAddress());
+                ring->setPeerAddress(peer, plain->getLocalAddress());
+
+                vector<tuple<MessageTarget, vector<uint8_t>>> messages;
+                vector<vector<uint8_t>> datagrams;
+                for (size_t i = 0; i < IO_URING_TRANSPORT_BUFFER_COUNT * 2; i++) {
+                    vector<uint8_t> datagram(i % 3 == 0 ? 100 : 64, (uint8_t) i);
+                    datagrams.push_back(datagram);
+                    messages.emplace_back(MessageTarget::single(peer), datagram);
+                }
+
+                /// Sent in parts as the socket buffer does not hold all of them at once
+                vector<vector<uint8_t>> received;
+                vector<vector<uint8_t>> buffers(UDP_TRANSPORT_BATCH_SIZE);
+                for (size_t offset = 0; offset < messages.size(); offset += UDP_TRANSPORT_BATCH_SIZE) {
+                    plain->sendBatch(vector<tuple<MessageTarget, vector<uint8_t>>>(
+                            messages.begin() + offset, messages.begin() + offset + UDP_TRANSPORT_BATCH_SIZE));
+
+                    for (size_t batchSize; (batchSize = ring->recvBatch(buffers.data(), buffers.size(), 100)) > 0;) {
+                        received.insert(received.end(), buffers.begin(), buffers.begin() + batchSize);
+                        if (received.size() == offset + UDP_TRANSPORT_BATCH_SIZE) break;
+                    }
+                }
+
+                THEN("the io_uring transport should receive all of them in order") {
+                    REQUIRE(received == datagrams);
+                }
+
+                AND_WHEN("the io_uring transport sends some of them back in one batch") {
+                    /// More than fit into the submission queue at once but few enough for the socket buffer
+                    messages.erase(messages.begin() + IO_URING_TRANSPORT_QUEUE_DEPTH * 4, messages.end());
+                    datagrams.erase(datagrams.begin() + IO_URING_TRANSPORT_QUEUE_DEPTH * 4, datagrams.end());
+                    ring->sendBatch(messages);
+
+                    THEN("the plain one should receive all of them") {
+                        received.clear();
+                        while (received.size() < datagrams.size()) {
+                            size_t batchSize = plain->recvBatch(buffers.data(), buffers.size(), 1000);
+                            if (batchSize == 0) break;
+                            received.insert(received.end(), buffers.begin(), buffers.begin() + batchSize);
+                        }
+
+                        REQUIRE(received == datagrams);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Descriptor of the datagram socket bound to the address or -1 if there is none
+    int socketBoundTo(sockaddr_in address) {
+        for (int descriptor = 0; descriptor < 1024; descriptor++) {
+            sockaddr_in boundAddress{};
+            socklen_t length = sizeof(boundAddress);
+            int type = 0;
+            socklen_t typeLength = sizeof(type);
+
+            if (getsockname(descriptor, (sockaddr *) &boundAddress, &length) == 0 && boundAddress.sin_family == AF_INET &&
+                boundAddress.sin_port == address.sin_port &&
+                getsockopt(descriptor, SOL_SOCKET, SO_TYPE, &type, &typeLength) == 0 && type == SOCK_DGRAM)
+                return descriptor;
+        }
+
+        return -1;
+    }
+
+    SCENARIO("Datagrams whose segmentation is refused should be sent again exactly once",
+             "[integration_test][module][communication][transmission]") {
+        GIVEN("an io_uring transport using GSO and a plain one on the loopback interface") {
+            UDPTransportConfiguration configuration = loopbackRingConfiguration();
+            auto a = IOUringTransport::open(configuration);
+            if (a.isErr() && a.unwrapErr() == IOUringTransport::IOUringTransportError::UNSUPPORTED) return;
+            shared_ptr<IOUringTransport> ring = a.unwrap();
+            shared_ptr<UDPTransport> plain = UDPTransport::open(configuration).unwrap();
+
+            /// Kernels without UDP GSO send single datagrams in the first place
+            if (!ring->usesSegmentationOffload()) return;
+
+            /// Sockets without checksums may only send single datagrams thus the kernel refuses every segmented send
+            int noChecksum = 1;
+            int socket = socketBoundTo(ring->getLocalAddress());
+            REQUIRE(socket >= 0);
+            REQUIRE(setsockopt(socket, SOL_SOCKET, SO_NO_CHECK, &noChecksum, sizeof(noChecksum)) == 0);
+
+            WHEN("a batch is sent whose segmented datagrams lie between single ones for the same peer") {
+                cryptography::UUID peer, otherPeer;
+                ring->setPeerAddress(peer, plain->getLocalAddress());
+                sockaddr_in otherAddress = plain->getLocalAddress();
+                otherAddress.sin_port = htons(9);
+                ring->setPeerAddress(otherPeer, otherAddress);
+
+                vector<tuple<MessageTarget, vector<uint8_t>>> messages = {
+                        make_tuple(MessageTarget::single(peer), vector<uint8_t>(64, 1)),
+                        make_tuple(MessageTarget::single(otherPeer), vector<uint8_t>(64, 2)),
+                        make_tuple(MessageTarget::single(peer), vector<uint8_t>(64, 3)),
+                        make_tuple(MessageTarget::single(peer), vector<uint8_t>(64, 4)),
+                        make_tuple(MessageTarget::single(otherPeer), vector<uint8_t>(64, 5)),
+                        make_tuple(MessageTarget::single(peer), vector<uint8_t>(64, 6))
+                };
+                ring->sendBatch(messages);
+
+                THEN("every datagram should have arrived once and segmentation should have been turned off") {
+                    vector<vector<uint8_t>> received;
+                    vector<vector<uint8_t>> buffers(UDP_TRANSPORT_BATCH_SIZE);
+                    for (size_t batchSize; (batchSize = plain->recvBatch(buffers.data(), buffers.size(), 200)) > 0;)
+                        received.insert(received.end(), buffers.begin(), buffers.begin() + batchSize);
+
+                    sort(received.begin(), received.end());
+                    REQUIRE(received == vector<vector<uint8_t>>({vector<uint8_t>(64, 1), vector<uint8_t>(64, 3),
+                                                                 vector<uint8_t>(64, 4), vector<uint8_t>(64, 6)}));
+                    REQUIRE_FALSE(ring->usesSegmentationOffload());
+                }
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking io_uring against the plain UDP transport", "[.][benchmark][communication][transmission]") {
+        /// Measures how much CPU time the receiving core spends per datagram
+        auto benchmark = [](const char *name, shared_ptr<UDPTransport> sender, shared_ptr<UDPTransport> receiver) {
+            cryptography::UUID peer;
+            sender->setPeerAddress(peer, receiver->getLocalAddress());
+            vector<tuple<MessageTarget, vector<uint8_t>>> batch(UDP_TRANSPORT_BATCH_SIZE,
+                                                                make_tuple(MessageTarget::single(peer), vector<uint8_t>(200, 0)));
+
+            const size_t count = 1000000;
+            size_t received = 0;
+            long long receiveTime = 0;
+            thread receiving([&]() {
+                vector<vector<uint8_t>> buffers(UDP_TRANSPORT_BATCH_SIZE);
+                timespec start{}, end{};
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+                for (size_t batchSize; (batchSize = receiver->recvBatch(buffers.data(), buffers.size(), 200)) > 0;)
+                    received += batchSize;
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+                receiveTime = (end.tv_sec - start.tv_sec) * 1000000000ll + end.tv_nsec - start.tv_nsec;
+            });
+
+            using namespace std::chrono;
+            auto start = steady_clock::now();
+            for (size_t sent = 0; sent < count; sent += batch.size())
+                sender->sendBatch(batch);
+            receiving.join();
+            /// The receiver stopped 200ms after the last datagram
+            auto duration = duration_cast<microseconds>(steady_clock::now() - start).count() - 200000;
+
+            WARN(name << ": " << received * 1000000 / duration << " datagrams per second, "
+                      << (received > 0 ? receiveTime / (long long) received : 0) << "ns of receiving CPU time per datagram ("
+                      << received * 100 / count << "% of the sent ones)");
+        };
+
+        UDPTransportConfiguration configuration = loopbackRingConfiguration();
+        configuration.receiveBufferSize = 1 << 24;
+        configuration.sendBufferSize = 1 << 24;
+
+        auto ring = IOUringTransport::open(configuration);
+        if (ring.isErr()) {
+            WARN("io_uring is not supported by the kernel");
+            return;
+        }
+
+        benchmark("recvmmsg/sendmmsg", UDPTransport::open(configuration).unwrap(), UDPTransport::open(configuration).unwrap());
+        benchmark("io_uring", IOUringTransport::open(configuration).unwrap(), ring.unwrap());
+    }
+
+#endif // UNIT_TESTING
+}
+
+#endif // PROTOMESH_HAVE_IO_URING
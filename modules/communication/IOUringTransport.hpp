@@ -0,0 +1,127 @@
+#ifndef PROTOMESH_IOURINGTRANSPORT_HPP
+#define PROTOMESH_IOURINGTRANSPORT_HPP
+
+#include "UDPTransport.hpp"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+/// Multishot receive and provided buffer rings require the headers of Linux 6.0 or newer
+#ifdef IORING_RECV_MULTISHOT
+#define PROTOMESH_HAVE_IO_URING
+#endif
+
+#ifdef PROTOMESH_HAVE_IO_URING
+
+/// Amount of receive buffers registered with the kernel, has to be a power of two
+#define IO_URING_TRANSPORT_BUFFER_COUNT 512
+/// Size of a receive buffer which holds the header of the kernel, the sender address and the datagram
+#define IO_URING_TRANSPORT_BUFFER_SIZE (sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in) + UDP_TRANSPORT_MAX_DATAGRAM_SIZE)
+/// Maximum amount of sends submitted with a single system call
+#define IO_URING_TRANSPORT_QUEUE_DEPTH 64
+
+namespace ProtoMesh::communication::transmission {
+
+    /// Submission and completion queue of an io_uring instance on top of the raw system calls
+    class IOUring {
+        int descriptor = -1;
+
+        void *ringMemory = nullptr;
+        size_t ringSize = 0;
+        io_uring_sqe *submissionEntries = nullptr;
+        size_t submissionEntriesSize = 0;
+
+        uint32_t *submissionHead = nullptr;
+        uint32_t *submissionTail = nullptr;
+        uint32_t submissionMask = 0;
+        uint32_t submissionCount = 0;
+        /// Entries up to this one have been filled but not yet made visible to the kernel
+        uint32_t localSubmissionTail = 0;
+
+        uint32_t *completionHead = nullptr;
+        uint32_t *completionTail = nullptr;
+        uint32_t completionMask = 0;
+        io_uring_cqe *completionEntries = nullptr;
+
+    public:
+        IOUring() = default;
+        ~IOUring();
+
+        IOUring(const IOUring &) = delete;
+        IOUring &operator=(const IOUring &) = delete;
+
+        /// Returns false if the kernel does not support io_uring or the features used
+        bool setup(unsigned int entries, unsigned int completions);
+        /// Cancels everything in flight, called by the destructor
+        void close();
+
+        /// Cleared entry that is submitted by the next call of submit or nullptr if the queue is full
+        io_uring_sqe *nextSubmission();
+
+        /// Submits all filled entries and waits at most timeout_ms (-1 for no limit) until the amount of completions
+        /// is available. Returns the result of io_uring_enter.
+        int submit(unsigned int completions = 0, int timeout_ms = -1);
+
+        /// Oldest completion that has not been consumed yet or nullptr if there is none
+        io_uring_cqe *peekCompletion();
+        void consumeCompletion();
+
+        /// Becomes readable once a completion is available
+        int fileDescriptor() const { return this->descriptor; }
+    };
+
+    /// UDP transport (see UDPTransport) which moves datagrams through io_uring instead of system calls per batch.
+    /// Both sockets are received from by multishot receives into buffers registered with the kernel so that
+    /// receiving does not require any system call while datagrams arrive. Sends are submitted in batches.
+    /// Requires Linux 6.0 or newer.
+    class IOUringTransport : public UDPTransport {
+        /// The completion queue of the receive ring only holds received datagrams so that it can be polled
+        IOUring receiveRing;
+        IOUring sendRing;
+
+        /// Memory of the receive buffers and the ring they are provided to the kernel with
+        uint8_t *bufferMemory = nullptr;
+        io_uring_buf *bufferRing = nullptr;
+        uint16_t bufferRingTail = 0;
+
+        /// Template of the receives which only sets the size of the sender address
+        msghdr receiveHeader{};
+        /// A multishot receive ends if the kernel ran out of buffers and has to be submitted again
+        bool receiving[2] = {false, false};
+
+        IOUringTransport(UDPTransportConfiguration configuration, Sockets sockets);
+
+        bool registerBuffers();
+        void provideBuffer(uint16_t buffer);
+        void publishBuffers();
+        void submitReceives();
+        size_t receiveCompleted(vector<uint8_t> *buffers, size_t count);
+
+    public:
+        enum class IOUringTransportError {
+            /// The multicast group or interface address could not be parsed
+            INVALID_ADDRESS,
+            /// A socket could not be created, configured or bound
+            SOCKET_ERROR,
+            /// The kernel does not support io_uring or one of the features used
+            UNSUPPORTED
+        };
+
+        static Result<shared_ptr<IOUringTransport>, IOUringTransportError> open(UDPTransportConfiguration configuration);
+        ~IOUringTransport();
+
+        /// TransmissionHandler overrides
+        void sendTo(const MessageTarget &target, vector<uint8_t> message) override;
+        void sendBatch(const vector<tuple<MessageTarget, vector<uint8_t>>> &messages) override;
+        size_t recvBatch(vector<uint8_t> *buffers, size_t count, unsigned int timeout_ms) override;
+        int fileDescriptor() override { return this->receiveRing.fileDescriptor(); }
+    };
+
+}
+
+#endif // PROTOMESH_HAVE_IO_URING
+
+#endif //PROTOMESH_IOURINGTRANSPORT_HPP
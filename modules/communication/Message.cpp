@@ -46,7 +46,12 @@ namespace ProtoMesh::communication {
         vector<uint8_t> signatureVector(this->signature.begin(), this->signature.end());
         auto signature = builder.CreateVector(signatureVector);
 
-        auto message = CreateMessageDatagram(builder, routeVector, payload, signature);
+        /// Serialize the optional sender key
+        flatbuffers::Offset<scheme::cryptography::PublicKey> senderKey = 0;
+        if (this->senderKey.has_value())
+            senderKey = this->senderKey->toBuffer(&builder);
+
+        auto message = CreateMessageDatagram(builder, routeVector, payload, signature, senderKey);
 
         /// Convert it to a byte array
         builder.Finish(message, MessageDatagramIdentifier());
@@ -57,7 +62,7 @@ namespace ProtoMesh::communication {
 
     Message Message::build(const vector<uint8_t> &payload, vector<cryptography::UUID> route,
                            cryptography::asymmetric::PublicKey destinationKey,
-                           cryptography::asymmetric::KeyPair signer) {
+                           cryptography::asymmetric::KeyPair signer, bool includeSenderKey) {
         /// Sign the payload
         SIGNATURE_T signature(cryptography::asymmetric::sign(payload, signer.priv));
 
@@ -66,7 +71,10 @@ namespace ProtoMesh::communication {
         // Note that since the IV is randomly generated its size can't mismatch so we can call unwrap
         vector<uint8_t> encryptedPayload = cryptography::symmetric::encrypt(payload, sharedSecret).unwrap();
 
-        return Message(std::move(route), encryptedPayload, signature);
+        optional<cryptography::asymmetric::PublicKey> senderKey;
+        if (includeSenderKey) senderKey = signer.pub;
+
+        return Message(std::move(route), encryptedPayload, signature, senderKey);
     }
 
     Result<Message, DeserializationError> Message::fromBuffer(vector<uint8_t> buffer) {
@@ -100,7 +108,16 @@ namespace ProtoMesh::communication {
         // TODO Make this more memory efficient.
         copy(msg->signature()->begin(), msg->signature()->end(), signature.begin());
 
-        return Ok(Message(route, payload, signature));
+        /// Deserialize the optional sender key
+        optional<cryptography::asymmetric::PublicKey> senderKey;
+        if (msg->senderKey()) {
+            auto senderKeyResult = cryptography::asymmetric::PublicKey::fromBuffer(msg->senderKey()->compressed());
+            if (senderKeyResult.isErr())
+                return Err(DeserializationError::INVALID_PUB_KEY);
+            senderKey = senderKeyResult.unwrap();
+        }
+
+        return Ok(Message(route, payload, signature, senderKey));
     }
 
 #ifdef UNIT_TESTING
@@ -161,6 +178,29 @@ namespace ProtoMesh::communication {
 
                 // TODO Write a test and function to check encryption and signature
             }
+
+            WHEN("it is built with the sender key attached and serialized") {
+                Message msgWithKey = Message::build(payload, route, destinationKeyPair.pub, keyPair, true);
+                vector<uint8_t> serializedMsg = msgWithKey.serialize();
+
+                THEN("it should be larger than the message without a key") {
+                    REQUIRE(serializedMsg.size() > msg.serialize().size());
+                }
+
+                AND_WHEN("it is deserialized") {
+                    Message deserializedMsg = Message::fromBuffer(serializedMsg).unwrap();
+
+                    THEN("the sender key should be retained") {
+                        REQUIRE(deserializedMsg.senderKey.has_value());
+                        REQUIRE(deserializedMsg.senderKey.value() == keyPair.pub);
+                    }
+
+                    THEN("the payload should be decryptable with the attached key") {
+                        vector<uint8_t> decryptedPayload = deserializedMsg.decryptPayload(deserializedMsg.senderKey.value(), destinationKeyPair).unwrap();
+                        REQUIRE(decryptedPayload == payload);
+                    }
+                }
+            }
         }
     }
 
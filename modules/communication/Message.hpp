@@ -3,6 +3,7 @@
 
 #include <utility>
 #include <vector>
+#include <optional>
 
 using namespace std;
 
@@ -23,21 +24,25 @@ namespace ProtoMesh::communication {
         vector<cryptography::UUID> route;
         vector<uint8_t> payload;
         SIGNATURE_T signature;
+        optional<cryptography::asymmetric::PublicKey> senderKey;
 
         enum class MessageDecryptionError {
             InvalidSignature
         };
 
-        Message(vector<cryptography::UUID> route, vector<uint8_t> payload, SIGNATURE_T signature)
-                : route(std::move(route)), payload(std::move(payload)), signature(signature) {};
+        Message(vector<cryptography::UUID> route, vector<uint8_t> payload, SIGNATURE_T signature,
+                optional<cryptography::asymmetric::PublicKey> senderKey = nullopt)
+                : route(std::move(route)), payload(std::move(payload)), signature(signature), senderKey(senderKey) {};
 
     public:
         /// Member functions
         Result<vector<uint8_t>, MessageDecryptionError> decryptPayload(cryptography::asymmetric::PublicKey sender, cryptography::asymmetric::KeyPair recipient);
 
         /// Constructors
+        /// When includeSenderKey is set the public key of the signer is attached to the message
         static Message build(const vector<uint8_t> &payload, vector<cryptography::UUID> route,
-                             cryptography::asymmetric::PublicKey destinationKey, cryptography::asymmetric::KeyPair signer);
+                             cryptography::asymmetric::PublicKey destinationKey, cryptography::asymmetric::KeyPair signer,
+                             bool includeSenderKey = false);
 
         /// Serializable overrides
         static Result<Message, DeserializationError> fromBuffer(vector<uint8_t> buffer);
@@ -0,0 +1,45 @@
+#ifndef PROTOMESH_MESSAGETARGET_HPP
+#define PROTOMESH_MESSAGETARGET_HPP
+
+#include <optional>
+
+using namespace std;
+
+#include "uuid.hpp"
+
+namespace ProtoMesh::communication {
+
+    class MessageTarget {
+    public:
+        enum class Type {
+            SINGLE,
+            BROADCAST
+        };
+
+        Type type;
+        cryptography::UUID target;
+        /// Node that does not need to receive a broadcast, usually the one it has been received from.
+        /// Transmission media that are unable to exclude single nodes may ignore it.
+        optional<cryptography::UUID> excluded;
+
+        explicit MessageTarget(Type type, cryptography::UUID target = cryptography::UUID::Empty())
+                : type(type), target(target) {};
+
+        static MessageTarget broadcast() {
+            return MessageTarget(Type::BROADCAST);
+        }
+
+        static MessageTarget broadcastExcluding(cryptography::UUID excluded) {
+            MessageTarget target(Type::BROADCAST);
+            target.excluded = excluded;
+            return target;
+        }
+
+        static MessageTarget single(cryptography::UUID target) {
+            return MessageTarget(Type::SINGLE, target);
+        }
+    };
+
+}
+
+#endif //PROTOMESH_MESSAGETARGET_HPP
@@ -1,5 +1,10 @@
 #ifdef UNIT_TESTING
 
+#include <thread>
+#include <atomic>
+#include <set>
+#include <chrono>
+#include <sstream>
 #include "catch.hpp"
 #include "NetworkSimulator.hpp"
 
@@ -10,14 +15,9 @@
 
 namespace ProtoMesh::communication {
 
-    Datagrams Network::processAdvertisement(const Datagram &datagram) {
+    Datagrams Network::processAdvertisement(Routing::IARP::Advertisement advertisement) {
         using namespace Routing::IARP;
 
-        /// Deserialize the advertisement
-        auto advertisementResult = Advertisement::fromBuffer(datagram);
-        if (advertisementResult.isErr()) return {};
-        Advertisement advertisement = advertisementResult.unwrap();
-
         /// Discard the advertisement if it originated from us
         if (advertisement.uuid == this->deviceID) return {};
 
@@ -25,51 +25,221 @@ namespace ProtoMesh::communication {
         if (std::find(advertisement.route.begin(), advertisement.route.end(), this->deviceID) != advertisement.route.end())
             return {};
 
+        /// Store the key in the credentials store or request it if the advertisement only references an unknown one.
+        /// A hash that differs from the one of the stored key means that the advertiser changed its key.
+        Datagrams outgoingDatagrams;
+        if (advertisement.pubKey.has_value()) {
+            cryptography::asymmetric::PublicKey key = advertisement.pubKey.value();
+            auto inserted = this->credentials.insertKey(advertisement.uuid, key);
+
+            auto announcedKeyHash = this->announcedKeyHashes.find(advertisement.uuid);
+            if (announcedKeyHash != this->announcedKeyHashes.end() && announcedKeyHash->second == key.getHash()) {
+                if (inserted.isErr()) this->credentials.replaceKey(advertisement.uuid, key);
+                this->announcedKeyHashes.erase(announcedKeyHash);
+            }
+        } else {
+            auto knownKeyHash = this->credentials.getKeyHash(advertisement.uuid);
+            if (knownKeyHash.isErr() || knownKeyHash.unwrap() != advertisement.keyHash) {
+                if (knownKeyHash.isOk()) this->announcedKeyHashes[advertisement.uuid] = advertisement.keyHash;
+                outgoingDatagrams = this->requestKey(KeyRequest::build(this->deviceID, advertisement.uuid, advertisement.route));
+            }
+        }
+
+        /// Advertisements sent directly by a neighbor reveal the quality of the link to it
+        cryptography::UUID previousHop = advertisement.route.empty() ? advertisement.uuid : advertisement.route.back();
+        if (advertisement.route.empty())
+            this->linkEstimators[previousHop].recordAdvertisement(this->timeProvider->millis(), advertisement.interval);
+
+        /// Account for the link the advertisement arrived over
+        advertisement.pathMetric += this->linkCostTo(previousHop);
+
         /// Store the route in the routing table and add ourselves to the list
         advertisement.addHop(this->deviceID);
         this->routingTable.processAdvertisement(advertisement);
 
-        /// Store the key in the credentials store
-        this->credentials.insertKey(advertisement.uuid, advertisement.pubKey);
+        /// The advertised route might allow us to forward messages we are holding for repair
+        if (!this->repairBuffer.empty())
+            this->retryLocalRepairs();
+
+        /// Our advertisements have to reach the advertiser if we are part of its zone.
+        /// The route already includes us so add one for the advertiser.
+        this->zoneRadiusController.recordAdvertisement(advertisement, advertisement.route.size() + 1,
+                                                       this->timeProvider->millis());
+
+        /// Check if it has already travelled to the border of the zone(s) it has to reach
+        /// We have to add one since the route does not include the advertiser
+        size_t propagationRadius = min<size_t>(advertisement.propagationRadius, ZONE_RADIUS_MAX);
+        bool rebroadcast = advertisement.route.size() + 1 < propagationRadius;
+
+        /// Leave it to the scheduler to decide whether or not the rebroadcast is necessary
+        if (this->suppressAdvertisementRebroadcasts) {
+            this->rebroadcastScheduler.record(advertisement, rebroadcast, this->timeProvider->millis());
+            return outgoingDatagrams;
+        }
 
-        /// Check if it has already travelled to the border of the zone
-        /// We have to subtract one since the route already includes us
-        if (advertisement.route.size() >= ZONE_RADIUS - 1) return {};
+        if (rebroadcast)
+            outgoingDatagrams.emplace_back(MessageTarget::broadcastExcluding(previousHop), advertisement.serialize());
 
-        // TODO Don't rebroadcast to the original sender. Some form of target node white/blacklist maybe
-        //      Optionally obviously since not all transmission media might support it.
-        return { make_tuple(MessageTarget::broadcast(), advertisement.serialize()) };
+        return outgoingDatagrams;
     }
 
-    Datagrams Network::dispatchRouteDiscoveryAcknowledgement(Routing::IERP::RouteDiscovery routeDiscovery) {
-        vector<cryptography::UUID> reversedRoute(routeDiscovery.route.rbegin(), routeDiscovery.route.rend());
-        reversedRoute.push_back(this->deviceID);
-        this->routeCache.addRoute(routeDiscovery.route.front(), reversedRoute);
+    void Network::processPendingRebroadcasts() {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        for (auto &advertisement : this->rebroadcastScheduler.takeDue(this->timeProvider->millis())) {
+            /// The route already includes us so the previous hop is the one before the last
+            size_t hops = advertisement.route.size();
+            cryptography::UUID previousHop = hops < 2 ? advertisement.uuid : advertisement.route[hops - 2];
+
+            this->pushOutgoing({MessageTarget::broadcastExcluding(previousHop), advertisement.serialize()},
+                                     TrafficClass::CONTROL);
+        }
+    }
+
+    void Network::scheduleTimers(long currentTime) {
+        /// Devices that start at the same time advertise themselves at different times right away
+        long jitter = this->advertisementInterval * ADVERTISEMENT_JITTER / 100;
+        this->timers.schedule(currentTime + (long) (this->advertisementJitter() % (jitter + 1)), NetworkTimer::ADVERTISEMENT);
+        this->timers.schedule(currentTime + NETWORK_MAINTENANCE_INTERVAL, NetworkTimer::MAINTENANCE);
+        this->timers.schedule(currentTime + NETWORK_SWEEP_INTERVAL, NetworkTimer::SWEEP);
+    }
+
+    void Network::scheduleAdvertisement(long currentTime) {
+        /// Sent early so that the routes to us are refreshed before they expire at the receivers
+        long jitter = this->advertisementInterval * ADVERTISEMENT_JITTER / 100;
+        long delay = this->advertisementInterval - (long) (this->advertisementJitter() % (jitter + 1));
+        this->timers.schedule(currentTime + max(delay, (long) NETWORK_TIMER_RESOLUTION), NetworkTimer::ADVERTISEMENT);
+    }
+
+    void Network::deleteExpiredState(long currentTime) {
+        this->statistics.expiredRoutesDeleted += this->routingTable.deleteExpiredRoutes();
+        this->statistics.expiredRoutesDeleted += this->routeCache.deleteExpiredRoutes();
+        this->retransmitBuffer.deleteExpiredEntries(currentTime);
+        this->routeSelector.prune([this](const cryptography::UUID &destination) {
+            return this->routingTable.getRouteTo(destination).isOk() || this->routeCache.getRouteTo(destination).isOk();
+        });
+
+        for (auto it = this->keyRequests.begin(); it != this->keyRequests.end();) {
+            if (currentTime - it->second >= KEY_REQUEST_INTERVAL) it = this->keyRequests.erase(it);
+            else ++it;
+        }
+
+        for (auto it = this->routeLifetimeEstimators.begin(); it != this->routeLifetimeEstimators.end();) {
+            if (it->second.isExpired(currentTime)) it = this->routeLifetimeEstimators.erase(it);
+            else ++it;
+        }
+    }
+
+    void Network::processTimers() {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+        long currentTime = this->timeProvider->millis();
+
+        /// Every timer is rescheduled relative to the current time so that missed runs are coalesced into one
+        for (NetworkTimer timer : this->timers.advance(currentTime)) {
+            switch (timer) {
+                case NetworkTimer::ADVERTISEMENT:
+                    if (this->periodicAdvertisements) {
+                        this->pushOutgoing({MessageTarget::broadcast(), this->buildAdvertisement()},
+                                                 TrafficClass::CONTROL);
+                        this->statistics.advertisementsDispatched++;
+                    }
+                    this->scheduleAdvertisement(currentTime);
+                    break;
+                case NetworkTimer::MAINTENANCE:
+                    this->retryPendingDiscoveries();
+                    this->processPendingRebroadcasts();
+                    this->retryLocalRepairs();
+                    this->timers.schedule(currentTime + NETWORK_MAINTENANCE_INTERVAL, NetworkTimer::MAINTENANCE);
+                    break;
+                case NetworkTimer::SWEEP:
+                    this->deleteExpiredState(currentTime);
+                    this->timers.schedule(currentTime + NETWORK_SWEEP_INTERVAL, NetworkTimer::SWEEP);
+                    break;
+            }
+        }
+    }
+
+    Datagrams Network::processKeyRequest(const Routing::IARP::KeyRequest &request, const Datagram &datagram) {
+        auto it = find(request.route.begin(), request.route.end(), this->deviceID);
+        if (it == request.route.end()) return {};
+
+        /// Forward it towards the advertiser
+        if (it + 1 != request.route.end())
+            return { make_tuple(MessageTarget::single(*(it + 1)), datagram) };
+
+        /// Our next advertisement reaches the whole zone so requests of multiple nodes are answered at once
+        this->keyAnnouncementPending = true;
+        return {};
+    }
+
+    Datagrams Network::requestKey(const Routing::IARP::KeyRequest &request) {
+        cryptography::UUID owner = request.route.back();
+        long currentTime = this->timeProvider->millis();
+        auto lastRequest = this->keyRequests.find(owner);
+
+        if (lastRequest != this->keyRequests.end() && currentTime - lastRequest->second < KEY_REQUEST_INTERVAL)
+            return {};
+
+        this->keyRequests[owner] = currentTime;
+        this->statistics.keyRequestsDispatched++;
+        return { make_tuple(MessageTarget::single(request.route[1]), request.serialize()) };
+    }
+
+    void Network::requestAttachedKey(cryptography::UUID sender) {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        /// Only the advertisements of devices within our zone reach us, others are confirmed by route discoveries
+        auto route = this->routingTable.getRouteTo(sender);
+        if (route.isErr()) return;
+
+        for (DatagramPacket &packet : this->requestKey(Routing::IARP::KeyRequest(route.unwrap().route)))
+            this->pushOutgoing(std::move(packet), TrafficClass::CONTROL);
+    }
 
-        using namespace scheme::communication::ierp;
-        flatbuffers::FlatBufferBuilder builder;
+    Datagram Network::buildAdvertisement() {
+        using namespace Routing::IARP;
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        uint32_t sequenceNumber = ++this->advertisementSequenceNumber;
+
+        long currentTime = this->timeProvider->millis();
+
+        if (this->adaptiveZoneRadius &&
+            this->zoneRadiusController.adapt(this->routingTable.getZoneSize(), currentTime)) {
+            this->routingTable.setZoneRadius(this->zoneRadiusController.getZoneRadius());
+            this->statistics.zoneRadiusChanges++;
+        }
 
-        /// Serialize the route
-        vector<scheme::cryptography::UUID> routeEntries;
-        for (auto hop : routeDiscovery.route)
-            routeEntries.push_back(hop.toScheme());
-        routeEntries.push_back(this->deviceID.toScheme());
+        Advertisement advertisement = Advertisement::buildIncremental(this->deviceID, this->deviceKeyHash, sequenceNumber);
+        if (!this->incrementalAdvertisements || this->keyAnnouncementPending) {
+            advertisement.pubKey = this->deviceKeys.pub;
+            this->keyAnnouncementPending = false;
+        }
 
-        auto routeVector = builder.CreateVectorOfStructs(routeEntries);
+        advertisement.interval = this->advertisementInterval;
+        advertisement.zoneRadius = this->zoneRadiusController.getZoneRadius();
+        advertisement.propagationRadius = this->zoneRadiusController.getPropagationRadius(currentTime);
 
-        /// Serialize our public key
-        auto pubKey = this->deviceKeys.pub.toBuffer(&builder);
+        return advertisement.serialize();
+    }
 
-        auto routeDiscoveryAcknowledgement = CreateRouteDiscoveryAcknowledgementDatagram(builder, routeVector,
-                                                                                         pubKey);
+    void Network::setZoneRadius(uint8_t zoneRadius) {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+        this->zoneRadiusController.setZoneRadius(zoneRadius);
+        this->routingTable.setZoneRadius(zoneRadius);
+    }
 
-        /// Convert it to a byte array
-        builder.Finish(routeDiscoveryAcknowledgement, RouteDiscoveryAcknowledgementDatagramIdentifier());
-        uint8_t *buf = builder.GetBufferPointer();
-        vector<uint8_t> routeDiscoveryAcknowledgementDatagram({buf, buf + builder.GetSize()});
+    Datagrams Network::dispatchRouteDiscoveryAcknowledgement(Routing::IERP::RouteDiscovery routeDiscovery) {
+        vector<cryptography::UUID> reversedRoute = {this->deviceID};
+        reversedRoute.insert(reversedRoute.end(), routeDiscovery.route.rbegin(), routeDiscovery.route.rend());
+        this->routeCache.addRoute(routeDiscovery.route.front(), reversedRoute);
 
+        vector<cryptography::UUID> acknowledgedRoute = routeDiscovery.route;
+        acknowledgedRoute.push_back(this->deviceID);
+        Routing::IERP::RouteDiscoveryAcknowledgement acknowledgement(acknowledgedRoute, this->deviceKeys.pub,
+                                                                     routeDiscovery.sentTimestamp);
 
-        auto message = this->sendMessageLocalTo(routeDiscovery.route.back(), routeDiscoveryAcknowledgementDatagram);
+        auto message = this->sendMessageLocalTo(routeDiscovery.route.back(), acknowledgement.serialize());
         if (message.isOk()) return { message.unwrap() };
 
         return {};
@@ -77,7 +247,8 @@ namespace ProtoMesh::communication {
 
     Datagrams Network::rebroadcastRouteDiscovery(Routing::IERP::RouteDiscovery routeDiscovery) {
         /// Get the list of bordercast nodes (destinations to which this should be forwarded) excluding the coveredNodes
-        vector<cryptography::UUID> bordercastNodes = this->routingTable.getBordercastNodes(routeDiscovery.coveredNodes);
+        vector<cryptography::UUID> bordercastNodes = this->routingTable.getBordercastNodes(
+                [&routeDiscovery](const cryptography::UUID &node) { return routeDiscovery.isCovered(node); });
 
         /// Add the bordercast nodes to the list of covered nodes
         routeDiscovery.addCoveredNodes(bordercastNodes);
@@ -87,19 +258,43 @@ namespace ProtoMesh::communication {
         Datagrams outgoingDatagrams = {};
         for (auto bordercastNode : bordercastNodes) {
             auto message = this->sendMessageLocalTo(bordercastNode, serializedDiscovery);
-            if (message.isOk()) return { message.unwrap() };
+            if (message.isOk()) outgoingDatagrams.push_back(message.unwrap());
         }
 
         return outgoingDatagrams;
     }
 
-    Datagrams Network::processRouteDiscovery(const Datagram &datagram) {
-        using namespace Routing::IERP;
+    void Network::learnRoutesFrom(const vector<cryptography::UUID> &route) {
+        if (!this->passiveRouteLearning) return;
+
+        auto self = find(route.begin(), route.end(), this->deviceID);
+        if (self == route.end()) return;
+
+        /// The suffix of the route leads to its destination while the reversed prefix leads back to its origin
+        vector<cryptography::UUID> routeToDestination(self, route.end());
+        vector<cryptography::UUID> routeToOrigin(make_reverse_iterator(self + 1), route.rend());
+
+        for (const vector<cryptography::UUID> &learnedRoute : {routeToDestination, routeToOrigin}) {
+            if (learnedRoute.size() < 2 || learnedRoute.size() > LEARNED_ROUTE_MAXIMUM_LENGTH) continue;
+
+            /// Destinations within our zone are already covered by the routing table
+            cryptography::UUID destination = learnedRoute.back();
+            if (this->routingTable.getRouteTo(destination).isOk()) continue;
+
+            this->routeCache.addRoute(destination, learnedRoute, LEARNED_ROUTE_LIFETIME, true);
+            this->statistics.routesLearned++;
+        }
+    }
 
-        /// Deserialize the route discovery datagram
-        auto routingResult = RouteDiscovery::fromBuffer(datagram);
-        if (routingResult.isErr()) return {};
-        RouteDiscovery routeDiscovery = routingResult.unwrap();
+    Datagrams Network::processRouteDiscovery(Routing::IERP::RouteDiscovery routeDiscovery) {
+        /// Drop copies of discoveries that reached us over another path before doing any further work
+        if (this->suppressDuplicateDiscoveries && !routeDiscovery.route.empty()) {
+            long currentTime = this->timeProvider->millis();
+            if (!this->discoveryHistory.insert(routeDiscovery.route.front(), routeDiscovery.sequenceNumber, currentTime)) {
+                this->statistics.duplicateRouteDiscoveriesDropped++;
+                return {};
+            }
+        }
 
         /// Check if this is meant for us
         if (routeDiscovery.destination == this->deviceID) {
@@ -115,6 +310,11 @@ namespace ProtoMesh::communication {
         if (std::find(routeDiscovery.route.begin(), routeDiscovery.route.end(), this->deviceID) != routeDiscovery.route.end())
             return {};
 
+        /// Remember the origins key so that routes learned from the acknowledgement can be used.
+        /// Nothing ties it to the origin so it is kept apart from the keys we trust.
+        if (this->passiveRouteLearning)
+            this->credentials.insertUnverifiedKey(routeDiscovery.route.front(), routeDiscovery.origin);
+
         /// Add ourselves to the route
         routeDiscovery.addHop(this->deviceID);
 
@@ -126,109 +326,129 @@ namespace ProtoMesh::communication {
 
 
         /// Check whether or not the route discovery has exceeded the maximum route length
-        if (routeDiscovery.route.size() > MAXIMUM_ROUTE_LENGTH) {
-            // TODO Dispatch DeliveryFailureDatagram to sender
+        /// No delivery failure is reported since every branch of the flood would do so.
+        /// The origin relies on its discovery timeout instead.
+        if (routeDiscovery.route.size() > MAXIMUM_ROUTE_LENGTH)
             return {};
-        }
 
         /// Rebroadcast the routeDiscovery to all neighbors
         return this->rebroadcastRouteDiscovery(routeDiscovery);
     }
 
-    Datagrams Network::processRouteDiscoveryAcknowledgement(const Datagram &datagram) {
-        using namespace scheme::communication::ierp;
-
-        /// Verify the buffer type
-        if (!flatbuffers::BufferHasIdentifier(datagram.data(), RouteDiscoveryAcknowledgementDatagramIdentifier()))
-            return {}; // INVALID_IDENTIFIER
-
-        /// Verify buffer integrity
-        auto verifier = flatbuffers::Verifier(datagram.data(), datagram.size());
-        if (!VerifyRouteDiscoveryAcknowledgementDatagramBuffer(verifier))
-            return {}; // INVALID_BUFFER
-
-        auto acknowledgement = GetRouteDiscoveryAcknowledgementDatagram(datagram.data());
-
-        /// Deserialize route
-        vector<cryptography::UUID> route;
-        auto routeBuffer = acknowledgement->route();
-        for (uint i = 0; i < routeBuffer->Length(); i++)
-            route.emplace_back(routeBuffer->Get(i));
+    Datagrams Network::processRouteDiscoveryAcknowledgement(
+            const Routing::IERP::RouteDiscoveryAcknowledgement &acknowledgement, const Datagram &datagram) {
+        const vector<cryptography::UUID> &route = acknowledgement.route;
+        cryptography::UUID discoveredDevice = route.back();
 
         /// Check if we are the final recipient of this route discovery ack and if not forward it accordingly
         /// Since the route in a route discovery acknowledgement is reversed we have to look at route[0]
         auto it = find(route.begin(), route.end(), this->deviceID);
-        if (it != route.end() && it != route.begin()) {
-            // TODO Possibly use this datagram to derive a partial route and cache that instead of ignoring it
+        if (it == route.end()) {
+            // TODO Log that we received a route discovery acknowledgement that wasn't meant for us
+            return {};
+        } else if (it != route.begin()) {
+            /// Derive partial routes to both ends of the discovered route
+            if (this->passiveRouteLearning) {
+                this->credentials.insertUnverifiedKey(discoveredDevice, acknowledgement.targetKey);
+                this->learnRoutesFrom(route);
+            }
+
             cryptography::UUID nextBorderNode = *(it-1);
 
             auto message = this->sendMessageLocalTo(nextBorderNode, datagram);
             if (message.isOk())
                 return { message.unwrap() };
-        } else if (it == route.end()) {
-            // TODO Log that we received a route discovery acknowledgement that wasn't meant for us
+
+            return {};
         }
 
-        /// Deserialize public key
-        auto pubKeyBuffer = acknowledgement->targetKey();
-        auto compressedPubKey = pubKeyBuffer->compressed();
-        auto pubKey = cryptography::asymmetric::PublicKey::fromBuffer(compressedPubKey);
-        if (pubKey.isErr())
-            return {}; // INVALID_PUB_KEY
+        /// Only the first acknowledgement of a discovery is used for measurements
+        /// since later ones for the same discovery would be mistaken for route changes
+        long routeLifetime = ROUTE_CACHE_LIFETIME;
+        if (this->pendingDiscoveries.find(discoveredDevice) != this->pendingDiscoveries.end()) {
+            Routing::IERP::RouteLifetimeEstimator &estimator = this->routeLifetimeEstimators[discoveredDevice];
+            estimator.recordRoundTripTime(this->timeProvider->millis() - acknowledgement.sentTimestamp);
+            estimator.recordRoute(route, this->timeProvider->millis());
+            routeLifetime = estimator.getRouteLifetime();
+        } else {
+            auto estimator = this->routeLifetimeEstimators.find(discoveredDevice);
+            if (estimator != this->routeLifetimeEstimators.end())
+                routeLifetime = estimator->second.getRouteLifetime();
+        }
 
         /// Insert the route into the routeCache and the public key into the credentialsStore
-        cryptography::UUID discoveredDevice = route.back();
-        this->routeCache.addRoute(discoveredDevice, route);
-        this->credentials.insertKey(discoveredDevice, pubKey.unwrap());
+        this->routeCache.addRoute(discoveredDevice, route, routeLifetime);
+        this->credentials.insertKey(discoveredDevice, acknowledgement.targetKey);
 
 
         /// Dispatch messages in the routing queue
-        if (this->routingQueue.find(discoveredDevice) != this->routingQueue.end()) {
-            vector<Datagram> &queuedPayloads = this->routingQueue.at(discoveredDevice);
+        this->pendingDiscoveries.erase(discoveredDevice);
+        vector<Datagram> droppedPayloads;
+        for (QueuedPayload &queuedPayload : this->takeQueuedPayloads(discoveredDevice))
+            if (this->queueMessageTo(discoveredDevice, queuedPayload.payload, queuedPayload.trafficClass,
+                                     queuedPayload.stream).isErr())
+                droppedPayloads.push_back(std::move(queuedPayload.payload));
 
-            for (Datagram payload : queuedPayloads)
-                this->queueMessageTo(discoveredDevice, payload);
-
-            this->routingQueue.erase(discoveredDevice);
-        }
+        if (!droppedPayloads.empty() && this->delegate)
+            this->delegate->didFailToDeliver(discoveredDevice, droppedPayloads, DeliveryFailureReason::QUEUE_FULL);
 
         return {};
     }
 
-    Datagrams Network::processDeliveryFailure(const Datagram &datagram) {
-        return {};
-    }
+    Datagrams Network::processDeliveryFailure(const DeliveryFailure &failure, const Datagram &datagram) {
+        auto it = find(failure.route.begin(), failure.route.end(), this->deviceID);
+        if (it == failure.route.end() || failure.route.empty()) {
+            // TODO Log that we received a delivery failure that wasn't meant for us
+            return {};
+        }
 
-    Datagrams Network::processMessageDatagram(const Datagram &datagram) {
+        /// Stop using the broken link right away, no matter whether we are the recipient or just forwarding
+        this->invalidateLink(failure.route.front(), failure.unreachableHop);
 
-        /// Deserialize the message
-        auto messageResult = Message::fromBuffer(datagram);
-        if (messageResult.isErr()) return {};
-        Message message = messageResult.unwrap();
+        /// Forward it towards the sender of the failed message
+        if (it + 1 != failure.route.end()) {
+            auto message = this->sendMessageLocalTo(*(it + 1), datagram);
+            if (message.isOk())
+                return { message.unwrap() };
+
+            return {};
+        }
 
-        /// Check whether or not the message is meant for us
-        if (message.route.back() == this->deviceID) {
-            /// Attempt to retrieve the senders key
-            auto keyResult = this->credentials.getKey(message.route.front());
+        /// Send the payload of the failed message again which picks an alternative route or discovers a new one
+        auto entry = this->retransmitBuffer.take(failure.messageSignature, this->timeProvider->millis());
+        if (entry.isOk()) {
+            RetransmitEntry retransmission = entry.unwrap();
+            this->statistics.payloadsRetransmitted++;
+
+            auto queued = this->queueMessageTo(retransmission.destination, retransmission.payload,
+                                               retransmission.trafficClass);
+            if (queued.isErr() && this->delegate)
+                this->delegate->didFailToDeliver(retransmission.destination, {retransmission.payload},
+                                                 DeliveryFailureReason::QUEUE_FULL);
+        }
 
-            if (keyResult.isOk()) {
-                cryptography::asymmetric::PublicKey key = keyResult.unwrap();
+        return {};
+    }
 
-                /// Calculate the shared secret and decrypt the payload
-                vector<uint8_t> secret = cryptography::asymmetric::generateSharedSecret(key, this->deviceKeys.priv);
-                vector<uint8_t> plaintext = cryptography::symmetric::decrypt(message.payload, secret);
+    Datagrams Network::dispatchDeliveryFailure(const Message &message, cryptography::UUID unreachableHop) {
+        if (!this->reportDeliveryFailures || message.route.front() == this->deviceID) return {};
 
-                /// Verify the signature and process the decrypted payload
-                if (cryptography::asymmetric::verify(plaintext, message.signature, &key))
-                    return this->processDatagram(plaintext);
-                // TODO Print a warning when a mismatching signature is received
-            } else {
-                // TODO Log that the public key to decrypt was unavailable
-            }
+        DeliveryFailure failure = DeliveryFailure::build(this->deviceID, message.route, unreachableHop, message.signature);
+        this->statistics.deliveryFailuresDispatched++;
 
-            return {};
-        }
+        auto failureMessage = this->sendMessageLocalTo(failure.route[1], failure.serialize());
+        if (failureMessage.isOk())
+            return { failureMessage.unwrap() };
+
+        return {};
+    }
 
+    void Network::invalidateLink(cryptography::UUID a, cryptography::UUID b) {
+        this->routeCache.removeRoutesVia(a, b);
+        this->routingTable.removeRoutesVia(a, b);
+    }
+
+    Datagrams Network::processMessage(const Message &message) {
         /// Get our index in the route to determine the next hop
         auto it = find(message.route.begin(), message.route.end(), this->deviceID);
         if (it == message.route.end()) {
@@ -236,173 +456,858 @@ namespace ProtoMesh::communication {
             return {};
         }
 
+        /// Forward it to the next hop along the route and attempt to repair the route if that fails
+        cryptography::UUID nextHop = *(it+1);
+        auto forwardResult = this->forwardMessage(message);
+
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+        if (forwardResult.isErr())
+            return this->repairMessage(message, nextHop);
+
+        /// Cache the partial routes to the origin and destination of the message
+        this->learnRoutesFrom(message.route);
+
+        return { forwardResult.unwrap() };
+    }
+
+    Result<DatagramPacket, Network::MessageSendError> Network::forwardMessage(const Message &message) {
+        auto it = find(message.route.begin(), message.route.end(), this->deviceID);
+        if (it == message.route.end() || it + 1 == message.route.end())
+            return Err(Network::MessageSendError::TARGET_UNREACHABLE);
+
         /// Get the route to the next hop along the route
         cryptography::UUID nextHop = *(it+1);
-        auto routeToNextHopResult = this->routingTable.getRouteTo(nextHop);
+        unique_lock<recursive_mutex> lock(this->stateMutex);
+        auto routeToNextHopResult = this->selectRouteTo(nextHop, flowOf(message.route.front(), message.route.back()));
         auto nextHopPublicKey = this->credentials.getKey(nextHop);
-        if (routeToNextHopResult.isErr() || nextHopPublicKey.isErr()) {
-            // TODO Dispatch DeliveryFailureDatagram
-            return {};
-        }
+        if (nextHopPublicKey.isErr())
+            return Err(Network::MessageSendError::TARGET_PUBLIC_KEY_UNKNOWN);
+        if (routeToNextHopResult.isErr())
+            return Err(Network::MessageSendError::TARGET_UNREACHABLE);
         auto routeToNextHop = routeToNextHopResult.unwrap();
 
         /// When the route to the next hop is just one in length forward it as is.
         /// Note that we need to subtract one from the size since we are part of the route.
         if (routeToNextHop.route.size()-1 == 1)
-            return { make_tuple(MessageTarget::single(nextHop), message.serialize()) };
+            return Ok(DatagramPacket(MessageTarget::single(nextHop), message.serialize()));
 
-        /// Otherwise wrap it in another message following routeToNextHop and dispatch that
+        /// Otherwise wrap it in another message following routeToNextHop and dispatch that.
+        /// Signing and encrypting it does not touch the routing state so other threads may go on meanwhile.
+        /// Callers that hold the lock themselves (e.g. retryLocalRepairs) keep holding it.
+        lock.unlock();
+        Datagram serializedMessage = message.serialize();
         Message rewrappedMessage = Message::build(
-                message.serialize(),
+                serializedMessage,
                 routeToNextHop.route,
                 nextHopPublicKey.unwrap(),
                 this->deviceKeys);
+        lock.lock();
+
+        /// We are the sender of the rewrapped message so failures on its way to the next hop are reported to us
+        this->retransmitBuffer.insert(nextHop, serializedMessage, rewrappedMessage.signature, this->timeProvider->millis());
 
-        return { make_tuple(MessageTarget::single(routeToNextHop.route[1]), rewrappedMessage.serialize()) };
+        return Ok(DatagramPacket(MessageTarget::single(routeToNextHop.route[1]), rewrappedMessage.serialize()));
     }
 
-    Datagrams Network::processDatagram(const Datagram &datagram) {
+    bool Network::spliceRoute(Message &message) {
+        auto it = find(message.route.begin(), message.route.end(), this->deviceID);
+        if (it == message.route.end() || it + 1 == message.route.end()) return false;
+
+        /// Skip over the unreachable hop to the first later hop that is reachable within our zone
+        for (auto laterHop = it + 2; laterHop < message.route.end(); ++laterHop) {
+            if (this->routingTable.getRouteTo(*laterHop).isOk() && this->credentials.getKey(*laterHop).isOk()) {
+                message.route.erase(it + 1, laterHop);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    Datagrams Network::repairMessage(Message message, cryptography::UUID unreachableHop) {
+        if (!this->localRepair)
+            return this->dispatchDeliveryFailure(message, unreachableHop);
+
+        /// Attempt to repair the route right away
+        if (this->spliceRoute(message)) {
+            auto forwardResult = this->forwardMessage(message);
+            if (forwardResult.isOk()) {
+                this->statistics.localRepairs++;
+                return { forwardResult.unwrap() };
+            }
+        }
+
+        /// Otherwise hold it until a route to one of the remaining hops is advertised
+        auto evictedRepair = this->repairBuffer.insert(message, unreachableHop, this->timeProvider->millis());
+        if (evictedRepair.has_value())
+            return this->dispatchDeliveryFailure(evictedRepair->message, evictedRepair->unreachableHop);
+
+        return {};
+    }
+
+    void Network::retryLocalRepairs() {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+        long currentTime = this->timeProvider->millis();
+
+        for (Routing::IERP::PendingRepair &repair : this->repairBuffer.takeAll()) {
+            auto forwardResult = this->forwardMessage(repair.message);
+            if (forwardResult.isErr() && this->spliceRoute(repair.message))
+                forwardResult = this->forwardMessage(repair.message);
+
+            if (forwardResult.isOk()) {
+                this->statistics.localRepairs++;
+                this->pushOutgoing(forwardResult.unwrap(), TrafficClass::INTERACTIVE);
+                continue;
+            }
+
+            /// Give up and let the sender know once the repair timed out
+            if (currentTime > repair.deadline) {
+                for (DatagramPacket packet : this->dispatchDeliveryFailure(repair.message, repair.unreachableHop))
+                    this->pushOutgoing(packet, TrafficClass::CONTROL);
+                continue;
+            }
+
+            this->repairBuffer.insert(repair);
+        }
+    }
+
+    /// Deserializes the datagram as the content of a prepared datagram of the given type
+    template<class Content>
+    PreparedDatagram prepareContent(PreparedDatagram::Type type, const Datagram &datagram) {
+        auto result = Content::fromBuffer(datagram);
+        if (result.isErr()) return PreparedDatagram(PreparedDatagram::Type::INVALID);
+
+        return PreparedDatagram(type, datagram, result.unwrap());
+    }
+
+    PreparedDatagram Network::prepareDatagram(const Datagram &datagram) {
         using namespace flatbuffers;
+        using Type = PreparedDatagram::Type;
+
+        /// Datagrams too short to carry an identifier can't be part of the communication layer
+        if (datagram.size() < sizeof(uoffset_t) + FlatBufferBuilder::kFileIdentifierLength)
+            return PreparedDatagram(Type::PAYLOAD, datagram);
 
         if (BufferHasIdentifier(datagram.data(), scheme::communication::iarp::AdvertisementDatagramIdentifier()))
-            return this->processAdvertisement(datagram);
+            return prepareContent<Routing::IARP::Advertisement>(Type::ADVERTISEMENT, datagram);
+        else if (BufferHasIdentifier(datagram.data(), scheme::communication::iarp::KeyRequestDatagramIdentifier()))
+            return prepareContent<Routing::IARP::KeyRequest>(Type::KEY_REQUEST, datagram);
         else if (BufferHasIdentifier(datagram.data(), scheme::communication::ierp::RouteDiscoveryDatagramIdentifier()))
-            return this->processRouteDiscovery(datagram);
+            return prepareContent<Routing::IERP::RouteDiscovery>(Type::ROUTE_DISCOVERY, datagram);
         else if (BufferHasIdentifier(datagram.data(), scheme::communication::ierp::RouteDiscoveryAcknowledgementDatagramIdentifier()))
-            return this->processRouteDiscoveryAcknowledgement(datagram);
+            return prepareContent<Routing::IERP::RouteDiscoveryAcknowledgement>(Type::ROUTE_DISCOVERY_ACKNOWLEDGEMENT, datagram);
         else if (BufferHasIdentifier(datagram.data(), scheme::communication::DeliveryFailureDatagramIdentifier()))
-            return this->processDeliveryFailure(datagram);
-        else if (BufferHasIdentifier(datagram.data(), scheme::communication::MessageDatagramIdentifier()))
-            return this->processMessageDatagram(datagram);
+            return prepareContent<DeliveryFailure>(Type::DELIVERY_FAILURE, datagram);
+        else if (!BufferHasIdentifier(datagram.data(), scheme::communication::MessageDatagramIdentifier()))
+            return PreparedDatagram(Type::PAYLOAD, datagram);
 
-        this->incomingBuffer.push_back(datagram);
-        // TODO Call a callback to process the incomingBuffer
-        return {};
-    }
+        /// Deserialize the message
+        auto messageResult = Message::fromBuffer(datagram);
+        if (messageResult.isErr()) return PreparedDatagram(Type::INVALID);
+        Message message = messageResult.unwrap();
 
-    Datagrams Network::discoverDevice(cryptography::UUID device) {
-        vector<cryptography::UUID> bordercastNodes = this->routingTable.getBordercastNodes();
+        /// Messages for other devices are forwarded which depends on the routing state
+        if (message.route.back() != this->deviceID)
+            return PreparedDatagram(Type::MESSAGE, datagram, message);
 
-        // TODO Add a reasonable timestamp
-        Routing::IERP::RouteDiscovery routeDiscovery = Routing::IERP::RouteDiscovery::discover(device, this->deviceKeys.pub, this->deviceID, 0);
-        Datagram payload = routeDiscovery.serialize();
-        Datagrams outgoingDatagrams;
+        if (atomic_load(&this->offloadedDecryptions.service))
+            return PreparedDatagram(Type::ENCRYPTED_MESSAGE, datagram, message);
 
-        for (cryptography::UUID bordercastNode : bordercastNodes) {
-            auto datagram = this->sendMessageLocalTo(bordercastNode, payload);
-            if (datagram.isOk())
-                outgoingDatagrams.push_back(datagram.unwrap());
-        }
+        auto decryptedMessage = this->decryptMessage(message);
+        if (!decryptedMessage) return PreparedDatagram(Type::MESSAGE_FROM_UNKNOWN_SENDER, datagram, message);
 
-        return outgoingDatagrams;
+        /// Verify the signature and prepare the decrypted payload
+        if (cryptography::asymmetric::verify(decryptedMessage->plaintext, decryptedMessage->signature,
+                                             &decryptedMessage->senderKey))
+            return this->prepareDecryptedMessage(decryptedMessage.value());
+
+        // TODO Print a warning when a mismatching signature is received
+        return PreparedDatagram(Type::INVALID);
     }
 
-    Result<DatagramPacket, Network::MessageSendError> Network::sendMessageLocalTo(cryptography::UUID target,
-                                                                                  const Datagram &payload) {
-        auto routeResult = this->routingTable.getRouteTo(target);
-        auto targetPublicKey = this->credentials.getKey(target);
-        if (targetPublicKey.isErr())
-            return Err(Network::MessageSendError::TARGET_PUBLIC_KEY_UNKNOWN);
-        if (routeResult.isErr())
-            return Err(Network::MessageSendError::TARGET_UNREACHABLE);
+    optional<DecryptedMessage> Network::decryptMessage(const Message &message) {
+        /// Attempt to retrieve the senders key and fall back to the one attached to the message
+        auto keyResult = this->credentials.getKey(message.route.front());
+        if (keyResult.isErr() && !message.senderKey.has_value()) return nullopt;
 
+        cryptography::asymmetric::PublicKey key = keyResult.isOk() ? keyResult.unwrap() : message.senderKey.value();
 
-        auto route = routeResult.unwrap();
+        /// Calculate the shared secret and decrypt the payload
+        vector<uint8_t> secret = cryptography::asymmetric::generateSharedSecret(key, this->deviceKeys.priv);
+        vector<uint8_t> plaintext = cryptography::symmetric::decrypt(message.payload, secret);
 
-        Message message = Message::build(payload, route.route, targetPublicKey.unwrap(), this->deviceKeys);
-        DatagramPacket datagram(MessageTarget::single(route.route[1]), message.serialize());
+        return DecryptedMessage{message.route.front(), key, keyResult.isErr(), plaintext, message.signature};
+    }
 
-        return Ok(datagram);
+    PreparedDatagram Network::prepareDecryptedMessage(const DecryptedMessage &decryptedMessage) {
+        if (decryptedMessage.attachedKey) this->requestAttachedKey(decryptedMessage.sender);
+        return this->prepareDatagram(decryptedMessage.plaintext);
     }
 
-    void Network::queueMessageTo(cryptography::UUID target, const Datagram &payload) {
-        /// Attempt to deliver the message within the current zone
-        auto deliveryResult = this->sendMessageLocalTo(target, payload);
+    Datagrams Network::applyDatagram(const PreparedDatagram &prepared) {
+        using Type = PreparedDatagram::Type;
+
+        /// Relayed messages only take the lock while they are not being rewrapped (see forwardMessage)
+        if (prepared.type == Type::MESSAGE)
+            return this->processMessage(get<Message>(prepared.content));
+
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        switch (prepared.type) {
+            case Type::ADVERTISEMENT:
+                return this->processAdvertisement(get<Routing::IARP::Advertisement>(prepared.content));
+            case Type::KEY_REQUEST:
+                return this->processKeyRequest(get<Routing::IARP::KeyRequest>(prepared.content), prepared.datagram);
+            case Type::ROUTE_DISCOVERY:
+                return this->processRouteDiscovery(get<Routing::IERP::RouteDiscovery>(prepared.content));
+            case Type::ROUTE_DISCOVERY_ACKNOWLEDGEMENT:
+                return this->processRouteDiscoveryAcknowledgement(
+                        get<Routing::IERP::RouteDiscoveryAcknowledgement>(prepared.content), prepared.datagram);
+            case Type::DELIVERY_FAILURE:
+                return this->processDeliveryFailure(get<DeliveryFailure>(prepared.content), prepared.datagram);
+            case Type::ENCRYPTED_MESSAGE:
+                return this->decryptAsynchronously(get<Message>(prepared.content));
+            case Type::MESSAGE_FROM_UNKNOWN_SENDER: {
+                auto decryptedMessage = this->decryptMessage(get<Message>(prepared.content));
+                if (!decryptedMessage) {
+                    // TODO Log that the public key to decrypt was unavailable
+                    return {};
+                }
 
-        if (deliveryResult.isOk()) {
-            this->outgoingQueue.push_back(deliveryResult.unwrap());
-            return;
-        }
+                if (!cryptography::asymmetric::verify(decryptedMessage->plaintext, decryptedMessage->signature,
+                                                      &decryptedMessage->senderKey)) {
+                    // TODO Print a warning when a mismatching signature is received
+                    return {};
+                }
 
+                return this->applyDatagram(this->prepareDecryptedMessage(decryptedMessage.value()));
+            }
+            case Type::PAYLOAD:
+                this->bufferIncomingPayload(prepared.datagram);
+                // TODO Call a callback to process the incomingBuffer
+                return {};
+            case Type::MESSAGE:
+                /// Processed before taking the lock
+            case Type::INVALID:
+                return {};
+        }
 
-        /// Attempt to retrieve a route to the destination outside of this zone
-        auto routeResult = this->routeCache.getRouteTo(target);
-        auto targetKey = this->credentials.getKey(target);
+        return {};
+    }
 
-        if (routeResult.isOk() && targetKey.isOk()) {
-            auto route = routeResult.unwrap();
+    Datagrams Network::processDatagram(const Datagram &datagram) {
+        return this->applyDatagram(this->prepareDatagram(datagram));
+    }
 
-            /// Wrap the payload in a message for intrazone transmission
-            Message message = Message::build(payload, route.route, targetKey.unwrap(), this->deviceKeys);
+    Datagrams Network::processDatagrams(const vector<Datagram> &datagrams, size_t count) {
+        using namespace flatbuffers;
 
-            /// Send that message wrapped interzone to the first border node
-            auto borderDeliveryResult = this->sendMessageLocalTo(route.route[1], message.serialize());
-            if (borderDeliveryResult.isOk()) {
-                this->outgoingQueue.push_back(borderDeliveryResult.unwrap());
-                return;
+        /// Messages addressed to us are decrypted right away but verified once all datagrams have been looked at
+        vector<optional<PreparedDatagram>> preparedDatagrams;
+        vector<size_t> decryptedIndices;
+        vector<DecryptedMessage> decryptedMessages;
+
+        bool offloadDecryptions = atomic_load(&this->offloadedDecryptions.service) != nullptr;
+        for (size_t i = 0; i < min(count, datagrams.size()); i++) {
+            const Datagram &datagram = datagrams[i];
+            if (!offloadDecryptions && datagram.size() >= sizeof(uoffset_t) + FlatBufferBuilder::kFileIdentifierLength &&
+                BufferHasIdentifier(datagram.data(), scheme::communication::MessageDatagramIdentifier())) {
+                auto message = Message::fromBuffer(datagram);
+
+                if (message.isOk() && message.unwrap().route.back() == this->deviceID) {
+                    auto decryptedMessage = this->decryptMessage(message.unwrap());
+                    if (decryptedMessage) {
+                        decryptedIndices.push_back(preparedDatagrams.size());
+                        decryptedMessages.push_back(decryptedMessage.value());
+                        preparedDatagrams.emplace_back();
+                    } else {
+                        preparedDatagrams.emplace_back(PreparedDatagram(
+                                PreparedDatagram::Type::MESSAGE_FROM_UNKNOWN_SENDER, datagram, message.unwrap()));
+                    }
+                    continue;
+                }
             }
+
+            preparedDatagrams.emplace_back(this->prepareDatagram(datagram));
         }
 
+        vector<cryptography::asymmetric::SignedText> signedTexts;
+        for (const DecryptedMessage &decryptedMessage : decryptedMessages)
+            signedTexts.push_back({decryptedMessage.plaintext, decryptedMessage.signature, decryptedMessage.senderKey});
 
-        /// Dispatch a route discovery datagram and queue the message
-        if (this->routingQueue.find(target) != this->routingQueue.end()) {
-            vector<Datagram> &queuedPayloads = this->routingQueue.at(target);
-            queuedPayloads.push_back(payload);
-            // TODO Maybe don't dispatch another route discovery within a set timeframe to prevent spamming
-        } else {
-            this->routingQueue.insert({target, {payload}});
+        vector<bool> validSignatures = cryptography::asymmetric::verifyBatch(signedTexts);
+        for (size_t i = 0; i < decryptedMessages.size(); i++) {
+            // TODO Print a warning when a mismatching signature is received
+            preparedDatagrams[decryptedIndices[i]] = validSignatures[i]
+                                                     ? this->prepareDecryptedMessage(decryptedMessages[i])
+                                                     : PreparedDatagram(PreparedDatagram::Type::INVALID);
         }
 
-        for (DatagramPacket packet : this->discoverDevice(target))
-            this->outgoingQueue.push_back(packet);
+        Datagrams outgoingDatagrams;
+        for (const optional<PreparedDatagram> &prepared : preparedDatagrams) {
+            Datagrams resultingDatagrams = this->applyDatagram(prepared.value());
+            outgoingDatagrams.insert(outgoingDatagrams.end(), resultingDatagrams.begin(), resultingDatagrams.end());
+        }
+
+        return outgoingDatagrams;
     }
 
-#ifdef UNIT_TESTING
+    Datagrams Network::decryptAsynchronously(const Message &message) {
+        /// The service might have been detached since the message has been prepared
+        shared_ptr<cryptography::CryptoService> cryptoService = atomic_load(&this->offloadedDecryptions.service);
+        if (!cryptoService)
+            return this->applyDatagram(PreparedDatagram(PreparedDatagram::Type::MESSAGE_FROM_UNKNOWN_SENDER, {}, message));
 
-    SCENARIO("Two devices within the same zone should be able to communicate",
-             "[integration_test][module][communication][network][routing][iarp]") {
-        GIVEN("five devices (keyPair + id + network) A, w, x, B, y") {
-            // Zone layout
-            // A <-> w <-> x <-> B <-> y
-            NetworkSimulator simulator;
-            cryptography::UUID A, w, x, B, y;
-            CAPTURE(A);
-            CAPTURE(w);
-            CAPTURE(x);
-            CAPTURE(B);
-            CAPTURE(y);
+        /// Attempt to retrieve the senders key and fall back to the one attached to the message
+        auto keyResult = this->credentials.getKey(message.route.front());
+        if (keyResult.isErr() && !message.senderKey.has_value()) {
+            // TODO Log that the public key to decrypt was unavailable
+            return {};
+        }
 
-            auto keyA = simulator.createDevice(A, {w});
-            auto keyW = simulator.createDevice(w, {A, x});
-            auto keyX = simulator.createDevice(x, {w, B});
-            auto keyB = simulator.createDevice(B, {x, y});
-            auto keyY = simulator.createDevice(y, {B});
+        cryptography::asymmetric::PublicKey key = keyResult.isOk() ? keyResult.unwrap() : message.senderKey.value();
+        OffloadedDecryptions &offloaded = this->offloadedDecryptions;
+        uint64_t tag = offloaded.nextTag++;
 
-            WHEN("A sends an advertisement to its neighbors") {
-                REQUIRE(simulator.advertiseNode(A));
+        offloaded.pending.insert({tag, PendingDecryption{message.route.front(), key, keyResult.isErr(), nullopt}});
+        cryptoService->submit({cryptography::CryptoJob::decryptAndVerify(
+                tag, message.payload, message.signature, key, this->deviceKeys.priv)}, offloaded.completions);
 
-                THEN("w, x and B should have a route to A") {
-                    vector<cryptography::UUID> expectedRoute_wA = {w, A};
-                    vector<cryptography::UUID> expectedRoute_xA = {x, w, A};
-                    vector<cryptography::UUID> expectedRoute_BA = {B, x, w, A};
+        return {};
+    }
 
-                    REQUIRE(simulator.getNode(w).unwrap()->network.routingTable.getRouteTo(A).unwrap().route == expectedRoute_wA);
-                    REQUIRE(simulator.getNode(x).unwrap()->network.routingTable.getRouteTo(A).unwrap().route == expectedRoute_xA);
-                    REQUIRE(simulator.getNode(B).unwrap()->network.routingTable.getRouteTo(A).unwrap().route == expectedRoute_BA);
-                }
+    void Network::setCryptoService(shared_ptr<cryptography::CryptoService> cryptoService) {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+        atomic_store(&this->offloadedDecryptions.service, std::move(cryptoService));
+    }
 
-                THEN("y should not have a route to A") {
-                    REQUIRE(simulator.getNode(y).unwrap()->network.routingTable.getRouteTo(A).isErr());
-                }
+    void Network::processCryptoCompletions() {
+        lock_guard<mutex> applicationLock(this->offloadedDecryptions.applicationMutex);
 
-                THEN("B should have the public key of A") {
-                    REQUIRE(simulator.getNode(B).unwrap()->network.credentials.getKey(A).isOk());
-                }
+        /// Messages whose decryption completed early wait for the ones that arrived before them
+        vector<PendingDecryption> completedDecryptions;
+        {
+            lock_guard<recursive_mutex> lock(this->stateMutex);
+            OffloadedDecryptions &offloaded = this->offloadedDecryptions;
+
+            for (cryptography::CryptoCompletion &completion : offloaded.completions->takeAll()) {
+                auto pendingDecryption = offloaded.pending.find(completion.tag);
+                if (pendingDecryption != offloaded.pending.end())
+                    pendingDecryption->second.completion = std::move(completion);
+            }
+
+            while (!offloaded.pending.empty() && offloaded.pending.begin()->second.completion) {
+                completedDecryptions.push_back(std::move(offloaded.pending.begin()->second));
+                offloaded.pending.erase(offloaded.pending.begin());
             }
         }
+
+        /// Applied outside of the state lock like received datagrams so that relayed payloads are rewrapped concurrently
+        for (PendingDecryption &decryption : completedDecryptions) {
+            if (!decryption.completion->success) {
+                // TODO Print a warning when a mismatching signature is received
+                continue;
+            }
+
+            if (decryption.attachedKey) this->requestAttachedKey(decryption.sender);
+
+            /// Payloads relayed through us are queued like other forwarded messages (see retryLocalRepairs) while
+            /// responses to the payloads of the communication layer, like acknowledgements of route discoveries, are control traffic
+            PreparedDatagram prepared = this->prepareDatagram(decryption.completion->result);
+            TrafficClass trafficClass = prepared.type == PreparedDatagram::Type::MESSAGE ? TrafficClass::INTERACTIVE
+                                                                                         : TrafficClass::CONTROL;
+            Datagrams datagrams = this->applyDatagram(prepared);
+
+            lock_guard<recursive_mutex> lock(this->stateMutex);
+            for (DatagramPacket &packet : datagrams)
+                this->pushOutgoing(std::move(packet), trafficClass);
+        }
     }
 
-    SCENARIO("Two devices in different zones should be able to communicate",
+    Datagrams Network::drainOutgoingQueue(size_t maxCount) {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+        return this->outgoingQueue.drain(maxCount);
+    }
+
+    Datagrams Network::discoverDevice(cryptography::UUID device) {
+        vector<cryptography::UUID> bordercastNodes = this->routingTable.getBordercastNodes();
+
+        Routing::IERP::RouteDiscovery routeDiscovery = Routing::IERP::RouteDiscovery::discover(
+                device, this->deviceKeys.pub, this->deviceID, this->timeProvider->millis(), ++this->discoverySequenceNumber,
+                this->routeDiscoveryVersion);
+        Datagram payload = routeDiscovery.serialize();
+        Datagrams outgoingDatagrams;
+        this->statistics.routeDiscoveriesDispatched++;
+        this->zoneRadiusController.recordDiscovery();
+
+        for (cryptography::UUID bordercastNode : bordercastNodes) {
+            auto datagram = this->sendMessageLocalTo(bordercastNode, payload);
+            if (datagram.isOk())
+                outgoingDatagrams.push_back(datagram.unwrap());
+        }
+
+        return outgoingDatagrams;
+    }
+
+    unsigned int Network::linkCostTo(cryptography::UUID neighbor) {
+        auto estimator = this->linkEstimators.find(neighbor);
+        if (!this->linkQualityMetric || estimator == this->linkEstimators.end())
+            return LINK_ETX_SCALE;
+
+        return estimator->second.getExpectedTransmissionCount();
+    }
+
+    uint64_t Network::flowOf(cryptography::UUID origin, cryptography::UUID destination) {
+        return origin.hash(destination.hash());
+    }
+
+    uint64_t Network::flowOf(cryptography::UUID destination, optional<uint64_t> stream) {
+        uint64_t flow = flowOf(this->deviceID, destination);
+        if (stream.has_value()) return flow ^ cryptography::hash::mix(stream.value());
+
+        /// Consecutive flows are pinned to consecutive routes (see RouteSelector) which spreads them evenly
+        return flow + this->unstreamedPayloadCount++;
+    }
+
+    Result<Routing::IARP::RoutingTableEntry, Routing::IARP::RouteDiscoveryError>
+    Network::selectRouteTo(cryptography::UUID target, uint64_t flow) {
+        vector<Routing::IARP::RoutingTableEntry> availableRoutes = this->routingTable.getRoutesTo(target);
+        if (availableRoutes.empty()) return Err(Routing::IARP::RouteDiscoveryError::NO_ROUTE_AVAILABLE);
+
+        vector<vector<cryptography::UUID>> routes;
+        vector<unsigned long> costs;
+        for (const Routing::IARP::RoutingTableEntry &entry : availableRoutes) {
+            routes.push_back(entry.route);
+            costs.push_back(entry.cost());
+        }
+
+        return Ok(availableRoutes[this->routeSelector.select(target, routes, costs, flow)]);
+    }
+
+    Result<Routing::IERP::RouteCacheEntry, Routing::IERP::RouteCache::RouteCacheError>
+    Network::selectCachedRouteTo(cryptography::UUID target, uint64_t flow) {
+        vector<Routing::IERP::RouteCacheEntry> availableRoutes = this->routeCache.getRoutesTo(target);
+        if (availableRoutes.empty()) return Err(Routing::IERP::RouteCache::RouteCacheError::NO_ROUTE_AVAILABLE);
+
+        vector<vector<cryptography::UUID>> routes;
+        vector<unsigned long> costs;
+        for (const Routing::IERP::RouteCacheEntry &entry : availableRoutes) {
+            routes.push_back(entry.route);
+            costs.push_back(entry.route.size() - 1);
+        }
+
+        return Ok(availableRoutes[this->routeSelector.select(target, routes, costs, flow)]);
+    }
+
+    Result<DatagramPacket, Network::MessageSendError> Network::sendMessageLocalTo(cryptography::UUID target,
+                                                                                  const Datagram &payload) {
+        return this->sendMessageLocalTo(target, payload, flowOf(this->deviceID, target));
+    }
+
+    Result<DatagramPacket, Network::MessageSendError> Network::sendMessageLocalTo(cryptography::UUID target,
+                                                                                  const Datagram &payload,
+                                                                                  uint64_t flow) {
+        auto messageResult = this->buildMessageLocalTo(target, payload, flow);
+        if (messageResult.isErr())
+            return Err(messageResult.unwrapErr());
+
+        Message message = messageResult.unwrap();
+        DatagramPacket datagram(MessageTarget::single(message.route[1]), message.serialize());
+
+        return Ok(datagram);
+    }
+
+    Result<Message, Network::MessageSendError> Network::buildMessageLocalTo(cryptography::UUID target,
+                                                                            const Datagram &payload,
+                                                                            uint64_t flow) {
+        auto routeResult = this->selectRouteTo(target, flow);
+        auto targetPublicKey = this->credentials.getKey(target);
+        if (targetPublicKey.isErr())
+            return Err(Network::MessageSendError::TARGET_PUBLIC_KEY_UNKNOWN);
+        if (routeResult.isErr())
+            return Err(Network::MessageSendError::TARGET_UNREACHABLE);
+
+
+        auto route = routeResult.unwrap();
+
+        return Ok(Message::build(payload, route.route, targetPublicKey.unwrap(), this->deviceKeys));
+    }
+
+    Result<QueuePressure, QueueError> Network::queueMessageTo(cryptography::UUID target, const Datagram &payload,
+                                                              TrafficClass trafficClass, optional<uint64_t> stream) {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        long currentTime = this->timeProvider->millis();
+        uint64_t flow = this->flowOf(target, stream);
+
+        /// Attempt to deliver the message within the current zone
+        auto localMessage = this->buildMessageLocalTo(target, payload, flow);
+
+        if (localMessage.isOk()) {
+            Message message = localMessage.unwrap();
+            if (!this->pushOutgoing({MessageTarget::single(message.route[1]), message.serialize()}, trafficClass,
+                                    OutgoingPayload{target, payload}))
+                return Err(QueueError::QUEUE_FULL);
+
+            this->retransmitBuffer.insert(target, payload, message.signature, currentTime, trafficClass);
+            return Ok(this->outgoingQueue.pressure());
+        }
+
+
+        /// Attempt to retrieve a route to the destination outside of this zone
+        auto routeResult = this->selectCachedRouteTo(target, flow);
+        auto targetKey = this->credentials.getKey(target);
+        /// Learned routes lead to devices whose key we only know from the traffic we relayed
+        if (targetKey.isErr() && routeResult.isOk() && routeResult.unwrap().learned)
+            targetKey = this->credentials.getUnverifiedKey(target);
+
+        if (routeResult.isOk() && targetKey.isOk()) {
+            auto route = routeResult.unwrap();
+
+            /// Wrap the payload in a message for intrazone transmission
+            /// The target might not know us yet if the route has been learned from relayed traffic
+            Message message = Message::build(payload, route.route, targetKey.unwrap(), this->deviceKeys, route.learned);
+
+            /// Send that message wrapped interzone to the first border node
+            /// Failures may be reported for either message depending on where the route breaks
+            Datagram serializedMessage = message.serialize();
+            auto borderMessage = this->buildMessageLocalTo(route.route[1], serializedMessage, flow);
+            if (borderMessage.isOk()) {
+                Message wrappedMessage = borderMessage.unwrap();
+                if (!this->pushOutgoing({MessageTarget::single(wrappedMessage.route[1]), wrappedMessage.serialize()},
+                                        trafficClass, OutgoingPayload{target, payload}))
+                    return Err(QueueError::QUEUE_FULL);
+
+                this->retransmitBuffer.insert(target, payload, message.signature, currentTime, trafficClass,
+                                              wrappedMessage.signature);
+                return Ok(this->outgoingQueue.pressure());
+            }
+        }
+
+
+        /// Queue the message
+        auto queued = this->enqueuePayload(target, payload, trafficClass, stream);
+        if (queued.isErr()) return queued;
+
+        /// Dispatch a route discovery datagram unless one is already in flight
+        if (this->pendingDiscoveries.find(target) != this->pendingDiscoveries.end()) {
+            this->statistics.routeDiscoveriesSuppressed++;
+            return queued;
+        }
+
+        /// Wait as long as discoveries to this target took before (if any)
+        long discoveryTimeout = ROUTE_DISCOVERY_TIMEOUT;
+        auto estimator = this->routeLifetimeEstimators.find(target);
+        if (estimator != this->routeLifetimeEstimators.end())
+            discoveryTimeout = estimator->second.getDiscoveryTimeout();
+
+        this->pendingDiscoveries.insert({target, Routing::IERP::PendingDiscovery(this->timeProvider->millis(),
+                                                                                 discoveryTimeout)});
+        for (DatagramPacket packet : this->discoverDevice(target))
+            this->pushOutgoing(packet, TrafficClass::CONTROL);
+
+        return queued;
+    }
+
+    void Network::retryPendingDiscoveries() {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        long currentTime = this->timeProvider->millis();
+
+        vector<cryptography::UUID> unreachableTargets;
+        for (auto &entry : this->pendingDiscoveries) {
+            Routing::IERP::PendingDiscovery &pendingDiscovery = entry.second;
+            if (!pendingDiscovery.isDue(currentTime)) continue;
+
+            if (pendingDiscovery.isExhausted()) {
+                unreachableTargets.push_back(entry.first);
+                continue;
+            }
+
+            pendingDiscovery.backoff(currentTime);
+            for (DatagramPacket packet : this->discoverDevice(entry.first))
+                this->pushOutgoing(packet, TrafficClass::CONTROL);
+        }
+
+        /// Give up on the payloads for targets that could not be discovered
+        for (cryptography::UUID target : unreachableTargets) {
+            this->pendingDiscoveries.erase(target);
+
+            vector<Datagram> payloads;
+            for (QueuedPayload &queuedPayload : this->takeQueuedPayloads(target))
+                payloads.push_back(std::move(queuedPayload.payload));
+
+            if (this->delegate)
+                this->delegate->didFailToDeliver(target, payloads, DeliveryFailureReason::TARGET_UNREACHABLE);
+        }
+    }
+
+    void Network::setQueueLimits(QueueLimits limits) {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        this->queueLimits = limits;
+        this->outgoingQueue.setLimit(limits.outgoingQueue, limits.dropPolicy);
+    }
+
+    NetworkQueueMetrics Network::getQueueMetrics() {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        NetworkQueueMetrics metrics = this->queueMetrics;
+        metrics.outgoingQueue.count = this->outgoingQueue.size();
+        metrics.outgoingQueue.bytes = this->outgoingQueue.byteSize();
+        metrics.outgoingQueue.drops = this->outgoingQueue.getDropCount();
+        return metrics;
+    }
+
+    /// Whether or not the drop policy drops a before b
+    bool isDroppedBefore(const QueuedPayload &a, const QueuedPayload &b, DropPolicy policy) {
+        if (policy == DropPolicy::PRIORITY && a.trafficClass != b.trafficClass)
+            return a.trafficClass > b.trafficClass;
+
+        return a.sequenceNumber < b.sequenceNumber;
+    }
+
+    Result<QueuePressure, QueueError> Network::enqueuePayload(cryptography::UUID target, const Datagram &payload,
+                                                              TrafficClass trafficClass, optional<uint64_t> stream) {
+        const QueueLimit &destinationLimit = this->queueLimits.routingQueuePerDestination;
+        const QueueLimit &limit = this->queueLimits.routingQueue;
+        QueueMetrics &metrics = this->queueMetrics.routingQueue;
+
+        if (!destinationLimit.fits(0, 0, payload.size()) || !limit.fits(0, 0, payload.size())) {
+            metrics.drops++;
+            return Err(QueueError::QUEUE_FULL);
+        }
+
+        /// Make room among the payloads for the same destination first and among all of them afterwards
+        size_t destinationCount, destinationBytes;
+        while (true) {
+            destinationCount = 0;
+            destinationBytes = 0;
+            auto queuedPayloads = this->routingQueue.find(target);
+            if (queuedPayloads != this->routingQueue.end()) {
+                destinationCount = queuedPayloads->second.size();
+                for (const QueuedPayload &queuedPayload : queuedPayloads->second)
+                    destinationBytes += queuedPayload.payload.size();
+            }
+
+            bool destinationFits = destinationLimit.fits(destinationCount, destinationBytes, payload.size());
+            if (destinationFits && limit.fits(metrics.count, metrics.bytes, payload.size())) break;
+
+            auto victim = this->selectPayloadToDrop(destinationFits ? nullopt : optional(target), trafficClass);
+            if (!victim.has_value()) {
+                metrics.drops++;
+                return Err(QueueError::QUEUE_FULL);
+            }
+
+            this->dropPayload(get<0>(*victim), get<1>(*victim));
+        }
+
+        this->routingQueue[target].push_back({payload, trafficClass, this->nextQueuedPayloadNumber++, stream});
+        metrics.count++;
+        metrics.bytes += payload.size();
+
+        bool congested = destinationLimit.pressureAt(destinationCount + 1, destinationBytes + payload.size()) ==
+                         QueuePressure::CONGESTED || limit.pressureAt(metrics.count, metrics.bytes) ==
+                         QueuePressure::CONGESTED;
+        return Ok(congested ? QueuePressure::CONGESTED : QueuePressure::NORMAL);
+    }
+
+    optional<tuple<cryptography::UUID, size_t>> Network::selectPayloadToDrop(optional<cryptography::UUID> target,
+                                                                             TrafficClass trafficClass) {
+        DropPolicy policy = this->queueLimits.dropPolicy;
+        if (policy == DropPolicy::NEWEST) return nullopt;
+
+        /// Only the payloads of the target are considered if it is given
+        optional<tuple<cryptography::UUID, size_t>> victim;
+        const QueuedPayload *victimPayload = nullptr;
+        for (const auto &entry : this->routingQueue) {
+            if (target.has_value() && entry.first != *target) continue;
+
+            for (size_t i = 0; i < entry.second.size(); i++) {
+                if (victimPayload && !isDroppedBefore(entry.second[i], *victimPayload, policy)) continue;
+                victim = make_tuple(entry.first, i);
+                victimPayload = &entry.second[i];
+            }
+        }
+
+        /// Payloads of a higher class than the new one are kept
+        if (!victimPayload || (policy == DropPolicy::PRIORITY && victimPayload->trafficClass < trafficClass))
+            return nullopt;
+
+        return victim;
+    }
+
+    void Network::dropPayload(cryptography::UUID target, size_t index) {
+        vector<QueuedPayload> &queuedPayloads = this->routingQueue.at(target);
+        Datagram payload = std::move(queuedPayloads[index].payload);
+        queuedPayloads.erase(queuedPayloads.begin() + index);
+        if (queuedPayloads.empty()) this->routingQueue.erase(target);
+
+        QueueMetrics &metrics = this->queueMetrics.routingQueue;
+        metrics.count--;
+        metrics.bytes -= payload.size();
+        metrics.drops++;
+
+        if (this->delegate)
+            this->delegate->didFailToDeliver(target, {payload}, DeliveryFailureReason::QUEUE_FULL);
+    }
+
+    bool Network::pushOutgoing(DatagramPacket datagram, TrafficClass trafficClass, optional<OutgoingPayload> payload) {
+        bool queued = this->outgoingQueue.push(std::move(datagram), trafficClass, std::move(payload));
+
+        for (OutgoingPayload &droppedPayload : this->outgoingQueue.takeDroppedPayloads())
+            if (this->delegate)
+                this->delegate->didFailToDeliver(droppedPayload.destination, {std::move(droppedPayload.payload)},
+                                                 DeliveryFailureReason::QUEUE_FULL);
+
+        return queued;
+    }
+
+    vector<QueuedPayload> Network::takeQueuedPayloads(cryptography::UUID target) {
+        vector<QueuedPayload> payloads;
+        auto queuedPayloads = this->routingQueue.find(target);
+        if (queuedPayloads == this->routingQueue.end()) return payloads;
+
+        payloads = std::move(queuedPayloads->second);
+        this->routingQueue.erase(queuedPayloads);
+
+        QueueMetrics &metrics = this->queueMetrics.routingQueue;
+        for (const QueuedPayload &queuedPayload : payloads) {
+            metrics.count--;
+            metrics.bytes -= queuedPayload.payload.size();
+        }
+
+        return payloads;
+    }
+
+    void Network::bufferIncomingPayload(const Datagram &payload) {
+        const QueueLimit &limit = this->queueLimits.incomingBuffer;
+        QueueMetrics &metrics = this->queueMetrics.incomingBuffer;
+
+        /// Received payloads have no traffic class so the priority policy drops the oldest ones as well
+        bool dropOlder = this->queueLimits.dropPolicy != DropPolicy::NEWEST && limit.fits(0, 0, payload.size());
+        while (dropOlder && !limit.fits(metrics.count, metrics.bytes, payload.size())) {
+            metrics.count--;
+            metrics.bytes -= this->incomingBuffer.front().size();
+            metrics.drops++;
+            this->incomingBuffer.pop_front();
+        }
+
+        if (!limit.fits(metrics.count, metrics.bytes, payload.size())) {
+            metrics.drops++;
+            return;
+        }
+
+        this->incomingBuffer.push_back(payload);
+        metrics.count++;
+        metrics.bytes += payload.size();
+    }
+
+    vector<Datagram> Network::drainIncomingBuffer() {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        vector<Datagram> payloads(make_move_iterator(this->incomingBuffer.begin()),
+                                  make_move_iterator(this->incomingBuffer.end()));
+        this->incomingBuffer.clear();
+        this->queueMetrics.incomingBuffer.count = 0;
+        this->queueMetrics.incomingBuffer.bytes = 0;
+        return payloads;
+    }
+
+    Datagram Network::createSnapshot(uint64_t currentTime) {
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+
+        long now = this->timeProvider->millis();
+
+        vector<SnapshotRoute> zoneRoutes;
+        for (const Routing::IARP::RoutingTableEntry &entry : this->routingTable.getAllRoutes())
+            zoneRoutes.emplace_back(entry.route, entry.validUntil - now, entry.metric);
+
+        vector<SnapshotRoute> cachedRoutes;
+        for (const Routing::IERP::RouteCacheEntry &entry : this->routeCache.getAllRoutes())
+            cachedRoutes.emplace_back(entry.route, entry.validUntil - now, 0, entry.learned);
+
+        return NetworkSnapshot::build(this->deviceID, currentTime, zoneRoutes, cachedRoutes,
+                                      this->credentials.getAllKeys()).serialize();
+    }
+
+    Result<void, Network::SnapshotRestoreError>
+    Network::restoreSnapshot(NetworkSnapshot snapshot, uint64_t currentTime) {
+        if (snapshot.getDevice() != this->deviceID)
+            return Err(SnapshotRestoreError::FOREIGN_DEVICE);
+
+        /// Snapshots from the future are treated as fresh ones since the clock might have been adjusted
+        uint64_t age = currentTime > snapshot.getCreatedAt() ? currentTime - snapshot.getCreatedAt() : 0;
+        if (age > NETWORK_SNAPSHOT_MAX_AGE)
+            return Err(SnapshotRestoreError::OUTDATED);
+
+        /// Restore the routes that would not have expired in the meantime
+        lock_guard<recursive_mutex> lock(this->stateMutex);
+        long now = this->timeProvider->millis();
+        long elapsedTime = (long) age * 1000;
+
+        for (const SnapshotRoute &route : snapshot.getZoneRoutes())
+            if (route.remainingLifetime > elapsedTime)
+                this->routingTable.insertRoute(Routing::IARP::RoutingTableEntry(
+                        route.route, now + route.remainingLifetime - elapsedTime, route.metric));
+
+        for (const SnapshotRoute &route : snapshot.getCachedRoutes())
+            if (route.remainingLifetime > elapsedTime)
+                this->routeCache.addRoute(route.route.back(), route.route, route.remainingLifetime - elapsedTime,
+                                          route.learned);
+
+        /// Keys are only decoded once they are needed
+        this->credentials.attachSnapshot(make_shared<const NetworkSnapshot>(std::move(snapshot)));
+
+        return Ok();
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Two devices within the same zone should be able to communicate",
+             "[integration_test][module][communication][network][routing][iarp]") {
+        GIVEN("five devices (keyPair + id + network) A, w, x, B, y") {
+            // Zone layout
+            // A <-> w <-> x <-> B <-> y
+            NetworkSimulator simulator;
+            cryptography::UUID A, w, x, B, y;
+            CAPTURE(A);
+            CAPTURE(w);
+            CAPTURE(x);
+            CAPTURE(B);
+            CAPTURE(y);
+
+            auto keyA = simulator.createDevice(A, {w});
+            auto keyW = simulator.createDevice(w, {A, x});
+            auto keyX = simulator.createDevice(x, {w, B});
+            auto keyB = simulator.createDevice(B, {x, y});
+            auto keyY = simulator.createDevice(y, {B});
+
+            WHEN("A sends an advertisement to its neighbors") {
+                REQUIRE(simulator.advertiseNode(A));
+
+                THEN("w, x and B should have a route to A") {
+                    vector<cryptography::UUID> expectedRoute_wA = {w, A};
+                    vector<cryptography::UUID> expectedRoute_xA = {x, w, A};
+                    vector<cryptography::UUID> expectedRoute_BA = {B, x, w, A};
+
+                    REQUIRE(simulator.getNode(w).unwrap()->network.routingTable.getRouteTo(A).unwrap().route == expectedRoute_wA);
+                    REQUIRE(simulator.getNode(x).unwrap()->network.routingTable.getRouteTo(A).unwrap().route == expectedRoute_xA);
+                    REQUIRE(simulator.getNode(B).unwrap()->network.routingTable.getRouteTo(A).unwrap().route == expectedRoute_BA);
+                }
+
+                THEN("y should not have a route to A") {
+                    REQUIRE(simulator.getNode(y).unwrap()->network.routingTable.getRouteTo(A).isErr());
+                }
+
+                THEN("B should have the public key of A") {
+                    REQUIRE(simulator.getNode(B).unwrap()->network.credentials.getKey(A).isOk());
+                }
+            }
+        }
+    }
+
+    SCENARIO("Two devices in different zones should be able to communicate",
              "[integration_test][module][communication][network][routing][ierp]") {
         GIVEN("seven devices (keyPair + id + network) A, w, x, B, y, z, C") {
             // Zone layout
@@ -436,8 +1341,7 @@ namespace ProtoMesh::communication {
                 NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
                 NetworkSimulationNode* nodeC = simulator.getNode(C).unwrap();
 
-                for (auto node : nodes)
-                    REQUIRE(simulator.advertiseNode(node));
+                REQUIRE(simulator.advertiseAll(nodes));
 
                 THEN("C should have B as its bordercast node") {
                     vector<cryptography::UUID> expectedBordercastNodes = {B};
@@ -460,7 +1364,7 @@ namespace ProtoMesh::communication {
                     THEN("A should have a message datagram in its outgoingDatagrams buffer") {
                         REQUIRE(nodeA->network.outgoingQueue.size() == 1);
                         REQUIRE(nodeA->network.routingQueue.size() == 1);
-                        DatagramPacket discovery = nodeA->network.outgoingQueue.back();
+                        DatagramPacket discovery = nodeA->network.outgoingQueue.contents().back();
                         Datagram discoveryData = get<1>(discovery);
 
                         CAPTURE(discoveryData);
@@ -492,5 +1396,1896 @@ namespace ProtoMesh::communication {
         }
     }
 
+    SCENARIO("Route discoveries should reach their target no matter how many nodes they have covered",
+             "[integration_test][module][communication][network][routing][ierp]") {
+        GIVEN("a chain of thirteen devices in which the first one is four zones away from the last one") {
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(13);
+            cryptography::UUID A = nodes.front(), B = nodes.back();
+
+            NetworkSimulator simulator;
+            simulator.createChain(nodes);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            WHEN("A sends a route discovery for B that has already covered 200 unrelated devices") {
+                NetworkSimulationNode *nodeA = simulator.getNode(A).unwrap();
+                Routing::IERP::RouteDiscovery routeDiscovery = Routing::IERP::RouteDiscovery::discover(
+                        B, nodeA->network.deviceKeys.pub, A, nodeA->network.timeProvider->millis(), 1,
+                        ROUTE_DISCOVERY_VERSION_FILTER);
+                routeDiscovery.addCoveredNodes(NetworkSimulator::numberedDevices(200, 1000));
+
+                Datagrams datagrams;
+                for (cryptography::UUID bordercastNode : nodeA->network.routingTable.getBordercastNodes())
+                    datagrams.push_back(nodeA->network.sendMessageLocalTo(bordercastNode, routeDiscovery.serialize()).unwrap());
+                simulator.processDatagrams(datagrams, A);
+
+                THEN("the discovery should have listed the devices the filter could not hold") {
+                    REQUIRE(!routeDiscovery.coveredNodes.empty());
+                }
+
+                THEN("the relays should not have mistaken their bordercast nodes for covered ones") {
+                    REQUIRE(nodeA->network.routeCache.getRouteTo(B).isOk());
+                }
+            }
+        }
+    }
+
+    SCENARIO("Relaying devices should learn routes from traffic passing through them",
+             "[integration_test][module][communication][network][routing][ierp]") {
+        GIVEN("ten devices (keyPair + id + network) in a chain A, w, x, B, y, z, C, p, q, D") {
+            // Zone layout
+            // A <-> w <-> x <-> B <-> y <-> z <-> C <-> p <-> q <-> D
+            NetworkSimulator simulator;
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(10);
+            cryptography::UUID A = nodes[0], B = nodes[3], C = nodes[6], D = nodes[9];
+            simulator.createChain(nodes);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+            NetworkSimulationNode* nodeB = simulator.getNode(B).unwrap();
+            NetworkSimulationNode* nodeC = simulator.getNode(C).unwrap();
+            NetworkSimulationNode* nodeD = simulator.getNode(D).unwrap();
+
+            WHEN("A discovers D") {
+                simulator.processDatagrams(nodeA->network.discoverDevice(D), A);
+                REQUIRE(nodeA->network.routeCache.getRouteTo(D).isOk());
+
+                THEN("the border nodes B and C should have learned partial routes") {
+                    vector<cryptography::UUID> expectedRoute_BD = {B, C, D};
+                    vector<cryptography::UUID> expectedRoute_CA = {C, B, A};
+
+                    REQUIRE(nodeB->network.routeCache.getRouteTo(D).unwrap().route == expectedRoute_BD);
+                    REQUIRE(nodeC->network.routeCache.getRouteTo(A).unwrap().route == expectedRoute_CA);
+                    REQUIRE(nodeB->network.getStatistics().routesLearned == 1);
+                    REQUIRE(nodeC->network.getStatistics().routesLearned == 1);
+                }
+
+                THEN("the keys they relayed should not have been trusted") {
+                    REQUIRE(nodeB->network.credentials.getKey(D).isErr());
+                    REQUIRE(nodeC->network.credentials.getKey(A).isErr());
+                    REQUIRE(nodeB->network.credentials.getUnverifiedKey(D).unwrap() == nodeD->network.getKeys().pub);
+                    REQUIRE(nodeC->network.credentials.getUnverifiedKey(A).unwrap() == nodeA->network.getKeys().pub);
+                }
+
+                AND_WHEN("B and C send messages to D and A respectively") {
+                    Datagram payload = {1, 2, 3, 4, 5};
+                    nodeB->network.queueMessageTo(D, payload);
+                    nodeC->network.queueMessageTo(A, payload);
+
+                    THEN("no further route discoveries should have been dispatched") {
+                        REQUIRE(simulator.sumOfStatistics(&NetworkStatistics::routeDiscoveriesDispatched) == 1);
+                        REQUIRE(nodeB->network.routingQueue.empty());
+                        REQUIRE(nodeC->network.routingQueue.empty());
+                    }
+
+                    AND_WHEN("the messages are dispatched") {
+                        simulator.processMessageQueueOf(B);
+                        simulator.processMessageQueueOf(C);
+
+                        THEN("both recipients should have received the payload") {
+                            REQUIRE(nodeD->network.incomingBuffer.size() == 1);
+                            REQUIRE(nodeD->network.incomingBuffer.back() == payload);
+                            REQUIRE(nodeA->network.incomingBuffer.size() == 1);
+                            REQUIRE(nodeA->network.incomingBuffer.back() == payload);
+                        }
+                    }
+                }
+            }
+
+            WHEN("passive route learning is disabled and A discovers D") {
+                simulator.configureAll([](Network &network) { network.passiveRouteLearning = false; });
+
+                simulator.processDatagrams(nodeA->network.discoverDevice(D), A);
+
+                AND_WHEN("B sends a message to D") {
+                    nodeB->network.queueMessageTo(D, {1, 2, 3});
+
+                    THEN("B has to dispatch a route discovery of its own") {
+                        REQUIRE(nodeB->network.getStatistics().routeDiscoveriesDispatched == 1);
+                        REQUIRE(nodeB->network.routingQueue.size() == 1);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking the route discoveries avoided by passive route learning in a busy mesh",
+             "[.][benchmark][communication][network][routing][ierp]") {
+        /// A strip of 24 by 3 devices that spans several zones in which random pairs of devices exchange messages
+        vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(72);
+
+        for (bool passiveRouteLearning : {true, false}) {
+            NetworkSimulator simulator;
+            simulator.createGrid(nodes, 24);
+            simulator.configureAll([&](Network &network) { network.passiveRouteLearning = passiveRouteLearning; });
+
+            mt19937 randomGenerator(42);
+            uniform_int_distribution<size_t> randomDevice(0, nodes.size() - 1);
+            unsigned long sentMessages = 0;
+            for (uint8_t second = 0; second < 240; second++) {
+                if (second % 10 == 0) simulator.advertiseAll(nodes);
+
+                for (int i = 0; i < 5; i++) {
+                    cryptography::UUID source = nodes[randomDevice(randomGenerator)];
+                    cryptography::UUID target = nodes[randomDevice(randomGenerator)];
+                    if (source == target) continue;
+
+                    simulator.getNode(source).unwrap()->network.queueMessageTo(target, {second});
+                    /// Payloads waiting for a discovery are queued again once it has been acknowledged
+                    simulator.processMessageQueueOf(source);
+                    simulator.processMessageQueueOf(source);
+                    sentMessages++;
+                }
+
+                simulator.turnTheClockBy(1000);
+            }
+
+            unsigned long receivedMessages = 0;
+            for (auto node : nodes)
+                receivedMessages += simulator.getNode(node).unwrap()->network.incomingBuffer.size();
+
+            WARN((passiveRouteLearning ? "with" : "without") << " passive route learning: "
+                         << simulator.sumOfStatistics(&NetworkStatistics::routeDiscoveriesDispatched)
+                         << " route discoveries for " << sentMessages << " messages, "
+                         << simulator.sumOfStatistics(&NetworkStatistics::routesLearned) << " routes learned, "
+                         << receivedMessages << " messages received, "
+                         << simulator.getTransmissionCount() << " transmissions");
+        }
+    }
+
+    SCENARIO("Route discoveries to the same target should be coalesced",
+             "[integration_test][module][communication][network][routing][ierp]") {
+        GIVEN("seven devices (keyPair + id + network) A, w, x, B, y, z, C") {
+            // Zone layout
+            // A <-> w <-> x <-> B <-> y <-> z <-> C
+            NetworkSimulator simulator;
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(7);
+            cryptography::UUID A = nodes[0], C = nodes[6];
+            simulator.createChain(nodes);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+            NetworkSimulationNode* nodeC = simulator.getNode(C).unwrap();
+
+            WHEN("A queues a burst of 100 messages to C") {
+                for (uint8_t i = 0; i < 100; i++)
+                    nodeA->network.queueMessageTo(C, {i});
+
+                THEN("only a single route discovery should have been dispatched") {
+                    REQUIRE(nodeA->network.getStatistics().routeDiscoveriesDispatched == 1);
+                    REQUIRE(nodeA->network.getStatistics().routeDiscoveriesSuppressed == 99);
+                    REQUIRE(nodeA->network.outgoingQueue.size() == 1);
+                    REQUIRE(nodeA->network.routingQueue.at(C).size() == 100);
+                }
+
+                AND_WHEN("the route discovery is processed by the network") {
+                    simulator.processMessageQueueOf(A);
+
+                    THEN("all payloads should have been moved into the outgoingQueue") {
+                        REQUIRE(nodeA->network.pendingDiscoveries.empty());
+                        REQUIRE(nodeA->network.routingQueue.empty());
+                        REQUIRE(nodeA->network.outgoingQueue.size() == 100);
+
+                        AND_WHEN("the messages are dispatched") {
+                            simulator.processMessageQueueOf(A);
+
+                            THEN("C should have received all of them in order") {
+                                REQUIRE(nodeC->network.incomingBuffer.size() == 100);
+                                REQUIRE(nodeC->network.incomingBuffer.front() == Datagram{0});
+                                REQUIRE(nodeC->network.incomingBuffer.back() == Datagram{99});
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Payloads for unreachable targets should be given up on after a few retries",
+             "[unit_test][module][communication][network][routing][ierp]") {
+        GIVEN("a network without any neighbors and a delegate") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            Network network(cryptography::UUID(), cryptography::asymmetric::generateKeyPair(), timeProvider);
+            cryptography::UUID target;
+
+            class FailureRecorder : public NetworkDelegate {
+            public:
+                vector<cryptography::UUID> failedTargets;
+                size_t failedPayloads = 0;
+
+                void didFailToDeliver(cryptography::UUID target, const vector<vector<uint8_t>> &payloads,
+                                      DeliveryFailureReason reason) override {
+                    this->failedTargets.push_back(target);
+                    this->failedPayloads += payloads.size();
+                }
+            };
+
+            auto recorder = make_shared<FailureRecorder>();
+            network.delegate = recorder;
+
+            WHEN("two messages are queued to an unknown target") {
+                network.queueMessageTo(target, {1});
+                network.queueMessageTo(target, {2});
+
+                AND_WHEN("less time than the discovery timeout passes") {
+                    ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(ROUTE_DISCOVERY_TIMEOUT - 1);
+                    network.retryPendingDiscoveries();
+
+                    THEN("no retry should've been dispatched") {
+                        REQUIRE(network.getStatistics().routeDiscoveriesDispatched == 1);
+                    }
+                }
+
+                AND_WHEN("the discovery times out repeatedly") {
+                    for (int i = 0; i < ROUTE_DISCOVERY_MAX_RETRIES; i++) {
+                        ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(ROUTE_DISCOVERY_TIMEOUT << (i + 1));
+                        network.retryPendingDiscoveries();
+                    }
+
+                    THEN("it should have been retried with backoff without giving up yet") {
+                        REQUIRE(network.getStatistics().routeDiscoveriesDispatched == ROUTE_DISCOVERY_MAX_RETRIES + 1);
+                        REQUIRE(recorder->failedTargets.empty());
+                    }
+
+                    AND_WHEN("the last retry times out as well") {
+                        ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(ROUTE_DISCOVERY_TIMEOUT << (ROUTE_DISCOVERY_MAX_RETRIES + 1));
+                        network.retryPendingDiscoveries();
+
+                        THEN("the delegate should have been notified about both payloads") {
+                            REQUIRE(recorder->failedTargets.size() == 1);
+                            REQUIRE(recorder->failedTargets.front() == target);
+                            REQUIRE(recorder->failedPayloads == 2);
+                            REQUIRE(network.routingQueue.empty());
+                            REQUIRE(network.pendingDiscoveries.empty());
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Route discoveries reaching a node over multiple paths should only be relayed once",
+             "[integration_test][module][communication][network][routing][ierp]") {
+        GIVEN("a ring of twelve devices where each bordercast node can be reached in two directions") {
+            // Zone layout (O's bordercast nodes are P and Q which in turn share R as a bordercast node)
+            // O <-> a1 <-> a2 <-> P <-> b1 <-> b2 <-> R
+            // O <-> c1 <-> c2 <-> Q <-> d1 <-> d2 <-> R
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(12);
+            cryptography::UUID O = nodes[0];
+            cryptography::UUID unknownDevice = cryptography::UUID::fromNumber(100);
+
+            auto createRing = [&nodes](NetworkSimulator &simulator, bool suppressDuplicates) {
+                simulator.createRing(nodes);
+                simulator.configureAll([&](Network &network) {
+                    network.suppressDuplicateDiscoveries = suppressDuplicates;
+                });
+                simulator.advertiseAll(nodes);
+            };
+
+            NetworkSimulator simulator;
+            NetworkSimulator referenceSimulator;
+            createRing(simulator, true);
+            createRing(referenceSimulator, false);
+
+            WHEN("O floods a route discovery for a device that does not exist in both networks") {
+                unsigned long transmissionsBefore = simulator.getTransmissionCount();
+                unsigned long referenceTransmissionsBefore = referenceSimulator.getTransmissionCount();
+
+                NetworkSimulationNode* nodeO = simulator.getNode(O).unwrap();
+                NetworkSimulationNode* referenceNodeO = referenceSimulator.getNode(O).unwrap();
+                simulator.processDatagrams(nodeO->network.discoverDevice(unknownDevice), O);
+                referenceSimulator.processDatagrams(referenceNodeO->network.discoverDevice(unknownDevice), O);
+
+                unsigned long transmissions = simulator.getTransmissionCount() - transmissionsBefore;
+                unsigned long referenceTransmissions = referenceSimulator.getTransmissionCount() - referenceTransmissionsBefore;
+                CAPTURE(transmissions);
+                CAPTURE(referenceTransmissions);
+
+                THEN("duplicates should have been dropped and the flood should have caused less traffic") {
+                    REQUIRE(simulator.sumOfStatistics(&NetworkStatistics::duplicateRouteDiscoveriesDropped) > 0);
+                    REQUIRE(transmissions < referenceTransmissions);
+                }
+            }
+        }
+
+        GIVEN("seven devices in a chain where A restarts right after discovering C") {
+            // Zone layout
+            // A <-> n1 <-> n2 <-> B <-> n4 <-> n5 <-> C
+            NetworkSimulator simulator;
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(7);
+            cryptography::UUID A = nodes[0], C = nodes[6];
+            simulator.createChain(nodes);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            simulator.processDatagrams(simulator.getNode(A).unwrap()->network.discoverDevice(C), A);
+            simulator.restartDevice(A);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            WHEN("A discovers C again while the relays still remember its previous discovery") {
+                NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+                simulator.processDatagrams(nodeA->network.discoverDevice(C), A);
+
+                THEN("the discovery should not have been mistaken for a duplicate") {
+                    REQUIRE(simulator.sumOfStatistics(&NetworkStatistics::duplicateRouteDiscoveriesDropped) == 0);
+                    REQUIRE(nodeA->network.routeCache.getRouteTo(C).isOk());
+                }
+            }
+        }
+    }
+
+    SCENARIO("Traffic to a device reachable over multiple paths should be spread across them",
+             "[integration_test][module][communication][network][routing][iarp]") {
+        GIVEN("four devices where A can reach B through two disjoint relays") {
+            // Zone layout
+            // A <-> m1 <-> B
+            // A <-> m2 <-> B
+            cryptography::UUID A, m1, m2, B;
+
+            auto createDiamond = [&](NetworkSimulator &simulator, optional<Routing::RouteSelectionPolicy> policy) {
+                simulator.createDevice(A, {m1, m2});
+                simulator.createDevice(m1, {A, B});
+                simulator.createDevice(m2, {A, B});
+                simulator.createDevice(B, {m1, m2});
+                if (policy.has_value())
+                    simulator.getNode(A).unwrap()->network.setRouteSelectionPolicy(policy.value());
+
+                simulator.advertiseNode(A);
+                simulator.advertiseNode(B);
+            };
+
+            auto sendMessages = [&](NetworkSimulator &simulator, int count, optional<uint64_t> stream = nullopt) {
+                NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+                for (int i = 0; i < count; i++)
+                    nodeA->network.queueMessageTo(B, {1, 2, 3, 4, 5, 6, 7, (uint8_t) i}, TrafficClass::INTERACTIVE,
+                                                  stream);
+                simulator.processMessageQueueOf(A);
+            };
+
+            NetworkSimulator simulator;
+            NetworkSimulator referenceSimulator;
+            createDiamond(simulator, Routing::RouteSelectionPolicy::ROUND_ROBIN);
+            createDiamond(referenceSimulator, Routing::RouteSelectionPolicy::SHORTEST);
+
+            THEN("A should know both routes to B") {
+                REQUIRE(simulator.getNode(A).unwrap()->network.routingTable.getRoutesTo(B).size() == 2);
+            }
+
+            WHEN("A sends ten messages to B in both networks") {
+                unsigned long m1Before = simulator.getReceptionCount(m1);
+                unsigned long m2Before = simulator.getReceptionCount(m2);
+                unsigned long referenceM1Before = referenceSimulator.getReceptionCount(m1);
+                unsigned long referenceM2Before = referenceSimulator.getReceptionCount(m2);
+                unsigned long bBefore = simulator.getReceptionCount(B);
+
+                sendMessages(simulator, 10);
+                sendMessages(referenceSimulator, 10);
+
+                unsigned long m1Load = simulator.getReceptionCount(m1) - m1Before;
+                unsigned long m2Load = simulator.getReceptionCount(m2) - m2Before;
+                unsigned long referenceM1Load = referenceSimulator.getReceptionCount(m1) - referenceM1Before;
+                unsigned long referenceM2Load = referenceSimulator.getReceptionCount(m2) - referenceM2Before;
+
+                THEN("all messages should have arrived at B") {
+                    REQUIRE(simulator.getReceptionCount(B) - bBefore == 10);
+                }
+
+                THEN("the load on the busiest relay should have been halved") {
+                    REQUIRE(m1Load == 5);
+                    REQUIRE(m2Load == 5);
+                    REQUIRE(max(referenceM1Load, referenceM2Load) == 10);
+                }
+            }
+
+            WHEN("A sends ten messages to B with the default policy") {
+                NetworkSimulator defaultSimulator;
+                createDiamond(defaultSimulator, nullopt);
+                unsigned long m1Before = defaultSimulator.getReceptionCount(m1);
+                unsigned long m2Before = defaultSimulator.getReceptionCount(m2);
+
+                sendMessages(defaultSimulator, 10);
+
+                THEN("they should have been spread across both relays") {
+                    REQUIRE(defaultSimulator.getReceptionCount(m1) - m1Before == 5);
+                    REQUIRE(defaultSimulator.getReceptionCount(m2) - m2Before == 5);
+                }
+
+                AND_WHEN("A sends ten more messages as part of a single stream") {
+                    NetworkSimulationNode* nodeB = defaultSimulator.getNode(B).unwrap();
+                    nodeB->network.drainIncomingBuffer();
+                    m1Before = defaultSimulator.getReceptionCount(m1);
+                    m2Before = defaultSimulator.getReceptionCount(m2);
+
+                    sendMessages(defaultSimulator, 10, 7);
+
+                    THEN("all of them should have taken the same relay and arrived in order") {
+                        unsigned long m1Load = defaultSimulator.getReceptionCount(m1) - m1Before;
+                        unsigned long m2Load = defaultSimulator.getReceptionCount(m2) - m2Before;
+                        REQUIRE(max(m1Load, m2Load) == 10);
+
+                        vector<Datagram> received = nodeB->network.drainIncomingBuffer();
+                        REQUIRE(received.size() == 10);
+                        for (uint8_t i = 0; i < 10; i++)
+                            REQUIRE(received[i].back() == i);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Routes over lossy links should be avoided in favour of longer but reliable ones",
+             "[integration_test][module][communication][network][routing][iarp]") {
+        GIVEN("five devices where the shortest route from A to B contains a lossy link") {
+            // Zone layout (the link between A and L loses half of all transmissions)
+            // A <~> L <-> B
+            // A <-> c1 <-> c2 <-> B
+            cryptography::UUID A, L, B, c1, c2;
+
+            auto createNetwork = [&](NetworkSimulator &simulator, bool linkQualityMetric) {
+                simulator.createDevice(A, {L, c1});
+                simulator.createDevice(L, {A, B});
+                simulator.createDevice(B, {L, c2});
+                simulator.createDevice(c1, {A, c2});
+                simulator.createDevice(c2, {c1, B});
+                simulator.setLinkLoss(A, L, 50);
+
+                for (auto node : {A, L, B, c1, c2})
+                    simulator.getNode(node).unwrap()->network.linkQualityMetric = linkQualityMetric;
+            };
+
+            /// Advertise every interval and send a few messages in between
+            auto runRounds = [&](NetworkSimulator &simulator) {
+                NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+                for (int round = 0; round < 20; round++) {
+                    simulator.turnTheClockBy(10000);
+                    for (auto node : {A, L, B, c1, c2})
+                        simulator.advertiseNode(node);
+
+                    for (int i = 0; i < 5; i++)
+                        nodeA->network.queueMessageTo(B, {1, 2, 3, 4, 5, 6, (uint8_t) round, (uint8_t) i});
+                    simulator.processMessageQueueOf(A);
+                }
+            };
+
+            NetworkSimulator simulator;
+            NetworkSimulator referenceSimulator;
+            createNetwork(simulator, true);
+            createNetwork(referenceSimulator, false);
+
+            WHEN("A sends a hundred messages to B while routes are advertised in both networks") {
+                runRounds(simulator);
+                runRounds(referenceSimulator);
+
+                size_t delivered = simulator.getNode(B).unwrap()->network.incomingBuffer.size();
+                size_t referenceDelivered = referenceSimulator.getNode(B).unwrap()->network.incomingBuffer.size();
+                CAPTURE(delivered);
+                CAPTURE(referenceDelivered);
+
+                THEN("A should have noticed that the link to L is lossy") {
+                    NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+                    REQUIRE(nodeA->network.linkEstimators.at(L).getDeliveryRatio() < 1.0);
+                    REQUIRE(nodeA->network.linkEstimators.at(c1).getDeliveryRatio() == Approx(1.0));
+                }
+
+                THEN("more messages should have arrived than when routing by hop count") {
+                    REQUIRE(referenceDelivered < 100);
+                    REQUIRE(delivered > referenceDelivered);
+                }
+            }
+        }
+    }
+
+    SCENARIO("Routes that are rediscovered unchanged should be cached for longer",
+             "[integration_test][module][communication][network][routing][ierp]") {
+        GIVEN("seven devices in a chain A, w, x, B, y, z, C") {
+            // Zone layout
+            // A <-> w <-> x <-> B <-> y <-> z <-> C
+            NetworkSimulator simulator;
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(7);
+            cryptography::UUID A = nodes[0], C = nodes[6];
+            simulator.createChain(nodes);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+            Datagram payload = {1, 2, 3, 4, 5, 6, 7, 8};
+
+            WHEN("A sends a message to C and the route discovery takes 300ms") {
+                nodeA->network.queueMessageTo(C, payload);
+                simulator.turnTheClockBy(300);
+                simulator.processMessageQueueOf(A);
+
+                THEN("the round trip time should have been measured") {
+                    Routing::IERP::RouteLifetimeEstimator estimator = nodeA->network.routeLifetimeEstimators.at(C);
+                    REQUIRE(estimator.getSmoothedRoundTripTime() == 300);
+                    REQUIRE(estimator.getDiscoveryTimeout() == 900);
+                }
+
+                THEN("the route should be cached for the default lifetime") {
+                    REQUIRE(nodeA->network.routeCache.getRouteTo(C).unwrap().validUntil == 300 + ROUTE_CACHE_LIFETIME);
+                }
+
+                AND_WHEN("the route expires and C is discovered again over the same route") {
+                    simulator.turnTheClockBy(ROUTE_CACHE_LIFETIME + 1000);
+                    REQUIRE(simulator.advertiseAll(nodes));
+
+                    REQUIRE(nodeA->network.routeCache.getRouteTo(C).isErr());
+                    nodeA->network.queueMessageTo(C, payload);
+                    simulator.processMessageQueueOf(A);
+
+                    THEN("the route should be cached for twice as long") {
+                        long currentTime = 300 + ROUTE_CACHE_LIFETIME + 1000;
+                        REQUIRE(nodeA->network.routeCache.getRouteTo(C).unwrap().validUntil ==
+                                currentTime + 2 * ROUTE_CACHE_LIFETIME);
+                    }
+                }
+
+                AND_WHEN("C is not discovered again for a long time") {
+                    simulator.turnTheClockBy(ROUTE_LIFETIME_ESTIMATOR_EXPIRY);
+                    nodeA->network.processTimers();
+
+                    THEN("the estimator of C should have been discarded") {
+                        REQUIRE(nodeA->network.routeLifetimeEstimators.find(C) == nodeA->network.routeLifetimeEstimators.end());
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Messages should be rerouted as soon as a broken link is reported",
+             "[integration_test][module][communication][network][routing][ierp]") {
+        GIVEN("a ring of twelve devices where O reaches the opposite device R over either half of the ring") {
+            // Zone layout (O's bordercast nodes are P and Q which in turn have R as a bordercast node)
+            // O <-> a1 <-> a2 <-> P <-> b1 <-> b2 <-> R
+            // O <-> c1 <-> c2 <-> Q <-> d1 <-> d2 <-> R
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(12);
+            cryptography::UUID O = nodes[0], P = nodes[3], R = nodes[6];
+
+            auto createRing = [&nodes](NetworkSimulator &simulator, bool reportDeliveryFailures) {
+                simulator.createRing(nodes);
+                simulator.configureAll([&](Network &network) {
+                    network.reportDeliveryFailures = reportDeliveryFailures;
+                    /// There is no way around the broken link within the zone so relays should not hold messages
+                    network.localRepair = false;
+                });
+                simulator.advertiseAll(nodes);
+            };
+
+            /// Breaks the link next to R on the half of the ring O currently uses and
+            /// returns the time in seconds until a message from O arrives at R again
+            auto measureRecovery = [&](NetworkSimulator &simulator) {
+                NetworkSimulationNode* nodeO = simulator.getNode(O).unwrap();
+                NetworkSimulationNode* nodeR = simulator.getNode(R).unwrap();
+                Datagram payload = {1, 2, 3, 4, 5, 6, 7, 8};
+
+                nodeO->network.queueMessageTo(R, payload);
+                simulator.processMessageQueueOf(O);
+                simulator.processMessageQueueOf(O);
+                REQUIRE(nodeR->network.incomingBuffer.size() == 1);
+
+                bool usesP = nodeO->network.routeCache.getRouteTo(R).unwrap().route[1] == P;
+                simulator.disconnect(R, usesP ? nodes[5] : nodes[7]);
+
+                for (int second = 1; second <= 120; second++) {
+                    simulator.turnTheClockBy(1000);
+                    if (second % 10 == 0)
+                        simulator.advertiseAll(nodes);
+
+                    size_t receivedMessages = nodeR->network.incomingBuffer.size();
+                    nodeO->network.queueMessageTo(R, payload);
+                    for (int i = 0; i < 3; i++)
+                        simulator.processMessageQueueOf(O);
+
+                    if (nodeR->network.incomingBuffer.size() > receivedMessages)
+                        return second;
+                }
+
+                return -1;
+            };
+
+            NetworkSimulator simulator;
+            NetworkSimulator referenceSimulator;
+            createRing(simulator, true);
+            createRing(referenceSimulator, false);
+
+            WHEN("O sends a message to R over a border node") {
+                NetworkSimulationNode* nodeO = simulator.getNode(O).unwrap();
+                nodeO->network.queueMessageTo(R, {1, 2, 3});
+                simulator.processMessageQueueOf(O);
+                simulator.processMessageQueueOf(O);
+
+                THEN("the payload should have been kept for retransmission once") {
+                    REQUIRE(simulator.getNode(R).unwrap()->network.incomingBuffer.size() == 1);
+                    REQUIRE(nodeO->network.retransmitBuffer.size() == 1);
+                }
+            }
+
+            WHEN("the route used by O breaks in both networks") {
+                int recoveryTime = measureRecovery(simulator);
+                int referenceRecoveryTime = measureRecovery(referenceSimulator);
+                CAPTURE(recoveryTime);
+                CAPTURE(referenceRecoveryTime);
+
+                THEN("messages should arrive again once the zone noticed the broken link") {
+                    REQUIRE(recoveryTime > 0);
+                    REQUIRE(recoveryTime <= 11);
+                    REQUIRE(simulator.getNode(O).unwrap()->network.getStatistics().payloadsRetransmitted > 0);
+                }
+
+                THEN("recovery should be faster than waiting for the cached route to expire") {
+                    REQUIRE(referenceRecoveryTime > ROUTE_CACHE_LIFETIME / 1000);
+                    REQUIRE(recoveryTime < referenceRecoveryTime);
+                }
+            }
+        }
+    }
+
+    SCENARIO("Relays should repair broken routes locally without involving the origin",
+             "[integration_test][module][communication][network][routing][ierp]") {
+        GIVEN("ten devices in a chain and a mobile device s that might connect B and D") {
+            // Zone layout (the link between s and its neighbors is broken at first)
+            // A <-> a1 <-> a2 <-> B <-> b1 <-> b2 <-> C <-> c1 <-> c2 <-> D
+            //                     B <~> s <~> D
+            NetworkSimulator simulator;
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(10);
+            cryptography::UUID A = nodes[0], B = nodes[3], C = nodes[6], D = nodes[9];
+            cryptography::UUID s = cryptography::UUID::fromNumber(100);
+
+            simulator.createChain(nodes);
+            simulator.createDevice(s, {B, D});
+            simulator.connect(s, B);
+            simulator.connect(s, D);
+            simulator.disconnect(s, B);
+            simulator.disconnect(s, D);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+            NetworkSimulationNode* nodeB = simulator.getNode(B).unwrap();
+            NetworkSimulationNode* nodeD = simulator.getNode(D).unwrap();
+            Datagram payload = {1, 2, 3, 4, 5, 6, 7, 8};
+
+            /// Discover D and deliver a first message over A, B, C and D
+            nodeA->network.queueMessageTo(D, payload);
+            simulator.processMessageQueueOf(A);
+            simulator.processMessageQueueOf(A);
+            REQUIRE(nodeD->network.incomingBuffer.size() == 1);
+            REQUIRE(nodeA->network.routeCache.getRouteTo(D).unwrap().route == vector<cryptography::UUID>({A, B, C, D}));
+
+            /// Break the link between b2 and C and wait until B notices that C is no longer reachable
+            simulator.disconnect(nodes[5], C);
+
+            auto advertiseAndSend = [&]() {
+                simulator.turnTheClockBy(10000);
+                simulator.advertiseAll(nodes);
+                simulator.turnTheClockBy(1000);
+
+                nodeA->network.queueMessageTo(D, payload);
+                for (int i = 0; i < 3; i++)
+                    simulator.processMessageQueueOf(A);
+            };
+
+            WHEN("s connects B and D before B notices") {
+                simulator.setLinkLoss(s, B, 0);
+                simulator.setLinkLoss(s, D, 0);
+                advertiseAndSend();
+
+                THEN("B should have forwarded the message to D over s without involving A") {
+                    REQUIRE(nodeD->network.incomingBuffer.size() == 2);
+                    REQUIRE(nodeB->network.getStatistics().localRepairs == 1);
+                    REQUIRE(nodeB->network.getStatistics().deliveryFailuresDispatched == 0);
+                    REQUIRE(nodeA->network.getStatistics().routeDiscoveriesDispatched == 1);
+                }
+            }
+
+            WHEN("there is no way around the broken link when B notices") {
+                advertiseAndSend();
+
+                THEN("B should hold the message") {
+                    REQUIRE(nodeD->network.incomingBuffer.size() == 1);
+                    REQUIRE(nodeB->network.repairBuffer.size() == 1);
+                    REQUIRE(nodeB->network.getStatistics().deliveryFailuresDispatched == 0);
+                }
+
+                AND_WHEN("s connects B and D and D advertises itself shortly after") {
+                    simulator.setLinkLoss(s, B, 0);
+                    simulator.setLinkLoss(s, D, 0);
+                    simulator.turnTheClockBy(1000);
+                    simulator.advertiseNode(D);
+                    simulator.processMessageQueueOf(B);
+
+                    THEN("B should have forwarded the held message over s") {
+                        REQUIRE(nodeD->network.incomingBuffer.size() == 2);
+                        REQUIRE(nodeB->network.repairBuffer.empty());
+                        REQUIRE(nodeB->network.getStatistics().localRepairs == 1);
+                        REQUIRE(nodeA->network.getStatistics().routeDiscoveriesDispatched == 1);
+                    }
+                }
+
+                AND_WHEN("the repair times out") {
+                    simulator.turnTheClockBy(REPAIR_TIMEOUT + 1);
+                    nodeB->network.retryLocalRepairs();
+                    simulator.processMessageQueueOf(B);
+
+                    THEN("B should have reported the failure to A which retransmitted the payload") {
+                        REQUIRE(nodeB->network.repairBuffer.empty());
+                        REQUIRE(nodeB->network.getStatistics().deliveryFailuresDispatched == 1);
+                        REQUIRE(nodeA->network.getStatistics().payloadsRetransmitted == 1);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Incremental advertisements should only carry the public key when it is needed",
+             "[integration_test][module][communication][network][routing][iarp]") {
+        GIVEN("six devices in a chain") {
+            // Zone layout
+            // A <-> n1 <-> n2 <-> n3 <-> n4 <-> n5
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(6);
+            cryptography::UUID A = nodes[0];
+
+            auto createChain = [&](NetworkSimulator &simulator, bool incrementalAdvertisements) {
+                simulator.createChain(nodes);
+                simulator.configureAll([&](Network &network) {
+                    network.incrementalAdvertisements = incrementalAdvertisements;
+                });
+            };
+
+            /// Advertises every device once per interval for an hour and returns the bytes sent per device
+            auto advertiseForAnHour = [&](NetworkSimulator &simulator) {
+                for (int round = 0; round < 360; round++) {
+                    simulator.advertiseAll(nodes);
+                    simulator.turnTheClockBy(10000);
+                }
+                return simulator.getTransmittedByteCount() / nodes.size();
+            };
+
+            WHEN("all devices advertise themselves for an hour with and without incremental advertisements") {
+                NetworkSimulator fullSimulator;
+                NetworkSimulator incrementalSimulator;
+                createChain(fullSimulator, false);
+                createChain(incrementalSimulator, true);
+
+                unsigned long fullBytesPerNodeHour = advertiseForAnHour(fullSimulator);
+                unsigned long incrementalBytesPerNodeHour = advertiseForAnHour(incrementalSimulator);
+                CAPTURE(fullBytesPerNodeHour);
+                CAPTURE(incrementalBytesPerNodeHour);
+
+                THEN("the incremental advertisements should have required at least ten percent less bytes") {
+                    REQUIRE(incrementalBytesPerNodeHour < fullBytesPerNodeHour * 9 / 10);
+                }
+
+                THEN("every device should know the keys of the devices in its zone without requesting them") {
+                    NetworkSimulationNode* n3 = incrementalSimulator.getNode(nodes[3]).unwrap();
+                    REQUIRE(n3->network.credentials.getKey(A).isOk());
+                    REQUIRE(n3->network.getStatistics().keyRequestsDispatched == 0);
+                }
+            }
+
+            WHEN("the neighbor of A misses its first advertisement") {
+                NetworkSimulator simulator;
+                createChain(simulator, true);
+                NetworkSimulationNode* n1 = simulator.getNode(nodes[1]).unwrap();
+                NetworkSimulationNode* n2 = simulator.getNode(nodes[2]).unwrap();
+
+                simulator.disconnect(A, nodes[1]);
+                simulator.advertiseNode(A);
+                simulator.setLinkLoss(A, nodes[1], 0);
+                simulator.turnTheClockBy(10000);
+                simulator.advertiseNode(A);
+
+                THEN("the devices that received the incremental advertisement should have requested the key") {
+                    REQUIRE(n1->network.credentials.getKey(A).isErr());
+                    REQUIRE(n1->network.getStatistics().keyRequestsDispatched == 1);
+                    REQUIRE(n2->network.getStatistics().keyRequestsDispatched == 1);
+                }
+
+                AND_WHEN("A advertises itself again") {
+                    simulator.turnTheClockBy(10000);
+                    simulator.advertiseNode(A);
+
+                    THEN("the advertisement should have carried the key to all of them") {
+                        REQUIRE(n1->network.credentials.getKey(A).isOk());
+                        REQUIRE(n2->network.credentials.getKey(A).isOk());
+                        REQUIRE(n1->network.getStatistics().keyRequestsDispatched == 1);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("The key of an advertiser should be requested again once it changes",
+             "[unit_test][module][communication][network][routing][iarp]") {
+        GIVEN("a device that knows the key of its neighbor") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            auto *clock = (DummyRelativeTimeProvider *) timeProvider.get();
+            cryptography::UUID deviceID, neighbor;
+            Network network(deviceID, cryptography::asymmetric::generateKeyPair(), timeProvider);
+            cryptography::asymmetric::KeyPair neighborKeys = cryptography::asymmetric::generateKeyPair();
+            network.processDatagram(Routing::IARP::Advertisement::build(neighbor, neighborKeys, 1).serialize());
+
+            WHEN("the neighbor advertises the same key incrementally") {
+                network.processDatagram(Routing::IARP::Advertisement::buildIncremental(
+                        neighbor, neighborKeys.pub.getHash(), 2).serialize());
+
+                THEN("no key should have been requested") {
+                    REQUIRE(network.getStatistics().keyRequestsDispatched == 0);
+                }
+            }
+
+            WHEN("the neighbor advertises a different key incrementally") {
+                cryptography::asymmetric::KeyPair changedKeys = cryptography::asymmetric::generateKeyPair();
+                PUB_HASH_T changedKeyHash = changedKeys.pub.getHash();
+                Datagrams datagrams = network.processDatagram(Routing::IARP::Advertisement::buildIncremental(
+                        neighbor, changedKeyHash, 2).serialize());
+
+                THEN("the changed key should have been requested from the neighbor") {
+                    REQUIRE(network.getStatistics().keyRequestsDispatched == 1);
+                    REQUIRE(get<0>(datagrams.front()).target == neighbor);
+                    REQUIRE(Routing::IARP::KeyRequest::fromBuffer(get<1>(datagrams.front())).isOk());
+                }
+
+                AND_WHEN("it is advertised again within the key request interval") {
+                    network.processDatagram(Routing::IARP::Advertisement::buildIncremental(
+                            neighbor, changedKeyHash, 3).serialize());
+
+                    THEN("the request should not have been repeated") {
+                        REQUIRE(network.getStatistics().keyRequestsDispatched == 1);
+                    }
+                }
+
+                AND_WHEN("the neighbor answers the request with its new key") {
+                    network.processDatagram(Routing::IARP::Advertisement::build(neighbor, changedKeys, 3).serialize());
+
+                    THEN("the stored key should have been replaced") {
+                        REQUIRE(network.credentials.getKey(neighbor).unwrap() == changedKeys.pub);
+                    }
+
+                    AND_WHEN("it keeps advertising the new key incrementally after the key request interval") {
+                        clock->turnTheClockBy(KEY_REQUEST_INTERVAL);
+                        network.processDatagram(Routing::IARP::Advertisement::buildIncremental(
+                                neighbor, changedKeyHash, 4).serialize());
+
+                        THEN("no further key should have been requested") {
+                            REQUIRE(network.getStatistics().keyRequestsDispatched == 1);
+                        }
+                    }
+                }
+
+                AND_WHEN("the neighbor answers with a key that does not match the announced hash") {
+                    cryptography::asymmetric::KeyPair otherKeys = cryptography::asymmetric::generateKeyPair();
+                    network.processDatagram(Routing::IARP::Advertisement::build(neighbor, otherKeys, 3).serialize());
+
+                    THEN("the stored key should have been kept") {
+                        REQUIRE(network.credentials.getKey(neighbor).unwrap() == neighborKeys.pub);
+                    }
+                }
+            }
+
+            WHEN("the neighbor advertises a different key without announcing it") {
+                cryptography::asymmetric::KeyPair otherKeys = cryptography::asymmetric::generateKeyPair();
+                network.processDatagram(Routing::IARP::Advertisement::build(neighbor, otherKeys, 2).serialize());
+
+                THEN("the stored key should have been kept") {
+                    REQUIRE(network.credentials.getKey(neighbor).unwrap() == neighborKeys.pub);
+                }
+            }
+        }
+    }
+
+    SCENARIO("Redundant advertisement rebroadcasts should be avoided",
+             "[integration_test][module][communication][network][routing][iarp]") {
+        GIVEN("three devices in a chain") {
+            // Zone layout
+            // A <-> B <-> C
+            NetworkSimulator simulator;
+            cryptography::UUID A, B, C;
+            simulator.createDevice(A, {B});
+            simulator.createDevice(B, {A, C});
+            simulator.createDevice(C, {B});
+
+            WHEN("A advertises itself") {
+                simulator.advertiseNode(A);
+
+                THEN("the rebroadcasts should not have been sent back to the nodes they came from") {
+                    REQUIRE(simulator.getTransmissionCount() == 2);
+                    REQUIRE(simulator.getNode(C).unwrap()->network.routingTable.getRouteTo(A).isOk());
+                }
+            }
+        }
+
+        GIVEN("a dense grid of five by five devices where every device reaches the eight surrounding ones") {
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(25);
+
+            auto createGrid = [&](NetworkSimulator &simulator, bool suppressAdvertisementRebroadcasts) {
+                simulator.createGrid(nodes, 5);
+                simulator.configureAll([&](Network &network) {
+                    network.suppressAdvertisementRebroadcasts = suppressAdvertisementRebroadcasts;
+                });
+            };
+
+            /// Lets every device advertise itself and waits for all delayed rebroadcasts
+            auto advertiseAndRebroadcast = [&](NetworkSimulator &simulator) {
+                simulator.advertiseAll(nodes);
+
+                for (int elapsed = 0; elapsed <= REBROADCAST_MAX_DELAY; elapsed += 10) {
+                    simulator.turnTheClockBy(10);
+                    for (auto node : nodes) {
+                        simulator.getNode(node).unwrap()->network.processPendingRebroadcasts();
+                        simulator.processMessageQueueOf(node);
+                    }
+                }
+            };
+
+            WHEN("all devices advertise themselves with and without rebroadcast suppression") {
+                NetworkSimulator simulator;
+                NetworkSimulator referenceSimulator;
+                createGrid(simulator, true);
+                createGrid(referenceSimulator, false);
+
+                advertiseAndRebroadcast(simulator);
+                advertiseAndRebroadcast(referenceSimulator);
+
+                unsigned long airtime = simulator.getTransmittedByteCount();
+                unsigned long referenceAirtime = referenceSimulator.getTransmittedByteCount();
+                CAPTURE(airtime);
+                CAPTURE(referenceAirtime);
+
+                THEN("less than half of the bytes should have been transmitted") {
+                    REQUIRE(airtime * 2 < referenceAirtime);
+                }
+
+                THEN("every device should still know a route to each of its neighbors") {
+                    NetworkSimulationNode* center = simulator.getNode(nodes[12]).unwrap();
+                    for (auto neighbor : center->neighbors)
+                        REQUIRE(center->network.routingTable.getRouteTo(neighbor).isOk());
+                }
+
+                THEN("the center should still learn about the corners of the grid") {
+                    NetworkSimulationNode* center = simulator.getNode(nodes[12]).unwrap();
+                    REQUIRE(center->network.routingTable.getRouteTo(nodes[0]).isOk());
+                    REQUIRE(center->network.routingTable.getRouteTo(nodes[24]).isOk());
+                }
+            }
+        }
+    }
+
+    SCENARIO("Devices should advertise themselves and expire routing state periodically",
+             "[integration_test][module][communication][network][routing][iarp]") {
+        GIVEN("three devices in a chain") {
+            // Zone layout
+            // A <-> B <-> C
+            NetworkSimulator simulator;
+            cryptography::UUID A, B, C;
+            simulator.createDevice(A, {B});
+            simulator.createDevice(B, {A, C});
+            simulator.createDevice(C, {B});
+
+            auto runTimersFor = [&simulator](long duration) {
+                for (long elapsed = 0; elapsed < duration; elapsed += NETWORK_TIMER_RESOLUTION) {
+                    simulator.turnTheClockBy(NETWORK_TIMER_RESOLUTION);
+                    simulator.processTimers();
+                }
+            };
+
+            WHEN("their timers run for three advertisement intervals") {
+                runTimersFor(3 * ADVERTISEMENT_INTERVAL);
+
+                THEN("they should have learned about each other without being told to advertise") {
+                    REQUIRE(simulator.getNode(A).unwrap()->network.routingTable.getRouteTo(C).isOk());
+                    REQUIRE(simulator.getNode(C).unwrap()->network.routingTable.getRouteTo(A).isOk());
+                }
+
+                THEN("every device should have advertised itself about once per interval") {
+                    for (auto node : {A, B, C}) {
+                        unsigned long advertisements = simulator.getNode(node).unwrap()->network.getStatistics().advertisementsDispatched;
+                        REQUIRE(advertisements >= 3);
+                        REQUIRE(advertisements <= 5);
+                    }
+                }
+
+                AND_WHEN("A stops advertising itself") {
+                    simulator.getNode(A).unwrap()->network.periodicAdvertisements = false;
+                    runTimersFor(ADVERTISEMENT_INTERVAL + 2 * NETWORK_SWEEP_INTERVAL);
+
+                    THEN("the routes to it should have been deleted") {
+                        Network &network = simulator.getNode(B).unwrap()->network;
+                        REQUIRE(network.getStatistics().expiredRoutesDeleted > 0);
+                        REQUIRE(network.routingTable.getRouteTo(A).isErr());
+                        REQUIRE(network.routingTable.getRouteTo(C).isOk());
+                    }
+                }
+            }
+        }
+
+        GIVEN("a single device") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            auto *clock = (DummyRelativeTimeProvider *) timeProvider.get();
+            Network network(cryptography::UUID(), cryptography::asymmetric::generateKeyPair(), timeProvider);
+            network.advertisementInterval = 2000;
+
+            WHEN("its timers run for a while") {
+                vector<long> advertisementTimes;
+                for (long time = 0; time < 60000; time += NETWORK_TIMER_RESOLUTION) {
+                    clock->turnTheClockBy(NETWORK_TIMER_RESOLUTION);
+                    network.processTimers();
+
+                    for (DatagramPacket &packet : network.drainOutgoingQueue()) {
+                        REQUIRE(get<0>(packet).type == MessageTarget::Type::BROADCAST);
+                        REQUIRE(Routing::IARP::Advertisement::fromBuffer(get<1>(packet)).unwrap().interval == 2000);
+                        advertisementTimes.push_back(clock->millis());
+                    }
+                }
+
+                THEN("its advertisements should be jittered but never be later than the interval") {
+                    set<long> gaps;
+                    for (size_t i = 1; i < advertisementTimes.size(); i++)
+                        gaps.insert(advertisementTimes[i] - advertisementTimes[i - 1]);
+
+                    REQUIRE(*gaps.begin() >= 2000 * (100 - ADVERTISEMENT_JITTER) / 100);
+                    REQUIRE(*gaps.rbegin() <= 2000 + NETWORK_TIMER_RESOLUTION);
+                    REQUIRE(gaps.size() > 1);
+                }
+            }
+        }
+    }
+
+    SCENARIO("Control traffic should not wait behind bulk transfers",
+             "[integration_test][module][communication][network]") {
+        GIVEN("two neighboring devices") {
+            // Zone layout
+            // A <-> B
+            NetworkSimulator simulator;
+            cryptography::UUID A, B;
+            simulator.createDevice(A, {B});
+            simulator.createDevice(B, {A});
+            REQUIRE(simulator.advertiseNode(A));
+            REQUIRE(simulator.advertiseNode(B));
+
+            NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+            NetworkSimulationNode* nodeB = simulator.getNode(B).unwrap();
+
+            auto queueBurst = [&]() {
+                for (uint8_t i = 0; i < 50; i++)
+                    nodeA->network.queueMessageTo(B, Datagram(1000, i), TrafficClass::BULK);
+                for (uint8_t i = 0; i < 10; i++)
+                    nodeA->network.queueMessageTo(B, {i}, TrafficClass::INTERACTIVE);
+
+                simulator.turnTheClockBy(ADVERTISEMENT_INTERVAL);
+                nodeA->network.processTimers();
+                REQUIRE(nodeA->network.getStatistics().advertisementsDispatched == 1);
+            };
+
+            WHEN("A queues a bulk transfer, a few interactive messages and its advertisement becomes due") {
+                queueBurst();
+
+                THEN("the advertisement should leave first") {
+                    Datagrams datagrams = nodeA->network.drainOutgoingQueue(1);
+                    REQUIRE(get<0>(datagrams.front()).type == MessageTarget::Type::BROADCAST);
+                }
+
+                THEN("B should receive the interactive messages before most of the bulk transfer") {
+                    while (!nodeA->network.outgoingQueue.empty())
+                        simulator.processMessageQueueOf(A, 8);
+
+                    deque<Datagram> &received = nodeB->network.incomingBuffer;
+                    REQUIRE(received.size() == 60);
+                    for (uint8_t i = 0; i < 10; i++) {
+                        auto position = find(received.begin(), received.end(), Datagram{i});
+                        REQUIRE(position - received.begin() < 15);
+                    }
+                    REQUIRE(received.back() == Datagram(1000, 49));
+                }
+            }
+
+            WHEN("A queues the same burst without scheduling by traffic class") {
+                nodeA->network.outgoingQueue.prioritize = false;
+                queueBurst();
+
+                THEN("the advertisement should wait for everything queued before it") {
+                    Datagrams datagrams = nodeA->network.drainOutgoingQueue();
+                    REQUIRE(datagrams.size() == 61);
+                    REQUIRE(get<0>(datagrams.back()).type == MessageTarget::Type::BROADCAST);
+                }
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking the head-of-line latency of control traffic under saturation",
+             "[.][benchmark][communication][network]") {
+        /// A link that carries 10 datagrams per millisecond while A queues 12 bulk payloads per millisecond
+        const size_t linkCapacity = 10;
+        const size_t bulkRate = 12;
+        const long duration = 1000;
+
+        for (bool prioritize : {true, false}) {
+            NetworkSimulator simulator;
+            cryptography::UUID A, B;
+            simulator.createDevice(A, {B});
+            simulator.createDevice(B, {A});
+            REQUIRE(simulator.advertiseNode(A));
+            REQUIRE(simulator.advertiseNode(B));
+
+            Network &network = simulator.getNode(A).unwrap()->network;
+            network.outgoingQueue.prioritize = prioritize;
+            network.advertisementInterval = 100;
+
+            /// The first advertisement has been scheduled with the default interval
+            simulator.turnTheClockBy(ADVERTISEMENT_INTERVAL);
+            network.processTimers();
+            network.drainOutgoingQueue();
+
+            /// Times at which the advertisements that are still queued have been queued
+            deque<long> queuedAdvertisements;
+            vector<long> latencies;
+            for (long time = 0; time < duration; time++) {
+                simulator.turnTheClockBy(1);
+                for (size_t i = 0; i < bulkRate; i++)
+                    network.queueMessageTo(B, Datagram(1000, (uint8_t) i), TrafficClass::BULK);
+
+                unsigned long advertisements = network.getStatistics().advertisementsDispatched;
+                network.processTimers();
+                if (network.getStatistics().advertisementsDispatched > advertisements)
+                    queuedAdvertisements.push_back(time);
+
+                Datagrams datagrams = network.drainOutgoingQueue(linkCapacity);
+                for (DatagramPacket &packet : datagrams) {
+                    if (get<0>(packet).type != MessageTarget::Type::BROADCAST) continue;
+                    latencies.push_back(time - queuedAdvertisements.front());
+                    queuedAdvertisements.pop_front();
+                }
+                simulator.processDatagrams(datagrams, A);
+            }
+
+            long maximum = latencies.empty() ? 0 : *max_element(latencies.begin(), latencies.end());
+            WARN((prioritize ? "scheduled by traffic class" : "first in first out") << ": "
+                         << latencies.size() << " of " << latencies.size() + queuedAdvertisements.size()
+                         << " advertisements sent, maximum head-of-line latency " << maximum << "ms, "
+                         << network.outgoingQueue.size() << " datagrams queued");
+        }
+    }
+
+    SCENARIO("Queues should stay bounded when destinations never answer or payloads are not taken",
+             "[integration_test][module][communication][network]") {
+        class DropRecorder : public NetworkDelegate {
+        public:
+            size_t droppedPayloads = 0;
+
+            void didFailToDeliver(cryptography::UUID target, const vector<vector<uint8_t>> &payloads,
+                                  DeliveryFailureReason reason) override {
+                if (reason == DeliveryFailureReason::QUEUE_FULL)
+                    this->droppedPayloads += payloads.size();
+            }
+        };
+
+        GIVEN("a network without any neighbors and small routing queue limits") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            Network network(cryptography::UUID(), cryptography::asymmetric::generateKeyPair(), timeProvider);
+            QueueLimits limits;
+            limits.routingQueuePerDestination = {8, SIZE_MAX};
+            limits.routingQueue = {32, 4096};
+
+            auto recorder = make_shared<DropRecorder>();
+            network.delegate = recorder;
+
+            WHEN("payloads of every class are queued for many destinations that never answer") {
+                network.setQueueLimits(limits);
+                vector<cryptography::UUID> targets(16);
+                size_t rejected = 0;
+                for (size_t i = 0; i < 10000; i++) {
+                    auto result = network.queueMessageTo(targets[i % targets.size()], Datagram(64 + i % 64, (uint8_t) i),
+                                                         static_cast<TrafficClass>(i % 3));
+                    if (result.isErr()) rejected++;
+
+                    QueueMetrics metrics = network.getQueueMetrics().routingQueue;
+                    REQUIRE(metrics.count <= 32);
+                    REQUIRE(metrics.bytes <= 4096);
+                }
+
+                THEN("every payload should either be queued or have been dropped once") {
+                    QueueMetrics metrics = network.getQueueMetrics().routingQueue;
+                    REQUIRE(metrics.count + metrics.drops == 10000);
+                    REQUIRE(recorder->droppedPayloads + rejected == metrics.drops);
+                    for (const auto &entry : network.routingQueue)
+                        REQUIRE(entry.second.size() <= 8);
+                }
+
+                THEN("only control payloads should be left and discoveries should not have been repeated") {
+                    for (const auto &entry : network.routingQueue)
+                        for (const QueuedPayload &queuedPayload : entry.second)
+                            REQUIRE(queuedPayload.trafficClass == TrafficClass::CONTROL);
+                    REQUIRE(network.getStatistics().routeDiscoveriesDispatched == targets.size());
+                }
+            }
+
+            WHEN("payloads for a single destination are queued while the newest ones are dropped") {
+                limits.dropPolicy = DropPolicy::NEWEST;
+                network.setQueueLimits(limits);
+                cryptography::UUID target;
+
+                vector<QueuePressure> pressures;
+                for (uint8_t i = 0; i < 8; i++)
+                    pressures.push_back(network.queueMessageTo(target, {i}).unwrap());
+
+                THEN("congestion should be signalled before payloads are rejected") {
+                    REQUIRE(pressures[5] == QueuePressure::NORMAL);
+                    REQUIRE(pressures[6] == QueuePressure::CONGESTED);
+                    REQUIRE(pressures[7] == QueuePressure::CONGESTED);
+
+                    auto result = network.queueMessageTo(target, {8});
+                    REQUIRE(result.isErr());
+                    REQUIRE(result.unwrapErr() == QueueError::QUEUE_FULL);
+                    REQUIRE(network.routingQueue.at(target).back().payload == Datagram{7});
+                    REQUIRE(recorder->droppedPayloads == 0);
+                }
+            }
+        }
+
+        GIVEN("two neighboring devices whose queues are not drained") {
+            // Zone layout
+            // A <-> B
+            NetworkSimulator simulator;
+            cryptography::UUID A, B;
+            simulator.createDevice(A, {B});
+            simulator.createDevice(B, {A});
+            REQUIRE(simulator.advertiseNode(A));
+            REQUIRE(simulator.advertiseNode(B));
+
+            NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+            NetworkSimulationNode* nodeB = simulator.getNode(B).unwrap();
+
+            QueueLimits limits;
+            limits.outgoingQueue = {64, SIZE_MAX};
+            limits.incomingBuffer = {16, SIZE_MAX};
+            nodeA->network.setQueueLimits(limits);
+            nodeB->network.setQueueLimits(limits);
+
+            WHEN("A queues far more bulk payloads for B than its outgoing queue holds") {
+                auto recorder = make_shared<DropRecorder>();
+                nodeA->network.delegate = recorder;
+
+                for (size_t i = 0; i < 1000; i++) {
+                    nodeA->network.queueMessageTo(B, Datagram(100, (uint8_t) i), TrafficClass::BULK);
+                    REQUIRE(nodeA->network.outgoingQueue.size() <= 64);
+                }
+
+                THEN("the oldest ones should have been dropped and reported") {
+                    QueueMetrics metrics = nodeA->network.getQueueMetrics().outgoingQueue;
+                    REQUIRE(metrics.count == 64);
+                    REQUIRE(metrics.drops == 1000 - 64);
+                    REQUIRE(recorder->droppedPayloads == 1000 - 64);
+                }
+
+                THEN("its control traffic should still be queued") {
+                    simulator.turnTheClockBy(ADVERTISEMENT_INTERVAL);
+                    nodeA->network.processTimers();
+
+                    Datagrams datagrams = nodeA->network.drainOutgoingQueue();
+                    REQUIRE(datagrams.size() == 64);
+                    REQUIRE(get<0>(datagrams.front()).type == MessageTarget::Type::BROADCAST);
+                }
+
+                AND_WHEN("B receives all of them but its payloads are never taken") {
+                    simulator.processMessageQueueOf(A);
+
+                    THEN("B should only hold the newest ones") {
+                        QueueMetrics metrics = nodeB->network.getQueueMetrics().incomingBuffer;
+                        REQUIRE(metrics.count == 16);
+                        REQUIRE(metrics.drops == 64 - 16);
+                        REQUIRE(nodeB->network.incomingBuffer.back() == Datagram(100, (uint8_t) 999));
+
+                        vector<Datagram> payloads = nodeB->network.drainIncomingBuffer();
+                        REQUIRE(payloads.size() == 16);
+                        REQUIRE(nodeB->network.getQueueMetrics().incomingBuffer.bytes == 0);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Restarted devices should resume routing from a snapshot",
+             "[integration_test][module][communication][network][routing]") {
+        GIVEN("seven devices in a chain where A has discovered C") {
+            // Zone layout
+            // A <-> n1 <-> n2 <-> B <-> n4 <-> n5 <-> C
+            NetworkSimulator simulator;
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(7);
+            cryptography::UUID A = nodes[0], B = nodes[3], C = nodes[6];
+            simulator.createChain(nodes);
+            REQUIRE(simulator.advertiseAll(nodes));
+
+            NetworkSimulationNode* nodeA = simulator.getNode(A).unwrap();
+            NetworkSimulationNode* nodeB = simulator.getNode(B).unwrap();
+            NetworkSimulationNode* nodeC = simulator.getNode(C).unwrap();
+
+            simulator.processDatagrams(nodeA->network.discoverDevice(C), A);
+            REQUIRE(nodeA->network.routeCache.getRouteTo(C).isOk());
+
+            uint64_t snapshotTime = 1500000000;
+            Datagram snapshot = nodeA->network.createSnapshot(snapshotTime);
+            simulator.restartDevice(A);
+
+            WHEN("A restores its snapshot two seconds later and sends a message to C") {
+                simulator.turnTheClockBy(2000);
+                auto result = nodeA->network.restoreSnapshot(NetworkSnapshot::fromBuffer(snapshot).unwrap(),
+                                                             snapshotTime + 2);
+                REQUIRE(result.isOk());
+
+                Datagram payload = {1, 2, 3};
+                nodeA->network.queueMessageTo(C, payload);
+                simulator.processMessageQueueOf(A);
+
+                THEN("the message should have been delivered without a route discovery") {
+                    REQUIRE(nodeA->network.getStatistics().routeDiscoveriesDispatched == 0);
+                    REQUIRE(nodeC->network.incomingBuffer.size() == 1);
+                    REQUIRE(nodeC->network.incomingBuffer.back() == payload);
+                }
+
+                THEN("the bordercast nodes of A should have been restored") {
+                    REQUIRE(nodeA->network.routingTable.getBordercastNodes() == vector<cryptography::UUID>({B}));
+                }
+            }
+
+            WHEN("A sends a message to C without restoring its snapshot") {
+                nodeA->network.queueMessageTo(C, {1, 2, 3});
+
+                THEN("it should have to discover C again") {
+                    REQUIRE(nodeA->network.getStatistics().routeDiscoveriesDispatched == 1);
+                }
+            }
+
+            WHEN("A restores its snapshot after the routes would have expired") {
+                long elapsedSeconds = ROUTE_CACHE_LIFETIME / 1000 + 1;
+                simulator.turnTheClockBy(elapsedSeconds * 1000);
+                auto result = nodeA->network.restoreSnapshot(NetworkSnapshot::fromBuffer(snapshot).unwrap(),
+                                                             snapshotTime + elapsedSeconds);
+
+                THEN("only the keys should have been restored") {
+                    REQUIRE(result.isOk());
+                    REQUIRE(nodeA->network.routeCache.getRouteTo(C).isErr());
+                    REQUIRE(nodeA->network.routingTable.getRouteTo(B).isErr());
+                    REQUIRE(nodeA->network.credentials.getKey(C).unwrap() == nodeC->network.getKeys().pub);
+                }
+            }
+
+            WHEN("A restores a snapshot that is too old") {
+                auto result = nodeA->network.restoreSnapshot(NetworkSnapshot::fromBuffer(snapshot).unwrap(),
+                                                             snapshotTime + NETWORK_SNAPSHOT_MAX_AGE + 1);
+
+                THEN("it should be rejected") {
+                    REQUIRE(result.unwrapErr() == Network::SnapshotRestoreError::OUTDATED);
+                    REQUIRE(nodeA->network.credentials.getKey(C).isErr());
+                }
+            }
+
+            WHEN("B attempts to restore the snapshot of A") {
+                auto result = nodeB->network.restoreSnapshot(NetworkSnapshot::fromBuffer(snapshot).unwrap(),
+                                                             snapshotTime);
+
+                THEN("it should be rejected") {
+                    REQUIRE(result.unwrapErr() == Network::SnapshotRestoreError::FOREIGN_DEVICE);
+                }
+            }
+        }
+    }
+
+    SCENARIO("The zone radius should adapt to the density of the network",
+             "[integration_test][module][communication][network][routing][iarp]") {
+        GIVEN("49 devices arranged in a seven by seven grid that wraps around at its edges") {
+            // Zone layout (every device is connected to its eight surrounding devices)
+            // n0  <-> n1  <-> ... <-> n6
+            //  ...
+            // n42 <-> n43 <-> ... <-> n48
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(49, 1);
+
+            auto createGrid = [&](NetworkSimulator &simulator, bool adaptiveZoneRadius) {
+                simulator.createGrid(nodes, 7, true);
+                simulator.configureAll([&](Network &network) {
+                    network.incrementalAdvertisements = true;
+                    network.adaptiveZoneRadius = adaptiveZoneRadius;
+                });
+            };
+
+            /// Advertises every device once per interval for the given amount of intervals and returns the transmissions
+            auto advertise = [&](NetworkSimulator &simulator, int intervals) {
+                unsigned long previousTransmissions = simulator.getTransmissionCount();
+                for (int interval = 0; interval < intervals; interval++) {
+                    simulator.advertiseAll(nodes);
+                    simulator.turnTheClockBy(10000);
+                }
+                return simulator.getTransmissionCount() - previousTransmissions;
+            };
+
+            WHEN("all devices advertise themselves for almost three minutes with a fixed and an adaptive radius") {
+                NetworkSimulator fixedSimulator;
+                NetworkSimulator adaptiveSimulator;
+                createGrid(fixedSimulator, false);
+                createGrid(adaptiveSimulator, true);
+
+                /// Give the adaptive zones some time to settle and measure the last minute
+                advertise(fixedSimulator, 10);
+                advertise(adaptiveSimulator, 10);
+                unsigned long fixedTransmissions = advertise(fixedSimulator, 6);
+                unsigned long adaptiveTransmissions = advertise(adaptiveSimulator, 6);
+                CAPTURE(fixedTransmissions);
+                CAPTURE(adaptiveTransmissions);
+
+                THEN("every device should have shrunk its zone exactly once") {
+                    for (auto node : nodes) {
+                        Network &network = adaptiveSimulator.getNode(node).unwrap()->network;
+                        REQUIRE(network.getZoneRadius() == ZONE_RADIUS - 1);
+                        REQUIRE(network.getStatistics().zoneRadiusChanges == 1);
+                    }
+                }
+
+                THEN("the smaller zones should have required less than half the transmissions") {
+                    REQUIRE(adaptiveTransmissions * 2 < fixedTransmissions);
+                }
+
+                THEN("every device should still know the routes to the devices within its smaller zone") {
+                    Network &network = adaptiveSimulator.getNode(nodes[0]).unwrap()->network;
+                    REQUIRE(network.routingTable.getZoneSize() == 24);
+                    REQUIRE(network.routingTable.getRouteTo(nodes[2 * 7 + 2]).isOk());
+                }
+            }
+        }
+
+        GIVEN("twelve devices in a chain where the first one regularly sends messages to the distant ones") {
+            // Zone layout
+            // A <-> n1 <-> n2 <-> n3 <-> n4 <-> ... <-> n11
+            vector<cryptography::UUID> nodes = NetworkSimulator::numberedDevices(12, 1);
+            cryptography::UUID A = nodes[0];
+
+            auto createChain = [&](NetworkSimulator &simulator, bool adaptiveZoneRadius) {
+                simulator.createChain(nodes);
+                simulator.configureAll([&](Network &network) { network.adaptiveZoneRadius = adaptiveZoneRadius; });
+            };
+
+            /// Sends a message from A to n4 ... n8 once per advertising interval for five minutes
+            auto communicate = [&](NetworkSimulator &simulator) {
+                NetworkSimulationNode *nodeA = simulator.getNode(A).unwrap();
+                for (uint8_t interval = 0; interval < 30; interval++) {
+                    simulator.advertiseAll(nodes);
+
+                    for (size_t target = 4; target <= 8; target++)
+                        nodeA->network.queueMessageTo(nodes[target], {interval});
+
+                    /// Payloads waiting for a discovery are queued again once it has been acknowledged
+                    simulator.processMessageQueueOf(A);
+                    simulator.processMessageQueueOf(A);
+                    simulator.turnTheClockBy(10000);
+                }
+            };
+
+            WHEN("the devices communicate with a fixed and an adaptive radius") {
+                NetworkSimulator fixedSimulator;
+                NetworkSimulator adaptiveSimulator;
+                createChain(fixedSimulator, false);
+                createChain(adaptiveSimulator, true);
+                communicate(fixedSimulator);
+                communicate(adaptiveSimulator);
+
+                Network &fixedNetwork = fixedSimulator.getNode(A).unwrap()->network;
+                Network &adaptiveNetwork = adaptiveSimulator.getNode(A).unwrap()->network;
+                CAPTURE(fixedSimulator.getTransmissionCount());
+                CAPTURE(adaptiveSimulator.getTransmissionCount());
+                CAPTURE(fixedNetwork.getStatistics().routeDiscoveriesDispatched);
+                CAPTURE(adaptiveNetwork.getStatistics().routeDiscoveriesDispatched);
+
+                THEN("A should have grown its zone") {
+                    REQUIRE(adaptiveNetwork.getZoneRadius() > ZONE_RADIUS);
+                }
+
+                THEN("the devices within the grown zone should have extended the reach of their advertisements") {
+                    REQUIRE(adaptiveNetwork.routingTable.getRouteTo(nodes[4]).isOk());
+                    REQUIRE(fixedNetwork.routingTable.getRouteTo(nodes[4]).isErr());
+                }
+
+                THEN("A should have required fewer route discoveries") {
+                    REQUIRE(adaptiveNetwork.getStatistics().routeDiscoveriesDispatched <
+                            fixedNetwork.getStatistics().routeDiscoveriesDispatched);
+                }
+            }
+        }
+    }
+
+
+    /// Processes the datagrams on the given amount of threads and returns the datagrams they caused
+    Datagrams processConcurrently(Network &network, const vector<Datagram> &datagrams, size_t threadCount) {
+        atomic<size_t> nextDatagram(0);
+        vector<Datagrams> outgoingDatagrams(threadCount);
+
+        vector<thread> threads;
+        for (size_t t = 0; t < threadCount; t++)
+            threads.emplace_back([&, t]() {
+                for (size_t i = nextDatagram++; i < datagrams.size(); i = nextDatagram++)
+                    for (DatagramPacket &packet : network.processDatagram(datagrams[i]))
+                        outgoingDatagrams[t].push_back(packet);
+            });
+
+        for (thread &t : threads)
+            t.join();
+
+        Datagrams mergedDatagrams;
+        for (Datagrams &threadDatagrams : outgoingDatagrams)
+            mergedDatagrams.insert(mergedDatagrams.end(), threadDatagrams.begin(), threadDatagrams.end());
+
+        return mergedDatagrams;
+    }
+
+    SCENARIO("Datagrams should be processable by multiple threads at once",
+             "[integration_test][module][communication][network]") {
+        GIVEN("a device with 16 neighbors") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            cryptography::UUID deviceID;
+            cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+            Network network(deviceID, deviceKeys, timeProvider);
+
+            vector<cryptography::UUID> neighbors(16);
+            vector<cryptography::asymmetric::KeyPair> neighborKeys;
+            for (size_t i = 0; i < neighbors.size(); i++)
+                neighborKeys.push_back(cryptography::asymmetric::generateKeyPair());
+
+            WHEN("all neighbors advertise themselves concurrently") {
+                vector<Datagram> advertisements;
+                for (size_t i = 0; i < neighbors.size(); i++)
+                    advertisements.push_back(Routing::IARP::Advertisement::build(neighbors[i], neighborKeys[i]).serialize());
+
+                processConcurrently(network, advertisements, 8);
+
+                THEN("the routes to and keys of all neighbors should be known") {
+                    for (size_t i = 0; i < neighbors.size(); i++) {
+                        REQUIRE(network.routingTable.getRouteTo(neighbors[i]).isOk());
+                        REQUIRE(network.credentials.getKey(neighbors[i]).unwrap() == neighborKeys[i].pub);
+                    }
+                }
+
+                AND_WHEN("the neighbors concurrently send messages to the device and through it to each other") {
+                    size_t rounds = 8;
+                    vector<Datagram> messages;
+                    for (size_t round = 0; round < rounds; round++) {
+                        for (size_t i = 0; i < neighbors.size(); i++) {
+                            size_t next = (i + 1) % neighbors.size();
+                            Datagram payload(16, 0);
+                            payload[0] = (uint8_t) round;
+                            payload[1] = (uint8_t) i;
+
+                            messages.push_back(Message::build(payload, {neighbors[i], deviceID}, deviceKeys.pub,
+                                                              neighborKeys[i]).serialize());
+                            messages.push_back(Message::build(payload, {neighbors[i], deviceID, neighbors[next]},
+                                                              neighborKeys[next].pub, neighborKeys[i]).serialize());
+                        }
+                    }
+
+                    Datagrams forwardedMessages = processConcurrently(network, messages, 8);
+
+                    THEN("every message for the device should have been decrypted exactly once") {
+                        set<Datagram> payloads(network.incomingBuffer.begin(), network.incomingBuffer.end());
+                        REQUIRE(network.incomingBuffer.size() == rounds * neighbors.size());
+                        REQUIRE(payloads.size() == rounds * neighbors.size());
+                    }
+
+                    THEN("every relayed message should have been forwarded to the calling thread") {
+                        REQUIRE(forwardedMessages.size() == rounds * neighbors.size());
+                        REQUIRE(network.drainOutgoingQueue().empty());
+                    }
+                }
+
+                AND_WHEN("the neighbors concurrently send messages through the device to a device behind the first one") {
+                    cryptography::UUID remoteDevice;
+                    cryptography::asymmetric::KeyPair remoteKeys = cryptography::asymmetric::generateKeyPair();
+                    Routing::IARP::Advertisement remoteAdvertisement =
+                            Routing::IARP::Advertisement::build(remoteDevice, remoteKeys);
+                    remoteAdvertisement.addHop(neighbors[0]);
+                    network.processDatagram(remoteAdvertisement.serialize());
+
+                    vector<Datagram> messages;
+                    for (size_t i = 1; i < neighbors.size(); i++)
+                        for (uint8_t round = 0; round < 4; round++)
+                            messages.push_back(Message::build(Datagram(16, round), {neighbors[i], deviceID, remoteDevice},
+                                                              remoteKeys.pub, neighborKeys[i]).serialize());
+
+                    Datagrams forwardedMessages = processConcurrently(network, messages, 8);
+
+                    THEN("every message should have been rewrapped for the route over the first neighbor") {
+                        REQUIRE(forwardedMessages.size() == messages.size());
+                        for (DatagramPacket &packet : forwardedMessages) {
+                            REQUIRE(get<0>(packet).target == neighbors[0]);
+                            auto rewrappedMessage = Message::fromBuffer(get<1>(packet));
+                            REQUIRE(rewrappedMessage.isOk());
+                            REQUIRE(rewrappedMessage.unwrap().route ==
+                                    vector<cryptography::UUID>({deviceID, neighbors[0], remoteDevice}));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking the datagram throughput against the amount of threads", "[.][benchmark][communication][network]") {
+        REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+        cryptography::UUID deviceID;
+        cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+
+        /// Messages for the device from 16 different senders with an advertisement of each sender in front
+        vector<Datagram> advertisements;
+        vector<Datagram> messages;
+        for (size_t i = 0; i < 16; i++) {
+            cryptography::UUID sender;
+            cryptography::asymmetric::KeyPair senderKeys = cryptography::asymmetric::generateKeyPair();
+            advertisements.push_back(Routing::IARP::Advertisement::build(sender, senderKeys).serialize());
+
+            for (size_t j = 0; j < 32; j++)
+                messages.push_back(Message::build(Datagram(64, (uint8_t) j), {sender, deviceID}, deviceKeys.pub,
+                                                  senderKeys).serialize());
+        }
+
+        for (size_t threadCount : {1, 2, 4, 8}) {
+            using namespace std::chrono;
+            Network network(deviceID, deviceKeys, timeProvider);
+            processConcurrently(network, advertisements, 1);
+
+            auto start = steady_clock::now();
+            processConcurrently(network, messages, threadCount);
+            auto duration = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+            REQUIRE(network.incomingBuffer.size() == messages.size());
+            WARN(threadCount << " threads: " << messages.size() * 1000000 / duration << " messages per second");
+        }
+    }
+
+    SCENARIO("Messages addressed to the device should be decryptable asynchronously",
+             "[integration_test][module][communication][network]") {
+        GIVEN("a device with a crypto service and two advertised neighbors") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            cryptography::UUID deviceID;
+            cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+            Network network(deviceID, deviceKeys, timeProvider);
+            auto cryptoService = make_shared<cryptography::CryptoService>(4);
+            network.setCryptoService(cryptoService);
+
+            vector<cryptography::UUID> neighbors(2);
+            vector<cryptography::asymmetric::KeyPair> neighborKeys;
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                neighborKeys.push_back(cryptography::asymmetric::generateKeyPair());
+                network.processDatagram(Routing::IARP::Advertisement::build(neighbors[i], neighborKeys[i]).serialize());
+            }
+
+            WHEN("the neighbors send messages to the device") {
+                vector<Datagram> payloads;
+                for (uint8_t i = 0; i < 32; i++) {
+                    Datagram payload(16, i);
+                    payloads.push_back(payload);
+                    REQUIRE(network.processDatagram(Message::build(payload, {neighbors[i % 2], deviceID}, deviceKeys.pub,
+                                                                   neighborKeys[i % 2]).serialize()).empty());
+                }
+
+                /// Signed by the other neighbor thus neither the decryption nor the verification succeeds
+                network.processDatagram(Message::build(Datagram(16, 0xFF), {neighbors[0], deviceID}, deviceKeys.pub,
+                                                       neighborKeys[1]).serialize());
+
+                THEN("their payloads should not be received before the completions have been processed") {
+                    REQUIRE(network.incomingBuffer.empty());
+                }
+
+                AND_WHEN("the completions are processed while and after the jobs are executed") {
+                    network.processCryptoCompletions();
+                    cryptoService->waitUntilIdle();
+                    network.processCryptoCompletions();
+
+                    THEN("the valid payloads should have been received in the order they have been sent") {
+                        REQUIRE(network.drainIncomingBuffer() == payloads);
+                    }
+                }
+
+                AND_WHEN("the device is copied before the jobs have been executed") {
+                    Network copy = network;
+                    cryptoService->waitUntilIdle();
+                    copy.processCryptoCompletions();
+                    network.processCryptoCompletions();
+
+                    THEN("the completions should only have been delivered to the original") {
+                        REQUIRE(copy.offloadedDecryptions.completions != network.offloadedDecryptions.completions);
+                        REQUIRE(copy.drainIncomingBuffer().empty());
+                        REQUIRE(network.drainIncomingBuffer() == payloads);
+                    }
+
+                    THEN("messages received by the copy should be decrypted by the same service") {
+                        Datagram payload(16, 0x01);
+                        copy.processDatagram(Message::build(payload, {neighbors[0], deviceID}, deviceKeys.pub,
+                                                            neighborKeys[0]).serialize());
+                        cryptoService->waitUntilIdle();
+                        copy.processCryptoCompletions();
+
+                        REQUIRE(copy.drainIncomingBuffer() == vector<Datagram>{payload});
+                    }
+                }
+
+                AND_WHEN("the crypto service is detached before the completions are processed") {
+                    network.setCryptoService(nullptr);
+                    cryptoService->waitUntilIdle();
+                    network.processCryptoCompletions();
+
+                    Datagram payload(16, 0x01);
+                    network.processDatagram(Message::build(payload, {neighbors[0], deviceID}, deviceKeys.pub,
+                                                           neighborKeys[0]).serialize());
+
+                    THEN("pending payloads should still be received while new ones are decrypted right away") {
+                        payloads.push_back(payload);
+                        REQUIRE(network.drainIncomingBuffer() == payloads);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Messages received at once should be verified as a batch",
+             "[integration_test][module][communication][network]") {
+        GIVEN("a device with two neighbors") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            cryptography::UUID deviceID;
+            cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+            Network network(deviceID, deviceKeys, timeProvider);
+
+            vector<cryptography::UUID> neighbors(2);
+            vector<cryptography::asymmetric::KeyPair> neighborKeys;
+            for (size_t i = 0; i < neighbors.size(); i++)
+                neighborKeys.push_back(cryptography::asymmetric::generateKeyPair());
+
+            WHEN("an advertisement of the first and messages of both neighbors are processed together") {
+                vector<Datagram> datagrams;
+                datagrams.push_back(Routing::IARP::Advertisement::build(neighbors[0], neighborKeys[0]).serialize());
+
+                /// Only the second neighbor attaches its key while the one of the first is part of its advertisement
+                vector<Datagram> payloads;
+                for (uint8_t i = 0; i < 8; i++) {
+                    Datagram payload(16, i);
+                    payloads.push_back(payload);
+                    datagrams.push_back(Message::build(payload, {neighbors[i % 2], deviceID}, deviceKeys.pub,
+                                                       neighborKeys[i % 2], i % 2 == 1).serialize());
+                }
+
+                /// Signed by the other neighbor and sent twice
+                Datagram forgedMessage = Message::build(Datagram(16, 0xFF), {neighbors[0], deviceID}, deviceKeys.pub,
+                                                        neighborKeys[1]).serialize();
+                datagrams.insert(datagrams.begin() + 3, forgedMessage);
+                datagrams.push_back(forgedMessage);
+
+                network.processDatagrams(datagrams);
+
+                THEN("the valid payloads should have been received in the order they have been sent") {
+                    REQUIRE(network.drainIncomingBuffer() == payloads);
+                }
+
+                THEN("the key attached to the messages of the second neighbor should only have been used to verify them") {
+                    REQUIRE(network.credentials.getKey(neighbors[1]).isErr());
+                }
+            }
+
+            WHEN("a neighbor whose key is unknown attaches it to a message after its last key request expired") {
+                network.processDatagram(Routing::IARP::Advertisement::buildIncremental(
+                        neighbors[1], neighborKeys[1].pub.getHash(), 1).serialize());
+                ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(KEY_REQUEST_INTERVAL);
+                network.drainOutgoingQueue();
+
+                Datagram payload(16, 0x01);
+                network.processDatagram(Message::build(payload, {neighbors[1], deviceID}, deviceKeys.pub,
+                                                       neighborKeys[1], true).serialize());
+
+                THEN("the payload should have been received without storing the attached key") {
+                    REQUIRE(network.drainIncomingBuffer() == vector<Datagram>{payload});
+                    REQUIRE(network.credentials.getKey(neighbors[1]).isErr());
+                }
+
+                THEN("the key should have been requested from the neighbor instead") {
+                    Datagrams outgoingDatagrams = network.drainOutgoingQueue();
+                    REQUIRE(outgoingDatagrams.size() == 1);
+                    REQUIRE(get<0>(outgoingDatagrams[0]).target == neighbors[1]);
+                    REQUIRE(Routing::IARP::KeyRequest::fromBuffer(get<1>(outgoingDatagrams[0])).isOk());
+                    REQUIRE(network.getStatistics().keyRequestsDispatched == 2);
+                }
+
+                AND_WHEN("the neighbor announces its key") {
+                    network.processDatagram(Routing::IARP::Advertisement::build(neighbors[1], neighborKeys[1]).serialize());
+
+                    THEN("the announced key should have been stored") {
+                        REQUIRE(network.credentials.getKey(neighbors[1]).unwrap() == neighborKeys[1].pub);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking the tick latency with and without a crypto service", "[.][benchmark][communication][network]") {
+        REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+        cryptography::UUID deviceID;
+        cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+
+        /// Mixed load of advertisements, messages for the device and messages relayed to a device behind one of
+        /// the 16 different senders
+        vector<Datagram> advertisements;
+        vector<tuple<Datagram, bool>> datagrams;
+        cryptography::UUID remoteDevice;
+        cryptography::asymmetric::KeyPair remoteKeys = cryptography::asymmetric::generateKeyPair();
+        for (size_t i = 0; i < 16; i++) {
+            cryptography::UUID sender;
+            cryptography::asymmetric::KeyPair senderKeys = cryptography::asymmetric::generateKeyPair();
+            advertisements.push_back(Routing::IARP::Advertisement::build(sender, senderKeys).serialize());
+
+            if (i == 0) {
+                Routing::IARP::Advertisement remoteAdvertisement = Routing::IARP::Advertisement::build(remoteDevice, remoteKeys);
+                remoteAdvertisement.addHop(sender);
+                advertisements.push_back(remoteAdvertisement.serialize());
+            }
+
+            for (size_t j = 0; j < 32; j++) {
+                if (j % 2 == 0)
+                    datagrams.emplace_back(Routing::IARP::Advertisement::build(sender, senderKeys).serialize(), true);
+                if (j % 4 == 0)
+                    datagrams.emplace_back(Message::build(Datagram(64, (uint8_t) j), {sender, deviceID, remoteDevice},
+                                                          remoteKeys.pub, senderKeys).serialize(), false);
+                datagrams.emplace_back(Message::build(Datagram(64, (uint8_t) j), {sender, deviceID}, deviceKeys.pub,
+                                                      senderKeys).serialize(), false);
+            }
+        }
+
+        for (bool asynchronous : {false, true}) {
+            using namespace std::chrono;
+            Network network(deviceID, deviceKeys, timeProvider);
+            auto cryptoService = asynchronous ? make_shared<cryptography::CryptoService>() : nullptr;
+            network.setCryptoService(cryptoService);
+            processConcurrently(network, advertisements, 1);
+
+            /// A tick processes one received datagram and whatever completed in the meantime
+            vector<int64_t> latencies;
+            vector<int64_t> advertisementLatencies;
+            for (const auto &datagram : datagrams) {
+                auto start = steady_clock::now();
+                network.processDatagram(get<0>(datagram));
+                network.processCryptoCompletions();
+                int64_t latency = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+                latencies.push_back(latency);
+                if (get<1>(datagram)) advertisementLatencies.push_back(latency);
+            }
+
+            if (cryptoService) {
+                cryptoService->waitUntilIdle();
+                network.processCryptoCompletions();
+            }
+
+            auto percentiles = [](vector<int64_t> samples) {
+                sort(samples.begin(), samples.end());
+                auto percentile = [&](size_t p) { return samples[(samples.size() - 1) * p / 1000]; };
+
+                stringstream summary;
+                summary << "p50 " << percentile(500) << ", p90 " << percentile(900) << ", p99 " << percentile(990)
+                        << ", p99.9 " << percentile(999) << ", max " << samples.back();
+                return summary.str();
+            };
+
+            REQUIRE(network.incomingBuffer.size() == 16 * 32);
+            WARN((asynchronous ? "asynchronous" : "synchronous") << " tick latency in µs: " << percentiles(latencies)
+                         << "; ticks of advertisements only: " << percentiles(advertisementLatencies));
+        }
+    }
+
 #endif // UNIT_TESTING
 }
\ No newline at end of file
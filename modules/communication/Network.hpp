@@ -6,21 +6,49 @@
 #include <vector>
 #include <tuple>
 #include <list>
+#include <deque>
+#include <optional>
+#include <variant>
+#include <mutex>
+#include <map>
+#include <random>
 #include <ierp/RouteCache.hpp>
 
 using namespace std;
 
 #include "iarp/RoutingTable.hpp"
 #include "iarp/Advertisement.hpp"
+#include "iarp/LinkEstimator.hpp"
+#include "iarp/KeyRequest.hpp"
+#include "iarp/RebroadcastScheduler.hpp"
+#include "iarp/ZoneRadiusController.hpp"
 #include "ierp/RouteDiscovery.hpp"
+#include "ierp/RouteDiscoveryAcknowledgement.hpp"
 #include "ierp/RouteCache.hpp"
+#include "ierp/PendingDiscovery.hpp"
+#include "ierp/RouteLifetimeEstimator.hpp"
+#include "ierp/DiscoveryHistory.hpp"
+#include "ierp/RepairBuffer.hpp"
+#include "delegates/NetworkDelegate.hpp"
+#include "RouteSelection.hpp"
 #include "Message.hpp"
+#include "DeliveryFailure.hpp"
+#include "RetransmitBuffer.hpp"
+#include "OutgoingQueue.hpp"
+#include "QueueLimits.hpp"
 #include "CredentialsStore.hpp"
+#include "NetworkSnapshot.hpp"
+#include "UUIDMap.hpp"
+#include "CopyableMutex.hpp"
+#include "CryptoService.hpp"
+#include "MessageTarget.hpp"
+#include "TimerWheel.hpp"
 
 #include "flatbuffers/flatbuffers.h"
 #include "communication/message_generated.h"
 #include "communication/deliveryFailure_generated.h"
 #include "communication/iarp/advertisement_generated.h"
+#include "communication/iarp/keyRequest_generated.h"
 #include "communication/ierp/routeDiscovery_generated.h"
 #include "communication/ierp/routeDiscoveryAcknowledgement_generated.h"
 
@@ -30,85 +58,448 @@ using namespace std;
 
 /// Note that the route length is defined in zones so the actual hop count would be MAXIMUM_ROUTE_LENGTH * ZONE_RADIUS
 #define MAXIMUM_ROUTE_LENGTH 20
-/// Note that the zone radius is inclusive thus including the origin and destination.
-/// e.g. A -> x -> y -> B would be a radius of 4
-#define ZONE_RADIUS 4
+/// Time in milliseconds a route learned from relayed traffic stays in the route cache
+#define LEARNED_ROUTE_LIFETIME 15000
+/// Routes longer than this (in zones) are not learned from relayed traffic
+#define LEARNED_ROUTE_MAXIMUM_LENGTH 8
+/// Minimum time in milliseconds between two requests for the key of the same advertiser
+#define KEY_REQUEST_INTERVAL 10000
+/// Time in milliseconds covered by one slot of the timer wheel of the network (see Network::processTimers)
+#define NETWORK_TIMER_RESOLUTION 50
+/// Interval in milliseconds at which pending discoveries, rebroadcasts and local repairs are retried
+#define NETWORK_MAINTENANCE_INTERVAL 100
+/// Interval in milliseconds at which expired routes, retransmit entries and key requests are deleted
+#define NETWORK_SWEEP_INTERVAL 5000
 
 namespace ProtoMesh::communication {
 
-    class MessageTarget {
+    /// Datagram that went through the part of processing that does not depend on the routing state:
+    /// deserialization, key decompression and the decryption of messages addressed to us.
+    /// May be prepared on any thread and applied to the network later (see Network::prepareDatagram).
+    class PreparedDatagram {
     public:
         enum class Type {
-            SINGLE,
-            BROADCAST
+            /// Malformed datagrams and messages that could not be decrypted
+            INVALID,
+            ADVERTISEMENT,
+            KEY_REQUEST,
+            ROUTE_DISCOVERY,
+            ROUTE_DISCOVERY_ACKNOWLEDGEMENT,
+            DELIVERY_FAILURE,
+            /// Message that has to be forwarded to another device
+            MESSAGE,
+            /// Message addressed to us that is left to the crypto service to decrypt
+            ENCRYPTED_MESSAGE,
+            /// Message addressed to us whose sender was unknown while it was prepared.
+            /// It is decrypted when applied since the datagrams applied in the meantime may have provided the key.
+            MESSAGE_FROM_UNKNOWN_SENDER,
+            /// Datagram that is not part of the communication layer
+            PAYLOAD
         };
 
         Type type;
-        cryptography::UUID target;
+        /// The received datagram or the decrypted payload of a message addressed to us
+        Datagram datagram;
+        variant<monostate, Routing::IARP::Advertisement, Routing::IARP::KeyRequest, Routing::IERP::RouteDiscovery,
+                Routing::IERP::RouteDiscoveryAcknowledgement, DeliveryFailure, Message> content;
 
-        explicit MessageTarget(Type type, cryptography::UUID target = cryptography::UUID::Empty())
-                : type(type), target(target) {};
+        explicit PreparedDatagram(Type type, Datagram datagram = {}) : type(type), datagram(std::move(datagram)) {};
 
-        static MessageTarget broadcast() {
-            return MessageTarget(Type::BROADCAST);
-        }
+        template<class Content>
+        PreparedDatagram(Type type, Datagram datagram, Content content)
+                : type(type), datagram(std::move(datagram)), content(std::move(content)) {}
+    };
 
-        static MessageTarget single(cryptography::UUID target) {
-            return MessageTarget(Type::SINGLE, target);
+    /// Message addressed to us whose signature has not been verified yet
+    class DecryptedMessage {
+    public:
+        cryptography::UUID sender;
+        cryptography::asymmetric::PublicKey senderKey;
+        /// Whether or not the key has been attached to the message. Such keys are only trusted to verify the message
+        /// itself while the actual key of the sender is requested (see Network::requestAttachedKey).
+        bool attachedKey;
+        Datagram plaintext;
+        SIGNATURE_T signature;
+    };
+
+    /// Message addressed to us whose decryption has been submitted to the crypto service
+    class PendingDecryption {
+    public:
+        cryptography::UUID sender;
+        cryptography::asymmetric::PublicKey senderKey;
+        /// See DecryptedMessage::attachedKey
+        bool attachedKey;
+        optional<cryptography::CryptoCompletion> completion;
+    };
+
+    /// Messages addressed to us whose decryption has been offloaded to a crypto service.
+    /// Copies share the service but get a completion queue of their own. Jobs submitted before copying only
+    /// complete for the original, so copies start out without any pending decryptions.
+    class OffloadedDecryptions {
+    public:
+        /// Accessed atomically since datagrams are prepared without the state lock
+        shared_ptr<cryptography::CryptoService> service;
+        shared_ptr<cryptography::CryptoCompletionQueue> completions = make_shared<cryptography::CryptoCompletionQueue>();
+        /// Indexed by the tag of their job which increases with every message so that payloads are processed in order
+        map<uint64_t, PendingDecryption> pending;
+        uint64_t nextTag = 0;
+        /// Completed payloads are applied one thread at a time so that they stay in order
+        CopyableMutex<mutex> applicationMutex;
+
+        OffloadedDecryptions() = default;
+        OffloadedDecryptions(const OffloadedDecryptions &other) : service(atomic_load(&other.service)), nextTag(other.nextTag) {};
+        OffloadedDecryptions(OffloadedDecryptions &&) = default;
+        OffloadedDecryptions &operator=(const OffloadedDecryptions &other) {
+            atomic_store(&this->service, atomic_load(&other.service));
+            this->completions = make_shared<cryptography::CryptoCompletionQueue>();
+            this->pending.clear();
+            this->nextTag = other.nextTag;
+            return *this;
         }
+        OffloadedDecryptions &operator=(OffloadedDecryptions &&) = default;
+    };
+
+    /// Payload waiting for a route to its destination, not wrapped in a Message yet
+    class QueuedPayload {
+    public:
+        Datagram payload;
+        TrafficClass trafficClass;
+        /// Order in which the payloads have been queued across all destinations
+        uint64_t sequenceNumber;
+        /// Stream the payload belongs to, see Network::queueMessageTo
+        optional<uint64_t> stream;
     };
 
+    /// Periodic tasks of the network, see Network::processTimers
+    enum class NetworkTimer {
+        /// Sends the advertisement of this device
+        ADVERTISEMENT,
+        /// Retries pending discoveries, rebroadcasts and local repairs
+        MAINTENANCE,
+        /// Deletes expired routing state
+        SWEEP
+    };
 
+    class NetworkStatistics {
+    public:
+        /// Route discoveries originated by this node
+        unsigned long routeDiscoveriesDispatched = 0;
+        /// Route discoveries that were not dispatched since one for the same target was still in flight
+        unsigned long routeDiscoveriesSuppressed = 0;
+        /// Relayed route discoveries that were dropped since they had been seen before
+        unsigned long duplicateRouteDiscoveriesDropped = 0;
+        /// Routes inserted into the route cache by observing relayed traffic
+        unsigned long routesLearned = 0;
+        /// Messages that could not be forwarded and have been reported to their sender
+        unsigned long deliveryFailuresDispatched = 0;
+        /// Payloads that have been sent again after a delivery failure has been reported
+        unsigned long payloadsRetransmitted = 0;
+        /// Relayed messages that were forwarded over a repaired route
+        unsigned long localRepairs = 0;
+        /// Requests for the key of an advertiser that only sent its key hash
+        unsigned long keyRequestsDispatched = 0;
+        /// Times the zone radius has been adapted
+        unsigned long zoneRadiusChanges = 0;
+        /// Advertisements of this device that have been queued by the timers
+        unsigned long advertisementsDispatched = 0;
+        /// Expired routes that have been deleted from the routing table and the route cache
+        unsigned long expiredRoutesDeleted = 0;
+    };
 
+    /// Network layer of a device.
+    /// processDatagram may be called from multiple threads at once. Deserialization, key decompression and the
+    /// decryption of messages addressed to us happen without holding the state lock, so that threads only
+    /// contend for the short routing state updates. The known keys are sharded (see CredentialsStore).
     class Network {
 #ifdef UNIT_TESTING
     public:
 #endif
+        /// Guards everything below except for the credentials which are locked on their own.
+        /// Recursive since public methods like queueMessageTo are also used while processing datagrams.
+        mutable CopyableMutex<recursive_mutex> stateMutex;
+
         cryptography::UUID deviceID;
         cryptography::asymmetric::KeyPair deviceKeys;
+        PUB_HASH_T deviceKeyHash;
+        REL_TIME_PROV_T timeProvider;
         Routing::IARP::RoutingTable routingTable;
+        cryptography::UUIDMap<Routing::IARP::LinkEstimator> linkEstimators;
         Routing::IERP::RouteCache routeCache;
+        cryptography::UUIDMap<Routing::IERP::RouteLifetimeEstimator> routeLifetimeEstimators;
+        Routing::IERP::DiscoveryHistory discoveryHistory;
+        /// Both sequence numbers start at a random value. Otherwise a restarted device would count from zero again
+        /// and its route discoveries would be dropped as duplicates until the relays forget the ones it sent
+        /// before the restart (see DISCOVERY_HISTORY_LIFETIME).
+        uint32_t discoverySequenceNumber;
+        Routing::RouteSelector routeSelector;
+        uint32_t advertisementSequenceNumber;
+        /// Whether or not the next advertisement has to carry our public key even if it is incremental
+        bool keyAnnouncementPending = true;
+        /// Time at which we last requested the key of an advertiser
+        cryptography::UUIDMap<long> keyRequests;
+        /// Hashes of changed keys that advertisers announced and we requested. The stored key of the advertiser
+        /// is only replaced by a key matching the hash so that unsolicited keys can't overwrite known ones.
+        cryptography::UUIDMap<PUB_HASH_T> announcedKeyHashes;
+        Routing::IARP::RebroadcastScheduler rebroadcastScheduler;
+        Routing::IARP::ZoneRadiusController zoneRadiusController;
+        TimerWheel<NetworkTimer> timers;
+        /// Decides by how much each advertisement is sent early
+        minstd_rand advertisementJitter;
 
         CredentialsStore credentials;
+        NetworkStatistics statistics;
 
         /// Incoming payloads that are not part of the communication layer
-        vector<Datagram> incomingBuffer;
-        /// Datagrams waiting to be dispatched (wrapped in a Message)
-        vector<DatagramPacket> outgoingQueue;
-        /// Payloads waiting for a queue to be available (not wrapped in a Message yet)
-        unordered_map<cryptography::UUID, vector<Datagram>> routingQueue;
+        deque<Datagram> incomingBuffer;
+        /// Datagrams waiting to be dispatched (wrapped in a Message), scheduled by their traffic class
+        OutgoingQueue outgoingQueue;
+        /// Payloads waiting for a route to be available (not wrapped in a Message yet)
+        cryptography::UUIDMap<vector<QueuedPayload>> routingQueue;
+        uint64_t nextQueuedPayloadNumber = 0;
+        /// Gives every payload that is not part of a stream a flow of its own, see flowOf
+        uint64_t unstreamedPayloadCount = 0;
+        QueueLimits queueLimits;
+        /// Depths and drops of the routing queue and the incoming buffer, the outgoing queue keeps track on its own
+        NetworkQueueMetrics queueMetrics;
+        /// Payloads that have recently been sent, kept until a delivery failure might arrive
+        RetransmitBuffer retransmitBuffer;
+        /// Relayed messages that could not be forwarded yet
+        Routing::IERP::RepairBuffer repairBuffer;
+        /// Route discoveries in flight for the destinations in the routingQueue
+        cryptography::UUIDMap<Routing::IERP::PendingDiscovery> pendingDiscoveries;
+        /// Processing of these messages resumes once processCryptoCompletions is called after their job completed
+        OffloadedDecryptions offloadedDecryptions;
 
         enum class MessageSendError {
             TARGET_PUBLIC_KEY_UNKNOWN,
             TARGET_UNREACHABLE
         };
 
-        /// Datagram processing
-        Datagrams processAdvertisement(const Datagram &datagram);
-        Datagrams processRouteDiscovery(const Datagram &datagram);
-        Datagrams processRouteDiscoveryAcknowledgement(const Datagram &datagram);
-        Datagrams processDeliveryFailure(const Datagram &datagram);
-        Datagrams processMessageDatagram(const Datagram &datagram);
+        /// Datagram processing (requires the state lock)
+        Datagrams processAdvertisement(Routing::IARP::Advertisement advertisement);
+        Datagrams processKeyRequest(const Routing::IARP::KeyRequest &request, const Datagram &datagram);
+        Datagrams processRouteDiscovery(Routing::IERP::RouteDiscovery routeDiscovery);
+        Datagrams processRouteDiscoveryAcknowledgement(const Routing::IERP::RouteDiscoveryAcknowledgement &acknowledgement,
+                                                       const Datagram &datagram);
+        Datagrams processDeliveryFailure(const DeliveryFailure &failure, const Datagram &datagram);
+        /// Takes the state lock on its own, see forwardMessage
+        Datagrams processMessage(const Message &message);
+        Datagrams decryptAsynchronously(const Message &message);
+
+        /// Message preparation (does not require the state lock)
+        optional<DecryptedMessage> decryptMessage(const Message &message);
+        PreparedDatagram prepareDecryptedMessage(const DecryptedMessage &decryptedMessage);
 
         /// Processing helpers
         Datagrams rebroadcastRouteDiscovery(Routing::IERP::RouteDiscovery routeDiscovery);
         Datagrams dispatchRouteDiscoveryAcknowledgement(Routing::IERP::RouteDiscovery routeDiscovery);
+        Datagrams dispatchDeliveryFailure(const Message &message, cryptography::UUID unreachableHop);
+        void invalidateLink(cryptography::UUID a, cryptography::UUID b);
+        /// Takes the state lock on its own and releases it while the message is rewrapped for the next hop
+        Result<DatagramPacket, MessageSendError> forwardMessage(const Message &message);
+        bool spliceRoute(Message &message);
+        Datagrams repairMessage(Message message, cryptography::UUID unreachableHop);
+        void learnRoutesFrom(const vector<cryptography::UUID> &route);
+        /// Returns the request unless one for the same key has been dispatched within KEY_REQUEST_INTERVAL
+        Datagrams requestKey(const Routing::IARP::KeyRequest &request);
+        /// Queues a request for the key of a device within our zone whose message only carried an unconfirmed key
+        void requestAttachedKey(cryptography::UUID sender);
+        unsigned int linkCostTo(cryptography::UUID neighbor);
+
+        /// Timers
+        void scheduleTimers(long currentTime);
+        void scheduleAdvertisement(long currentTime);
+        void deleteExpiredState(long currentTime);
+
+        /// Route selection
+        static uint64_t flowOf(cryptography::UUID origin, cryptography::UUID destination);
+        /// Payloads of the same stream share a flow and therefore a route, every other payload is a flow of its own
+        uint64_t flowOf(cryptography::UUID destination, optional<uint64_t> stream);
+        Result<Routing::IARP::RoutingTableEntry, Routing::IARP::RouteDiscoveryError>
+        selectRouteTo(cryptography::UUID target, uint64_t flow);
+        Result<Routing::IERP::RouteCacheEntry, Routing::IERP::RouteCache::RouteCacheError>
+        selectCachedRouteTo(cryptography::UUID target, uint64_t flow);
+
+        /// Queue limits
+        Result<QueuePressure, QueueError> enqueuePayload(cryptography::UUID target, const Datagram &payload,
+                                                         TrafficClass trafficClass, optional<uint64_t> stream);
+        optional<tuple<cryptography::UUID, size_t>> selectPayloadToDrop(optional<cryptography::UUID> target,
+                                                                        TrafficClass trafficClass);
+        void dropPayload(cryptography::UUID target, size_t index);
+        vector<QueuedPayload> takeQueuedPayloads(cryptography::UUID target);
+        /// Queues a datagram for dispatch and reports the payloads of the application dropped to make room for it
+        bool pushOutgoing(DatagramPacket datagram, TrafficClass trafficClass, optional<OutgoingPayload> payload = nullopt);
+        void bufferIncomingPayload(const Datagram &payload);
 
         /// Others
         Datagrams discoverDevice(cryptography::UUID device);
         Result<DatagramPacket, MessageSendError> sendMessageLocalTo(cryptography::UUID target, const Datagram &payload);
+        Result<DatagramPacket, MessageSendError> sendMessageLocalTo(cryptography::UUID target, const Datagram &payload,
+                                                                    uint64_t flow);
+        Result<Message, MessageSendError> buildMessageLocalTo(cryptography::UUID target, const Datagram &payload,
+                                                              uint64_t flow);
 
     public:
 
         explicit Network(cryptography::UUID deviceID, cryptography::asymmetric::KeyPair deviceKeys, REL_TIME_PROV_T timeProvider)
-                : deviceID(deviceID), deviceKeys(deviceKeys), routingTable(std::move(timeProvider), ZONE_RADIUS) {};
+                : deviceID(deviceID), deviceKeys(deviceKeys), deviceKeyHash(deviceKeys.pub.getHash()), timeProvider(timeProvider),
+                  routingTable(timeProvider, ZONE_RADIUS), routeCache(timeProvider),
+                  discoverySequenceNumber(random_device()()), advertisementSequenceNumber(random_device()()),
+                  rebroadcastScheduler(deviceID.hash()),
+                  zoneRadiusController(ZONE_RADIUS), timers(timeProvider->millis(), NETWORK_TIMER_RESOLUTION),
+                  advertisementJitter(deviceID.hash()) {
+            this->scheduleTimers(timeProvider->millis());
+            this->outgoingQueue.setLimit(this->queueLimits.outgoingQueue, this->queueLimits.dropPolicy);
+        };
 
         cryptography::asymmetric::KeyPair getKeys() { return this->deviceKeys; }
+        NetworkStatistics getStatistics() {
+            lock_guard<recursive_mutex> lock(this->stateMutex);
+            return this->statistics;
+        }
+
+        /// Whether or not routes observed in relayed acknowledgements and messages are cached
+        bool passiveRouteLearning = true;
+        /// Whether or not routes are compared by the estimated quality of their links instead of their hop count
+        bool linkQualityMetric = true;
+        /// Whether or not relays report messages they are unable to forward back to the sender
+        bool reportDeliveryFailures = true;
+        /// Whether or not relays attempt to route around unreachable hops before reporting a delivery failure
+        bool localRepair = true;
+        /// Whether or not our advertisements omit the public key once it has been announced.
+        /// Neighbors that don't know the key yet request it which causes the next advertisement to include it.
+        bool incrementalAdvertisements = false;
+        /// Whether or not advertisements are rebroadcast after a random delay and only if
+        /// not enough neighbors rebroadcast them in the meantime (see processPendingRebroadcasts)
+        bool suppressAdvertisementRebroadcasts = false;
+        /// Whether or not route discoveries that arrive a second time are dropped
+        bool suppressDuplicateDiscoveries = true;
+        /// Encoding of the covered nodes in route discoveries originating from us. The version is selected here and
+        /// not negotiated with the neighbors. Nodes predating ROUTE_DISCOVERY_VERSION_FILTER ignore the filter and
+        /// relay such discoveries as version 1 without the nodes covered so far, which causes redundant bordercasts.
+        /// Networks with such nodes should select ROUTE_DISCOVERY_VERSION_LIST until every node has been updated.
+        uint8_t routeDiscoveryVersion = ROUTE_DISCOVERY_VERSION_FILTER;
+
+        /// Whether or not processTimers queues the advertisement of this device once every advertisement interval
+        bool periodicAdvertisements = true;
+        /// Time in milliseconds between two advertisements of this device which is also the time
+        /// the routes to this device stay valid at the receivers. Takes effect with the next advertisement.
+        unsigned int advertisementInterval = ADVERTISEMENT_INTERVAL;
+
+        /// Whether or not the zone radius adapts to the density of the network and the rate of route discoveries.
+        /// The radius is reconsidered whenever an advertisement is built.
+        bool adaptiveZoneRadius = false;
 
+        uint8_t getZoneRadius() const {
+            lock_guard<recursive_mutex> lock(this->stateMutex);
+            return this->zoneRadiusController.getZoneRadius();
+        }
+        void setZoneRadius(uint8_t zoneRadius);
+
+        void setRouteSelectionPolicy(Routing::RouteSelectionPolicy policy) {
+            lock_guard<recursive_mutex> lock(this->stateMutex);
+            this->routeSelector.policy = policy;
+        }
+
+        /// Thread-safe. The limits apply to entries queued afterwards, queues that already exceed them are not trimmed.
+        void setQueueLimits(QueueLimits limits);
+        QueueLimits getQueueLimits() {
+            lock_guard<recursive_mutex> lock(this->stateMutex);
+            return this->queueLimits;
+        }
+
+        /// Thread-safe. Current depth of the routing queue, the outgoing queue and the incoming buffer
+        /// along with the amount of entries each of them dropped so far.
+        NetworkQueueMetrics getQueueMetrics();
+
+        /// Thread-safe. Datagrams caused by this one are returned to the calling thread
+        /// while those caused by timers or queued payloads are collected until drainOutgoingQueue is called.
+        /// Equivalent to applying the prepared datagram.
         Datagrams processDatagram(const Datagram &datagram);
 
+        /// Thread-safe. Processes the datagrams in order but verifies the signatures
+        /// of all messages addressed to us at once (see cryptography::asymmetric::verifyBatch).
+        /// Only the first count datagrams are processed so that receive buffers can be reused.
+        Datagrams processDatagrams(const vector<Datagram> &datagrams, size_t count);
+        Datagrams processDatagrams(const vector<Datagram> &datagrams) {
+            return this->processDatagrams(datagrams, datagrams.size());
+        }
+
+        /// Deserializes the datagram and decrypts it if it is addressed to us. Does not take the state lock
+        /// so that any amount of threads may prepare datagrams while another one applies them.
+        PreparedDatagram prepareDatagram(const Datagram &datagram);
+
+        /// Updates the routing state according to the prepared datagram
+        Datagrams applyDatagram(const PreparedDatagram &prepared);
+
+        /// Offloads the decryption and signature verification of messages addressed to us unless nullptr is passed.
+        /// Processing of the message resumes once processCryptoCompletions is called after its job completed.
+        void setCryptoService(shared_ptr<cryptography::CryptoService> cryptoService);
+
+        /// Processes the payloads of messages whose decryption completed in the order the messages arrived.
+        /// Resulting datagrams are queued (see drainOutgoingQueue).
+        void processCryptoCompletions();
+
+        /// Takes up to maxCount of the datagrams that have been queued by any thread in the order they are due.
+        /// Control traffic goes first, followed by interactive and bulk traffic sharing the remaining capacity
+        /// per next hop (see OutgoingQueue). Callers that can only send so much at once should pass that amount
+        /// and leave the rest queued so that later control traffic is not stuck behind it.
+        Datagrams drainOutgoingQueue(size_t maxCount = SIZE_MAX);
+
+        /// Builds the next advertisement of this device which is to be sent to all neighbors
+        Datagram buildAdvertisement();
+
         /// Note that the payload parameter may not be wrapped in a message.
-        void queueMessageTo(cryptography::UUID target, const Datagram &payload);
+        /// The traffic class only decides how this device schedules the message (see OutgoingQueue).
+        /// It is not transmitted, relaying devices forward the message in the order it arrives.
+        /// Payloads of the same stream (any identifier chosen by the caller) take the same route so that they
+        /// arrive in order. Payloads without a stream are spread across all routes the selection policy allows
+        /// and may overtake each other.
+        /// Returns an error if the payload has been dropped since the queue it went into is full, and whether or
+        /// not that queue is congested otherwise. Callers should hold back further payloads while it is.
+        Result<QueuePressure, QueueError> queueMessageTo(cryptography::UUID target, const Datagram &payload,
+                                                         TrafficClass trafficClass = TrafficClass::INTERACTIVE,
+                                                         optional<uint64_t> stream = nullopt);
+
+        /// Thread-safe. Takes the received payloads that are not part of the communication layer. Once the incoming
+        /// buffer is full payloads are dropped according to the drop policy (see setQueueLimits).
+        vector<Datagram> drainIncomingBuffer();
+
+        /// Thread-safe. Runs the periodic tasks that are due: advertisements of this device (jittered by up to
+        /// ADVERTISEMENT_JITTER percent of the interval), retries of discoveries, rebroadcasts and local repairs and
+        /// the deletion of expired state. Resulting datagrams are queued (see drainOutgoingQueue).
+        /// Should be called at least every NETWORK_TIMER_RESOLUTION milliseconds. Missed runs are not made up for.
+        void processTimers();
+
+        /// Redispatches route discoveries that timed out and gives up on those that exceeded the retry limit.
+        /// Payloads that are given up on are handed to the delegate.
+        void retryPendingDiscoveries();
+
+        /// Rebroadcasts delayed advertisements whose delay has passed unless they have been suppressed.
+        void processPendingRebroadcasts();
+
+        /// Forwards held messages whose route could be repaired in the meantime and
+        /// reports those that could not be repaired in time to their sender.
+        void retryLocalRepairs();
+
+        enum class SnapshotRestoreError {
+            /// The snapshot has been taken by a different device
+            FOREIGN_DEVICE,
+            /// The snapshot is older than NETWORK_SNAPSHOT_MAX_AGE
+            OUTDATED
+        };
+
+        /// Captures the routing table, route cache and known keys so that they survive a restart.
+        /// The time is an absolute timestamp in seconds (e.g. UNIX time) used to determine the age of the
+        /// snapshot when it is restored. Should be persisted periodically (see NETWORK_SNAPSHOT_INTERVAL) and on shutdown.
+        Datagram createSnapshot(uint64_t currentTime);
+
+        /// Restores the routes of the snapshot that are still valid after the time that passed since it has been taken.
+        /// Keys are looked up in the snapshot once they are needed.
+        Result<void, SnapshotRestoreError> restoreSnapshot(NetworkSnapshot snapshot, uint64_t currentTime);
+
+        /// Delegates
+        NETWORK_DELEGATE_T delegate = nullptr;
     };
 
 }
@@ -12,6 +12,79 @@ namespace ProtoMesh {
         return key;
     }
 
+    vector<cryptography::UUID> NetworkSimulator::numberedDevices(size_t count, uint32_t firstNumber) {
+        vector<cryptography::UUID> nodeIDs;
+        for (size_t i = 0; i < count; i++)
+            nodeIDs.push_back(cryptography::UUID::fromNumber(firstNumber + (uint32_t) i));
+
+        return nodeIDs;
+    }
+
+    void NetworkSimulator::createChain(const vector<cryptography::UUID> &nodeIDs) {
+        for (size_t i = 0; i < nodeIDs.size(); i++) {
+            vector<cryptography::UUID> neighbors;
+            if (i > 0) neighbors.push_back(nodeIDs[i - 1]);
+            if (i + 1 < nodeIDs.size()) neighbors.push_back(nodeIDs[i + 1]);
+            this->createDevice(nodeIDs[i], neighbors);
+        }
+    }
+
+    void NetworkSimulator::createRing(const vector<cryptography::UUID> &nodeIDs) {
+        this->createChain(nodeIDs);
+        if (nodeIDs.size() > 2) this->connect(nodeIDs.front(), nodeIDs.back());
+    }
+
+    void NetworkSimulator::createGrid(const vector<cryptography::UUID> &nodeIDs, size_t width, bool wrapAround) {
+        long columns = (long) width, rows = (long) (nodeIDs.size() / width);
+
+        for (long y = 0; y < rows; y++) {
+            for (long x = 0; x < columns; x++) {
+                vector<cryptography::UUID> neighbors;
+                for (long dy = -1; dy <= 1; dy++) {
+                    for (long dx = -1; dx <= 1; dx++) {
+                        long nx = x + dx, ny = y + dy;
+                        if (wrapAround) {
+                            nx = (nx + columns) % columns;
+                            ny = (ny + rows) % rows;
+                        } else if (nx < 0 || ny < 0 || nx >= columns || ny >= rows) continue;
+
+                        cryptography::UUID neighbor = nodeIDs[ny * columns + nx];
+                        if ((dx || dy) && find(neighbors.begin(), neighbors.end(), neighbor) == neighbors.end())
+                            neighbors.push_back(neighbor);
+                    }
+                }
+
+                this->createDevice(nodeIDs[y * columns + x], neighbors);
+            }
+        }
+    }
+
+    void NetworkSimulator::connect(cryptography::UUID a, cryptography::UUID b) {
+        if (!this->hasNeighbor(a, b)) this->nodes.at(a).neighbors.push_back(b);
+        if (!this->hasNeighbor(b, a)) this->nodes.at(b).neighbors.push_back(a);
+    }
+
+    void NetworkSimulator::configureAll(const function<void(Network &)> &configure) {
+        for (auto &node : this->nodes)
+            configure(node.second.network);
+    }
+
+    bool NetworkSimulator::advertiseAll(const vector<cryptography::UUID> &nodeIDs) {
+        bool advertised = true;
+        for (cryptography::UUID nodeID : nodeIDs)
+            advertised &= this->advertiseNode(nodeID);
+
+        return advertised;
+    }
+
+    unsigned long NetworkSimulator::sumOfStatistics(unsigned long NetworkStatistics::*counter) {
+        unsigned long sum = 0;
+        for (auto &node : this->nodes)
+            sum += node.second.network.getStatistics().*counter;
+
+        return sum;
+    }
+
     Result<NetworkSimulationNode *, NetworkSimulator::NetworkNodeError> NetworkSimulator::getNode(cryptography::UUID node) {
         if (nodes.find(node) != nodes.end()) {
             return Ok( &(nodes.at(node)) );
@@ -19,6 +92,11 @@ namespace ProtoMesh {
             return Err(NetworkNodeError::NODE_NOT_FOUND);
     }
 
+    void NetworkSimulator::restartDevice(cryptography::UUID deviceID) {
+        NetworkSimulationNode &node = this->nodes.at(deviceID);
+        node.network = Network(deviceID, node.network.getKeys(), this->timeProvider);
+    }
+
     bool NetworkSimulator::hasNeighbor(cryptography::UUID node, cryptography::UUID neighbor) {
         auto nodeResult = this->getNode(node);
         if (nodeResult.isErr()) return false;
@@ -34,20 +112,49 @@ namespace ProtoMesh {
 
         NetworkSimulationNode* node = nodeResult.unwrap();
 
-        auto advertisement = Routing::IARP::Advertisement::build(node->network.deviceID, node->network.deviceKeys);
+        Datagram advertisement = node->network.buildAdvertisement();
 
         for (cryptography::UUID neighbor : node->neighbors)
-            this->sendMessageTo(neighbor, advertisement.serialize());
+            this->sendMessageTo(nodeID, neighbor, advertisement);
 
         return true;
     }
 
-    void NetworkSimulator::sendMessageTo(cryptography::UUID target, vector<uint8_t> message) {
+    void NetworkSimulator::setLinkLoss(cryptography::UUID a, cryptography::UUID b, unsigned int lossPercentage) {
+        this->linkLosses[a][b] = lossPercentage;
+        this->linkLosses[b][a] = lossPercentage;
+    }
+
+    void NetworkSimulator::disconnect(cryptography::UUID a, cryptography::UUID b) {
+        /// Nodes keep each other as neighbors so that transmissions over the link are silently lost
+        this->setLinkLoss(a, b, 100);
+    }
+
+    void NetworkSimulator::turnTheClockBy(long milliseconds) {
+        ((DummyRelativeTimeProvider *) this->timeProvider.get())->turnTheClockBy(milliseconds);
+    }
+
+    bool NetworkSimulator::isLost(cryptography::UUID sender, cryptography::UUID target) {
+        auto senderLosses = this->linkLosses.find(sender);
+        if (senderLosses == this->linkLosses.end()) return false;
+
+        auto linkLoss = senderLosses->second.find(target);
+        if (linkLoss == senderLosses->second.end()) return false;
+
+        return this->randomGenerator() % 100 < linkLoss->second;
+    }
+
+    void NetworkSimulator::sendMessageTo(cryptography::UUID sender, cryptography::UUID target, vector<uint8_t> message) {
         auto nodeResult = this->getNode(target);
         if (nodeResult.isErr())
             return; // Node is not found so just exit. TODO Print a warning
         auto node = nodeResult.unwrap();
 
+        this->transmissionCount++;
+        this->transmittedByteCount += message.size();
+        if (this->isLost(sender, target)) return;
+
+        this->receptionCounts[target]++;
         this->processDatagrams(node->network.processDatagram(message), target);
     }
 
@@ -68,26 +175,34 @@ namespace ProtoMesh {
                         cout << "ERROR: Sender: " << senderID << endl;
                         cout << "ERROR: Recipient: " << msgTarget.target << endl;
                     } else {
-                        this->sendMessageTo(msgTarget.target, datagram);
+                        this->sendMessageTo(senderID, msgTarget.target, datagram);
                     }
                     break;
                 case MessageTarget::Type::BROADCAST:
                     for (cryptography::UUID neighbor : sender->neighbors)
-                        this->sendMessageTo(neighbor, datagram);
+                        if (neighbor != msgTarget.excluded)
+                            this->sendMessageTo(senderID, neighbor, datagram);
                     break;
             }
         }
     }
 
-    void NetworkSimulator::processMessageQueueOf(cryptography::UUID nodeID) {
+    void NetworkSimulator::processMessageQueueOf(cryptography::UUID nodeID, size_t maxCount) {
         auto nodeResult = this->getNode(nodeID);
         if (nodeResult.isErr()) return;
         auto node = nodeResult.unwrap();
 
-        // TODO Replace this with a network.take() function or smth similar
-        Datagrams datagrams(node->network.outgoingQueue.begin(), node->network.outgoingQueue.end());
-        node->network.outgoingQueue.clear();
+        this->processDatagrams(node->network.drainOutgoingQueue(maxCount), nodeID);
+    }
+
+    void NetworkSimulator::processTimers() {
+        vector<cryptography::UUID> nodeIDs;
+        for (auto &node : this->nodes) {
+            node.second.network.processTimers();
+            nodeIDs.push_back(node.first);
+        }
 
-        this->processDatagrams(datagrams, nodeID);
+        for (cryptography::UUID nodeID : nodeIDs)
+            this->processMessageQueueOf(nodeID);
     }
-}
\ No newline at end of file
+}
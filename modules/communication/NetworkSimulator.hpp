@@ -3,9 +3,14 @@
 #ifdef UNIT_TESTING
 
 #include <unordered_map>
+#include <random>
+#include <functional>
 
 #include <iostream>
 
+/// Seed of the random generator deciding which transmissions over lossy links are lost
+#define NETWORK_SIMULATOR_SEED 42
+
 using namespace std;
 
 #include "result.h"
@@ -26,8 +31,15 @@ namespace ProtoMesh::communication {
     class NetworkSimulator {
         unordered_map<cryptography::UUID, NetworkSimulationNode> nodes;
         REL_TIME_PROV_T timeProvider;
-
-        void sendMessageTo(cryptography::UUID target, vector<uint8_t> message);
+        unsigned long transmissionCount = 0;
+        unsigned long transmittedByteCount = 0;
+        unordered_map<cryptography::UUID, unsigned long> receptionCounts;
+        /// Percentage of transmissions that are lost, indexed by sender and recipient
+        unordered_map<cryptography::UUID, unordered_map<cryptography::UUID, unsigned int>> linkLosses;
+        mt19937 randomGenerator{NETWORK_SIMULATOR_SEED};
+
+        bool isLost(cryptography::UUID sender, cryptography::UUID target);
+        void sendMessageTo(cryptography::UUID sender, cryptography::UUID target, vector<uint8_t> message);
     public:
         enum class NetworkNodeError {
             NODE_NOT_FOUND
@@ -39,12 +51,51 @@ namespace ProtoMesh::communication {
 
         cryptography::asymmetric::KeyPair createDevice(cryptography::UUID deviceID, vector<cryptography::UUID> neighbors);
 
+        /// Topologies, none of the devices advertises itself yet so that they can be configured first
+
+        /// Devices numbered consecutively (see UUID::fromNumber) to be passed to the topologies below
+        static vector<cryptography::UUID> numberedDevices(size_t count, uint32_t firstNumber = 0);
+        /// Every device is connected to the one before and after it
+        void createChain(const vector<cryptography::UUID> &nodeIDs);
+        /// Chain whose last device is connected to the first one
+        void createRing(const vector<cryptography::UUID> &nodeIDs);
+        /// Every device is connected to the up to eight surrounding ones, the devices are given row by row.
+        /// A grid that wraps around at its edges gives every device eight neighbors.
+        void createGrid(const vector<cryptography::UUID> &nodeIDs, size_t width, bool wrapAround = false);
+        /// Connects two existing devices in both directions
+        void connect(cryptography::UUID a, cryptography::UUID b);
+
+        /// Applies the configuration to the network of every device
+        void configureAll(const function<void(Network &)> &configure);
+        /// Lets every device advertise itself once, returns false if one of them does not exist
+        bool advertiseAll(const vector<cryptography::UUID> &nodeIDs);
+        /// Sum of the given counter over the statistics of all devices, e.g. &NetworkStatistics::routesLearned
+        unsigned long sumOfStatistics(unsigned long NetworkStatistics::*counter);
+
         Result<NetworkSimulationNode*, NetworkNodeError> getNode(cryptography::UUID node);
+        /// Discards the state of the device as if it had been restarted. Its keys and neighbors are retained.
+        void restartDevice(cryptography::UUID deviceID);
         bool hasNeighbor(cryptography::UUID node, cryptography::UUID neighbor);
 
         bool advertiseNode(cryptography::UUID nodeID);
         void processDatagrams(Datagrams datagrams, cryptography::UUID sender);
-        void processMessageQueueOf(cryptography::UUID nodeID);
+        /// Delivers up to maxCount of the datagrams queued by the node, like a link that can only carry so much at once
+        void processMessageQueueOf(cryptography::UUID nodeID, size_t maxCount = SIZE_MAX);
+        /// Runs the timers of every node (see Network::processTimers) and delivers the datagrams they queued
+        void processTimers();
+
+        /// Makes the link between both nodes lose the given percentage of transmissions in either direction
+        void setLinkLoss(cryptography::UUID a, cryptography::UUID b, unsigned int lossPercentage);
+        void turnTheClockBy(long milliseconds);
+        /// Breaks the link between both nodes so that every transmission over it is lost
+        void disconnect(cryptography::UUID a, cryptography::UUID b);
+
+        /// Amount of single hop transmissions that have been simulated so far
+        unsigned long getTransmissionCount() { return this->transmissionCount; }
+        /// Sum of the sizes of all single hop transmissions that have been simulated so far
+        unsigned long getTransmittedByteCount() { return this->transmittedByteCount; }
+        /// Amount of single hop transmissions the node has received so far
+        unsigned long getReceptionCount(cryptography::UUID node) { return this->receptionCounts[node]; }
     };
 
 }
@@ -0,0 +1,334 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include <unordered_set>
+#include <algorithm>
+
+#include "NetworkSnapshot.hpp"
+
+namespace ProtoMesh::communication {
+
+    NetworkSnapshot NetworkSnapshot::build(cryptography::UUID device, uint64_t createdAt,
+                                           const vector<SnapshotRoute> &zoneRoutes,
+                                           const vector<SnapshotRoute> &cachedRoutes,
+                                           const vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> &hosts) {
+
+        using namespace scheme::communication;
+        flatbuffers::FlatBufferBuilder builder;
+
+        /// Collect all referenced nodes so that every hop only takes up a two byte index.
+        /// Routes and keys that would exceed NETWORK_SNAPSHOT_MAX_NODES distinct nodes are left out.
+        unordered_set<cryptography::UUID> referencedNodes;
+        auto reference = [&referencedNodes](const vector<cryptography::UUID> &route) {
+            size_t newNodes = count_if(route.begin(), route.end(), [&referencedNodes](const cryptography::UUID &node) {
+                return referencedNodes.find(node) == referencedNodes.end();
+            });
+            if (referencedNodes.size() + newNodes > NETWORK_SNAPSHOT_MAX_NODES) return false;
+
+            referencedNodes.insert(route.begin(), route.end());
+            return true;
+        };
+
+        vector<SnapshotRoute> storedZoneRoutes, storedCachedRoutes;
+        for (const SnapshotRoute &route : zoneRoutes)
+            if (reference(route.route)) storedZoneRoutes.push_back(route);
+        for (const SnapshotRoute &route : cachedRoutes)
+            if (reference(route.route)) storedCachedRoutes.push_back(route);
+
+        vector<pair<cryptography::UUID, const cryptography::asymmetric::PublicKey *>> storedHosts;
+        for (const auto &host : hosts)
+            if (reference({host.first})) storedHosts.emplace_back(host.first, &host.second);
+
+        vector<cryptography::UUID> nodes(referencedNodes.begin(), referencedNodes.end());
+        sort(nodes.begin(), nodes.end());
+
+        auto indexOf = [&nodes](const cryptography::UUID &node) {
+            return (uint16_t) (lower_bound(nodes.begin(), nodes.end(), node) - nodes.begin());
+        };
+
+        /// Serialize the node list
+        vector<scheme::cryptography::UUID> nodeEntries;
+        for (const cryptography::UUID &node : nodes)
+            nodeEntries.push_back(node.toScheme());
+        auto nodeVector = builder.CreateVectorOfStructs(nodeEntries);
+
+        /// Serialize the routes
+        auto serializeRoutes = [&builder, &indexOf](const vector<SnapshotRoute> &routes) {
+            vector<flatbuffers::Offset<scheme::communication::SnapshotRoute>> routeEntries;
+            for (const SnapshotRoute &route : routes) {
+                vector<uint16_t> hops;
+                for (const cryptography::UUID &hop : route.route)
+                    hops.push_back(indexOf(hop));
+
+                auto hopVector = builder.CreateVector(hops);
+                routeEntries.push_back(CreateSnapshotRoute(builder, hopVector, (uint32_t) route.remainingLifetime,
+                                                           (uint32_t) route.metric, route.learned));
+            }
+            return builder.CreateVector(routeEntries);
+        };
+        auto zoneRouteVector = serializeRoutes(storedZoneRoutes);
+        auto cachedRouteVector = serializeRoutes(storedCachedRoutes);
+
+        /// Serialize the decompressed keys ordered by their node index
+        vector<pair<uint16_t, const cryptography::asymmetric::PublicKey *>> sortedHosts;
+        for (const auto &host : storedHosts)
+            sortedHosts.emplace_back(indexOf(host.first), host.second);
+        sort(sortedHosts.begin(), sortedHosts.end(),
+             [](const auto &a, const auto &b) { return a.first < b.first; });
+
+        vector<flatbuffers::Offset<SnapshotHost>> hostEntries;
+        for (const auto &host : sortedHosts) {
+            auto keyVector = builder.CreateVector(host.second->raw.data(), PUB_KEY_SIZE);
+            hostEntries.push_back(CreateSnapshotHost(builder, host.first, keyVector));
+        }
+        auto hostVector = builder.CreateVector(hostEntries);
+
+        auto deviceID = device.toScheme();
+        auto snapshot = CreateNetworkSnapshotDatagram(builder, NETWORK_SNAPSHOT_VERSION, &deviceID, createdAt,
+                                                      nodeVector, zoneRouteVector, cachedRouteVector, hostVector);
+
+        /// Convert it to a byte array
+        builder.Finish(snapshot, NetworkSnapshotDatagramIdentifier());
+        uint8_t *buf = builder.GetBufferPointer();
+
+        auto storage = make_shared<const vector<uint8_t>>(buf, buf + builder.GetSize());
+        return NetworkSnapshot(storage, storage->data(), storage->size());
+    }
+
+    const scheme::communication::NetworkSnapshotDatagram *NetworkSnapshot::root() const {
+        return scheme::communication::GetNetworkSnapshotDatagram(this->data);
+    }
+
+    vector<SnapshotRoute> NetworkSnapshot::decodeRoutes(
+            const flatbuffers::Vector<flatbuffers::Offset<scheme::communication::SnapshotRoute>> *routes) const {
+        if (!routes) return {};
+
+        auto nodes = this->root()->nodes();
+        vector<SnapshotRoute> decodedRoutes;
+
+        for (uint i = 0; i < routes->Length(); i++) {
+            auto route = routes->Get(i);
+
+            vector<cryptography::UUID> hops;
+            for (uint hop = 0; hop < route->hops()->Length(); hop++)
+                hops.emplace_back(nodes->Get(route->hops()->Get(hop)));
+
+            decodedRoutes.emplace_back(hops, route->remainingLifetime(), route->metric(), route->learned());
+        }
+
+        return decodedRoutes;
+    }
+
+    cryptography::UUID NetworkSnapshot::getDevice() const {
+        return cryptography::UUID(this->root()->device());
+    }
+
+    uint64_t NetworkSnapshot::getCreatedAt() const {
+        return this->root()->createdAt();
+    }
+
+    vector<SnapshotRoute> NetworkSnapshot::getZoneRoutes() const {
+        return this->decodeRoutes(this->root()->zoneRoutes());
+    }
+
+    vector<SnapshotRoute> NetworkSnapshot::getCachedRoutes() const {
+        return this->decodeRoutes(this->root()->cachedRoutes());
+    }
+
+    size_t NetworkSnapshot::getHostCount() const {
+        auto hosts = this->root()->hosts();
+        return hosts ? hosts->Length() : 0;
+    }
+
+    vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> NetworkSnapshot::getKeys() const {
+        auto nodes = this->root()->nodes();
+        auto hosts = this->root()->hosts();
+        if (!hosts) return {};
+
+        vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> keys;
+        for (uint i = 0; i < hosts->Length(); i++) {
+            auto host = hosts->Get(i);
+            keys.emplace_back(cryptography::UUID(nodes->Get(host->node())),
+                              cryptography::asymmetric::PublicKey((uint8_t *) host->publicKey()->Data()));
+        }
+
+        return keys;
+    }
+
+    optional<cryptography::asymmetric::PublicKey> NetworkSnapshot::getKey(cryptography::UUID device) const {
+        auto nodes = this->root()->nodes();
+        auto hosts = this->root()->hosts();
+        if (!hosts) return nullopt;
+
+        /// Find the index of the node, the node list is sorted by ID
+        uint low = 0, high = nodes->Length();
+        while (low < high) {
+            uint middle = low + (high - low) / 2;
+            if (cryptography::UUID(nodes->Get(middle)) < device) low = middle + 1;
+            else high = middle;
+        }
+        if (low == nodes->Length() || cryptography::UUID(nodes->Get(low)) != device) return nullopt;
+        uint16_t node = low;
+
+        /// Find the key of the node, the hosts are sorted by their node index
+        low = 0, high = hosts->Length();
+        while (low < high) {
+            uint middle = low + (high - low) / 2;
+            if (hosts->Get(middle)->node() < node) low = middle + 1;
+            else high = middle;
+        }
+        if (low == hosts->Length() || hosts->Get(low)->node() != node) return nullopt;
+
+        /// The key is stored decompressed so it can be copied as is
+        return cryptography::asymmetric::PublicKey((uint8_t *) hosts->Get(low)->publicKey()->Data());
+    }
+
+    vector<uint8_t> NetworkSnapshot::serialize() const {
+        return {this->data, this->data + this->size};
+    }
+
+    Result<NetworkSnapshot, DeserializationError> NetworkSnapshot::fromBuffer(vector<uint8_t> buffer) {
+        auto storage = make_shared<const vector<uint8_t>>(std::move(buffer));
+        auto snapshot = NetworkSnapshot::fromMemory(storage->data(), storage->size());
+        if (snapshot.isErr()) return snapshot;
+
+        return Ok(NetworkSnapshot(storage, storage->data(), storage->size()));
+    }
+
+    Result<NetworkSnapshot, DeserializationError> NetworkSnapshot::fromMemory(const uint8_t *data, size_t size) {
+
+        using namespace scheme::communication;
+
+        /// Verify the buffer type
+        if (!flatbuffers::BufferHasIdentifier(data, NetworkSnapshotDatagramIdentifier()))
+            return Err(DeserializationError::INVALID_IDENTIFIER);
+
+        /// Verify buffer integrity
+        auto verifier = flatbuffers::Verifier(data, size);
+        if (!VerifyNetworkSnapshotDatagramBuffer(verifier))
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        auto snapshot = GetNetworkSnapshotDatagram(data);
+        if (snapshot->version() != NETWORK_SNAPSHOT_VERSION)
+            return Err(DeserializationError::UNSUPPORTED_VERSION);
+
+        if (!snapshot->device() || !snapshot->nodes())
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        /// Verify the node indices and key sizes once so that later lookups can't fail
+        uint nodeCount = snapshot->nodes()->Length();
+        for (auto routes : {snapshot->zoneRoutes(), snapshot->cachedRoutes()}) {
+            if (!routes) continue;
+            for (uint i = 0; i < routes->Length(); i++) {
+                auto hops = routes->Get(i)->hops();
+                if (!hops || hops->Length() < 2)
+                    return Err(DeserializationError::INVALID_BUFFER);
+                for (uint hop = 0; hop < hops->Length(); hop++)
+                    if (hops->Get(hop) >= nodeCount)
+                        return Err(DeserializationError::INVALID_BUFFER);
+            }
+        }
+
+        if (snapshot->hosts()) {
+            for (uint i = 0; i < snapshot->hosts()->Length(); i++) {
+                auto host = snapshot->hosts()->Get(i);
+                if (host->node() >= nodeCount || !host->publicKey() || host->publicKey()->Length() != PUB_KEY_SIZE)
+                    return Err(DeserializationError::INVALID_BUFFER);
+            }
+        }
+
+        return Ok(NetworkSnapshot(nullptr, data, size));
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Taking a snapshot of the routing state", "[unit_test][module][communication]") {
+        GIVEN("a few routes and keys") {
+            cryptography::UUID device, a, b, c, unknown;
+            auto keyA = cryptography::asymmetric::generateKeyPair().pub;
+            auto keyC = cryptography::asymmetric::generateKeyPair().pub;
+
+            vector<SnapshotRoute> zoneRoutes = {SnapshotRoute({device, a}, 8000, 100),
+                                                SnapshotRoute({device, a, b}, 9000, 250)};
+            vector<SnapshotRoute> cachedRoutes = {SnapshotRoute({device, a, b, c}, 50000, 0, true)};
+
+            NetworkSnapshot snapshot = NetworkSnapshot::build(device, 1500000000, zoneRoutes, cachedRoutes,
+                                                              {{c, keyC}, {a, keyA}});
+
+            WHEN("the snapshot is serialized and deserialized") {
+                auto deserializedSnapshot = NetworkSnapshot::fromBuffer(snapshot.serialize());
+
+                THEN("it should be valid") {
+                    REQUIRE(deserializedSnapshot.isOk());
+
+                    AND_THEN("the device and timestamp should be retained") {
+                        REQUIRE(deserializedSnapshot.unwrap().getDevice() == device);
+                        REQUIRE(deserializedSnapshot.unwrap().getCreatedAt() == 1500000000);
+                    }
+
+                    AND_THEN("all routes should be retained") {
+                        vector<SnapshotRoute> restoredZoneRoutes = deserializedSnapshot.unwrap().getZoneRoutes();
+                        vector<SnapshotRoute> restoredCachedRoutes = deserializedSnapshot.unwrap().getCachedRoutes();
+
+                        REQUIRE(restoredZoneRoutes.size() == 2);
+                        REQUIRE(restoredZoneRoutes[1].route == zoneRoutes[1].route);
+                        REQUIRE(restoredZoneRoutes[1].remainingLifetime == 9000);
+                        REQUIRE(restoredZoneRoutes[1].metric == 250);
+                        REQUIRE(restoredCachedRoutes.size() == 1);
+                        REQUIRE(restoredCachedRoutes[0].route == cachedRoutes[0].route);
+                        REQUIRE(restoredCachedRoutes[0].learned);
+                    }
+
+                    AND_THEN("the keys should be retrievable by their device") {
+                        REQUIRE(deserializedSnapshot.unwrap().getHostCount() == 2);
+                        REQUIRE(deserializedSnapshot.unwrap().getKey(a).value() == keyA);
+                        REQUIRE(deserializedSnapshot.unwrap().getKey(c).value() == keyC);
+                        REQUIRE_FALSE(deserializedSnapshot.unwrap().getKey(b).has_value());
+                        REQUIRE_FALSE(deserializedSnapshot.unwrap().getKey(unknown).has_value());
+                        REQUIRE(deserializedSnapshot.unwrap().getKeys().size() == 2);
+                    }
+                }
+            }
+
+            WHEN("the snapshot is read in place") {
+                vector<uint8_t> memory = snapshot.serialize();
+                auto mappedSnapshot = NetworkSnapshot::fromMemory(memory.data(), memory.size());
+
+                THEN("it should yield the same keys") {
+                    REQUIRE(mappedSnapshot.isOk());
+                    REQUIRE(mappedSnapshot.unwrap().getKey(a).value() == keyA);
+                }
+            }
+
+            WHEN("the routes reference more nodes than a snapshot is able to index") {
+                vector<SnapshotRoute> manyRoutes;
+                for (uint32_t i = 1; i <= NETWORK_SNAPSHOT_MAX_NODES; i++)
+                    manyRoutes.emplace_back(vector<cryptography::UUID>{device, cryptography::UUID::fromNumber(i)}, 8000);
+
+                NetworkSnapshot largeSnapshot = NetworkSnapshot::build(device, 1500000000, manyRoutes, {}, {{a, keyA}});
+                vector<SnapshotRoute> restoredRoutes = NetworkSnapshot::fromBuffer(largeSnapshot.serialize()).unwrap()
+                        .getZoneRoutes();
+
+                THEN("the routes that do not fit should have been left out") {
+                    REQUIRE(restoredRoutes.size() == NETWORK_SNAPSHOT_MAX_NODES - 1);
+                    REQUIRE(restoredRoutes.back().route == manyRoutes[NETWORK_SNAPSHOT_MAX_NODES - 2].route);
+                    REQUIRE_FALSE(largeSnapshot.getKey(a).has_value());
+                }
+            }
+
+            WHEN("the snapshot is corrupted") {
+                vector<uint8_t> buffer = snapshot.serialize();
+                buffer.resize(buffer.size() / 2);
+
+                THEN("deserializing it should fail") {
+                    REQUIRE(NetworkSnapshot::fromBuffer(buffer).isErr());
+                }
+            }
+        }
+    }
+
+#endif
+}
@@ -0,0 +1,91 @@
+#ifndef PROTOMESH_NETWORKSNAPSHOT_HPP
+#define PROTOMESH_NETWORKSNAPSHOT_HPP
+
+#include <utility>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+using namespace std;
+
+#include "uuid.hpp"
+#include "asymmetric.hpp"
+#include "Serializable.hpp"
+
+#include "flatbuffers/flatbuffers.h"
+#include "communication/snapshot_generated.h"
+
+/// Format version of the snapshots written by this implementation
+#define NETWORK_SNAPSHOT_VERSION 1
+/// Age in seconds above which a snapshot is no longer restored
+#define NETWORK_SNAPSHOT_MAX_AGE 3600
+/// Interval in seconds at which snapshots should be persisted while the device is running
+#define NETWORK_SNAPSHOT_INTERVAL 300
+/// Maximum amount of distinct nodes a snapshot references since hops are stored as two byte indices
+#define NETWORK_SNAPSHOT_MAX_NODES (UINT16_MAX + 1)
+
+namespace ProtoMesh::communication {
+
+    class SnapshotRoute {
+    public:
+        /// Starts with the device that created the snapshot and ends with the destination
+        vector<cryptography::UUID> route;
+        /// Time in milliseconds the route was still valid for when the snapshot was taken
+        long remainingLifetime;
+        unsigned long metric;
+        bool learned;
+
+        SnapshotRoute(vector<cryptography::UUID> route, long remainingLifetime, unsigned long metric = 0,
+                      bool learned = false)
+                : route(std::move(route)), remainingLifetime(remainingLifetime), metric(metric), learned(learned) {};
+    };
+
+    /// Binary snapshot of the routing table, route cache and known keys of a device.
+    /// Allows a restarted device to resume routing without waiting for advertisements and discoveries.
+    /// The snapshot is read in place so it may be backed by a memory-mapped file. Routes are only decoded
+    /// when they are restored and public keys are looked up on demand.
+    class NetworkSnapshot : public Serializable<NetworkSnapshot> {
+        /// Buffer owned by the snapshot, null if it refers to external memory
+        shared_ptr<const vector<uint8_t>> storage;
+        const uint8_t *data;
+        size_t size;
+
+        NetworkSnapshot(shared_ptr<const vector<uint8_t>> storage, const uint8_t *data, size_t size)
+                : storage(std::move(storage)), data(data), size(size) {};
+
+        const scheme::communication::NetworkSnapshotDatagram *root() const;
+        vector<SnapshotRoute> decodeRoutes(
+                const flatbuffers::Vector<flatbuffers::Offset<scheme::communication::SnapshotRoute>> *routes) const;
+
+    public:
+        /// Routes and keys are stored in the given order until NETWORK_SNAPSHOT_MAX_NODES distinct nodes are referenced,
+        /// the remaining ones that would reference further nodes are left out.
+        static NetworkSnapshot build(cryptography::UUID device, uint64_t createdAt,
+                                     const vector<SnapshotRoute> &zoneRoutes,
+                                     const vector<SnapshotRoute> &cachedRoutes,
+                                     const vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> &hosts);
+
+        cryptography::UUID getDevice() const;
+        /// Time in seconds at which the snapshot was taken, as provided to build
+        uint64_t getCreatedAt() const;
+        vector<SnapshotRoute> getZoneRoutes() const;
+        vector<SnapshotRoute> getCachedRoutes() const;
+        size_t getHostCount() const;
+        /// Decodes all keys of the snapshot
+        vector<pair<cryptography::UUID, cryptography::asymmetric::PublicKey>> getKeys() const;
+        /// Looks up the key of the device without decoding any of the other keys
+        optional<cryptography::asymmetric::PublicKey> getKey(cryptography::UUID device) const;
+
+        /// Serializable overrides
+        static Result<NetworkSnapshot, DeserializationError> fromBuffer(vector<uint8_t> buffer);
+        vector<uint8_t> serialize() const override;
+
+        /// Reads the snapshot in place without copying it.
+        /// The memory has to stay valid for as long as the snapshot or any of its copies is in use.
+        static Result<NetworkSnapshot, DeserializationError> fromMemory(const uint8_t *data, size_t size);
+    };
+
+}
+
+#endif //PROTOMESH_NETWORKSNAPSHOT_HPP
@@ -0,0 +1,424 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "OutgoingQueue.hpp"
+
+namespace ProtoMesh::communication {
+
+    void OutgoingQueue::setLimit(QueueLimit limit, DropPolicy dropPolicy) {
+        this->limit = limit;
+        this->dropPolicy = dropPolicy;
+    }
+
+    bool OutgoingQueue::push(tuple<MessageTarget, vector<uint8_t>> datagram, TrafficClass trafficClass,
+                             optional<OutgoingPayload> payload) {
+        /// Without scheduling every datagram goes through the same flow
+        cryptography::UUID nextHop = cryptography::UUID::Empty();
+        if (this->prioritize)
+            nextHop = get<0>(datagram).target;
+        else
+            trafficClass = TrafficClass::CONTROL;
+
+        /// Datagrams that would not even fit into an empty queue are dropped without touching the queued ones
+        size_t datagramSize = get<1>(datagram).size();
+        while (!this->limit.fits(this->count, this->byteCount, datagramSize)) {
+            if (!this->limit.fits(0, 0, datagramSize) || !this->dropFor(trafficClass)) {
+                this->dropCount++;
+                return false;
+            }
+        }
+
+        Flow &flow = this->flowsOf(trafficClass)[nextHop];
+        if (flow.datagrams.empty()) {
+            if (trafficClass == TrafficClass::CONTROL)
+                this->controlFlows.push_back(nextHop);
+            else
+                this->weightedFlows.emplace_back(trafficClass, nextHop);
+        }
+
+        flow.datagrams.push_back(Entry{std::move(datagram), this->nextSequenceNumber++, std::move(payload)});
+        this->count++;
+        this->byteCount += datagramSize;
+        return true;
+    }
+
+    tuple<MessageTarget, vector<uint8_t>> OutgoingQueue::takeFrontOf(TrafficClass trafficClass,
+                                                                     const cryptography::UUID &nextHop) {
+        cryptography::UUIDMap<Flow> &classFlows = this->flowsOf(trafficClass);
+        Flow &flow = classFlows.at(nextHop);
+        tuple<MessageTarget, vector<uint8_t>> datagram = std::move(flow.datagrams.front().datagram);
+        flow.datagrams.pop_front();
+
+        this->count--;
+        this->byteCount -= get<1>(datagram).size();
+
+        /// Idle flows do not save up deficit
+        if (flow.datagrams.empty())
+            classFlows.erase(nextHop);
+
+        return datagram;
+    }
+
+    bool OutgoingQueue::dropFor(TrafficClass trafficClass) {
+        if (this->dropPolicy == DropPolicy::NEWEST) return false;
+
+        /// Classes the victim may be taken from, the priority policy only considers the lowest one queued
+        size_t firstClass = static_cast<size_t>(TrafficClass::CONTROL);
+        if (this->dropPolicy == DropPolicy::PRIORITY) {
+            firstClass = static_cast<size_t>(TrafficClass::BULK);
+            while (this->flows[firstClass].empty()) firstClass--;
+            if (firstClass < static_cast<size_t>(trafficClass)) return false;
+        }
+
+        /// Oldest datagram among the first ones of every flow of those classes
+        optional<tuple<TrafficClass, cryptography::UUID, uint64_t>> victim;
+        for (size_t classIndex = firstClass; classIndex < this->flows.size(); classIndex++) {
+            for (const auto &entry : this->flows[classIndex]) {
+                uint64_t sequenceNumber = entry.second.datagrams.front().sequenceNumber;
+                if (!victim.has_value() || sequenceNumber < get<2>(*victim))
+                    victim = make_tuple(static_cast<TrafficClass>(classIndex), entry.first, sequenceNumber);
+            }
+        }
+
+        auto [victimClass, nextHop, sequenceNumber] = *victim;
+        optional<OutgoingPayload> &payload = this->flowsOf(victimClass).at(nextHop).datagrams.front().payload;
+        if (payload.has_value())
+            this->droppedPayloads.push_back(std::move(*payload));
+
+        this->takeFrontOf(victimClass, nextHop);
+        this->dropCount++;
+
+        /// The flow is no longer served if that was its last datagram
+        if (this->flowsOf(victimClass).find(nextHop) == this->flowsOf(victimClass).end()) {
+            if (victimClass == TrafficClass::CONTROL)
+                this->controlFlows.erase(find(this->controlFlows.begin(), this->controlFlows.end(), nextHop));
+            else
+                this->weightedFlows.erase(find(this->weightedFlows.begin(), this->weightedFlows.end(),
+                                               make_tuple(victimClass, nextHop)));
+        }
+
+        return true;
+    }
+
+    optional<tuple<MessageTarget, vector<uint8_t>>> OutgoingQueue::popControl() {
+        if (this->controlFlows.empty()) return nullopt;
+
+        cryptography::UUID nextHop = this->controlFlows.front();
+        this->controlFlows.pop_front();
+
+        tuple<MessageTarget, vector<uint8_t>> datagram = this->takeFrontOf(TrafficClass::CONTROL, nextHop);
+        if (this->flowsOf(TrafficClass::CONTROL).find(nextHop) != this->flowsOf(TrafficClass::CONTROL).end())
+            this->controlFlows.push_back(nextHop);
+
+        return datagram;
+    }
+
+    optional<tuple<MessageTarget, vector<uint8_t>>> OutgoingQueue::popWeighted() {
+        /// Terminates since every flow that is passed over receives another quantum on its next turn
+        while (!this->weightedFlows.empty()) {
+            auto [trafficClass, nextHop] = this->weightedFlows.front();
+            Flow &flow = this->flowsOf(trafficClass).at(nextHop);
+
+            if (!flow.hasTurn) {
+                flow.deficit += this->quantum * weightOf(trafficClass);
+                flow.hasTurn = true;
+            }
+
+            size_t datagramSize = get<1>(flow.datagrams.front().datagram).size();
+            if (datagramSize > flow.deficit) {
+                /// The turn ends but the deficit is kept so that large datagrams are sent eventually
+                flow.hasTurn = false;
+                this->weightedFlows.pop_front();
+                this->weightedFlows.emplace_back(trafficClass, nextHop);
+                continue;
+            }
+
+            flow.deficit -= datagramSize;
+            bool lastDatagram = flow.datagrams.size() == 1;
+            tuple<MessageTarget, vector<uint8_t>> datagram = this->takeFrontOf(trafficClass, nextHop);
+            if (lastDatagram)
+                this->weightedFlows.pop_front();
+
+            return datagram;
+        }
+
+        return nullopt;
+    }
+
+    optional<tuple<MessageTarget, vector<uint8_t>>> OutgoingQueue::pop() {
+        auto datagram = this->popControl();
+        if (!datagram.has_value())
+            datagram = this->popWeighted();
+
+        return datagram;
+    }
+
+    vector<tuple<MessageTarget, vector<uint8_t>>> OutgoingQueue::drain(size_t maxCount) {
+        vector<tuple<MessageTarget, vector<uint8_t>>> datagrams;
+        datagrams.reserve(min(maxCount, this->count));
+
+        while (datagrams.size() < maxCount && !this->empty())
+            datagrams.push_back(std::move(*this->pop()));
+
+        return datagrams;
+    }
+
+    vector<OutgoingPayload> OutgoingQueue::takeDroppedPayloads() {
+        vector<OutgoingPayload> payloads = std::move(this->droppedPayloads);
+        this->droppedPayloads.clear();
+        return payloads;
+    }
+
+    vector<tuple<MessageTarget, vector<uint8_t>>> OutgoingQueue::contents() const {
+        vector<tuple<MessageTarget, vector<uint8_t>>> datagrams;
+        datagrams.reserve(this->count);
+
+        for (const cryptography::UUIDMap<Flow> &classFlows : this->flows)
+            for (const auto &entry : classFlows)
+                for (const Entry &queued : entry.second.datagrams)
+                    datagrams.push_back(queued.datagram);
+
+        return datagrams;
+    }
+
+#ifdef UNIT_TESTING
+
+    /// Datagram of the given size whose first byte identifies it
+    tuple<MessageTarget, vector<uint8_t>> outgoingDatagram(cryptography::UUID nextHop, uint8_t tag, size_t size = 100) {
+        vector<uint8_t> datagram(size, 0);
+        datagram[0] = tag;
+        return make_tuple(MessageTarget::single(nextHop), datagram);
+    }
+
+    vector<uint8_t> tagsOf(const vector<tuple<MessageTarget, vector<uint8_t>>> &datagrams) {
+        vector<uint8_t> tags;
+        for (const auto &datagram : datagrams)
+            tags.push_back(get<1>(datagram)[0]);
+        return tags;
+    }
+
+    SCENARIO("Outgoing datagrams should be scheduled by their traffic class and next hop",
+             "[unit_test][module][communication]") {
+        GIVEN("an outgoing queue and two neighbors") {
+            OutgoingQueue queue;
+            cryptography::UUID neighborA;
+            cryptography::UUID neighborB;
+
+            WHEN("control datagrams are queued behind a bulk transfer") {
+                for (uint8_t i = 0; i < 10; i++)
+                    queue.push(outgoingDatagram(neighborA, 1), TrafficClass::BULK);
+                queue.push(outgoingDatagram(neighborA, 2), TrafficClass::CONTROL);
+                queue.push(make_tuple(MessageTarget::broadcast(), vector<uint8_t>({3})), TrafficClass::CONTROL);
+
+                THEN("they should leave first") {
+                    REQUIRE(queue.size() == 12);
+                    auto datagrams = queue.drain();
+                    REQUIRE(datagrams.size() == 12);
+                    REQUIRE(tagsOf(datagrams) == vector<uint8_t>({2, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}));
+                    REQUIRE(queue.empty());
+                }
+            }
+
+            WHEN("control datagrams are queued for both neighbors") {
+                queue.push(outgoingDatagram(neighborA, 1), TrafficClass::CONTROL);
+                queue.push(outgoingDatagram(neighborA, 1), TrafficClass::CONTROL);
+                queue.push(outgoingDatagram(neighborA, 1), TrafficClass::CONTROL);
+                queue.push(outgoingDatagram(neighborB, 2), TrafficClass::CONTROL);
+
+                THEN("the neighbors should take turns") {
+                    REQUIRE(tagsOf(queue.drain()) == vector<uint8_t>({1, 2, 1, 1}));
+                }
+            }
+
+            WHEN("both neighbors are sent bulk transfers of different sizes") {
+                for (uint8_t i = 0; i < 100; i++)
+                    queue.push(outgoingDatagram(neighborA, 1, 1000), TrafficClass::BULK);
+                for (uint8_t i = 0; i < 100; i++)
+                    queue.push(outgoingDatagram(neighborB, 2, 250), TrafficClass::BULK);
+
+                THEN("they should receive the same share of bytes") {
+                    auto datagrams = queue.drain(50);
+                    size_t bytesA = 0, bytesB = 0;
+                    for (const auto &datagram : datagrams)
+                        (get<1>(datagram)[0] == 1 ? bytesA : bytesB) += get<1>(datagram).size();
+
+                    REQUIRE(bytesA >= bytesB - OUTGOING_QUEUE_QUANTUM);
+                    REQUIRE(bytesA <= bytesB + OUTGOING_QUEUE_QUANTUM);
+                    REQUIRE(queue.size() == 150);
+                }
+            }
+
+            WHEN("interactive and bulk datagrams are queued for the same neighbor") {
+                for (uint8_t i = 0; i < 100; i++)
+                    queue.push(outgoingDatagram(neighborA, 1, 500), TrafficClass::BULK);
+                for (uint8_t i = 0; i < 100; i++)
+                    queue.push(outgoingDatagram(neighborA, 2, 500), TrafficClass::INTERACTIVE);
+
+                THEN("interactive datagrams should receive the larger share according to the weights") {
+                    /// Four rounds of three bulk and twelve interactive datagrams
+                    auto tags = tagsOf(queue.drain(60));
+                    size_t interactive = count(tags.begin(), tags.end(), 2);
+                    size_t bulk = count(tags.begin(), tags.end(), 1);
+
+                    REQUIRE(interactive == 48);
+                    REQUIRE(bulk == 12);
+                }
+            }
+
+            WHEN("a datagram is larger than the quantum") {
+                queue.push(outgoingDatagram(neighborA, 1, OUTGOING_QUEUE_QUANTUM * 3), TrafficClass::BULK);
+                queue.push(outgoingDatagram(neighborB, 2, 100), TrafficClass::BULK);
+
+                THEN("it should be sent once its flow saved up enough deficit") {
+                    REQUIRE(tagsOf(queue.drain()) == vector<uint8_t>({2, 1}));
+                }
+            }
+
+            WHEN("scheduling is disabled") {
+                queue.prioritize = false;
+                queue.push(outgoingDatagram(neighborA, 1), TrafficClass::BULK);
+                queue.push(outgoingDatagram(neighborB, 2), TrafficClass::INTERACTIVE);
+                queue.push(outgoingDatagram(neighborA, 3), TrafficClass::CONTROL);
+
+                THEN("datagrams should leave in the order they arrived") {
+                    REQUIRE(queue.contents().size() == 3);
+                    REQUIRE(tagsOf(queue.drain()) == vector<uint8_t>({1, 2, 3}));
+                }
+            }
+        }
+    }
+
+    SCENARIO("Outgoing datagrams should be dropped according to the policy once the queue is full",
+             "[unit_test][module][communication]") {
+        GIVEN("an outgoing queue limited to three datagrams") {
+            OutgoingQueue queue;
+            cryptography::UUID neighborA;
+            cryptography::UUID neighborB;
+
+            WHEN("a fourth datagram is queued while the oldest ones are dropped") {
+                queue.setLimit({3, SIZE_MAX}, DropPolicy::OLDEST);
+                queue.push(outgoingDatagram(neighborA, 1), TrafficClass::CONTROL);
+                queue.push(outgoingDatagram(neighborB, 2), TrafficClass::BULK);
+                queue.push(outgoingDatagram(neighborA, 3), TrafficClass::BULK);
+                REQUIRE(queue.push(outgoingDatagram(neighborB, 4), TrafficClass::BULK));
+
+                THEN("the oldest one should be gone regardless of its class") {
+                    REQUIRE(queue.size() == 3);
+                    REQUIRE(queue.getDropCount() == 1);
+                    auto tags = tagsOf(queue.drain());
+                    sort(tags.begin(), tags.end());
+                    REQUIRE(tags == vector<uint8_t>({2, 3, 4}));
+                }
+            }
+
+            WHEN("a fourth datagram is queued while the newest ones are dropped") {
+                queue.setLimit({3, SIZE_MAX}, DropPolicy::NEWEST);
+                for (uint8_t i = 1; i <= 3; i++)
+                    queue.push(outgoingDatagram(neighborA, i), TrafficClass::BULK);
+
+                THEN("it should be rejected") {
+                    REQUIRE_FALSE(queue.push(outgoingDatagram(neighborA, 4), TrafficClass::CONTROL));
+                    REQUIRE(queue.getDropCount() == 1);
+                    REQUIRE(tagsOf(queue.drain()) == vector<uint8_t>({1, 2, 3}));
+                }
+            }
+
+            WHEN("datagrams are dropped by priority") {
+                queue.setLimit({3, SIZE_MAX}, DropPolicy::PRIORITY);
+                queue.push(outgoingDatagram(neighborA, 1), TrafficClass::INTERACTIVE);
+                queue.push(outgoingDatagram(neighborA, 2), TrafficClass::BULK);
+                queue.push(outgoingDatagram(neighborB, 3), TrafficClass::BULK);
+
+                THEN("control datagrams should replace the oldest bulk datagram") {
+                    REQUIRE(queue.push(outgoingDatagram(neighborB, 4), TrafficClass::CONTROL));
+                    REQUIRE(queue.push(outgoingDatagram(neighborB, 5), TrafficClass::CONTROL));
+                    REQUIRE(queue.getDropCount() == 2);
+                    REQUIRE(tagsOf(queue.drain()) == vector<uint8_t>({4, 5, 1}));
+                }
+
+                THEN("the payloads of the replaced datagrams should be handed out once") {
+                    cryptography::UUID destination;
+                    queue.push(outgoingDatagram(neighborA, 4), TrafficClass::BULK, OutgoingPayload{destination, {4}});
+                    queue.push(outgoingDatagram(neighborA, 5), TrafficClass::CONTROL);
+                    queue.push(outgoingDatagram(neighborA, 6), TrafficClass::CONTROL);
+                    queue.push(outgoingDatagram(neighborA, 7), TrafficClass::CONTROL);
+
+                    vector<OutgoingPayload> droppedPayloads = queue.takeDroppedPayloads();
+                    REQUIRE(queue.getDropCount() == 4);
+                    REQUIRE(droppedPayloads.size() == 1);
+                    REQUIRE(droppedPayloads[0].destination == destination);
+                    REQUIRE(droppedPayloads[0].payload == vector<uint8_t>({4}));
+                    REQUIRE(queue.takeDroppedPayloads().empty());
+                }
+
+                THEN("bulk datagrams should replace older bulk datagrams") {
+                    REQUIRE(queue.push(outgoingDatagram(neighborA, 4), TrafficClass::BULK));
+                    REQUIRE(tagsOf(queue.drain()) == vector<uint8_t>({1, 3, 4}));
+                }
+
+                AND_WHEN("only control datagrams are queued") {
+                    for (uint8_t i = 4; i <= 6; i++)
+                        queue.push(outgoingDatagram(neighborA, i), TrafficClass::CONTROL);
+
+                    THEN("interactive datagrams should be rejected") {
+                        REQUIRE_FALSE(queue.push(outgoingDatagram(neighborA, 7), TrafficClass::INTERACTIVE));
+                        REQUIRE(tagsOf(queue.drain()) == vector<uint8_t>({4, 5, 6}));
+                    }
+                }
+            }
+
+            WHEN("the amount of bytes is limited") {
+                queue.setLimit({SIZE_MAX, 1000}, DropPolicy::OLDEST);
+                queue.push(outgoingDatagram(neighborA, 1, 400), TrafficClass::BULK);
+                queue.push(outgoingDatagram(neighborA, 2, 400), TrafficClass::BULK);
+
+                THEN("datagrams should be dropped until the new one fits") {
+                    REQUIRE(queue.pressure() == QueuePressure::CONGESTED);
+                    REQUIRE(queue.push(outgoingDatagram(neighborA, 3, 900), TrafficClass::BULK));
+                    REQUIRE(queue.getDropCount() == 2);
+                    REQUIRE(queue.byteSize() == 900);
+                }
+
+                THEN("datagrams larger than the limit should be rejected right away") {
+                    REQUIRE_FALSE(queue.push(outgoingDatagram(neighborA, 3, 1001), TrafficClass::CONTROL));
+                    REQUIRE(queue.size() == 2);
+                }
+
+                THEN("the bytes should be released once the datagrams are taken") {
+                    queue.drain();
+                    REQUIRE(queue.byteSize() == 0);
+                    REQUIRE(queue.pressure() == QueuePressure::NORMAL);
+                }
+            }
+        }
+    }
+
+    SCENARIO("Outgoing queues should stay within their limits under sustained overload",
+             "[unit_test][module][communication]") {
+        GIVEN("an outgoing queue limited to 64 datagrams and 16KiB that is never drained") {
+            OutgoingQueue queue;
+            vector<cryptography::UUID> neighbors(8);
+
+            for (DropPolicy policy : {DropPolicy::OLDEST, DropPolicy::NEWEST, DropPolicy::PRIORITY}) {
+                queue.setLimit({64, 16 * 1024}, policy);
+
+                for (size_t i = 0; i < 10000; i++) {
+                    auto trafficClass = static_cast<TrafficClass>(i % 3);
+                    queue.push(outgoingDatagram(neighbors[i % neighbors.size()], 1, 100 + i % 900), trafficClass);
+
+                    REQUIRE(queue.size() <= 64);
+                    REQUIRE(queue.byteSize() <= 16 * 1024);
+                }
+
+                size_t queued = queue.size();
+                REQUIRE(queue.drain().size() == queued);
+                REQUIRE(queue.byteSize() == 0);
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
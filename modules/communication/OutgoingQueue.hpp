@@ -0,0 +1,140 @@
+#ifndef PROTOMESH_OUTGOINGQUEUE_HPP
+#define PROTOMESH_OUTGOINGQUEUE_HPP
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <tuple>
+#include <optional>
+#include <cstdint>
+
+using namespace std;
+
+#include "uuid.hpp"
+#include "UUIDMap.hpp"
+#include "MessageTarget.hpp"
+#include "QueueLimits.hpp"
+
+/// Bytes a flow with a weight of one may send per round, should be at least the size of a typical datagram
+#define OUTGOING_QUEUE_QUANTUM 1500
+/// Share of the capacity left by control traffic that interactive flows receive relative to bulk flows
+#define OUTGOING_QUEUE_INTERACTIVE_WEIGHT 4
+#define OUTGOING_QUEUE_BULK_WEIGHT 1
+
+namespace ProtoMesh::communication {
+
+    /// Classes of outgoing datagrams in the order they are served
+    enum class TrafficClass {
+        /// Advertisements, route discoveries, acknowledgements and delivery failures
+        CONTROL,
+        /// Requests and responses someone is waiting for
+        INTERACTIVE,
+        /// Large transfers that may be delayed in favor of everything else
+        BULK
+    };
+
+    /// Payload of the application carried by an outgoing datagram, kept so that it can be reported if it is dropped
+    class OutgoingPayload {
+    public:
+        cryptography::UUID destination;
+        vector<uint8_t> payload;
+    };
+
+    /// Datagrams waiting to be dispatched, scheduled by their traffic class and next hop.
+    /// Control datagrams always go first, round robin between next hops. The remaining capacity is shared between
+    /// the interactive and bulk flows of every next hop by deficit round robin (Shreedhar & Varghese) weighted by
+    /// their class, so that a burst towards one neighbor neither starves other neighbors nor interactive traffic.
+    /// Once the limit is reached datagrams are dropped according to the drop policy.
+    class OutgoingQueue {
+        class Entry {
+        public:
+            tuple<MessageTarget, vector<uint8_t>> datagram;
+            /// Order in which the datagrams have been queued across all flows
+            uint64_t sequenceNumber;
+            optional<OutgoingPayload> payload;
+        };
+
+        class Flow {
+        public:
+            deque<Entry> datagrams;
+            /// Bytes the flow may still send during its turn or the next one
+            size_t deficit = 0;
+            /// Whether or not the flow already received its quantum for the current turn
+            bool hasTurn = false;
+        };
+
+        /// Flows of each class by next hop, broadcasts share the flow of the empty UUID. Empty flows are removed.
+        array<cryptography::UUIDMap<Flow>, 3> flows;
+        /// Next hops with queued control datagrams in the order they are served
+        deque<cryptography::UUID> controlFlows;
+        /// Interactive and bulk flows with queued datagrams in the order they are served
+        deque<tuple<TrafficClass, cryptography::UUID>> weightedFlows;
+
+        size_t quantum;
+        size_t count = 0;
+        size_t byteCount = 0;
+        uint64_t nextSequenceNumber = 0;
+
+        QueueLimit limit{SIZE_MAX, SIZE_MAX};
+        DropPolicy dropPolicy = DropPolicy::PRIORITY;
+        unsigned long dropCount = 0;
+        /// Payloads of the datagrams dropped to make room for others that have not been taken yet
+        vector<OutgoingPayload> droppedPayloads;
+
+        cryptography::UUIDMap<Flow> &flowsOf(TrafficClass trafficClass) {
+            return this->flows[static_cast<size_t>(trafficClass)];
+        }
+
+        static size_t weightOf(TrafficClass trafficClass) {
+            return trafficClass == TrafficClass::INTERACTIVE ? OUTGOING_QUEUE_INTERACTIVE_WEIGHT
+                                                             : OUTGOING_QUEUE_BULK_WEIGHT;
+        }
+
+        optional<tuple<MessageTarget, vector<uint8_t>>> popControl();
+        optional<tuple<MessageTarget, vector<uint8_t>>> popWeighted();
+
+        /// Removes the first datagram of the flow along with the flow if it is empty afterwards
+        tuple<MessageTarget, vector<uint8_t>> takeFrontOf(TrafficClass trafficClass, const cryptography::UUID &nextHop);
+
+        /// Drops a queued datagram to make room for one of the given class.
+        /// Returns false if the datagram of the given class should be dropped instead.
+        bool dropFor(TrafficClass trafficClass);
+
+    public:
+        explicit OutgoingQueue(size_t quantum = OUTGOING_QUEUE_QUANTUM) : quantum(quantum) {};
+
+        /// Whether or not datagrams are scheduled by class and next hop, otherwise they leave in the order they arrived
+        bool prioritize = true;
+
+        /// Datagrams queued afterwards are dropped according to the policy once the limit is reached
+        void setLimit(QueueLimit limit, DropPolicy dropPolicy);
+
+        /// Returns false if the datagram has been dropped since the queue is full.
+        /// The payload is handed out by takeDroppedPayloads if the datagram is dropped later on to make room for another.
+        bool push(tuple<MessageTarget, vector<uint8_t>> datagram, TrafficClass trafficClass,
+                  optional<OutgoingPayload> payload = nullopt);
+
+        /// Removes and returns the datagram that is due next
+        optional<tuple<MessageTarget, vector<uint8_t>>> pop();
+
+        /// Removes and returns up to maxCount datagrams in the order they are due
+        vector<tuple<MessageTarget, vector<uint8_t>>> drain(size_t maxCount = SIZE_MAX);
+
+        /// Removes and returns the payloads of the datagrams that have been dropped to make room for others
+        vector<OutgoingPayload> takeDroppedPayloads();
+
+        /// Copies of all queued datagrams, grouped by class but not in the order they are due
+        vector<tuple<MessageTarget, vector<uint8_t>>> contents() const;
+
+        size_t size() const { return this->count; }
+        bool empty() const { return this->count == 0; }
+        /// Sum of the sizes of all queued datagrams
+        size_t byteSize() const { return this->byteCount; }
+        QueuePressure pressure() const { return this->limit.pressureAt(this->count, this->byteCount); }
+        /// Amount of datagrams that have been dropped since the queue was full
+        unsigned long getDropCount() const { return this->dropCount; }
+    };
+
+}
+
+#endif //PROTOMESH_OUTGOINGQUEUE_HPP
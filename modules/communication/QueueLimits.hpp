@@ -0,0 +1,93 @@
+#ifndef PROTOMESH_QUEUELIMITS_HPP
+#define PROTOMESH_QUEUELIMITS_HPP
+
+#include <cstddef>
+
+using namespace std;
+
+/// Default limits of the payloads waiting for a route to a single destination
+#define ROUTING_QUEUE_DESTINATION_COUNT 256
+#define ROUTING_QUEUE_DESTINATION_BYTES (256 * 1024)
+/// Default limits of the payloads waiting for a route to any destination
+#define ROUTING_QUEUE_COUNT 1024
+#define ROUTING_QUEUE_BYTES (1024 * 1024)
+/// Default limits of the datagrams waiting to be dispatched
+#define OUTGOING_QUEUE_COUNT 4096
+#define OUTGOING_QUEUE_BYTES (4 * 1024 * 1024)
+/// Default limits of the received payloads waiting to be taken by the application
+#define INCOMING_BUFFER_COUNT 1024
+#define INCOMING_BUFFER_BYTES (1024 * 1024)
+/// Percentage of either limit of a queue above which it reports congestion
+#define QUEUE_CONGESTION_THRESHOLD 75
+
+namespace ProtoMesh::communication {
+
+    /// Decides what is dropped when something is added to a full queue
+    enum class DropPolicy {
+        /// The entry that has been waiting the longest
+        OLDEST,
+        /// The entry that is about to be added
+        NEWEST,
+        /// The oldest entry of the lowest traffic class queued, or the one about to be added if its class is lower.
+        /// Equivalent to OLDEST for entries without a traffic class.
+        PRIORITY
+    };
+
+    /// Whether or not the producers of a queue should slow down
+    enum class QueuePressure {
+        NORMAL,
+        /// The queue is filled beyond QUEUE_CONGESTION_THRESHOLD percent of its limits
+        CONGESTED
+    };
+
+    enum class QueueError {
+        /// The entry has been dropped since the queue is full (see DropPolicy)
+        QUEUE_FULL
+    };
+
+    class QueueLimit {
+    public:
+        size_t count;
+        size_t bytes;
+
+        /// Whether or not another entry of the given size fits into a queue holding the given amount
+        bool fits(size_t queuedCount, size_t queuedBytes, size_t size) const {
+            return queuedCount < this->count && size <= this->bytes && queuedBytes <= this->bytes - size;
+        }
+
+        QueuePressure pressureAt(size_t queuedCount, size_t queuedBytes) const {
+            /// Scales the amount queued instead of the limit which may be SIZE_MAX
+            bool congested = queuedCount * 100 / QUEUE_CONGESTION_THRESHOLD > this->count ||
+                             queuedBytes * 100 / QUEUE_CONGESTION_THRESHOLD > this->bytes;
+            return congested ? QueuePressure::CONGESTED : QueuePressure::NORMAL;
+        }
+    };
+
+    /// Bounds of the queues of the network (see Network::setQueueLimits)
+    class QueueLimits {
+    public:
+        QueueLimit routingQueuePerDestination{ROUTING_QUEUE_DESTINATION_COUNT, ROUTING_QUEUE_DESTINATION_BYTES};
+        QueueLimit routingQueue{ROUTING_QUEUE_COUNT, ROUTING_QUEUE_BYTES};
+        QueueLimit outgoingQueue{OUTGOING_QUEUE_COUNT, OUTGOING_QUEUE_BYTES};
+        QueueLimit incomingBuffer{INCOMING_BUFFER_COUNT, INCOMING_BUFFER_BYTES};
+        DropPolicy dropPolicy = DropPolicy::PRIORITY;
+    };
+
+    /// Current depth of a queue and the amount of entries it dropped so far
+    class QueueMetrics {
+    public:
+        size_t count = 0;
+        size_t bytes = 0;
+        unsigned long drops = 0;
+    };
+
+    class NetworkQueueMetrics {
+    public:
+        QueueMetrics routingQueue;
+        QueueMetrics outgoingQueue;
+        QueueMetrics incomingBuffer;
+    };
+
+}
+
+#endif //PROTOMESH_QUEUELIMITS_HPP
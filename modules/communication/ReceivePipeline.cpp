@@ -0,0 +1,248 @@
+#ifdef UNIT_TESTING
+
+#include <chrono>
+#include "catch.hpp"
+
+#endif
+
+#include "ReceivePipeline.hpp"
+
+namespace ProtoMesh::communication {
+
+    ReceivePipeline::ReceivePipeline(Network &network, size_t workerCount, size_t capacity)
+            : network(network), capacity(capacity), running(true), completions(capacity), outgoing(capacity),
+              applied(0), reorderWindow(capacity) {
+
+        for (size_t i = 0; i < max<size_t>(workerCount, 1); i++)
+            this->workers.push_back(make_unique<Worker>(capacity));
+
+        for (unique_ptr<Worker> &worker : this->workers)
+            worker->thread = std::thread(&ReceivePipeline::work, this, std::ref(*worker));
+    }
+
+    ReceivePipeline::~ReceivePipeline() {
+        this->running.store(false);
+
+        for (unique_ptr<Worker> &worker : this->workers) {
+            worker->wakeCondition.notify_one();
+            worker->thread.join();
+        }
+    }
+
+    void ReceivePipeline::work(Worker &worker) {
+        while (this->running.load(memory_order_relaxed)) {
+            auto job = worker.jobs.pop();
+
+            if (!job) {
+                unique_lock<mutex> lock(worker.wakeMutex);
+                worker.wakeCondition.wait_for(lock, chrono::microseconds(RECEIVE_PIPELINE_IDLE_TIMEOUT), [&]() {
+                    return !worker.jobs.empty() || !this->running.load(memory_order_relaxed);
+                });
+                continue;
+            }
+
+            /// Never fails since no more datagrams than the capacity are in flight
+            Completion completion{job->sequenceNumber, this->network.prepareDatagram(job->datagram)};
+            while (!this->completions.push(std::move(completion)))
+                this_thread::yield();
+        }
+    }
+
+    bool ReceivePipeline::submit(Datagram datagram) {
+        using namespace flatbuffers;
+
+        if (this->pending() >= this->capacity) return false;
+        uint64_t sequenceNumber = this->submitted++;
+
+        /// Only advertisements, route discoveries, their acknowledgements and messages contain keys or ciphertext.
+        /// Everything else is cheap enough to be prepared right away.
+        bool requiresCryptography = datagram.size() >= sizeof(uoffset_t) + FlatBufferBuilder::kFileIdentifierLength && (
+                BufferHasIdentifier(datagram.data(), scheme::communication::iarp::AdvertisementDatagramIdentifier()) ||
+                BufferHasIdentifier(datagram.data(), scheme::communication::ierp::RouteDiscoveryDatagramIdentifier()) ||
+                BufferHasIdentifier(datagram.data(), scheme::communication::ierp::RouteDiscoveryAcknowledgementDatagramIdentifier()) ||
+                BufferHasIdentifier(datagram.data(), scheme::communication::MessageDatagramIdentifier()));
+
+        if (!requiresCryptography) {
+            Completion completion{sequenceNumber, this->network.prepareDatagram(datagram)};
+            while (!this->completions.push(std::move(completion)))
+                this_thread::yield();
+            return true;
+        }
+
+        /// Every worker has room for the whole capacity so this can't fail either
+        Worker &worker = *this->workers[sequenceNumber % this->workers.size()];
+        Job job{sequenceNumber, std::move(datagram)};
+        while (!worker.jobs.push(std::move(job)))
+            this_thread::yield();
+        worker.wakeCondition.notify_one();
+
+        return true;
+    }
+
+    size_t ReceivePipeline::process() {
+        /// Collect the prepared datagrams and put them back in order
+        while (auto completion = this->completions.pop())
+            this->reorderWindow[completion->sequenceNumber % this->capacity] = std::move(completion->prepared);
+
+        /// Hand over the datagrams that did not fit the last time
+        while (!this->overflow.empty() && this->outgoing.push(std::move(this->overflow.front())))
+            this->overflow.pop_front();
+
+        /// Stop applying datagrams while the transmitting thread can't keep up
+        size_t appliedCount = 0;
+        uint64_t sequenceNumber = this->applied.load(memory_order_relaxed);
+        while (this->overflow.empty()) {
+            optional<PreparedDatagram> &prepared = this->reorderWindow[sequenceNumber % this->capacity];
+            if (!prepared) break;
+
+            for (DatagramPacket &packet : this->network.applyDatagram(prepared.value()))
+                this->emit(std::move(packet));
+            prepared.reset();
+
+            this->applied.store(++sequenceNumber, memory_order_release);
+            appliedCount++;
+        }
+
+        /// Payloads of messages decrypted by the crypto service end up in the outgoing queue of the network
+        this->network.processCryptoCompletions();
+        for (DatagramPacket &packet : this->network.drainOutgoingQueue())
+            this->emit(std::move(packet));
+
+        return appliedCount;
+    }
+
+    void ReceivePipeline::emit(DatagramPacket packet) {
+        /// Datagrams must not overtake the ones that are waiting already
+        if (!this->overflow.empty() || !this->outgoing.push(std::move(packet)))
+            this->overflow.push_back(std::move(packet));
+    }
+
+    optional<DatagramPacket> ReceivePipeline::takeOutgoing() {
+        return this->outgoing.pop();
+    }
+
+#ifdef UNIT_TESTING
+
+    /// Submits all datagrams while processing them on the same thread and returns the datagrams to transmit
+    Datagrams processInPipeline(ReceivePipeline &pipeline, const vector<Datagram> &datagrams) {
+        Datagrams outgoingDatagrams;
+        auto takeOutgoing = [&]() {
+            while (auto packet = pipeline.takeOutgoing())
+                outgoingDatagrams.push_back(packet.value());
+        };
+
+        for (const Datagram &datagram : datagrams) {
+            while (!pipeline.submit(datagram)) {
+                pipeline.process();
+                takeOutgoing();
+            }
+        }
+
+        while (pipeline.pending() > 0) {
+            pipeline.process();
+            takeOutgoing();
+        }
+        takeOutgoing();
+
+        return outgoingDatagrams;
+    }
+
+    SCENARIO("Received datagrams should be processed in stages", "[integration_test][module][communication][network]") {
+        GIVEN("a device with 8 neighbors and a pipeline with 4 workers") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            cryptography::UUID deviceID;
+            cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+            Network network(deviceID, deviceKeys, timeProvider);
+
+            vector<cryptography::UUID> neighbors(8);
+            vector<cryptography::asymmetric::KeyPair> neighborKeys;
+            for (size_t i = 0; i < neighbors.size(); i++)
+                neighborKeys.push_back(cryptography::asymmetric::generateKeyPair());
+
+            /// A small capacity makes the submitting thread wait for the pipeline
+            ReceivePipeline pipeline(network, 4, 16);
+
+            WHEN("the neighbors advertise themselves and send messages to the device and through it to each other") {
+                vector<Datagram> datagrams;
+                for (size_t i = 0; i < neighbors.size(); i++)
+                    datagrams.push_back(Routing::IARP::Advertisement::build(neighbors[i], neighborKeys[i]).serialize());
+
+                vector<Datagram> payloads;
+                vector<SIGNATURE_T> relayedMessages;
+                for (size_t round = 0; round < 4; round++) {
+                    for (size_t i = 0; i < neighbors.size(); i++) {
+                        size_t next = (i + 1) % neighbors.size();
+                        Datagram payload(16, 0);
+                        payload[0] = (uint8_t) round;
+                        payload[1] = (uint8_t) i;
+                        payloads.push_back(payload);
+
+                        datagrams.push_back(Message::build(payload, {neighbors[i], deviceID}, deviceKeys.pub,
+                                                           neighborKeys[i]).serialize());
+
+                        Message relayedMessage = Message::build(payload, {neighbors[i], deviceID, neighbors[next]},
+                                                                neighborKeys[next].pub, neighborKeys[i]);
+                        relayedMessages.push_back(relayedMessage.signature);
+                        datagrams.push_back(relayedMessage.serialize());
+                    }
+                }
+
+                Datagrams outgoingDatagrams = processInPipeline(pipeline, datagrams);
+
+                THEN("the routes to and keys of all neighbors should be known") {
+                    for (size_t i = 0; i < neighbors.size(); i++) {
+                        REQUIRE(network.routingTable.getRouteTo(neighbors[i]).isOk());
+                        REQUIRE(network.credentials.getKey(neighbors[i]).unwrap() == neighborKeys[i].pub);
+                    }
+                }
+
+                THEN("the payloads should have been received in the order they have been sent") {
+                    REQUIRE(network.drainIncomingBuffer() == payloads);
+                }
+
+                THEN("the relayed messages should have been forwarded in the order they have been received") {
+                    vector<SIGNATURE_T> forwardedMessages;
+                    for (DatagramPacket &packet : outgoingDatagrams) {
+                        auto message = Message::fromBuffer(get<1>(packet));
+                        if (message.isOk()) forwardedMessages.push_back(message.unwrap().signature);
+                    }
+
+                    REQUIRE(forwardedMessages == relayedMessages);
+                }
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking the pipeline against the amount of workers", "[.][benchmark][communication][network]") {
+        REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+        cryptography::UUID deviceID;
+        cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+
+        /// Messages for the device from 16 different senders with an advertisement of each sender in front
+        vector<Datagram> datagrams;
+        for (size_t i = 0; i < 16; i++) {
+            cryptography::UUID sender;
+            cryptography::asymmetric::KeyPair senderKeys = cryptography::asymmetric::generateKeyPair();
+            datagrams.push_back(Routing::IARP::Advertisement::build(sender, senderKeys).serialize());
+
+            for (size_t j = 0; j < 32; j++)
+                datagrams.push_back(Message::build(Datagram(64, (uint8_t) j), {sender, deviceID}, deviceKeys.pub,
+                                                   senderKeys).serialize());
+        }
+
+        for (size_t workerCount : {1, 2, 4, 8}) {
+            using namespace std::chrono;
+            Network network(deviceID, deviceKeys, timeProvider);
+            ReceivePipeline pipeline(network, workerCount);
+
+            auto start = steady_clock::now();
+            processInPipeline(pipeline, datagrams);
+            auto duration = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+            REQUIRE(network.incomingBuffer.size() == datagrams.size() - 16);
+            WARN(workerCount << " workers: " << datagrams.size() * 1000000 / duration << " datagrams per second");
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,105 @@
+#ifndef PROTOMESH_RECEIVEPIPELINE_HPP
+#define PROTOMESH_RECEIVEPIPELINE_HPP
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+#include "Network.hpp"
+#include "RingBuffer.hpp"
+
+/// Maximum amount of datagrams that have been submitted but not applied yet
+#define RECEIVE_PIPELINE_CAPACITY 1024
+/// Time in microseconds after which an idle worker checks for new datagrams even if it has not been woken up
+#define RECEIVE_PIPELINE_IDLE_TIMEOUT 1000
+
+namespace ProtoMesh::communication {
+
+    /// Processes received datagrams in stages so that the cryptography is spread over all cores
+    /// while the routing state is only ever changed by a single owner thread:
+    ///  1. submit (receiving thread): Identifier checks. Datagrams that don't involve any cryptography
+    ///     are prepared right away while the others are handed to the workers round robin.
+    ///  2. workers: Verification, deserialization, key decompression and the decryption of messages
+    ///     addressed to us (see Network::prepareDatagram).
+    ///  3. process (owner thread): Applies the prepared datagrams to the network in the order they have been
+    ///     submitted, which includes the order of every single source, and moves the resulting datagrams
+    ///     to the outgoing ring together with the ones the network queued.
+    ///  4. takeOutgoing (transmitting thread)
+    /// Stages are connected by lock-free ring buffers. Workers only sleep if they have nothing to do.
+    class ReceivePipeline {
+        class Job {
+        public:
+            uint64_t sequenceNumber;
+            Datagram datagram;
+        };
+
+        class Completion {
+        public:
+            uint64_t sequenceNumber;
+            PreparedDatagram prepared;
+        };
+
+        class Worker {
+        public:
+            SPSCRingBuffer<Job> jobs;
+            mutex wakeMutex;
+            condition_variable wakeCondition;
+            std::thread thread;
+
+            explicit Worker(size_t capacity) : jobs(capacity) {};
+        };
+
+        Network &network;
+        size_t capacity;
+        atomic<bool> running;
+
+        vector<unique_ptr<Worker>> workers;
+        /// Written by the workers and the submitting thread
+        MPSCRingBuffer<Completion> completions;
+        SPSCRingBuffer<DatagramPacket> outgoing;
+
+        /// Sequence number of the next submitted datagram (submitting thread)
+        uint64_t submitted = 0;
+        /// Sequence number of the next datagram to apply (owner thread)
+        atomic<uint64_t> applied;
+        /// Prepared datagrams indexed by their sequence number modulo the capacity (owner thread)
+        vector<optional<PreparedDatagram>> reorderWindow;
+        /// Datagrams that did not fit into the outgoing ring (owner thread)
+        deque<DatagramPacket> overflow;
+
+        void work(Worker &worker);
+        void emit(DatagramPacket packet);
+
+    public:
+        ReceivePipeline(Network &network, size_t workerCount = max(thread::hardware_concurrency(), 1u),
+                        size_t capacity = RECEIVE_PIPELINE_CAPACITY);
+        ~ReceivePipeline();
+
+        ReceivePipeline(const ReceivePipeline &) = delete;
+        ReceivePipeline &operator=(const ReceivePipeline &) = delete;
+
+        /// Hands a received datagram to the pipeline. May only be called by one thread at a time.
+        /// Returns false if the pipeline is full in which case the datagram has to be submitted again later.
+        bool submit(Datagram datagram);
+
+        /// Applies all prepared datagrams that are next in order. May only be called by the owner thread.
+        /// Returns the amount of applied datagrams.
+        size_t process();
+
+        /// Takes the next datagram that has to be transmitted. May only be called by one thread at a time.
+        optional<DatagramPacket> takeOutgoing();
+
+        /// Amount of datagrams that have been submitted but not applied yet (submitting thread)
+        size_t pending() const { return this->submitted - this->applied.load(memory_order_acquire); }
+    };
+
+}
+
+#endif //PROTOMESH_RECEIVEPIPELINE_HPP
@@ -0,0 +1,108 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "RetransmitBuffer.hpp"
+
+namespace ProtoMesh::communication {
+
+    void RetransmitBuffer::deleteExpiredEntries(long currentTime) {
+        /// Entries are inserted in chronological order so expired ones are always at the front
+        while (!this->entries.empty() && this->entries.front().expiresAt < currentTime)
+            this->entries.pop_front();
+    }
+
+    void RetransmitBuffer::insert(cryptography::UUID destination, const vector<uint8_t> &payload,
+                                  SIGNATURE_T signature, long currentTime, TrafficClass trafficClass,
+                                  optional<SIGNATURE_T> wrapperSignature) {
+        this->deleteExpiredEntries(currentTime);
+
+        if (this->capacity == 0) return;
+        if (this->entries.size() >= this->capacity)
+            this->entries.pop_front();
+
+        this->entries.emplace_back(destination, payload, signature, currentTime + this->lifetime, trafficClass,
+                                   wrapperSignature);
+    }
+
+    Result<RetransmitEntry, RetransmitBuffer::RetransmitBufferError>
+    RetransmitBuffer::take(const SIGNATURE_T &signature, long currentTime) {
+        this->deleteExpiredEntries(currentTime);
+
+        auto entry = find_if(this->entries.begin(), this->entries.end(), [&signature](const RetransmitEntry &entry) {
+            return entry.matches(signature);
+        });
+
+        if (entry == this->entries.end())
+            return Err(RetransmitBufferError::UNKNOWN_MESSAGE);
+
+        RetransmitEntry result = *entry;
+        this->entries.erase(entry);
+
+        return Ok(result);
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Sent payloads should be available for retransmission for a limited time",
+             "[unit_test][module][communication]") {
+        GIVEN("a retransmit buffer with a capacity of two") {
+            RetransmitBuffer buffer(2, 1000);
+            cryptography::UUID destination;
+            SIGNATURE_T first{}, second{}, third{};
+            first.fill(1);
+            second.fill(2);
+            third.fill(3);
+
+            WHEN("a payload is inserted") {
+                buffer.insert(destination, {1, 2, 3}, first, 0);
+
+                THEN("it should be retrievable exactly once by its signature") {
+                    auto entry = buffer.take(first, 500);
+                    REQUIRE(entry.isOk());
+                    REQUIRE(entry.unwrap().destination == destination);
+                    REQUIRE(entry.unwrap().payload == vector<uint8_t>({1, 2, 3}));
+                    REQUIRE(buffer.take(first, 500).isErr());
+                }
+
+                THEN("it should be gone once its lifetime has passed") {
+                    REQUIRE(buffer.take(first, 1001).isErr());
+                }
+
+                THEN("unknown signatures should not match") {
+                    REQUIRE(buffer.take(second, 0).isErr());
+                }
+            }
+
+            WHEN("a payload is inserted together with the signature of the message it was wrapped in") {
+                buffer.insert(destination, {1, 2, 3}, first, 0, TrafficClass::INTERACTIVE, second);
+
+                THEN("it should take up a single entry") {
+                    REQUIRE(buffer.size() == 1);
+                }
+
+                THEN("it should be retrievable exactly once by either signature") {
+                    REQUIRE(buffer.take(second, 0).unwrap().payload == vector<uint8_t>({1, 2, 3}));
+                    REQUIRE(buffer.take(first, 0).isErr());
+                }
+            }
+
+            WHEN("more payloads are inserted than it can hold") {
+                buffer.insert(destination, {1}, first, 0);
+                buffer.insert(destination, {2}, second, 0);
+                buffer.insert(destination, {3}, third, 0);
+
+                THEN("the oldest one should have been evicted") {
+                    REQUIRE(buffer.size() == 2);
+                    REQUIRE(buffer.take(first, 0).isErr());
+                    REQUIRE(buffer.take(second, 0).isOk());
+                    REQUIRE(buffer.take(third, 0).isOk());
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,75 @@
+#ifndef PROTOMESH_RETRANSMITBUFFER_HPP
+#define PROTOMESH_RETRANSMITBUFFER_HPP
+
+#include <deque>
+#include <vector>
+#include <optional>
+
+using namespace std;
+
+#include "result.h"
+#include "uuid.hpp"
+#include "asymmetric.hpp"
+#include "OutgoingQueue.hpp"
+
+/// Amount of sent payloads kept for retransmission
+#define RETRANSMIT_BUFFER_SIZE 32
+/// Time in milliseconds a sent payload is kept for retransmission
+#define RETRANSMIT_BUFFER_LIFETIME 10000
+
+namespace ProtoMesh::communication {
+
+    class RetransmitEntry {
+    public:
+        cryptography::UUID destination;
+        vector<uint8_t> payload;
+        SIGNATURE_T signature;
+        long expiresAt;
+        /// Class the payload has originally been queued with
+        TrafficClass trafficClass;
+        /// Signature of the message that carried the message of the payload to the first border node, if any.
+        /// Failures may be reported for either message depending on where the route breaks.
+        optional<SIGNATURE_T> wrapperSignature;
+
+        RetransmitEntry(cryptography::UUID destination, vector<uint8_t> payload, SIGNATURE_T signature, long expiresAt,
+                        TrafficClass trafficClass = TrafficClass::INTERACTIVE,
+                        optional<SIGNATURE_T> wrapperSignature = nullopt)
+                : destination(destination), payload(std::move(payload)), signature(signature), expiresAt(expiresAt),
+                  trafficClass(trafficClass), wrapperSignature(wrapperSignature) {};
+
+        bool matches(const SIGNATURE_T &messageSignature) const {
+            return this->signature == messageSignature || this->wrapperSignature == messageSignature;
+        }
+    };
+
+    /// Keeps recently sent payloads around so that they can be sent again when a delivery failure is reported.
+    /// Payloads are identified by the signature of the message they were sent in or the one it was wrapped in.
+    class RetransmitBuffer {
+        deque<RetransmitEntry> entries;
+        size_t capacity;
+        long lifetime;
+
+    public:
+        enum class RetransmitBufferError {
+            UNKNOWN_MESSAGE
+        };
+
+        explicit RetransmitBuffer(size_t capacity = RETRANSMIT_BUFFER_SIZE, long lifetime = RETRANSMIT_BUFFER_LIFETIME)
+                : capacity(capacity), lifetime(lifetime) {};
+
+        /// Remembers the payload, evicting the oldest one when the buffer is full
+        void insert(cryptography::UUID destination, const vector<uint8_t> &payload, SIGNATURE_T signature,
+                    long currentTime, TrafficClass trafficClass = TrafficClass::INTERACTIVE,
+                    optional<SIGNATURE_T> wrapperSignature = nullopt);
+
+        /// Removes and returns the payload that has been sent in (or wrapped in) the message with the given signature
+        Result<RetransmitEntry, RetransmitBufferError> take(const SIGNATURE_T &signature, long currentTime);
+
+        void deleteExpiredEntries(long currentTime);
+
+        size_t size() const { return this->entries.size(); }
+    };
+
+}
+
+#endif //PROTOMESH_RETRANSMITBUFFER_HPP
@@ -0,0 +1,111 @@
+#ifdef UNIT_TESTING
+
+#include <thread>
+#include <vector>
+#include "catch.hpp"
+
+#endif
+
+#include "RingBuffer.hpp"
+
+namespace ProtoMesh::communication {
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Passing values between one producer and one consumer", "[unit_test][module][communication]") {
+        GIVEN("a ring buffer with a capacity that is not a power of two") {
+            SPSCRingBuffer<int> buffer(3);
+
+            THEN("the capacity should have been rounded up") {
+                REQUIRE(buffer.capacity() == 4);
+            }
+
+            WHEN("it is filled up") {
+                for (int i = 0; i < 4; i++)
+                    REQUIRE(buffer.push(int(i)));
+
+                THEN("further values should be rejected") {
+                    REQUIRE_FALSE(buffer.push(4));
+                }
+
+                THEN("the values should be popped in the order they have been pushed") {
+                    for (int i = 0; i < 4; i++)
+                        REQUIRE(buffer.pop() == i);
+                    REQUIRE_FALSE(buffer.pop().has_value());
+                }
+            }
+        }
+
+        GIVEN("a producer and a consumer thread") {
+            SPSCRingBuffer<uint32_t> buffer(64);
+            const uint32_t count = 100000;
+
+            thread producer([&buffer, count]() {
+                for (uint32_t i = 0; i < count; i++)
+                    while (!buffer.push(uint32_t(i))) this_thread::yield();
+            });
+
+            bool ordered = true;
+            for (uint32_t expected = 0; expected < count;) {
+                auto value = buffer.pop();
+                if (!value) continue;
+                ordered &= value.value() == expected++;
+            }
+            producer.join();
+
+            THEN("all values should have arrived in order") {
+                REQUIRE(ordered);
+                REQUIRE(buffer.empty());
+            }
+        }
+    }
+
+    SCENARIO("Passing values from multiple producers to one consumer", "[unit_test][module][communication]") {
+        GIVEN("a full ring buffer") {
+            MPSCRingBuffer<int> buffer(2);
+            REQUIRE(buffer.push(1));
+            REQUIRE(buffer.push(2));
+
+            THEN("further values should be rejected until one has been popped") {
+                REQUIRE_FALSE(buffer.push(3));
+                REQUIRE(buffer.pop() == 1);
+                REQUIRE(buffer.push(3));
+                REQUIRE(buffer.pop() == 2);
+                REQUIRE(buffer.pop() == 3);
+            }
+        }
+
+        GIVEN("four producer threads") {
+            MPSCRingBuffer<pair<uint32_t, uint32_t>> buffer(64);
+            const uint32_t producerCount = 4;
+            const uint32_t count = 50000;
+
+            vector<thread> producers;
+            for (uint32_t producer = 0; producer < producerCount; producer++)
+                producers.emplace_back([&buffer, producer, count]() {
+                    for (uint32_t i = 0; i < count; i++)
+                        while (!buffer.push(make_pair(producer, i))) this_thread::yield();
+                });
+
+            bool ordered = true;
+            vector<uint32_t> expected(producerCount, 0);
+            for (uint32_t received = 0; received < producerCount * count;) {
+                auto value = buffer.pop();
+                if (!value) continue;
+                ordered &= value->second == expected[value->first]++;
+                received++;
+            }
+
+            for (thread &producer : producers)
+                producer.join();
+
+            THEN("all values should have arrived in the order of their producer") {
+                REQUIRE(ordered);
+                REQUIRE(expected == vector<uint32_t>(producerCount, count));
+                REQUIRE_FALSE(buffer.pop().has_value());
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,145 @@
+#ifndef PROTOMESH_RINGBUFFER_HPP
+#define PROTOMESH_RINGBUFFER_HPP
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+using namespace std;
+
+/// Size of a cache line. Producer and consumer positions are kept apart so that they don't share one.
+#define RING_BUFFER_CACHE_LINE_SIZE 64
+
+namespace ProtoMesh::communication {
+
+    /// Smallest power of two that is at least the given capacity
+    inline size_t ringBufferCapacityFor(size_t capacity) {
+        size_t powerOfTwo = 1;
+        while (powerOfTwo < capacity) powerOfTwo <<= 1;
+        return powerOfTwo;
+    }
+
+    /// Bounded lock-free queue for exactly one producing and one consuming thread.
+    /// The capacity is rounded up to a power of two.
+    template<class T>
+    class SPSCRingBuffer {
+        unique_ptr<optional<T>[]> slots;
+        size_t mask;
+
+        /// Position of the next value to pop, only written by the consumer
+        alignas(RING_BUFFER_CACHE_LINE_SIZE) atomic<size_t> head;
+        /// Position of the next value to push, only written by the producer
+        alignas(RING_BUFFER_CACHE_LINE_SIZE) atomic<size_t> tail;
+
+    public:
+        explicit SPSCRingBuffer(size_t capacity)
+                : slots(new optional<T>[ringBufferCapacityFor(capacity)]), mask(ringBufferCapacityFor(capacity) - 1),
+                  head(0), tail(0) {};
+
+        SPSCRingBuffer(const SPSCRingBuffer &) = delete;
+        SPSCRingBuffer &operator=(const SPSCRingBuffer &) = delete;
+
+        /// Producer only. Returns false and leaves the value untouched if the buffer is full.
+        bool push(T &&value) {
+            size_t position = this->tail.load(memory_order_relaxed);
+            if (position - this->head.load(memory_order_acquire) > this->mask) return false;
+
+            this->slots[position & this->mask] = std::move(value);
+            this->tail.store(position + 1, memory_order_release);
+            return true;
+        }
+
+        /// Consumer only
+        optional<T> pop() {
+            size_t position = this->head.load(memory_order_relaxed);
+            if (position == this->tail.load(memory_order_acquire)) return nullopt;
+
+            optional<T> &slot = this->slots[position & this->mask];
+            optional<T> value = std::move(slot);
+            slot.reset();
+            this->head.store(position + 1, memory_order_release);
+            return value;
+        }
+
+        /// Only exact when called by the producer or the consumer while the other one is idle
+        size_t size() const {
+            return this->tail.load(memory_order_acquire) - this->head.load(memory_order_acquire);
+        }
+
+        bool empty() const { return this->size() == 0; }
+        size_t capacity() const { return this->mask + 1; }
+    };
+
+    /// Bounded lock-free queue for any amount of producing threads and one consuming thread.
+    /// Every slot carries a sequence number that tells producers and the consumer whose turn it is.
+    /// The capacity is rounded up to a power of two.
+    template<class T>
+    class MPSCRingBuffer {
+        class Slot {
+        public:
+            atomic<size_t> sequence;
+            optional<T> value;
+        };
+
+        unique_ptr<Slot[]> slots;
+        size_t mask;
+
+        /// Position of the next value to push, claimed by the producers
+        alignas(RING_BUFFER_CACHE_LINE_SIZE) atomic<size_t> tail;
+        /// Position of the next value to pop, only used by the consumer
+        alignas(RING_BUFFER_CACHE_LINE_SIZE) size_t head;
+
+    public:
+        explicit MPSCRingBuffer(size_t capacity)
+                : slots(new Slot[ringBufferCapacityFor(capacity)]), mask(ringBufferCapacityFor(capacity) - 1),
+                  tail(0), head(0) {
+            for (size_t i = 0; i <= this->mask; i++)
+                this->slots[i].sequence.store(i, memory_order_relaxed);
+        };
+
+        MPSCRingBuffer(const MPSCRingBuffer &) = delete;
+        MPSCRingBuffer &operator=(const MPSCRingBuffer &) = delete;
+
+        /// Returns false and leaves the value untouched if the buffer is full
+        bool push(T &&value) {
+            size_t position = this->tail.load(memory_order_relaxed);
+            Slot *slot;
+
+            while (true) {
+                slot = &this->slots[position & this->mask];
+                auto difference = (intptr_t) slot->sequence.load(memory_order_acquire) - (intptr_t) position;
+
+                /// The slot is free, attempt to claim it
+                if (difference == 0) {
+                    if (this->tail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+                }
+                /// The slot still holds the value pushed one round earlier
+                else if (difference < 0) return false;
+                /// Another producer claimed the slot in the meantime
+                else position = this->tail.load(memory_order_relaxed);
+            }
+
+            slot->value = std::move(value);
+            slot->sequence.store(position + 1, memory_order_release);
+            return true;
+        }
+
+        /// Consumer only
+        optional<T> pop() {
+            Slot &slot = this->slots[this->head & this->mask];
+            if (slot.sequence.load(memory_order_acquire) != this->head + 1) return nullopt;
+
+            optional<T> value = std::move(slot.value);
+            slot.value.reset();
+            slot.sequence.store(this->head + this->mask + 1, memory_order_release);
+            this->head++;
+            return value;
+        }
+
+        size_t capacity() const { return this->mask + 1; }
+    };
+
+}
+
+#endif //PROTOMESH_RINGBUFFER_HPP
@@ -0,0 +1,179 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include <numeric>
+#include <algorithm>
+
+#include "RouteSelection.hpp"
+
+namespace ProtoMesh::communication::Routing {
+
+    vector<size_t> RouteSelector::disjointRoutes(const vector<vector<cryptography::UUID>> &routes,
+                                                 const vector<unsigned long> &costs, bool cheapestOnly) {
+        /// Order the routes by cost while retaining the insertion order for routes of equal cost
+        vector<size_t> order(routes.size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&costs](size_t a, size_t b) { return costs[a] < costs[b]; });
+
+        vector<size_t> selectedRoutes;
+        vector<cryptography::UUID> usedHops;
+        for (size_t index : order) {
+            if (cheapestOnly && costs[index] * 100 > costs[order.front()] * (100 + ROUTE_SELECTION_EQUAL_COST_TOLERANCE))
+                break;
+
+            /// Intermediate hops exclude us (index 0) and the destination (last index)
+            const vector<cryptography::UUID> &route = routes[index];
+            auto firstHop = route.size() > 2 ? route.begin() + 1 : route.end();
+            auto lastHop = route.size() > 2 ? route.end() - 1 : route.end();
+
+            bool isDisjoint = none_of(firstHop, lastHop, [&usedHops](const cryptography::UUID &hop) {
+                return find(usedHops.begin(), usedHops.end(), hop) != usedHops.end();
+            });
+
+            /// Identical direct routes have no intermediate hops and are filtered separately
+            bool isDuplicate = any_of(selectedRoutes.begin(), selectedRoutes.end(), [&](size_t selected) {
+                return routes[selected] == route;
+            });
+
+            if (!isDisjoint || isDuplicate) continue;
+
+            selectedRoutes.push_back(index);
+            usedHops.insert(usedHops.end(), firstHop, lastHop);
+        }
+
+        return selectedRoutes;
+    }
+
+    size_t RouteSelector::select(cryptography::UUID destination, const vector<vector<cryptography::UUID>> &routes,
+                                 const vector<unsigned long> &costs, uint64_t flow) {
+        switch (this->policy) {
+            case RouteSelectionPolicy::SHORTEST:
+                return disjointRoutes(routes, costs, true).front();
+            case RouteSelectionPolicy::ROUND_ROBIN: {
+                vector<size_t> candidates = disjointRoutes(routes, costs, true);
+                return candidates[this->counters[destination]++ % candidates.size()];
+            }
+            case RouteSelectionPolicy::FLOW_HASH: {
+                vector<size_t> candidates = disjointRoutes(routes, costs, true);
+                return candidates[flow % candidates.size()];
+            }
+            case RouteSelectionPolicy::WEIGHTED: {
+                vector<size_t> candidates = disjointRoutes(routes, costs, false);
+
+                /// The cheapest route gets a weight of ROUTE_SELECTION_WEIGHT_SCALE, others proportionally less
+                unsigned long cheapestCost = max(costs[candidates.front()], 1UL);
+                vector<unsigned long> weights;
+                for (size_t candidate : candidates)
+                    weights.push_back(max(1UL, ROUTE_SELECTION_WEIGHT_SCALE * cheapestCost / max(costs[candidate], 1UL)));
+
+                unsigned long position = this->counters[destination]++ % accumulate(weights.begin(), weights.end(), 0UL);
+                for (size_t i = 0; i < candidates.size(); i++) {
+                    if (position < weights[i]) return candidates[i];
+                    position -= weights[i];
+                }
+
+                return candidates.front();
+            }
+        }
+
+        return 0;
+    }
+
+    void RouteSelector::prune(const function<bool(const cryptography::UUID &)> &isReachable) {
+        for (auto it = this->counters.begin(); it != this->counters.end();) {
+            if (isReachable(it->first)) ++it;
+            else it = this->counters.erase(it);
+        }
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Traffic should be spread across multiple routes",
+             "[unit_test][module][communication][routing]") {
+        GIVEN("three routes of which two are disjoint and of equal length") {
+            cryptography::UUID self, a, b, c, destination;
+            vector<vector<cryptography::UUID>> routes = {
+                    {self, a, destination},
+                    {self, a, c, destination},
+                    {self, b, destination}
+            };
+            vector<unsigned long> costs = {2, 3, 2};
+
+            THEN("only the disjoint routes of equal cost should be candidates") {
+                REQUIRE(RouteSelector::disjointRoutes(routes, costs, true) == vector<size_t>({0, 2}));
+                REQUIRE(RouteSelector::disjointRoutes(routes, costs, false) == vector<size_t>({0, 2}));
+            }
+
+            WHEN("the shortest route is requested repeatedly") {
+                RouteSelector selector(RouteSelectionPolicy::SHORTEST);
+
+                THEN("the first of the shortest routes should always be used") {
+                    for (int i = 0; i < 4; i++)
+                        REQUIRE(selector.select(destination, routes, costs) == 0);
+                }
+            }
+
+            WHEN("routes are selected round robin") {
+                RouteSelector selector(RouteSelectionPolicy::ROUND_ROBIN);
+
+                THEN("both disjoint routes should be used alternately") {
+                    REQUIRE(selector.select(destination, routes, costs) == 0);
+                    REQUIRE(selector.select(destination, routes, costs) == 2);
+                    REQUIRE(selector.select(destination, routes, costs) == 0);
+                    REQUIRE(selector.select(destination, routes, costs) == 2);
+                }
+
+                AND_WHEN("the destination becomes unreachable") {
+                    selector.select(destination, routes, costs);
+                    selector.prune([&destination](const cryptography::UUID &uuid) { return uuid != destination; });
+
+                    THEN("its selections should have been forgotten") {
+                        REQUIRE(selector.size() == 0);
+                        REQUIRE(selector.select(destination, routes, costs) == 0);
+                    }
+                }
+            }
+
+            WHEN("routes are selected by flow") {
+                RouteSelector selector;
+
+                THEN("the same flow should always use the same route") {
+                    size_t route = selector.select(destination, routes, costs, 7);
+                    for (int i = 0; i < 4; i++)
+                        REQUIRE(selector.select(destination, routes, costs, 7) == route);
+                    REQUIRE(selector.select(destination, routes, costs, 8) != route);
+                }
+
+                THEN("no selections should have been remembered") {
+                    selector.select(destination, routes, costs, 7);
+                    REQUIRE(selector.size() == 0);
+                }
+            }
+        }
+
+        GIVEN("two disjoint routes where one is twice as expensive") {
+            cryptography::UUID self, a, b, c, destination;
+            vector<vector<cryptography::UUID>> routes = {
+                    {self, a, destination},
+                    {self, b, c, destination}
+            };
+            vector<unsigned long> costs = {2, 4};
+
+            WHEN("routes are selected weighted by their cost") {
+                RouteSelector selector(RouteSelectionPolicy::WEIGHTED);
+                size_t cheapRouteUsage = 0;
+                for (int i = 0; i < 60; i++)
+                    if (selector.select(destination, routes, costs) == 0) cheapRouteUsage++;
+
+                THEN("the cheaper route should be used twice as often") {
+                    REQUIRE(cheapRouteUsage == 40);
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
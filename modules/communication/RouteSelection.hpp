@@ -0,0 +1,62 @@
+#ifndef PROTOMESH_ROUTESELECTION_HPP
+#define PROTOMESH_ROUTESELECTION_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+#include "uuid.hpp"
+
+/// Percentage by which the cost of a route may exceed the cheapest one to still be considered equally good
+#define ROUTE_SELECTION_EQUAL_COST_TOLERANCE 10
+/// Weight of the cheapest route when selecting routes weighted by their cost
+#define ROUTE_SELECTION_WEIGHT_SCALE 4
+
+using namespace std;
+
+namespace ProtoMesh::communication::Routing {
+
+    enum class RouteSelectionPolicy {
+        /// Always use the cheapest route that has been inserted first
+        SHORTEST,
+        /// Alternate between the cheapest disjoint routes
+        ROUND_ROBIN,
+        /// Distribute across all disjoint routes proportional to the inverse of their cost
+        WEIGHTED,
+        /// Pin each flow (e.g. a stream of payloads) to one of the cheapest disjoint routes
+        FLOW_HASH
+    };
+
+    /// Picks one of multiple routes to a destination so that traffic is spread across relays.
+    /// Routes are passed as hop lists (including us at index 0 and the destination at the end)
+    /// together with their cost (e.g. the cumulative link metric) where lower costs are preferred.
+    class RouteSelector {
+        /// Amount of selections by destination for the ROUND_ROBIN and WEIGHTED policies (see prune)
+        unordered_map<cryptography::UUID, unsigned long> counters;
+
+    public:
+        RouteSelectionPolicy policy;
+
+        /// Flows are pinned to a route by default so that their datagrams are not reordered
+        explicit RouteSelector(RouteSelectionPolicy policy = RouteSelectionPolicy::FLOW_HASH) : policy(policy) {};
+
+        /// Returns the index of the selected route. Requires at least one route.
+        size_t select(cryptography::UUID destination, const vector<vector<cryptography::UUID>> &routes,
+                      const vector<unsigned long> &costs, uint64_t flow = 0);
+
+        /// Forgets the selections of destinations that are no longer reachable according to the predicate
+        void prune(const function<bool(const cryptography::UUID &)> &isReachable);
+
+        /// Amount of destinations whose selections are remembered
+        size_t size() const { return this->counters.size(); }
+
+        /// Indices of routes that share no intermediate hop with a cheaper (or earlier) route.
+        /// With cheapestOnly set, routes that are more than ROUTE_SELECTION_EQUAL_COST_TOLERANCE percent
+        /// more expensive than the cheapest one are excluded.
+        static vector<size_t> disjointRoutes(const vector<vector<cryptography::UUID>> &routes,
+                                             const vector<unsigned long> &costs, bool cheapestOnly);
+    };
+
+}
+
+#endif //PROTOMESH_ROUTESELECTION_HPP
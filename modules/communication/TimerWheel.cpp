@@ -0,0 +1,105 @@
+#ifdef UNIT_TESTING
+
+#include <chrono>
+#include <random>
+#include "catch.hpp"
+
+#endif
+
+#include "TimerWheel.hpp"
+
+namespace ProtoMesh::communication {
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Scheduling timers on a timer wheel", "[unit_test][module][communication]") {
+        GIVEN("a timer wheel with a resolution of 10ms and 8 slots") {
+            TimerWheel<int> wheel(0, 10, 8);
+
+            WHEN("timers are scheduled out of order") {
+                wheel.schedule(30, 3);
+                wheel.schedule(15, 1);
+                wheel.schedule(25, 2);
+
+                THEN("none of them should be returned before it is due") {
+                    REQUIRE(wheel.advance(10).empty());
+                    REQUIRE(wheel.size() == 3);
+                }
+
+                THEN("they should be returned ordered by their due time") {
+                    REQUIRE(wheel.advance(30) == vector<int>({1, 2, 3}));
+                    REQUIRE(wheel.empty());
+                }
+
+                THEN("a timer should not be returned early even if it shares the slot of the time") {
+                    REQUIRE(wheel.advance(20) == vector<int>({1}));
+                    REQUIRE(wheel.advance(29).empty());
+                    REQUIRE(wheel.advance(30) == vector<int>({2, 3}));
+                }
+            }
+
+            WHEN("timers are scheduled for the same time") {
+                wheel.schedule(50, 1);
+                wheel.schedule(50, 2);
+
+                THEN("they should be returned in the order they have been scheduled") {
+                    REQUIRE(wheel.advance(50) == vector<int>({1, 2}));
+                }
+            }
+
+            WHEN("a timer is more than one revolution away") {
+                wheel.schedule(250, 1);
+
+                THEN("it should stay in its slot until it is due") {
+                    REQUIRE(wheel.advance(90).empty());
+                    REQUIRE(wheel.advance(170).empty());
+                    REQUIRE(wheel.advance(250) == vector<int>({1}));
+                }
+            }
+
+            WHEN("the time jumps by multiple revolutions") {
+                wheel.schedule(20, 1);
+                wheel.schedule(500, 2);
+                wheel.schedule(1000, 3);
+
+                THEN("every timer that is due should be returned exactly once") {
+                    REQUIRE(wheel.advance(600) == vector<int>({1, 2}));
+                    REQUIRE(wheel.advance(1000) == vector<int>({3}));
+                }
+            }
+
+            WHEN("a timer is scheduled for a time that already passed") {
+                wheel.advance(100);
+                wheel.schedule(50, 1);
+
+                THEN("it should be returned by the next advance") {
+                    REQUIRE(wheel.advance(110) == vector<int>({1}));
+                }
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking the timer wheel", "[.][benchmark][communication]") {
+        /// Periodic timers with random intervals similar to the ones of advertisements and maintenance tasks
+        TimerWheel<size_t> wheel(0);
+        minstd_rand random(42);
+        const size_t timerCount = 100000;
+        for (size_t i = 0; i < timerCount; i++)
+            wheel.schedule(random() % 10000, i);
+
+        using namespace std::chrono;
+        auto start = steady_clock::now();
+        size_t fired = 0;
+        for (long time = 0; time < 60000; time += TIMER_WHEEL_RESOLUTION) {
+            for (size_t timer : wheel.advance(time)) {
+                wheel.schedule(time + 5000 + random() % 5000, timer);
+                fired++;
+            }
+        }
+        auto duration = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+        WARN(timerCount << " periodic timers: " << duration / fired << "ns per expiration");
+    }
+
+#endif // UNIT_TESTING
+}
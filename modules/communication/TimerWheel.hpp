@@ -0,0 +1,95 @@
+#ifndef PROTOMESH_TIMERWHEEL_HPP
+#define PROTOMESH_TIMERWHEEL_HPP
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+
+using namespace std;
+
+/// Time in milliseconds covered by one slot of a timer wheel
+#define TIMER_WHEEL_RESOLUTION 10
+/// Amount of slots of a timer wheel, timers further away than one revolution share slots with closer ones
+#define TIMER_WHEEL_SLOTS 256
+
+namespace ProtoMesh::communication {
+
+    /// Hashed timing wheel (Varghese & Lauck). Timers are hashed into the slot of their due time so that
+    /// scheduling is constant and advancing the time only visits the slots that passed.
+    /// Timers hold a value instead of a callback which is returned once they are due, so that the wheel
+    /// can be copied along with its owner. Times are relative timestamps in milliseconds (see RelativeTimeProvider).
+    template<class T>
+    class TimerWheel {
+        class Timer {
+        public:
+            long due;
+            /// Orders timers that are due at the same time by the time they have been scheduled
+            uint64_t sequenceNumber;
+            T value;
+        };
+
+        vector<vector<Timer>> slots;
+        long resolution;
+        /// Every slot up to this tick has been visited
+        long currentTick;
+        uint64_t nextSequenceNumber = 0;
+        size_t count = 0;
+
+        size_t slotOf(long tick) const { return (size_t) tick % this->slots.size(); }
+        /// First tick at which the time has reached the due time so that timers never fire early
+        long tickOf(long due) const { return (due + this->resolution - 1) / this->resolution; }
+
+    public:
+        explicit TimerWheel(long currentTime, long resolution = TIMER_WHEEL_RESOLUTION, size_t slotCount = TIMER_WHEEL_SLOTS)
+                : slots(slotCount), resolution(resolution), currentTick(currentTime / resolution) {};
+
+        /// The timer is returned by the first call of advance with a time at or after the due time rounded up
+        /// to the resolution. Timers that are already due are returned by the next call.
+        void schedule(long due, T value) {
+            long tick = max(this->tickOf(due), this->currentTick + 1);
+            this->slots[this->slotOf(tick)].push_back(Timer{due, this->nextSequenceNumber++, std::move(value)});
+            this->count++;
+        }
+
+        /// Removes and returns the values of all timers that are due at the given time, ordered by their due time
+        vector<T> advance(long currentTime) {
+            long tick = currentTime / this->resolution;
+            if (tick <= this->currentTick) return {};
+
+            /// Every slot has to be visited once at most even if the time jumped by multiple revolutions
+            long firstTick = max(this->currentTick + 1, tick - (long) this->slots.size() + 1);
+            this->currentTick = tick;
+
+            vector<Timer> dueTimers;
+            for (long visitedTick = firstTick; visitedTick <= tick; visitedTick++) {
+                vector<Timer> &slot = this->slots[this->slotOf(visitedTick)];
+
+                /// Timers that are more than one revolution away stay in the slot
+                auto remaining = partition(slot.begin(), slot.end(),
+                                           [tick, this](const Timer &timer) { return this->tickOf(timer.due) > tick; });
+                move(remaining, slot.end(), back_inserter(dueTimers));
+                slot.erase(remaining, slot.end());
+            }
+
+            sort(dueTimers.begin(), dueTimers.end(), [](const Timer &a, const Timer &b) {
+                return a.due != b.due ? a.due < b.due : a.sequenceNumber < b.sequenceNumber;
+            });
+
+            this->count -= dueTimers.size();
+
+            vector<T> values;
+            values.reserve(dueTimers.size());
+            for (Timer &timer : dueTimers)
+                values.push_back(std::move(timer.value));
+
+            return values;
+        }
+
+        size_t size() const { return this->count; }
+        bool empty() const { return this->count == 0; }
+    };
+
+}
+
+#endif //PROTOMESH_TIMERWHEEL_HPP
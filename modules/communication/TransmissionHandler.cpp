@@ -25,6 +25,31 @@ namespace ProtoMesh::communication::transmission {
                     }
                 }
             }
+
+            WHEN("more messages than the initial capacity are added while some have been received already") {
+                vector<vector<uint8_t>> messages;
+                for (uint8_t i = 0; i < 40; i++)
+                    messages.push_back({i});
+
+                vector<uint8_t> buf;
+                for (size_t i = 0; i < 10; i++)
+                    ((NetworkStub*) stub.get())->addMessageToIncomingQueue(messages[i]);
+                for (size_t i = 0; i < 5; i++)
+                    REQUIRE(stub->recv(&buf, 0) == ReceiveResult::OK);
+                for (size_t i = 10; i < messages.size(); i++)
+                    ((NetworkStub*) stub.get())->addMessageToIncomingQueue(messages[i]);
+
+                THEN("the remaining ones should be receivable as batches in the order they have been added") {
+                    vector<vector<uint8_t>> buffers(16);
+                    vector<vector<uint8_t>> received;
+
+                    size_t count;
+                    while ((count = stub->recvBatch(buffers.data(), buffers.size(), 0)) > 0)
+                        received.insert(received.end(), buffers.begin(), buffers.begin() + count);
+
+                    REQUIRE(received == vector<vector<uint8_t>>(messages.begin() + 5, messages.end()));
+                }
+            }
         }
     }
 
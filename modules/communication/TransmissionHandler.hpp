@@ -2,10 +2,14 @@
 #define PROTOMESH_TRANSMISSION_HPP
 
 #include <vector>
+#include <tuple>
 #include <memory>
+#include <algorithm>
 
 using namespace std;
 
+#include "MessageTarget.hpp"
+
 namespace ProtoMesh::communication::transmission {
     enum class ReceiveResult {
         OK,
@@ -19,24 +23,69 @@ namespace ProtoMesh::communication::transmission {
     public:
         TransmissionHandler() = default;
 
-        ~TransmissionHandler() = default;
+        /// Virtual since handlers that own sockets or rings are deleted through a pointer to this class
+        virtual ~TransmissionHandler() = default;
 
         virtual void send(vector<uint8_t> message)= 0;
         virtual ReceiveResult recv(vector<uint8_t> *buffer, unsigned int timeout_ms)= 0;
+
+        /// Transmission media that are able to address single nodes may override this, others broadcast the message.
+        virtual void sendTo(const MessageTarget &target, vector<uint8_t> message) { this->send(std::move(message)); }
+
+        /// Batch functions
+        /// Transports that are able to move multiple messages with a single call (e.g. sendmmsg/recvmmsg) should
+        /// override these while the default implementations fall back to the functions above.
+
+        virtual void sendBatch(const vector<tuple<MessageTarget, vector<uint8_t>>> &messages) {
+            for (const auto &message : messages)
+                this->sendTo(get<0>(message), get<1>(message));
+        }
+
+        /// Receives up to count messages into the given buffers whose capacity is reused. Waits at most timeout_ms
+        /// for the first message but returns as soon as no further one is available. Returns the amount of messages.
+        virtual size_t recvBatch(vector<uint8_t> *buffers, size_t count, unsigned int timeout_ms) {
+            size_t received = 0;
+            for (; received < count; received++, timeout_ms = 0) {
+                buffers[received].clear();
+                if (this->recv(&buffers[received], timeout_ms) != ReceiveResult::OK || buffers[received].empty())
+                    break;
+            }
+            return received;
+        }
+
+        /// File descriptor that becomes readable once a message can be received without blocking or -1 if there is none.
+        /// Required to serve the handler from an event loop.
+        virtual int fileDescriptor() { return -1; }
     };
 
     class NetworkStub : public TransmissionHandler {
-        vector<vector<uint8_t>> queue;
+        /// Ring buffer whose capacity is doubled once it is full
+        vector<vector<uint8_t>> queue = vector<vector<uint8_t>>(16);
+        size_t head = 0;
+        size_t count = 0;
     public:
         explicit NetworkStub() = default;
 
-        void addMessageToIncomingQueue(std::vector<uint8_t> message) { queue.push_back(message); }
+        void addMessageToIncomingQueue(std::vector<uint8_t> message) {
+            if (this->count == this->queue.size()) {
+                rotate(this->queue.begin(), this->queue.begin() + this->head, this->queue.end());
+                this->head = 0;
+                this->queue.resize(this->queue.size() * 2);
+            }
+
+            this->queue[(this->head + this->count++) % this->queue.size()] = std::move(message);
+        }
 
         void send(std::vector<uint8_t> message) override {}
         ReceiveResult recv(std::vector<uint8_t>* buffer, unsigned int timeout_ms) override {
-            if (queue.empty()) return ReceiveResult::NoData;
-            *buffer = queue[0];
-            queue.erase(queue.begin());
+            if (this->count == 0) return ReceiveResult::NoData;
+
+            /// The buffer of the caller takes the place of the message so that its capacity is reused
+            buffer->swap(this->queue[this->head]);
+            this->queue[this->head].clear();
+            this->head = (this->head + 1) % this->queue.size();
+            this->count--;
+
             return ReceiveResult::OK;
         }
     };
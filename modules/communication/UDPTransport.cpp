@@ -0,0 +1,487 @@
+#ifdef UNIT_TESTING
+
+#include <thread>
+#include <chrono>
+#include "catch.hpp"
+
+#endif
+
+#include "UDPTransport.hpp"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <ifaddrs.h>
+#include <arpa/inet.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+namespace ProtoMesh::communication::transmission {
+
+    bool isSameAddress(const sockaddr_in &a, const sockaddr_in &b) {
+        return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+    }
+
+    UDPTransport::UDPTransport(UDPTransportConfiguration configuration, Sockets sockets)
+            : configuration(std::move(configuration)), multicastSocket(sockets.multicastSocket),
+              unicastSocket(sockets.unicastSocket), epollDescriptor(sockets.epollDescriptor),
+              groupAddress(sockets.groupAddress), localAddress(sockets.localAddress),
+              interfaceAddresses(std::move(sockets.interfaceAddresses)), segmentationOffload(sockets.segmentationOffload) {}
+
+    UDPTransport::~UDPTransport() {
+        close(this->epollDescriptor);
+        close(this->unicastSocket);
+        close(this->multicastSocket);
+    }
+
+    Result<shared_ptr<UDPTransport>, UDPTransport::UDPTransportError>
+    UDPTransport::open(UDPTransportConfiguration configuration) {
+        auto sockets = UDPTransport::openSockets(configuration);
+        if (sockets.isErr()) return Err(sockets.unwrapErr());
+
+        return Ok(shared_ptr<UDPTransport>(new UDPTransport(std::move(configuration), sockets.unwrap())));
+    }
+
+    Result<UDPTransport::Sockets, UDPTransport::UDPTransportError>
+    UDPTransport::openSockets(const UDPTransportConfiguration &configuration) {
+        sockaddr_in groupAddress{};
+        groupAddress.sin_family = AF_INET;
+        groupAddress.sin_port = htons(configuration.port);
+
+        in_addr interfaceAddress{};
+        if (inet_pton(AF_INET, configuration.multicastGroup.c_str(), &groupAddress.sin_addr) != 1 ||
+            inet_pton(AF_INET, configuration.interfaceAddress.c_str(), &interfaceAddress) != 1)
+            return Err(UDPTransportError::INVALID_ADDRESS);
+
+        int multicastSocket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int unicastSocket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+
+        auto fail = [&]() {
+            for (int descriptor : {multicastSocket, unicastSocket, epollDescriptor})
+                if (descriptor >= 0) close(descriptor);
+            return Err(UDPTransportError::SOCKET_ERROR);
+        };
+
+        if (multicastSocket < 0 || unicastSocket < 0 || epollDescriptor < 0) return fail();
+
+        /// Every transport on this machine that joined the group receives its own copy of a broadcast
+        int enabled = 1;
+        ip_mreq membership{};
+        membership.imr_multiaddr = groupAddress.sin_addr;
+        membership.imr_interface = interfaceAddress;
+
+        if (setsockopt(multicastSocket, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled)) < 0 ||
+            bind(multicastSocket, (sockaddr *) &groupAddress, sizeof(groupAddress)) < 0 ||
+            setsockopt(multicastSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0)
+            return fail();
+
+        sockaddr_in localAddress{};
+        localAddress.sin_family = AF_INET;
+        localAddress.sin_addr = interfaceAddress;
+        socklen_t localAddressLength = sizeof(localAddress);
+        int multicastTTL = configuration.multicastTTL;
+
+        if (bind(unicastSocket, (sockaddr *) &localAddress, sizeof(localAddress)) < 0 ||
+            getsockname(unicastSocket, (sockaddr *) &localAddress, &localAddressLength) < 0 ||
+            setsockopt(unicastSocket, IPPROTO_IP, IP_MULTICAST_IF, &interfaceAddress, sizeof(interfaceAddress)) < 0 ||
+            setsockopt(unicastSocket, IPPROTO_IP, IP_MULTICAST_LOOP, &enabled, sizeof(enabled)) < 0 ||
+            setsockopt(unicastSocket, IPPROTO_IP, IP_MULTICAST_TTL, &multicastTTL, sizeof(multicastTTL)) < 0)
+            return fail();
+
+        for (int udpSocket : {multicastSocket, unicastSocket}) {
+            if (configuration.receiveBufferSize > 0 && setsockopt(udpSocket, SOL_SOCKET, SO_RCVBUF,
+                    &configuration.receiveBufferSize, sizeof(configuration.receiveBufferSize)) < 0)
+                return fail();
+            if (configuration.sendBufferSize > 0 && setsockopt(udpSocket, SOL_SOCKET, SO_SNDBUF,
+                    &configuration.sendBufferSize, sizeof(configuration.sendBufferSize)) < 0)
+                return fail();
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = udpSocket;
+            if (epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, udpSocket, &event) < 0) return fail();
+        }
+
+        /// Datagrams from our port may only be told apart from those of other hosts by the addresses of the interfaces
+        vector<in_addr_t> interfaceAddresses;
+        if (localAddress.sin_addr.s_addr == INADDR_ANY) {
+            ifaddrs *interfaces;
+            if (getifaddrs(&interfaces) < 0) return fail();
+
+            for (ifaddrs *interface = interfaces; interface; interface = interface->ifa_next)
+                if (interface->ifa_addr && interface->ifa_addr->sa_family == AF_INET)
+                    interfaceAddresses.push_back(((sockaddr_in *) interface->ifa_addr)->sin_addr.s_addr);
+            freeifaddrs(interfaces);
+        }
+
+        /// Setting the default segment size fails if the kernel does not support UDP GSO (Linux < 4.18)
+        int segmentSize = 0;
+        bool segmentationOffload = configuration.segmentationOffload &&
+                setsockopt(unicastSocket, SOL_UDP, UDP_SEGMENT, &segmentSize, sizeof(segmentSize)) == 0;
+
+        return Ok(Sockets{multicastSocket, unicastSocket, epollDescriptor, groupAddress, localAddress,
+                          std::move(interfaceAddresses), segmentationOffload});
+    }
+
+    sockaddr_in UDPTransport::destinationOf(const MessageTarget &target) const {
+        if (target.type == MessageTarget::Type::SINGLE) {
+            auto peer = this->peers.find(target.target);
+            if (peer != this->peers.end()) return peer->second;
+        }
+
+        return this->groupAddress;
+    }
+
+    bool UDPTransport::isOwnDatagram(const sockaddr_in &sender) const {
+        if (sender.sin_port != this->localAddress.sin_port) return false;
+        if (sender.sin_addr.s_addr == this->localAddress.sin_addr.s_addr) return true;
+
+        /// Sockets bound to all interfaces send from the address of the interface the datagram leaves on.
+        /// No other local socket may use our port on any of them, hosts elsewhere may use it though.
+        return find(this->interfaceAddresses.begin(), this->interfaceAddresses.end(), sender.sin_addr.s_addr) !=
+               this->interfaceAddresses.end();
+    }
+
+    void UDPTransport::send(vector<uint8_t> message) {
+        this->sendTo(MessageTarget::broadcast(), std::move(message));
+    }
+
+    void UDPTransport::sendTo(const MessageTarget &target, vector<uint8_t> message) {
+        sockaddr_in destination = this->destinationOf(target);
+
+        /// Datagrams that don't fit into the socket buffer are lost like any other UDP datagram
+        sendto(this->unicastSocket, message.data(), message.size(), 0, (sockaddr *) &destination, sizeof(destination));
+    }
+
+    void UDPTransport::prepareSends(const vector<tuple<MessageTarget, vector<uint8_t>>> &messages) {
+        size_t count = messages.size();
+
+        this->sendDestinations.clear();
+        this->sendVectors.clear();
+        for (const auto &message : messages) {
+            this->sendDestinations.push_back(this->destinationOf(get<0>(message)));
+            this->sendVectors.push_back({(void *) get<1>(message).data(), get<1>(message).size()});
+        }
+
+        /// Consecutive datagrams for the same destination are combined into segments of equal size of which
+        /// only the last one may be shorter. The kernel splits them up again.
+        this->sendHeaders.clear();
+        this->sendOffsets.clear();
+        if (this->sendControls.size() < count) this->sendControls.resize(count);
+
+        for (size_t first = 0; first < count;) {
+            size_t segmentSize = this->sendVectors[first].iov_len;
+            size_t end = first + 1;
+
+            if (this->segmentationOffload && segmentSize > 0) {
+                size_t segmentedSize = segmentSize;
+
+                while (end < count && end - first < UDP_TRANSPORT_MAX_SEGMENTS &&
+                       isSameAddress(this->sendDestinations[end], this->sendDestinations[first]) &&
+                       this->sendVectors[end].iov_len > 0 && this->sendVectors[end].iov_len <= segmentSize &&
+                       segmentedSize + this->sendVectors[end].iov_len <= UDP_TRANSPORT_MAX_SEGMENTED_SIZE) {
+                    segmentedSize += this->sendVectors[end].iov_len;
+                    if (this->sendVectors[end++].iov_len < segmentSize) break;
+                }
+            }
+
+            mmsghdr header{};
+            header.msg_hdr.msg_name = &this->sendDestinations[first];
+            header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            header.msg_hdr.msg_iov = &this->sendVectors[first];
+            header.msg_hdr.msg_iovlen = end - first;
+
+            if (end - first > 1) {
+                header.msg_hdr.msg_control = this->sendControls[this->sendHeaders.size()].data;
+                header.msg_hdr.msg_controllen = sizeof(SegmentationControl::data);
+
+                cmsghdr *control = CMSG_FIRSTHDR(&header.msg_hdr);
+                control->cmsg_level = SOL_UDP;
+                control->cmsg_type = UDP_SEGMENT;
+                control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                auto segmentSizeValue = (uint16_t) segmentSize;
+                memcpy(CMSG_DATA(control), &segmentSizeValue, sizeof(segmentSizeValue));
+            }
+
+            this->sendHeaders.push_back(header);
+            this->sendOffsets.push_back(first);
+            first = end;
+        }
+    }
+
+    bool UDPTransport::isSegmentationRefused(const msghdr &header, int error) {
+        return header.msg_controllen > 0 && (error == EIO || error == EINVAL || error == EOPNOTSUPP);
+    }
+
+    void UDPTransport::sendBatch(const vector<tuple<MessageTarget, vector<uint8_t>>> &messages) {
+        this->prepareSends(messages);
+
+        for (size_t sent = 0; sent < this->sendHeaders.size();) {
+            int result = sendmmsg(this->unicastSocket, this->sendHeaders.data() + sent,
+                                  (unsigned int) min<size_t>(this->sendHeaders.size() - sent, UDP_TRANSPORT_BATCH_SIZE), 0);
+
+            if (result > 0) {
+                sent += result;
+                continue;
+            }
+
+            /// Fall back to single datagrams if the kernel or the device refuse the segmentation
+            if (UDPTransport::isSegmentationRefused(this->sendHeaders[sent].msg_hdr, errno)) {
+                this->segmentationOffload = false;
+                this->sendBatch(vector<tuple<MessageTarget, vector<uint8_t>>>(messages.begin() + this->sendOffsets[sent],
+                                                                               messages.end()));
+                return;
+            }
+
+            /// Datagrams that don't fit into the socket buffer are lost like any other UDP datagram
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            sent++;
+        }
+    }
+
+    size_t UDPTransport::receiveFrom(int socket, vector<uint8_t> *buffers, size_t count) {
+        mmsghdr headers[UDP_TRANSPORT_BATCH_SIZE];
+        iovec vectors[UDP_TRANSPORT_BATCH_SIZE];
+        sockaddr_in senders[UDP_TRANSPORT_BATCH_SIZE];
+
+        /// Only allocated once something is received as subclasses may receive differently
+        if (this->receiveMemory.empty()) this->receiveMemory.resize(UDP_TRANSPORT_BATCH_SIZE * UDP_TRANSPORT_MAX_DATAGRAM_SIZE);
+
+        size_t received = 0;
+        while (received < count) {
+            auto batchSize = (unsigned int) min<size_t>(count - received, UDP_TRANSPORT_BATCH_SIZE);
+
+            for (unsigned int i = 0; i < batchSize; i++) {
+                vectors[i] = {this->receiveMemory.data() + i * UDP_TRANSPORT_MAX_DATAGRAM_SIZE, UDP_TRANSPORT_MAX_DATAGRAM_SIZE};
+                headers[i] = mmsghdr{};
+                headers[i].msg_hdr.msg_name = &senders[i];
+                headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                headers[i].msg_hdr.msg_iov = &vectors[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int result = recvmmsg(socket, headers, batchSize, MSG_DONTWAIT, nullptr);
+            if (result <= 0) break;
+
+            for (int i = 0; i < result; i++) {
+                if (headers[i].msg_hdr.msg_flags & MSG_TRUNC || this->isOwnDatagram(senders[i])) continue;
+
+                auto datagram = (uint8_t *) vectors[i].iov_base;
+                buffers[received++].assign(datagram, datagram + headers[i].msg_len);
+            }
+
+            /// The socket has been drained
+            if ((unsigned int) result < batchSize) break;
+        }
+
+        return received;
+    }
+
+    size_t UDPTransport::receiveAvailable(vector<uint8_t> *buffers, size_t count) {
+        size_t received = this->receiveFrom(this->unicastSocket, buffers, count);
+        return received + this->receiveFrom(this->multicastSocket, buffers + received, count - received);
+    }
+
+    size_t UDPTransport::recvBatch(vector<uint8_t> *buffers, size_t count, unsigned int timeout_ms) {
+        size_t received = this->receiveAvailable(buffers, count);
+        if (received > 0 || timeout_ms == 0) return received;
+
+        epoll_event event{};
+        if (epoll_wait(this->epollDescriptor, &event, 1, timeout_ms) <= 0) return 0;
+
+        return this->receiveAvailable(buffers, count);
+    }
+
+    ReceiveResult UDPTransport::recv(vector<uint8_t> *buffer, unsigned int timeout_ms) {
+        if (this->recvBatch(buffer, 1, timeout_ms) == 1) return ReceiveResult::OK;
+        return timeout_ms > 0 ? ReceiveResult::Timeout : ReceiveResult::NoData;
+    }
+
+#ifdef UNIT_TESTING
+
+    /// Runs all transports on the loopback interface so that they don't interfere with the actual network
+    UDPTransportConfiguration loopbackConfiguration() {
+        UDPTransportConfiguration configuration;
+        configuration.multicastGroup = "239.255.42.98";
+        configuration.port = 42998;
+        configuration.interfaceAddress = "127.0.0.1";
+        configuration.receiveBufferSize = 1 << 20;
+        return configuration;
+    }
+
+    /// Receives until the amount of datagrams arrived or nothing arrived for a second
+    vector<vector<uint8_t>> receiveAll(UDPTransport &transport, size_t count) {
+        vector<vector<uint8_t>> buffers(UDP_TRANSPORT_BATCH_SIZE);
+        vector<vector<uint8_t>> received;
+
+        while (received.size() < count) {
+            size_t batchSize = transport.recvBatch(buffers.data(), buffers.size(), 1000);
+            if (batchSize == 0) break;
+            received.insert(received.end(), buffers.begin(), buffers.begin() + batchSize);
+        }
+
+        return received;
+    }
+
+    /// Exposes the detection of our own datagrams
+    class InspectableUDPTransport : public UDPTransport {
+    public:
+        InspectableUDPTransport(UDPTransportConfiguration configuration, Sockets sockets)
+                : UDPTransport(std::move(configuration), std::move(sockets)) {};
+
+        using UDPTransport::openSockets;
+        using UDPTransport::isOwnDatagram;
+    };
+
+    SCENARIO("Datagrams of other hosts should not be mistaken for our own",
+             "[integration_test][module][communication][transmission]") {
+        GIVEN("a transport bound to all interfaces") {
+            UDPTransportConfiguration configuration = loopbackConfiguration();
+            configuration.interfaceAddress = "0.0.0.0";
+            auto sockets = InspectableUDPTransport::openSockets(configuration);
+            REQUIRE(sockets.isOk());
+            InspectableUDPTransport transport(configuration, sockets.unwrap());
+
+            sockaddr_in sender = transport.getLocalAddress();
+            inet_pton(AF_INET, "127.0.0.1", &sender.sin_addr);
+
+            THEN("datagrams from its port on a local address should be its own") {
+                REQUIRE(transport.isOwnDatagram(sender));
+            }
+
+            THEN("datagrams from the same port on another host should not be its own") {
+                inet_pton(AF_INET, "192.0.2.1", &sender.sin_addr);
+                REQUIRE_FALSE(transport.isOwnDatagram(sender));
+            }
+        }
+    }
+
+    SCENARIO("Datagrams should be transmittable over UDP", "[integration_test][module][communication][transmission]") {
+        GIVEN("two transports on the loopback interface") {
+            UDPTransportConfiguration configuration = loopbackConfiguration();
+            auto a = UDPTransport::open(configuration);
+            auto b = UDPTransport::open(configuration);
+            REQUIRE(a.isOk());
+            REQUIRE(b.isOk());
+            shared_ptr<UDPTransport> transportA = a.unwrap();
+            shared_ptr<UDPTransport> transportB = b.unwrap();
+
+            WHEN("one of them broadcasts a datagram") {
+                transportA->send({1, 2, 3});
+
+                THEN("the other one should receive it") {
+                    vector<uint8_t> buffer;
+                    REQUIRE(transportB->recv(&buffer, 1000) == ReceiveResult::OK);
+                    REQUIRE(buffer == vector<uint8_t>({1, 2, 3}));
+                }
+
+                THEN("the sender should not receive it itself") {
+                    vector<uint8_t> buffer;
+                    REQUIRE(transportA->recv(&buffer, 100) == ReceiveResult::Timeout);
+                }
+            }
+
+            WHEN("the address of a peer is known") {
+                cryptography::UUID peer;
+                transportA->setPeerAddress(peer, transportB->getLocalAddress());
+
+                auto c = UDPTransport::open(configuration);
+                REQUIRE(c.isOk());
+                shared_ptr<UDPTransport> transportC = c.unwrap();
+
+                transportA->sendTo(MessageTarget::single(peer), {4, 5, 6});
+
+                THEN("datagrams for it should only be sent to it") {
+                    vector<uint8_t> buffer;
+                    REQUIRE(transportB->recv(&buffer, 1000) == ReceiveResult::OK);
+                    REQUIRE(buffer == vector<uint8_t>({4, 5, 6}));
+                    REQUIRE(transportC->recv(&buffer, 100) == ReceiveResult::Timeout);
+                }
+            }
+
+            WHEN("a batch of datagrams with different sizes and targets is sent") {
+                cryptography::UUID peer;
+                transportA->setPeerAddress(peer, transportB->getLocalAddress());
+
+                vector<tuple<MessageTarget, vector<uint8_t>>> messages;
+                vector<vector<uint8_t>> datagrams;
+                for (size_t i = 0; i < 200; i++) {
+                    vector<uint8_t> datagram(i % 3 == 0 ? 100 : 64, (uint8_t) i);
+                    datagrams.push_back(datagram);
+                    messages.emplace_back(i % 50 < 25 ? MessageTarget::broadcast() : MessageTarget::single(peer), datagram);
+                }
+
+                transportA->sendBatch(messages);
+
+                THEN("the other one should receive all of them") {
+                    vector<vector<uint8_t>> received = receiveAll(*transportB, datagrams.size());
+
+                    /// Unicasts and broadcasts arrive on different sockets so only the contents are compared
+                    sort(received.begin(), received.end());
+                    sort(datagrams.begin(), datagrams.end());
+                    REQUIRE(received == datagrams);
+                }
+            }
+        }
+
+        GIVEN("an invalid multicast group") {
+            UDPTransportConfiguration configuration = loopbackConfiguration();
+            configuration.multicastGroup = "mesh";
+
+            THEN("the transport should not be opened") {
+                REQUIRE(UDPTransport::open(configuration).unwrapErr() == UDPTransport::UDPTransportError::INVALID_ADDRESS);
+            }
+        }
+    }
+
+    SCENARIO("Benchmarking the datagram throughput over UDP", "[.][benchmark][communication][transmission]") {
+        for (bool segmentationOffload : {false, true}) {
+            UDPTransportConfiguration configuration = loopbackConfiguration();
+            configuration.segmentationOffload = segmentationOffload;
+            configuration.receiveBufferSize = 1 << 24;
+            configuration.sendBufferSize = 1 << 24;
+
+            shared_ptr<UDPTransport> sender = UDPTransport::open(configuration).unwrap();
+            shared_ptr<UDPTransport> receiver = UDPTransport::open(configuration).unwrap();
+
+            cryptography::UUID peer;
+            sender->setPeerAddress(peer, receiver->getLocalAddress());
+            vector<tuple<MessageTarget, vector<uint8_t>>> batch(UDP_TRANSPORT_BATCH_SIZE,
+                                                                make_tuple(MessageTarget::single(peer), vector<uint8_t>(200, 0)));
+
+            /// One core sends while the other one receives
+            const size_t count = 1000000;
+            size_t received = 0;
+            thread receiving([&]() {
+                vector<vector<uint8_t>> buffers(UDP_TRANSPORT_BATCH_SIZE);
+                for (size_t batchSize; (batchSize = receiver->recvBatch(buffers.data(), buffers.size(), 200)) > 0;)
+                    received += batchSize;
+            });
+
+            using namespace std::chrono;
+            auto start = steady_clock::now();
+            for (size_t sent = 0; sent < count; sent += batch.size())
+                sender->sendBatch(batch);
+            receiving.join();
+            /// The receiver stopped 200ms after the last datagram
+            auto duration = duration_cast<microseconds>(steady_clock::now() - start).count() - 200000;
+
+            WARN((sender->usesSegmentationOffload() ? "with" : "without") << " GSO: "
+                         << received * 1000000 / duration << " datagrams per second received on one core ("
+                         << received * 100 / count << "% of the sent ones)");
+        }
+    }
+
+#endif // UNIT_TESTING
+}
+
+#endif // __linux__
@@ -0,0 +1,154 @@
+#ifndef PROTOMESH_UDPTRANSPORT_HPP
+#define PROTOMESH_UDPTRANSPORT_HPP
+
+#ifdef __linux__
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace std;
+
+#include "result.h"
+#include "uuid.hpp"
+#include "UUIDMap.hpp"
+#include "TransmissionHandler.hpp"
+
+/// Largest datagram that can be received, larger ones are dropped
+#define UDP_TRANSPORT_MAX_DATAGRAM_SIZE 8192
+/// Maximum amount of datagrams moved by a single system call
+#define UDP_TRANSPORT_BATCH_SIZE 64
+/// Maximum amount of datagrams combined into a single send by UDP GSO
+#define UDP_TRANSPORT_MAX_SEGMENTS 64
+/// Maximum size in bytes of all datagrams combined into a single send by UDP GSO
+#define UDP_TRANSPORT_MAX_SEGMENTED_SIZE 65000
+
+namespace ProtoMesh::communication::transmission {
+
+    class UDPTransportConfiguration {
+    public:
+        /// IPv4 multicast group broadcasts are sent to
+        string multicastGroup = "239.255.42.99";
+        /// Port of the multicast group
+        uint16_t port = 42999;
+        /// IPv4 address of the interface to send and receive on.
+        /// Use 127.0.0.1 to run multiple nodes on a single machine.
+        string interfaceAddress = "0.0.0.0";
+        /// Amount of routers a broadcast may pass, which usually is none
+        uint8_t multicastTTL = 1;
+
+        /// Socket buffer sizes in bytes, 0 keeps the defaults of the system
+        int receiveBufferSize = 0;
+        int sendBufferSize = 0;
+
+        /// Whether or not consecutive datagrams for the same destination are sent with a single system call
+        /// by UDP generic segmentation offload if the kernel supports it
+        bool segmentationOffload = true;
+    };
+
+    /// Transport over UDP (Linux only). Broadcasts are sent to a multicast group while messages for a single node
+    /// are sent to its unicast address if it is known (see setPeerAddress) and to the group otherwise.
+    /// One socket is bound to the group and another one to an ephemeral port which all datagrams are sent from
+    /// and unicasts are received on. Datagrams sent by the transport itself are not received again.
+    class UDPTransport : public TransmissionHandler {
+    public:
+        enum class UDPTransportError {
+            /// The multicast group or interface address could not be parsed
+            INVALID_ADDRESS,
+            /// A socket could not be created, configured or bound
+            SOCKET_ERROR
+        };
+
+    protected:
+        /// Descriptors and addresses of an opened transport
+        class Sockets {
+        public:
+            int multicastSocket;
+            int unicastSocket;
+            /// Polls both sockets so that they can be served by a single file descriptor
+            int epollDescriptor;
+
+            sockaddr_in groupAddress;
+            sockaddr_in localAddress;
+            /// IPv4 addresses of all interfaces if the unicast socket is bound to all of them, empty otherwise
+            vector<in_addr_t> interfaceAddresses;
+            bool segmentationOffload;
+        };
+
+        struct SegmentationControl {
+            alignas(cmsghdr) uint8_t data[CMSG_SPACE(sizeof(uint16_t))];
+        };
+
+        UDPTransportConfiguration configuration;
+
+        int multicastSocket;
+        int unicastSocket;
+        int epollDescriptor;
+
+        sockaddr_in groupAddress;
+        sockaddr_in localAddress;
+        vector<in_addr_t> interfaceAddresses;
+        bool segmentationOffload;
+
+        cryptography::UUIDMap<sockaddr_in> peers;
+
+        /// Headers of the last batch prepared by prepareSends and the memory they point to, reused by every batch
+        vector<mmsghdr> sendHeaders;
+        /// Index of the first message of every header
+        vector<size_t> sendOffsets;
+        vector<sockaddr_in> sendDestinations;
+        vector<iovec> sendVectors;
+        vector<SegmentationControl> sendControls;
+
+        /// Datagrams are received into this memory and copied into the buffers of the caller afterwards
+        vector<uint8_t> receiveMemory;
+
+        UDPTransport(UDPTransportConfiguration configuration, Sockets sockets);
+        static Result<Sockets, UDPTransportError> openSockets(const UDPTransportConfiguration &configuration);
+
+        sockaddr_in destinationOf(const MessageTarget &target) const;
+        /// Whether or not the datagram has been sent from our unicast socket, i.e. from its port on one of our addresses
+        bool isOwnDatagram(const sockaddr_in &sender) const;
+
+        /// Builds a header for every datagram. If GSO is enabled consecutive datagrams for the same destination
+        /// share a single header. The headers point into the messages which have to outlive the send.
+        void prepareSends(const vector<tuple<MessageTarget, vector<uint8_t>>> &messages);
+        /// Whether or not a send failed because the kernel or the device refused the segmentation
+        static bool isSegmentationRefused(const msghdr &header, int error);
+
+    private:
+        size_t receiveFrom(int socket, vector<uint8_t> *buffers, size_t count);
+        size_t receiveAvailable(vector<uint8_t> *buffers, size_t count);
+
+    public:
+        static Result<shared_ptr<UDPTransport>, UDPTransportError> open(UDPTransportConfiguration configuration);
+        ~UDPTransport();
+
+        UDPTransport(const UDPTransport &) = delete;
+        UDPTransport &operator=(const UDPTransport &) = delete;
+
+        /// Messages for the peer are sent to this address instead of the multicast group from now on
+        void setPeerAddress(cryptography::UUID peer, sockaddr_in address) { this->peers[peer] = address; }
+
+        /// Address unicasts to this transport have to be sent to
+        sockaddr_in getLocalAddress() const { return this->localAddress; }
+
+        bool usesSegmentationOffload() const { return this->segmentationOffload; }
+
+        /// TransmissionHandler overrides
+        void send(vector<uint8_t> message) override;
+        ReceiveResult recv(vector<uint8_t> *buffer, unsigned int timeout_ms) override;
+        void sendTo(const MessageTarget &target, vector<uint8_t> message) override;
+        void sendBatch(const vector<tuple<MessageTarget, vector<uint8_t>>> &messages) override;
+        size_t recvBatch(vector<uint8_t> *buffers, size_t count, unsigned int timeout_ms) override;
+        int fileDescriptor() override { return this->epollDescriptor; }
+    };
+
+}
+
+#endif // __linux__
+
+#endif //PROTOMESH_UDPTRANSPORT_HPP
@@ -0,0 +1,31 @@
+#ifndef PROTOMESH_NETWORKDELEGATE_HPP
+#define PROTOMESH_NETWORKDELEGATE_HPP
+
+#include <memory>
+#include <vector>
+
+#include "uuid.hpp"
+
+namespace ProtoMesh::communication {
+
+#define NETWORK_DELEGATE_T shared_ptr<ProtoMesh::communication::NetworkDelegate>
+
+    enum class DeliveryFailureReason {
+        /// No route to the target could be discovered within the retry limit
+        TARGET_UNREACHABLE,
+        /// The payload has been dropped from the routing or outgoing queue since it was full (see QueueLimits)
+        QUEUE_FULL
+    };
+
+    class NetworkDelegate {
+    public:
+        NetworkDelegate() = default;
+        ~NetworkDelegate() = default;
+
+        virtual void didFailToDeliver(cryptography::UUID target, const vector<vector<uint8_t>> &payloads,
+                                      DeliveryFailureReason reason) {};
+    };
+
+}
+
+#endif //PROTOMESH_NETWORKDELEGATE_HPP
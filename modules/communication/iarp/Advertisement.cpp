@@ -13,7 +13,13 @@ namespace ProtoMesh::communication::Routing::IARP {
         using namespace scheme::communication::iarp;
         flatbuffers::FlatBufferBuilder builder;
 
-        auto pubKey = this->pubKey.toBuffer(&builder);
+        /// Incremental advertisements carry the hash of the key instead of the key itself
+        flatbuffers::Offset<scheme::cryptography::PublicKey> pubKey = 0;
+        flatbuffers::Offset<flatbuffers::Vector<uint8_t>> keyHash = 0;
+        if (this->pubKey.has_value())
+            pubKey = this->pubKey->toBuffer(&builder);
+        else
+            keyHash = builder.CreateVector((const uint8_t *) this->keyHash.data(), this->keyHash.size());
 
         scheme::cryptography::UUID uuid = this->uuid.toScheme();
 
@@ -26,7 +32,13 @@ namespace ProtoMesh::communication::Routing::IARP {
         auto advertisement = CreateAdvertisementDatagram(builder,
                                                          &uuid,
                                                          pubKey,
-                                                         routeVector);
+                                                         routeVector,
+                                                         this->interval,
+                                                         this->pathMetric,
+                                                         this->sequenceNumber,
+                                                         keyHash,
+                                                         this->zoneRadius,
+                                                         this->propagationRadius);
 
         /// Convert it to a byte array
         builder.Finish(advertisement, AdvertisementDatagramIdentifier());
@@ -51,12 +63,22 @@ namespace ProtoMesh::communication::Routing::IARP {
 
         auto adv = GetAdvertisementDatagram(buffer.data());
 
-        /// Deserialize public key
+        /// Deserialize the public key or its hash if the key has been omitted
+        optional<cryptography::asymmetric::PublicKey> pubKey;
+        PUB_HASH_T keyHash;
         auto pubKeyBuffer = adv->pubKey();
-        auto compressedPubKey = pubKeyBuffer->compressed();
-        auto pubKey = cryptography::asymmetric::PublicKey::fromBuffer(compressedPubKey);
-        if (pubKey.isErr())
-            return Err(DeserializationError::INVALID_PUB_KEY);
+        if (pubKeyBuffer) {
+            auto pubKeyResult = cryptography::asymmetric::PublicKey::fromBuffer(pubKeyBuffer->compressed());
+            if (pubKeyResult.isErr())
+                return Err(DeserializationError::INVALID_PUB_KEY);
+            pubKey = pubKeyResult.unwrap();
+            keyHash = pubKey->getHash();
+        } else {
+            auto keyHashBuffer = adv->keyHash();
+            if (!keyHashBuffer || keyHashBuffer->size() != PUB_HASH_SIZE)
+                return Err(DeserializationError::INVALID_PUB_KEY);
+            copy(keyHashBuffer->begin(), keyHashBuffer->end(), keyHash.begin());
+        }
 
         /// Deserialize route
         vector<cryptography::UUID> route;
@@ -67,7 +89,12 @@ namespace ProtoMesh::communication::Routing::IARP {
         /// Deserialize uuid
         cryptography::UUID uuid(adv->uuid());
 
-        return Ok(Advertisement(uuid, pubKey.unwrap(), route));
+        Advertisement advertisement(uuid, pubKey, keyHash, route, adv->interval(), adv->pathMetric(),
+                                    adv->sequenceNumber());
+        advertisement.zoneRadius = adv->zoneRadius();
+        advertisement.propagationRadius = adv->propagationRadius();
+
+        return Ok(advertisement);
     }
 
     void Advertisement::addHop(cryptography::UUID uuid) {
@@ -88,6 +115,10 @@ namespace ProtoMesh::communication::Routing::IARP {
 
             adv.addHop(hop1);
             adv.addHop(hop2);
+            adv.pathMetric = 250;
+            adv.sequenceNumber = 3;
+            adv.zoneRadius = 3;
+            adv.propagationRadius = 5;
 
             WHEN("it is serialized") {
                 vector<uint8_t> serializedAdvertisement = adv.serialize();
@@ -106,6 +137,11 @@ namespace ProtoMesh::communication::Routing::IARP {
                         REQUIRE(deserializedAdvertisement.route == adv.route);
                         REQUIRE(deserializedAdvertisement.uuid == adv.uuid);
                         REQUIRE(deserializedAdvertisement.pubKey == adv.pubKey);
+                        REQUIRE(deserializedAdvertisement.interval == adv.interval);
+                        REQUIRE(deserializedAdvertisement.pathMetric == adv.pathMetric);
+                        REQUIRE(deserializedAdvertisement.sequenceNumber == adv.sequenceNumber);
+                        REQUIRE(deserializedAdvertisement.zoneRadius == adv.zoneRadius);
+                        REQUIRE(deserializedAdvertisement.propagationRadius == adv.propagationRadius);
                     }
                     THEN("both bytestreams should be equal") {
                         REQUIRE(reSerializedAdvertisement == serializedAdvertisement);
@@ -114,6 +150,35 @@ namespace ProtoMesh::communication::Routing::IARP {
             }
         }
 
+        GIVEN("An incremental advertisement") {
+            cryptography::UUID uuid;
+            cryptography::UUID hop;
+            cryptography::asymmetric::KeyPair pair(cryptography::asymmetric::generateKeyPair());
+            Routing::IARP::Advertisement adv = IARP::Advertisement::buildIncremental(uuid, pair.pub.getHash(), 7);
+            adv.addHop(hop);
+
+            WHEN("it is serialized") {
+                vector<uint8_t> serializedAdvertisement = adv.serialize();
+
+                THEN("it should be smaller than a full advertisement") {
+                    Routing::IARP::Advertisement fullAdv = IARP::Advertisement::build(uuid, pair, 7);
+                    fullAdv.addHop(hop);
+                    REQUIRE(serializedAdvertisement.size() < fullAdv.serialize().size());
+                }
+
+                AND_WHEN("it is deserialized") {
+                    Routing::IARP::Advertisement deserializedAdvertisement = Routing::IARP::Advertisement::fromBuffer(serializedAdvertisement).unwrap();
+
+                    THEN("it should reference the key by its hash") {
+                        REQUIRE(deserializedAdvertisement.isIncremental());
+                        REQUIRE(deserializedAdvertisement.keyHash == pair.pub.getHash());
+                        REQUIRE(deserializedAdvertisement.sequenceNumber == 7);
+                        REQUIRE(deserializedAdvertisement.route == adv.route);
+                    }
+                }
+            }
+        }
+
     }
 
 #endif // UNIT_TESTING
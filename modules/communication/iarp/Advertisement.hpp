@@ -2,6 +2,7 @@
 #define PROTOMESH_ADVERTISEMENT_HPP
 
 #include <utility>
+#include <optional>
 
 #include "uuid.hpp"
 #include "asymmetric.hpp"
@@ -10,15 +11,35 @@
 #include "flatbuffers/flatbuffers.h"
 #include "communication/iarp/advertisement_generated.h"
 
+/// Default zone radius of a device and of the radii carried by advertisements (see advertisement.fbs).
+/// Note that the zone radius is inclusive thus including the origin and destination.
+/// e.g. A -> x -> y -> B would be a radius of 4
+#define ZONE_RADIUS 4
+/// Default time in milliseconds between two advertisements of a device. Routes learned from an advertisement
+/// stay valid for the interval it carries.
+#define ADVERTISEMENT_INTERVAL 10000
+/// Share of the interval in percent by which an advertisement is sent early at random so that the
+/// advertisements of devices that started at the same time don't collide
+#define ADVERTISEMENT_JITTER 25
+
 namespace ProtoMesh::communication::Routing::IARP {
 
     class Advertisement : public Serializable<Advertisement> {
     public:
         cryptography::UUID uuid;
-        cryptography::asymmetric::PublicKey pubKey;
+        /// Omitted from incremental advertisements
+        optional<cryptography::asymmetric::PublicKey> pubKey;
+        PUB_HASH_T keyHash;
 
         vector<cryptography::UUID> route;
         unsigned int interval;
+        /// Cumulative link cost of the route, see LinkEstimator
+        unsigned int pathMetric;
+        uint32_t sequenceNumber;
+        /// Zone radius of the advertiser
+        uint8_t zoneRadius = ZONE_RADIUS;
+        /// Radius within which the advertisement is rebroadcast, at least the zone radius
+        uint8_t propagationRadius = ZONE_RADIUS;
 
         enum class AdvertisementDeserializationError {
             INVALID_IDENTIFIER,
@@ -27,15 +48,28 @@ namespace ProtoMesh::communication::Routing::IARP {
         };
 
         explicit Advertisement(cryptography::UUID uuid,
-                               cryptography::asymmetric::PublicKey pubKey,
+                               optional<cryptography::asymmetric::PublicKey> pubKey,
+                               PUB_HASH_T keyHash,
                                vector<cryptography::UUID> route = {},
-                               unsigned int interval = 10000)
-                : uuid(uuid), pubKey(pubKey), route(std::move(route)), interval(interval) {};
+                               unsigned int interval = ADVERTISEMENT_INTERVAL,
+                               unsigned int pathMetric = 0,
+                               uint32_t sequenceNumber = 0)
+                : uuid(uuid), pubKey(std::move(pubKey)), keyHash(keyHash), route(std::move(route)), interval(interval),
+                  pathMetric(pathMetric), sequenceNumber(sequenceNumber) {};
 
         void addHop(cryptography::UUID uuid);
 
-        static Advertisement build(cryptography::UUID uuid, cryptography::asymmetric::KeyPair key) {
-            return Advertisement(uuid, key.pub);
+        /// Whether or not the public key has been replaced by its hash
+        bool isIncremental() const { return !this->pubKey.has_value(); }
+
+        static Advertisement build(cryptography::UUID uuid, cryptography::asymmetric::KeyPair key,
+                                   uint32_t sequenceNumber = 0) {
+            return Advertisement(uuid, key.pub, key.pub.getHash(), {}, ADVERTISEMENT_INTERVAL, 0, sequenceNumber);
+        }
+
+        /// Builds an advertisement that only references the public key by its hash
+        static Advertisement buildIncremental(cryptography::UUID uuid, PUB_HASH_T keyHash, uint32_t sequenceNumber) {
+            return Advertisement(uuid, nullopt, keyHash, {}, ADVERTISEMENT_INTERVAL, 0, sequenceNumber);
         }
 
         /// Serializable overrides
@@ -0,0 +1,95 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "KeyRequest.hpp"
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    KeyRequest KeyRequest::build(cryptography::UUID requester, cryptography::UUID advertiser,
+                                 const vector<cryptography::UUID> &advertisementRoute) {
+        vector<cryptography::UUID> route = {requester};
+        route.insert(route.end(), advertisementRoute.rbegin(), advertisementRoute.rend());
+        route.push_back(advertiser);
+
+        return KeyRequest(route);
+    }
+
+    vector<uint8_t> KeyRequest::serialize() const {
+
+        using namespace scheme::communication::iarp;
+        flatbuffers::FlatBufferBuilder builder;
+
+        /// Serialize the route
+        vector<scheme::cryptography::UUID> routeEntries;
+        for (auto hop : this->route)
+            routeEntries.push_back(hop.toScheme());
+
+        auto routeVector = builder.CreateVectorOfStructs(routeEntries);
+
+        auto keyRequest = CreateKeyRequestDatagram(builder, routeVector);
+
+        /// Convert it to a byte array
+        builder.Finish(keyRequest, KeyRequestDatagramIdentifier());
+        uint8_t *buf = builder.GetBufferPointer();
+
+        return {buf, buf + builder.GetSize()};
+    }
+
+    Result<KeyRequest, DeserializationError> KeyRequest::fromBuffer(vector<uint8_t> buffer) {
+
+        using namespace scheme::communication::iarp;
+
+        /// Verify the buffer type
+        if (!flatbuffers::BufferHasIdentifier(buffer.data(), KeyRequestDatagramIdentifier()))
+            return Err(DeserializationError::INVALID_IDENTIFIER);
+
+        /// Verify buffer integrity
+        auto verifier = flatbuffers::Verifier(buffer.data(), buffer.size());
+        if (!VerifyKeyRequestDatagramBuffer(verifier))
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        auto request = GetKeyRequestDatagram(buffer.data());
+        if (!request->route())
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        /// Deserialize route
+        vector<cryptography::UUID> route;
+        auto routeBuffer = request->route();
+        for (uint i = 0; i < routeBuffer->Length(); i++)
+            route.emplace_back(routeBuffer->Get(i));
+
+        return Ok(KeyRequest(route));
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Requesting the key of an advertiser", "[unit_test][module][communication][routing][iarp]") {
+        GIVEN("A key request for an advertisement that traversed two hops") {
+            cryptography::UUID requester;
+            cryptography::UUID advertiser;
+            cryptography::UUID hop1;
+            cryptography::UUID hop2;
+
+            KeyRequest request = KeyRequest::build(requester, advertiser, {hop1, hop2});
+
+            THEN("it should travel back along the route of the advertisement") {
+                REQUIRE(request.route == vector<cryptography::UUID>({requester, hop2, hop1, advertiser}));
+            }
+
+            WHEN("it is serialized and deserialized again") {
+                vector<uint8_t> serializedRequest = request.serialize();
+                auto result = KeyRequest::fromBuffer(serializedRequest);
+
+                THEN("it should contain the same route") {
+                    REQUIRE(result.isOk());
+                    REQUIRE(result.unwrap().route == request.route);
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,38 @@
+#ifndef PROTOMESH_KEYREQUEST_HPP
+#define PROTOMESH_KEYREQUEST_HPP
+
+#include <utility>
+#include <vector>
+#include <iterator>
+
+using namespace std;
+
+#include "uuid.hpp"
+#include "Serializable.hpp"
+
+#include "flatbuffers/flatbuffers.h"
+#include "communication/iarp/keyRequest_generated.h"
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    /// Asks an advertiser to include its public key in its next advertisement.
+    /// Sent by nodes that received an incremental advertisement referencing a key they do not know
+    /// and travels back along the route of that advertisement.
+    class KeyRequest : public Serializable<KeyRequest> {
+    public:
+        vector<cryptography::UUID> route;
+
+        explicit KeyRequest(vector<cryptography::UUID> route) : route(std::move(route)) {};
+
+        /// Builds a request for the key of the advertiser which reached the requester over the given route
+        static KeyRequest build(cryptography::UUID requester, cryptography::UUID advertiser,
+                                const vector<cryptography::UUID> &advertisementRoute);
+
+        /// Serializable overrides
+        static Result<KeyRequest, DeserializationError> fromBuffer(vector<uint8_t> buffer);
+        vector<uint8_t> serialize() const override;
+    };
+
+}
+
+#endif //PROTOMESH_KEYREQUEST_HPP
@@ -0,0 +1,79 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "LinkEstimator.hpp"
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    void LinkEstimator::recordAdvertisement(long currentTime, unsigned int interval) {
+        if (!this->heard) {
+            this->heard = true;
+            this->lastHeard = currentTime;
+            return;
+        }
+
+        /// Count the advertisements that should have arrived in between (rounded to the nearest interval)
+        long gap = currentTime - this->lastHeard;
+        long expectedGap = interval;
+        long missedAdvertisements = expectedGap > 0 && gap > expectedGap ? (gap + expectedGap / 2) / expectedGap - 1 : 0;
+
+        for (long i = 0; i < missedAdvertisements; i++)
+            this->deliveryRatio *= 1 - LINK_ESTIMATOR_WEIGHT;
+
+        this->deliveryRatio = this->deliveryRatio * (1 - LINK_ESTIMATOR_WEIGHT) + LINK_ESTIMATOR_WEIGHT;
+        this->lastHeard = currentTime;
+    }
+
+    unsigned int LinkEstimator::getExpectedTransmissionCount() const {
+        double bidirectionalRatio = this->deliveryRatio * this->deliveryRatio;
+        return (unsigned int) (LINK_ETX_SCALE / bidirectionalRatio);
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("The quality of a link should be estimated from received advertisements",
+             "[unit_test][module][communication][routing][iarp]") {
+        GIVEN("a link estimator") {
+            LinkEstimator estimator;
+
+            WHEN("every advertisement is received") {
+                for (long time = 0; time <= 100000; time += 10000)
+                    estimator.recordAdvertisement(time, 10000);
+
+                THEN("the link should be considered lossless") {
+                    REQUIRE(estimator.getDeliveryRatio() == Approx(1.0));
+                    REQUIRE(estimator.getExpectedTransmissionCount() == LINK_ETX_SCALE);
+                }
+            }
+
+            WHEN("every second advertisement is lost") {
+                for (long time = 0; time <= 400000; time += 20000)
+                    estimator.recordAdvertisement(time, 10000);
+
+                THEN("the delivery ratio should approach one half") {
+                    REQUIRE(estimator.getDeliveryRatio() > 0.5);
+                    REQUIRE(estimator.getDeliveryRatio() < 0.6);
+                }
+
+                THEN("the link should be considered about three times as expensive") {
+                    REQUIRE(estimator.getExpectedTransmissionCount() > 2.5 * LINK_ETX_SCALE);
+                    REQUIRE(estimator.getExpectedTransmissionCount() < 4 * LINK_ETX_SCALE);
+                }
+            }
+
+            WHEN("nothing has been heard for a long time") {
+                estimator.recordAdvertisement(0, 10000);
+                estimator.recordAdvertisement(1000000, 10000);
+
+                THEN("the link should be considered very expensive") {
+                    REQUIRE(estimator.getExpectedTransmissionCount() > 10 * LINK_ETX_SCALE);
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,33 @@
+#ifndef PROTOMESH_LINKESTIMATOR_HPP
+#define PROTOMESH_LINKESTIMATOR_HPP
+
+/// Expected transmission count of a lossless link. Link costs are integers scaled by this value.
+#define LINK_ETX_SCALE 100
+/// Weight of the most recent observation in the moving average of the delivery ratio
+#define LINK_ESTIMATOR_WEIGHT 0.25
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    /// Estimates the quality of the link to a neighbor from the advertisements it sends.
+    /// Since neighbors advertise periodically, gaps between two received advertisements
+    /// reveal how many advertisements have been lost on the way.
+    class LinkEstimator {
+        long lastHeard = 0;
+        bool heard = false;
+        double deliveryRatio = 1.0;
+
+    public:
+        /// Records an advertisement sent by the neighbor itself (not one relayed by it)
+        void recordAdvertisement(long currentTime, unsigned int interval);
+
+        /// Moving average of the fraction of advertisements that have been received
+        double getDeliveryRatio() const { return this->deliveryRatio; }
+
+        /// Expected amount of transmissions (scaled by LINK_ETX_SCALE) required to deliver a datagram
+        /// and its acknowledgement. Assumes the link is equally lossy in both directions.
+        unsigned int getExpectedTransmissionCount() const;
+    };
+
+}
+
+#endif //PROTOMESH_LINKESTIMATOR_HPP
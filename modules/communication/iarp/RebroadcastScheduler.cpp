@@ -0,0 +1,125 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "RebroadcastScheduler.hpp"
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    void RebroadcastScheduler::record(const Advertisement &advertisement, bool rebroadcast, long currentTime) {
+        size_t distance = advertisement.route.size() - 1;
+        auto existing = this->rebroadcasts.find(advertisement.uuid);
+
+        /// Copies of an advertisement we've already seen only count towards the suppression threshold
+        /// if they have been sent by nodes that are not farther away from the advertiser than us.
+        if (existing != this->rebroadcasts.end() && existing->second.sequenceNumber == advertisement.sequenceNumber) {
+            PendingRebroadcast &pending = existing->second;
+
+            if (distance < pending.distance && rebroadcast && !pending.completed) {
+                /// Prefer rebroadcasting the shorter route, copies counted so far were farther away
+                pending.advertisement = advertisement;
+                pending.distance = distance;
+                pending.copies = 1;
+            } else if (distance <= pending.distance)
+                pending.copies++;
+
+            return;
+        }
+
+        long delay = this->random() % (REBROADCAST_MAX_DELAY + 1);
+        optional<Advertisement> scheduledAdvertisement;
+        if (rebroadcast) scheduledAdvertisement = advertisement;
+
+        this->rebroadcasts.erase(advertisement.uuid);
+        this->rebroadcasts.emplace(advertisement.uuid, PendingRebroadcast(advertisement.sequenceNumber, distance,
+                                                                          currentTime + delay, scheduledAdvertisement));
+    }
+
+    vector<Advertisement> RebroadcastScheduler::takeDue(long currentTime) {
+        vector<Advertisement> dueAdvertisements;
+
+        for (auto &entry : this->rebroadcasts) {
+            PendingRebroadcast &pending = entry.second;
+            if (pending.completed || !pending.advertisement.has_value() || pending.due > currentTime) continue;
+
+            if (pending.copies < this->threshold)
+                dueAdvertisements.push_back(pending.advertisement.value());
+
+            /// Keep the sequence number around so that late copies are not rebroadcast again
+            pending.advertisement = nullopt;
+            pending.completed = true;
+        }
+
+        return dueAdvertisements;
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Redundant advertisement rebroadcasts should be suppressed",
+             "[unit_test][module][communication][routing][iarp]") {
+        GIVEN("a rebroadcast scheduler with a threshold of two and an advertisement received over two hops") {
+            RebroadcastScheduler scheduler(0, 2);
+            cryptography::UUID advertiser, hop1, hop2, us;
+            cryptography::asymmetric::KeyPair pair(cryptography::asymmetric::generateKeyPair());
+
+            Advertisement advertisement = Advertisement::build(advertiser, pair, 1);
+            advertisement.addHop(hop1);
+            advertisement.addHop(us);
+            scheduler.record(advertisement, true, 0);
+
+            /// The delay drawn by a scheduler with the same seed
+            minstd_rand reference(0);
+            long delay = reference() % (REBROADCAST_MAX_DELAY + 1);
+            REQUIRE(delay > 0);
+
+            THEN("it should not be rebroadcast before the delay has passed") {
+                REQUIRE(scheduler.takeDue(delay - 1).empty());
+                REQUIRE(scheduler.takeDue(delay).size() == 1);
+                REQUIRE(scheduler.takeDue(REBROADCAST_MAX_DELAY * 2).empty());
+            }
+
+            WHEN("the same advertisement is heard from another node at the same distance") {
+                Advertisement copy = Advertisement::build(advertiser, pair, 1);
+                copy.addHop(hop2);
+                copy.addHop(us);
+                scheduler.record(copy, true, 10);
+
+                THEN("the rebroadcast should be suppressed") {
+                    REQUIRE(scheduler.takeDue(REBROADCAST_MAX_DELAY).empty());
+                }
+            }
+
+            WHEN("the same advertisement is heard from a node that is farther away") {
+                Advertisement copy = Advertisement::build(advertiser, pair, 1);
+                copy.addHop(hop1);
+                copy.addHop(hop2);
+                copy.addHop(us);
+                scheduler.record(copy, false, 10);
+
+                THEN("it should still be rebroadcast exactly once") {
+                    vector<Advertisement> due = scheduler.takeDue(REBROADCAST_MAX_DELAY);
+                    REQUIRE(due.size() == 1);
+                    REQUIRE(due[0].route == advertisement.route);
+
+                    scheduler.record(copy, false, REBROADCAST_MAX_DELAY + 10);
+                    REQUIRE(scheduler.takeDue(REBROADCAST_MAX_DELAY * 2).empty());
+                }
+            }
+
+            WHEN("the next advertisement of the same advertiser arrives") {
+                scheduler.takeDue(REBROADCAST_MAX_DELAY);
+                Advertisement next = Advertisement::build(advertiser, pair, 2);
+                next.addHop(us);
+                scheduler.record(next, true, 10000);
+
+                THEN("it should be scheduled again") {
+                    REQUIRE(scheduler.takeDue(10000 + REBROADCAST_MAX_DELAY).size() == 1);
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
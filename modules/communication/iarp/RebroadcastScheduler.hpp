@@ -0,0 +1,61 @@
+#ifndef PROTOMESH_REBROADCASTSCHEDULER_HPP
+#define PROTOMESH_REBROADCASTSCHEDULER_HPP
+
+#include <unordered_map>
+#include <vector>
+#include <optional>
+#include <random>
+
+#include "uuid.hpp"
+#include "Advertisement.hpp"
+
+/// Upper bound of the random delay in milliseconds before an advertisement is rebroadcast
+#define REBROADCAST_MAX_DELAY 200
+/// Amount of copies of an advertisement after which a pending rebroadcast of it is cancelled
+#define REBROADCAST_SUPPRESSION_THRESHOLD 3
+
+using namespace std;
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    class PendingRebroadcast {
+    public:
+        uint32_t sequenceNumber;
+        /// Hops the copy that is going to be rebroadcast has travelled before reaching us
+        size_t distance;
+        /// Copies heard from nodes that are not farther away from the advertiser than us
+        unsigned int copies;
+        long due;
+        /// Empty if none of the copies heard so far is to be rebroadcast
+        optional<Advertisement> advertisement;
+        /// Whether or not the advertisement has been rebroadcast or suppressed already
+        bool completed = false;
+
+        PendingRebroadcast(uint32_t sequenceNumber, size_t distance, long due, optional<Advertisement> advertisement)
+                : sequenceNumber(sequenceNumber), distance(distance), copies(1), due(due),
+                  advertisement(std::move(advertisement)) {};
+    };
+
+    /// Delays rebroadcasts of advertisements by a random amount and cancels them if enough
+    /// neighbors rebroadcast the same advertisement in the meantime (counter-based flooding).
+    /// Copies are identified by the advertiser and the sequence number of the advertisement.
+    class RebroadcastScheduler {
+        unordered_map<cryptography::UUID, PendingRebroadcast> rebroadcasts;
+        minstd_rand random;
+        unsigned int threshold;
+
+    public:
+        explicit RebroadcastScheduler(unsigned long seed, unsigned int threshold = REBROADCAST_SUPPRESSION_THRESHOLD)
+                : random(seed), threshold(threshold) {};
+
+        /// Records a received copy of an advertisement (with ourselves appended to its route).
+        /// The first copy of an advertisement is scheduled for rebroadcast if the rebroadcast flag is set.
+        void record(const Advertisement &advertisement, bool rebroadcast, long currentTime);
+
+        /// Removes and returns the advertisements that are due and have not been suppressed
+        vector<Advertisement> takeDue(long currentTime);
+    };
+
+}
+
+#endif //PROTOMESH_REBROADCASTSCHEDULER_HPP
@@ -10,62 +10,153 @@ namespace ProtoMesh::communication::Routing::IARP {
 
     Result<RoutingTableEntry, RouteDiscoveryError>
     RoutingTable::getRouteTo(cryptography::UUID uuid) {
-        if (routes.find(uuid) != routes.end()) {
-            vector<RoutingTableEntry> &availableRoutes = routes.at(uuid);
+        vector<RoutingTableEntry> availableRoutes = this->getRoutesTo(uuid);
+        if (availableRoutes.empty())
+            return Err(RouteDiscoveryError::NO_ROUTE_AVAILABLE);
 
-            size_t routeIndex = 0;
-            size_t routeLength = 9999;
-            long currentTime = this->timeProvider->millis();
+        /// Pick the cheapest route, preferring the one that has been inserted first
+        auto cheapestRoute = min_element(availableRoutes.begin(), availableRoutes.end(),
+                                         [](const RoutingTableEntry &a, const RoutingTableEntry &b) {
+                                             return a.cost() < b.cost();
+                                         });
 
-            vector<size_t> staleRoutes;
-            for (size_t i = 0; i < availableRoutes.size(); i++) {
-                RoutingTableEntry route = availableRoutes[i];
+        return Ok(*cheapestRoute);
+    }
 
-                if (route.validUntil < currentTime) {
-                    staleRoutes.push_back(i);
-                    continue;
-                }
+    vector<RoutingTableEntry> RoutingTable::getRoutesTo(cryptography::UUID uuid) {
+        auto entry = routes.find(uuid);
+        if (entry == routes.end()) return {};
 
-                if (route.route.size() < routeLength) {
-                    routeLength = route.route.size();
-                    routeIndex = i;
-                }
-            }
+        vector<RoutingTableEntry> &availableRoutes = entry->second;
+        long currentTime = this->timeProvider->millis();
 
-            reverse(staleRoutes.begin(), staleRoutes.end());
+        availableRoutes.erase(remove_if(availableRoutes.begin(), availableRoutes.end(),
+                                        [currentTime](const RoutingTableEntry &route) {
+                                            return route.validUntil < currentTime;
+                                        }), availableRoutes.end());
 
-            if (staleRoutes.size() == availableRoutes.size()) {
-                /// Delete the whole entry in the map
-                routes.erase(uuid);
-                return Err(RouteDiscoveryError::NO_ROUTE_AVAILABLE);
-            } else {
-                /// Delete only the stale routes but keep the vector
-                for (size_t staleRoute : staleRoutes)
-                    availableRoutes.erase(availableRoutes.begin() + staleRoute);
-            }
+        if (availableRoutes.empty()) {
+            routes.erase(entry);
+            return {};
+        }
 
-            return Ok(availableRoutes[routeIndex]);
-        } else
-            return Err(RouteDiscoveryError::NO_ROUTE_AVAILABLE);
+        return availableRoutes;
+    }
+
+    size_t RoutingTable::removeRoutesVia(cryptography::UUID a, cryptography::UUID b) {
+        size_t removedRoutes = 0;
+
+        for (auto it = this->routes.begin(); it != this->routes.end();) {
+            vector<RoutingTableEntry> &availableRoutes = it->second;
+            size_t previousSize = availableRoutes.size();
+
+            availableRoutes.erase(remove_if(availableRoutes.begin(), availableRoutes.end(),
+                                            [&a, &b](const RoutingTableEntry &entry) {
+                                                for (size_t i = 0; i + 1 < entry.route.size(); i++)
+                                                    if ((entry.route[i] == a && entry.route[i + 1] == b) ||
+                                                        (entry.route[i] == b && entry.route[i + 1] == a))
+                                                        return true;
+                                                return false;
+                                            }), availableRoutes.end());
+
+            removedRoutes += previousSize - availableRoutes.size();
+            it = availableRoutes.empty() ? this->routes.erase(it) : next(it);
+        }
+
+        return removedRoutes;
     }
 
     void RoutingTable::processAdvertisement(Advertisement adv) {
-        long currentTime = this->timeProvider->millis();
+        this->insertRoute(RoutingTableEntry(adv, this->timeProvider->millis()));
+    }
+
+    void RoutingTable::insertRoute(const RoutingTableEntry &newEntry) {
+        cryptography::UUID destination = newEntry.route.back();
 
         /// Check if we already have a route for this target
-        if (routes.find(adv.uuid) != routes.end()) {
-            // Possibly add the new route entry
-            vector<RoutingTableEntry> &availableRoutes = routes.at(adv.uuid);
-            availableRoutes.emplace_back(adv, currentTime);
+        if (routes.find(destination) != routes.end()) {
+            vector<RoutingTableEntry> &availableRoutes = routes.at(destination);
+
+            /// Refresh the lifetime of a known route instead of storing it twice
+            auto knownRoute = find_if(availableRoutes.begin(), availableRoutes.end(),
+                                      [&newEntry](const RoutingTableEntry &entry) {
+                                          return entry.route == newEntry.route;
+                                      });
+
+            if (knownRoute != availableRoutes.end()) {
+                knownRoute->validUntil = max(knownRoute->validUntil, newEntry.validUntil);
+                knownRoute->metric = newEntry.metric;
+            } else
+                availableRoutes.push_back(newEntry);
         } else {
             /// Insert the route
-            vector<RoutingTableEntry> availableRoutes({RoutingTableEntry(adv, currentTime)});
-            routes.insert({adv.uuid, availableRoutes});
+            vector<RoutingTableEntry> availableRoutes({newEntry});
+            routes.insert({destination, availableRoutes});
+        }
+
+        /// Store the destination as a bordercast node if it is zoneRadius hops away
+        /// Since the route contains both, us and the destination, its size equals the radius
+        if (newEntry.route.size() == zoneRadius &&
+            find(this->bordercastNodes.begin(), this->bordercastNodes.end(), destination) == this->bordercastNodes.end())
+            this->bordercastNodes.push_back(destination);
+    }
+
+    vector<RoutingTableEntry> RoutingTable::getAllRoutes() {
+        long currentTime = this->timeProvider->millis();
+        vector<RoutingTableEntry> allRoutes;
+
+        for (const auto &entry : this->routes)
+            for (const RoutingTableEntry &route : entry.second)
+                if (route.validUntil >= currentTime) allRoutes.push_back(route);
+
+        return allRoutes;
+    }
+
+    void RoutingTable::setZoneRadius(uint zoneRadius) {
+        this->zoneRadius = zoneRadius;
+        this->bordercastNodes.clear();
+
+        for (const RoutingTableEntry &entry : this->getAllRoutes())
+            if (entry.route.size() == zoneRadius &&
+                find(this->bordercastNodes.begin(), this->bordercastNodes.end(), entry.route.back()) == this->bordercastNodes.end())
+                this->bordercastNodes.push_back(entry.route.back());
+    }
+
+    size_t RoutingTable::getZoneSize() {
+        long currentTime = this->timeProvider->millis();
+        size_t zoneSize = 0;
+
+        /// Routes to destinations beyond our radius are known if they are part of a larger zone nearby
+        for (const auto &entry : this->routes)
+            for (const RoutingTableEntry &route : entry.second)
+                if (route.validUntil >= currentTime && route.route.size() <= this->zoneRadius) {
+                    zoneSize++;
+                    break;
+                }
+
+        return zoneSize;
+    }
+
+    size_t RoutingTable::deleteExpiredRoutes() {
+        long currentTime = this->timeProvider->millis();
+        size_t deletedRoutes = 0;
+
+        for (auto it = this->routes.begin(); it != this->routes.end();) {
+            vector<RoutingTableEntry> &availableRoutes = it->second;
+            size_t previousSize = availableRoutes.size();
+
+            availableRoutes.erase(remove_if(availableRoutes.begin(), availableRoutes.end(),
+                                            [currentTime](const RoutingTableEntry &route) {
+                                                return route.validUntil < currentTime;
+                                            }), availableRoutes.end());
+            deletedRoutes += previousSize - availableRoutes.size();
+
+            if (availableRoutes.empty()) it = this->routes.erase(it);
+            else ++it;
         }
 
-        /// Store the nodeID as a bordercast node if it is zoneRadius hops away
-        /// Since the route in the advertisement does not contain the advertiser add one to the size
-        if (adv.route.size()+1 == zoneRadius) this->bordercastNodes.push_back(adv.uuid);
+        this->deleteStaleBordercastNodes();
+        return deletedRoutes;
     }
 
     void RoutingTable::deleteStaleBordercastNodes() {
@@ -80,26 +171,27 @@ namespace ProtoMesh::communication::Routing::IARP {
             this->bordercastNodes.erase(this->bordercastNodes.begin() + staleNodeIndex);
     }
 
-    vector<cryptography::UUID> RoutingTable::getBordercastNodes(vector<cryptography::UUID> nodesToExclude) {
+    vector<cryptography::UUID>
+    RoutingTable::getBordercastNodes(const function<bool(const cryptography::UUID &)> &isExcluded) {
         this->deleteStaleBordercastNodes();
 
         vector<cryptography::UUID> resultingNodes;
 
-        for (auto bordercastNode : this->bordercastNodes) {
-            for (auto excludedNode : nodesToExclude) {
-                if (bordercastNode == excludedNode) goto outerLoop;
-            }
-
-            resultingNodes.push_back(bordercastNode);
-
-            outerLoop:;
-        }
+        for (auto bordercastNode : this->bordercastNodes)
+            if (!isExcluded(bordercastNode))
+                resultingNodes.push_back(bordercastNode);
 
         return resultingNodes;
     }
 
+    vector<cryptography::UUID> RoutingTable::getBordercastNodes(vector<cryptography::UUID> nodesToExclude) {
+        return this->getBordercastNodes([&nodesToExclude](const cryptography::UUID &node) {
+            return find(nodesToExclude.begin(), nodesToExclude.end(), node) != nodesToExclude.end();
+        });
+    }
+
     vector<cryptography::UUID> RoutingTable::getBordercastNodes() {
-        return this->getBordercastNodes({});
+        return this->getBordercastNodes([](const cryptography::UUID &node) { return false; });
     }
 
 #ifdef UNIT_TESTING
@@ -145,6 +237,10 @@ namespace ProtoMesh::communication::Routing::IARP {
                     ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(6000);
                     table.processAdvertisement(adv);
 
+                    THEN("the known route should be refreshed instead of being stored twice") {
+                        REQUIRE(table.getRoutesTo(uuid).size() == 1);
+                    }
+
                     AND_WHEN("the time advances by another 5000ms") {
                         ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(5000);
 
@@ -172,6 +268,10 @@ namespace ProtoMesh::communication::Routing::IARP {
                         vector<cryptography::UUID> expectedRoute({hop2, hop1, uuid});
                         REQUIRE(route == expectedRoute);
                     }
+
+                    THEN("both routes should be available for route selection") {
+                        REQUIRE(table.getRoutesTo(uuid).size() == 2);
+                    }
                 }
             }
         }
@@ -231,6 +331,27 @@ namespace ProtoMesh::communication::Routing::IARP {
                     }
                 }
 
+                THEN("all of them should be part of the zone") {
+                    REQUIRE(table.getZoneSize() == 8);
+                }
+
+                AND_WHEN("the zone radius is reduced by one") {
+                    table.setZoneRadius(1);
+
+                    THEN("the closer nodes should have become the bordercast nodes") {
+                        vector<cryptography::UUID> bordercastNodes = table.getBordercastNodes();
+                        vector<cryptography::UUID> expectedNodes = {c, d, f, g};
+                        sort(bordercastNodes.begin(), bordercastNodes.end());
+                        sort(expectedNodes.begin(), expectedNodes.end());
+                        REQUIRE(bordercastNodes == expectedNodes);
+                    }
+
+                    THEN("the routes to the farther nodes should be retained outside of the zone") {
+                        REQUIRE(table.getZoneSize() == 4);
+                        REQUIRE(table.getRouteTo(a).isOk());
+                    }
+                }
+
                 AND_WHEN("the time advances by 20000ms") {
                     ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(20000);
                     THEN("add bordercast nodes should've been removed") {
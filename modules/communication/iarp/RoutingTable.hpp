@@ -3,10 +3,12 @@
 
 #include <vector>
 #include <utility>
-#include <unordered_map>
+#include <UUIDMap.hpp>
+#include <functional>
 #include <RelativeTimeProvider.hpp>
 
 #include "Advertisement.hpp"
+#include "LinkEstimator.hpp"
 
 using namespace std;
 using namespace ProtoMesh::communication;
@@ -17,12 +19,22 @@ namespace ProtoMesh::communication::Routing::IARP {
     public:
         long validUntil;
         vector<cryptography::UUID> route;
+        /// Cumulative link cost as reported by the advertisement
+        unsigned long metric;
 
         RoutingTableEntry(Advertisement adv, long currentTime)
-                : validUntil(currentTime + adv.interval), route(adv.route) {
+                : validUntil(currentTime + adv.interval), route(adv.route), metric(adv.pathMetric) {
             std::reverse(this->route.begin(), this->route.end());
             this->route.push_back(adv.uuid);
         };
+
+        RoutingTableEntry(vector<cryptography::UUID> route, long validUntil, unsigned long metric)
+                : validUntil(validUntil), route(std::move(route)), metric(metric) {};
+
+        /// Cost used to compare routes. Falls back to the hop count for advertisements without a path metric.
+        unsigned long cost() const {
+            return max(this->metric, (unsigned long) (this->route.size() - 1) * LINK_ETX_SCALE);
+        }
     };
 
     enum class RouteDiscoveryError {
@@ -30,7 +42,7 @@ namespace ProtoMesh::communication::Routing::IARP {
     };
 
     class RoutingTable {
-        unordered_map<cryptography::UUID, vector<RoutingTableEntry>> routes;
+        cryptography::UUIDMap<vector<RoutingTableEntry>> routes;
         vector<cryptography::UUID> bordercastNodes = {};
         REL_TIME_PROV_T timeProvider;
         uint zoneRadius;
@@ -38,12 +50,31 @@ namespace ProtoMesh::communication::Routing::IARP {
         void deleteStaleBordercastNodes();
 
     public:
-        explicit RoutingTable(REL_TIME_PROV_T timeProvider, uint zoneRadius = 4) : timeProvider(move(timeProvider)), zoneRadius(zoneRadius) {};
+        explicit RoutingTable(REL_TIME_PROV_T timeProvider, uint zoneRadius = ZONE_RADIUS) : timeProvider(move(timeProvider)), zoneRadius(zoneRadius) {};
+
+        uint getZoneRadius() const { return this->zoneRadius; }
+        /// Changes the radius and determines the bordercast nodes at the new radius from the known routes
+        void setZoneRadius(uint zoneRadius);
+        /// Amount of destinations within the zone radius
+        size_t getZoneSize();
 
         Result<RoutingTableEntry, RouteDiscoveryError> getRouteTo(cryptography::UUID uuid);
+        /// All routes to the target that have not yet expired
+        vector<RoutingTableEntry> getRoutesTo(cryptography::UUID uuid);
+
+        /// Removes all routes that contain the link between both nodes (in either direction).
+        /// Returns the amount of removed routes.
+        size_t removeRoutesVia(cryptography::UUID a, cryptography::UUID b);
 
         void processAdvertisement(Advertisement adv);
+        /// Inserts the route or refreshes it if it is already known
+        void insertRoute(const RoutingTableEntry &newEntry);
+        /// All routes that have not yet expired
+        vector<RoutingTableEntry> getAllRoutes();
+        /// Expired routes are only skipped when looked up, this deletes them. Returns the amount of deleted routes.
+        size_t deleteExpiredRoutes();
 
+        vector<cryptography::UUID> getBordercastNodes(const function<bool(const cryptography::UUID &)> &isExcluded);
         vector<cryptography::UUID> getBordercastNodes(vector<cryptography::UUID> nodesToExclude);
         vector<cryptography::UUID> getBordercastNodes();
     };
@@ -0,0 +1,129 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "ZoneRadiusController.hpp"
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    void ZoneRadiusController::recordAdvertisement(const Advertisement &advertisement, size_t distance,
+                                                   long currentTime) {
+        /// Radii beyond the maximum are not honored so that single devices can't flood the network
+        uint8_t radius = min<uint8_t>(advertisement.zoneRadius, ZONE_RADIUS_MAX);
+        if (distance > radius) return;
+
+        /// Tolerate a single lost advertisement before the zone is forgotten
+        long validUntil = currentTime + 2 * (long) advertisement.interval;
+        this->enclosingZones[advertisement.uuid] = {radius, validUntil};
+    }
+
+    uint8_t ZoneRadiusController::getPropagationRadius(long currentTime) {
+        uint8_t propagationRadius = this->zoneRadius;
+
+        for (auto it = this->enclosingZones.begin(); it != this->enclosingZones.end();) {
+            if (it->second.second < currentTime) {
+                it = this->enclosingZones.erase(it);
+                continue;
+            }
+
+            propagationRadius = max(propagationRadius, it->second.first);
+            ++it;
+        }
+
+        return propagationRadius;
+    }
+
+    bool ZoneRadiusController::adapt(size_t zoneSize, long currentTime) {
+        if (currentTime - this->intervalStart < ZONE_RADIUS_ADAPTATION_INTERVAL) return false;
+
+        uint8_t previousRadius = this->zoneRadius;
+
+        if (zoneSize > ZONE_RADIUS_SHRINK_ZONE_SIZE && this->zoneRadius > ZONE_RADIUS_MIN)
+            this->zoneRadius--;
+        else if (this->discoveries >= ZONE_RADIUS_GROW_DISCOVERY_COUNT && zoneSize < ZONE_RADIUS_GROW_ZONE_SIZE &&
+                 this->zoneRadius < ZONE_RADIUS_MAX)
+            this->zoneRadius++;
+
+        this->discoveries = 0;
+        this->intervalStart = currentTime;
+
+        return this->zoneRadius != previousRadius;
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("The zone radius should adapt to the surroundings of a device",
+             "[unit_test][module][communication][routing][iarp]") {
+        GIVEN("a controller with the default radius") {
+            ZoneRadiusController controller;
+
+            WHEN("the zone is crowded") {
+                THEN("the radius should not change before the interval has passed") {
+                    REQUIRE_FALSE(controller.adapt(ZONE_RADIUS_SHRINK_ZONE_SIZE + 1, ZONE_RADIUS_ADAPTATION_INTERVAL - 1));
+                    REQUIRE(controller.getZoneRadius() == ZONE_RADIUS);
+                }
+
+                THEN("the radius should shrink once per interval down to the minimum") {
+                    long time = 0;
+                    for (int i = ZONE_RADIUS; i > ZONE_RADIUS_MIN; i--) {
+                        time += ZONE_RADIUS_ADAPTATION_INTERVAL;
+                        REQUIRE(controller.adapt(ZONE_RADIUS_SHRINK_ZONE_SIZE + 1, time));
+                    }
+
+                    time += ZONE_RADIUS_ADAPTATION_INTERVAL;
+                    REQUIRE_FALSE(controller.adapt(ZONE_RADIUS_SHRINK_ZONE_SIZE + 1, time));
+                    REQUIRE(controller.getZoneRadius() == ZONE_RADIUS_MIN);
+                }
+            }
+
+            WHEN("many discoveries are dispatched from a sparse zone") {
+                for (int i = 0; i < ZONE_RADIUS_GROW_DISCOVERY_COUNT; i++)
+                    controller.recordDiscovery();
+
+                THEN("the radius should grow") {
+                    REQUIRE(controller.adapt(ZONE_RADIUS_GROW_ZONE_SIZE - 1, ZONE_RADIUS_ADAPTATION_INTERVAL));
+                    REQUIRE(controller.getZoneRadius() == ZONE_RADIUS + 1);
+
+                    AND_THEN("the discoveries should not count towards the next interval") {
+                        REQUIRE_FALSE(controller.adapt(ZONE_RADIUS_GROW_ZONE_SIZE - 1, 2 * ZONE_RADIUS_ADAPTATION_INTERVAL));
+                    }
+                }
+
+                THEN("the radius should be retained if the zone is between both thresholds") {
+                    REQUIRE_FALSE(controller.adapt(ZONE_RADIUS_GROW_ZONE_SIZE, ZONE_RADIUS_ADAPTATION_INTERVAL));
+                    REQUIRE(controller.getZoneRadius() == ZONE_RADIUS);
+                }
+            }
+
+            WHEN("an advertisement of a device with a larger zone arrives") {
+                Advertisement advertisement = Advertisement::build(cryptography::UUID(),
+                                                                   cryptography::asymmetric::generateKeyPair());
+                advertisement.zoneRadius = 6;
+                controller.recordAdvertisement(advertisement, 5, 0);
+
+                THEN("our advertisements should reach that device") {
+                    REQUIRE(controller.getPropagationRadius(0) == 6);
+                }
+
+                THEN("the larger zone should be forgotten once the device stops advertising") {
+                    REQUIRE(controller.getPropagationRadius(2 * advertisement.interval + 1) == ZONE_RADIUS);
+                }
+            }
+
+            WHEN("an advertisement of a device with a larger zone that does not include us arrives") {
+                Advertisement advertisement = Advertisement::build(cryptography::UUID(),
+                                                                   cryptography::asymmetric::generateKeyPair());
+                advertisement.zoneRadius = 6;
+                controller.recordAdvertisement(advertisement, 7, 0);
+
+                THEN("the propagation radius should not change") {
+                    REQUIRE(controller.getPropagationRadius(0) == ZONE_RADIUS);
+                }
+            }
+        }
+    }
+
+#endif
+}
@@ -0,0 +1,57 @@
+#ifndef PROTOMESH_ZONERADIUSCONTROLLER_HPP
+#define PROTOMESH_ZONERADIUSCONTROLLER_HPP
+
+#include <utility>
+
+#include "uuid.hpp"
+#include "UUIDMap.hpp"
+#include "Advertisement.hpp"
+
+/// Bounds of the adaptive zone radius. A radius of two only includes the direct neighbors.
+#define ZONE_RADIUS_MIN 2
+#define ZONE_RADIUS_MAX 8
+/// Time in milliseconds over which discoveries are counted before the radius is reconsidered
+#define ZONE_RADIUS_ADAPTATION_INTERVAL 60000
+/// The radius shrinks while the zone contains more destinations than this
+#define ZONE_RADIUS_SHRINK_ZONE_SIZE 32
+/// The radius only grows while the zone contains less destinations than this.
+/// The gap to ZONE_RADIUS_SHRINK_ZONE_SIZE keeps a grown zone from shrinking right away.
+#define ZONE_RADIUS_GROW_ZONE_SIZE 12
+/// The radius grows if at least this many route discoveries have been dispatched within one interval
+#define ZONE_RADIUS_GROW_DISCOVERY_COUNT 3
+
+namespace ProtoMesh::communication::Routing::IARP {
+
+    /// Adapts the zone radius of a device to its surroundings.
+    /// Dense areas shrink the zone to limit the amount of advertisements while frequent route discoveries
+    /// in sparse areas grow it so that more destinations can be reached without a discovery.
+    /// Also keeps track of the zones of other devices we are part of since our advertisements have to reach them.
+    class ZoneRadiusController {
+        uint8_t zoneRadius;
+        /// Radius of the zones we are part of and until when they are considered current, indexed by their owner
+        cryptography::UUIDMap<pair<uint8_t, long>> enclosingZones;
+        unsigned int discoveries = 0;
+        long intervalStart = 0;
+
+    public:
+        explicit ZoneRadiusController(uint8_t zoneRadius = ZONE_RADIUS) : zoneRadius(zoneRadius) {};
+
+        uint8_t getZoneRadius() const { return this->zoneRadius; }
+        void setZoneRadius(uint8_t zoneRadius) { this->zoneRadius = zoneRadius; }
+
+        void recordDiscovery() { this->discoveries++; }
+
+        /// Records an advertisement that traversed the given amount of nodes (including the advertiser and us)
+        void recordAdvertisement(const Advertisement &advertisement, size_t distance, long currentTime);
+
+        /// Radius our advertisements have to reach: our own one or that of the largest zone we are part of
+        uint8_t getPropagationRadius(long currentTime);
+
+        /// Reconsiders the radius once per interval given the current amount of destinations within the zone.
+        /// Returns whether or not the radius changed.
+        bool adapt(size_t zoneSize, long currentTime);
+    };
+
+}
+
+#endif //PROTOMESH_ZONERADIUSCONTROLLER_HPP
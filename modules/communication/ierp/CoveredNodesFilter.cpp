@@ -0,0 +1,102 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include <cmath>
+#include <bitset>
+
+#include "CoveredNodesFilter.hpp"
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    void CoveredNodesFilter::insert(const cryptography::UUID &node) {
+        for (uint64_t i = 0; i < COVERED_NODES_FILTER_HASHES; i++) {
+            uint64_t bit = node.hash(i) % (COVERED_NODES_FILTER_SIZE * 8);
+            this->bits[bit / 8] |= 1 << (bit % 8);
+        }
+    }
+
+    bool CoveredNodesFilter::contains(const cryptography::UUID &node) const {
+        for (uint64_t i = 0; i < COVERED_NODES_FILTER_HASHES; i++) {
+            uint64_t bit = node.hash(i) % (COVERED_NODES_FILTER_SIZE * 8);
+            if (!(this->bits[bit / 8] & (1 << (bit % 8)))) return false;
+        }
+
+        return true;
+    }
+
+    bool CoveredNodesFilter::setBits(const vector<uint8_t> &buffer) {
+        if (buffer.size() != COVERED_NODES_FILTER_SIZE) return false;
+        copy(buffer.begin(), buffer.end(), this->bits.begin());
+        return true;
+    }
+
+    double CoveredNodesFilter::falsePositiveRate(size_t insertedNodes) {
+        double bitCount = COVERED_NODES_FILTER_SIZE * 8;
+        double unsetProbability = exp(-(double) COVERED_NODES_FILTER_HASHES * insertedNodes / bitCount);
+        return pow(1 - unsetProbability, COVERED_NODES_FILTER_HASHES);
+    }
+
+    double CoveredNodesFilter::getFalsePositiveRate() const {
+        size_t setBits = 0;
+        for (uint8_t byte : this->bits)
+            setBits += bitset<8>(byte).count();
+
+        return pow((double) setBits / (COVERED_NODES_FILTER_SIZE * 8), COVERED_NODES_FILTER_HASHES);
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Covered nodes should be tracked in a constant size filter",
+             "[unit_test][module][communication][routing][ierp]") {
+        GIVEN("A covered nodes filter with 20 inserted nodes") {
+            CoveredNodesFilter filter;
+            for (uint32_t i = 1; i <= 20; i++)
+                filter.insert(cryptography::UUID::fromNumber(i));
+
+            THEN("all inserted nodes should be contained") {
+                for (uint32_t i = 1; i <= 20; i++)
+                    REQUIRE(filter.contains(cryptography::UUID::fromNumber(i)));
+            }
+
+            THEN("the false positive rate for other nodes should be close to the expected rate") {
+                size_t falsePositives = 0;
+                size_t samples = 10000;
+                for (uint32_t i = 1000; i < 1000 + samples; i++)
+                    if (filter.contains(cryptography::UUID::fromNumber(i))) falsePositives++;
+
+                double falsePositiveRate = (double) falsePositives / samples;
+                double expectedRate = CoveredNodesFilter::falsePositiveRate(20);
+                CAPTURE(falsePositiveRate);
+                CAPTURE(expectedRate);
+
+                REQUIRE(falsePositiveRate <= 3 * expectedRate);
+            }
+
+            THEN("the rate derived from its bits should be close to the expected rate") {
+                REQUIRE(filter.getFalsePositiveRate() > CoveredNodesFilter::falsePositiveRate(20) / 3);
+                REQUIRE(filter.getFalsePositiveRate() < CoveredNodesFilter::falsePositiveRate(20) * 3);
+                REQUIRE(CoveredNodesFilter().getFalsePositiveRate() == 0);
+            }
+
+            WHEN("its bits are copied into another filter") {
+                CoveredNodesFilter copiedFilter;
+                vector<uint8_t> bits(filter.getBits().begin(), filter.getBits().end());
+
+                THEN("both filters should be equal") {
+                    REQUIRE(copiedFilter.setBits(bits));
+                    REQUIRE(copiedFilter == filter);
+                }
+
+                THEN("buffers of a different size should be rejected") {
+                    bits.push_back(0);
+                    REQUIRE_FALSE(copiedFilter.setBits(bits));
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
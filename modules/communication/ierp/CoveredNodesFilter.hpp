@@ -0,0 +1,45 @@
+#ifndef PROTOMESH_COVEREDNODESFILTER_HPP
+#define PROTOMESH_COVEREDNODESFILTER_HPP
+
+#include <array>
+#include <vector>
+
+#include "uuid.hpp"
+
+/// Size of the filter in bytes. 64 bytes keep the false positive rate below 1% for up to 40 covered nodes,
+/// route discoveries list further nodes explicitly (see ROUTE_DISCOVERY_FILTER_MAX_FALSE_POSITIVE_RATE).
+#define COVERED_NODES_FILTER_SIZE 64
+/// Amount of bits set per inserted node
+#define COVERED_NODES_FILTER_HASHES 3
+
+using namespace std;
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    /// Constant size bloom filter of the nodes a route discovery has already been sent to.
+    /// Membership tests may yield false positives but never false negatives.
+    class CoveredNodesFilter {
+        array<uint8_t, COVERED_NODES_FILTER_SIZE> bits = {};
+
+    public:
+        CoveredNodesFilter() = default;
+
+        void insert(const cryptography::UUID &node);
+        bool contains(const cryptography::UUID &node) const;
+
+        const array<uint8_t, COVERED_NODES_FILTER_SIZE> &getBits() const { return this->bits; }
+        /// Returns false if the buffer does not match the filter size
+        bool setBits(const vector<uint8_t> &buffer);
+
+        /// Expected false positive rate after the given amount of nodes have been inserted
+        static double falsePositiveRate(size_t insertedNodes);
+        /// False positive rate of the filter in its current state, derived from the share of set bits.
+        /// Unlike falsePositiveRate it does not require the amount of inserted nodes to be known.
+        double getFalsePositiveRate() const;
+
+        inline bool operator==(const CoveredNodesFilter &other) const { return this->bits == other.bits; }
+    };
+
+}
+
+#endif //PROTOMESH_COVEREDNODESFILTER_HPP
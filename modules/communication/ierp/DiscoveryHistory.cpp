@@ -0,0 +1,64 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "DiscoveryHistory.hpp"
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    bool DiscoveryHistory::insert(cryptography::UUID origin, uint32_t sequenceNumber, long currentTime) {
+        uint64_t fingerprint = origin.hash(sequenceNumber);
+
+        for (const Entry &entry : this->ring)
+            if (entry.fingerprint == fingerprint && entry.expiresAt >= currentTime)
+                return false;
+
+        this->ring[this->nextIndex] = {fingerprint, currentTime + this->lifetime};
+        this->nextIndex = (this->nextIndex + 1) % this->ring.size();
+
+        return true;
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Duplicate route discoveries should be detected",
+             "[unit_test][module][communication][routing][ierp]") {
+        GIVEN("A discovery history with a capacity of two") {
+            DiscoveryHistory history(2, 1000);
+            cryptography::UUID origin;
+            cryptography::UUID otherOrigin;
+
+            WHEN("a discovery is inserted") {
+                REQUIRE(history.insert(origin, 1, 0));
+
+                THEN("inserting it again should be rejected") {
+                    REQUIRE_FALSE(history.insert(origin, 1, 500));
+                }
+
+                THEN("discoveries with another sequence number or origin should be accepted") {
+                    REQUIRE(history.insert(origin, 2, 0));
+                    REQUIRE(history.insert(otherOrigin, 1, 0));
+                }
+
+                AND_WHEN("its lifetime has passed") {
+                    THEN("it should be accepted again") {
+                        REQUIRE(history.insert(origin, 1, 1001));
+                    }
+                }
+
+                AND_WHEN("the ring has been exhausted by other discoveries") {
+                    history.insert(origin, 2, 0);
+                    history.insert(origin, 3, 0);
+
+                    THEN("the oldest discovery should have been forgotten") {
+                        REQUIRE(history.insert(origin, 1, 0));
+                    }
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
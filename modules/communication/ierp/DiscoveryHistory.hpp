@@ -0,0 +1,41 @@
+#ifndef PROTOMESH_DISCOVERYHISTORY_HPP
+#define PROTOMESH_DISCOVERYHISTORY_HPP
+
+#include <vector>
+#include <climits>
+
+#include "uuid.hpp"
+
+/// Amount of route discoveries remembered per node
+#define DISCOVERY_HISTORY_SIZE 64
+/// Time in milliseconds after which a remembered route discovery is forgotten
+#define DISCOVERY_HISTORY_LIFETIME 30000
+
+using namespace std;
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    /// Time-bounded set of route discoveries that have been seen recently.
+    /// Implemented as a fixed size ring of fingerprints so that memory usage is constant and
+    /// the oldest discoveries are forgotten first when the ring is exhausted.
+    class DiscoveryHistory {
+        struct Entry {
+            uint64_t fingerprint;
+            long expiresAt;
+        };
+
+        vector<Entry> ring;
+        size_t nextIndex = 0;
+        long lifetime;
+
+    public:
+        explicit DiscoveryHistory(size_t capacity = DISCOVERY_HISTORY_SIZE, long lifetime = DISCOVERY_HISTORY_LIFETIME)
+                : ring(capacity, {0, LONG_MIN}), lifetime(lifetime) {};
+
+        /// Remembers the discovery and returns false if it has already been seen within its lifetime
+        bool insert(cryptography::UUID origin, uint32_t sequenceNumber, long currentTime);
+    };
+
+}
+
+#endif //PROTOMESH_DISCOVERYHISTORY_HPP
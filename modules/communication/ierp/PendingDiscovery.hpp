@@ -0,0 +1,35 @@
+#ifndef PROTOMESH_PENDINGDISCOVERY_HPP
+#define PROTOMESH_PENDINGDISCOVERY_HPP
+
+/// Time in milliseconds to wait for a route discovery acknowledgement before the first retry
+#define ROUTE_DISCOVERY_TIMEOUT 2000
+/// Amount of retries after which the payloads queued for a destination are given up on
+#define ROUTE_DISCOVERY_MAX_RETRIES 3
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    /// Keeps track of a route discovery that has been dispatched but not yet acknowledged.
+    /// The timeout doubles with every retry (exponential backoff).
+    class PendingDiscovery {
+    public:
+        long startedAt;
+        long nextAttemptAt;
+        long timeout;
+        unsigned int retries = 0;
+
+        PendingDiscovery(long currentTime, long timeout = ROUTE_DISCOVERY_TIMEOUT)
+                : startedAt(currentTime), nextAttemptAt(currentTime + timeout), timeout(timeout) {};
+
+        inline bool isDue(long currentTime) const { return currentTime >= this->nextAttemptAt; }
+        inline bool isExhausted() const { return this->retries >= ROUTE_DISCOVERY_MAX_RETRIES; }
+
+        inline void backoff(long currentTime) {
+            this->retries++;
+            this->timeout *= 2;
+            this->nextAttemptAt = currentTime + this->timeout;
+        }
+    };
+
+}
+
+#endif //PROTOMESH_PENDINGDISCOVERY_HPP
@@ -0,0 +1,66 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "RepairBuffer.hpp"
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    optional<PendingRepair> RepairBuffer::insert(Message message, cryptography::UUID unreachableHop, long currentTime) {
+        return this->insert(PendingRepair(std::move(message), unreachableHop, currentTime + this->timeout));
+    }
+
+    optional<PendingRepair> RepairBuffer::insert(PendingRepair repair) {
+        if (this->capacity == 0) return repair;
+
+        optional<PendingRepair> evictedRepair;
+        if (this->entries.size() >= this->capacity) {
+            evictedRepair = this->entries.front();
+            this->entries.pop_front();
+        }
+
+        this->entries.push_back(std::move(repair));
+        return evictedRepair;
+    }
+
+    vector<PendingRepair> RepairBuffer::takeAll() {
+        vector<PendingRepair> repairs(make_move_iterator(this->entries.begin()), make_move_iterator(this->entries.end()));
+        this->entries.clear();
+        return repairs;
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Relays should hold a bounded amount of messages for repair",
+             "[unit_test][module][communication][routing][ierp]") {
+        GIVEN("a repair buffer with a capacity of two") {
+            RepairBuffer buffer(2, 1000);
+            cryptography::UUID origin, relay, unreachableHop, destination;
+            SIGNATURE_T signature{};
+            Message message({origin, relay, unreachableHop, destination}, {1, 2, 3}, signature);
+
+            WHEN("two messages are held") {
+                REQUIRE_FALSE(buffer.insert(message, unreachableHop, 0).has_value());
+                REQUIRE_FALSE(buffer.insert(message, unreachableHop, 500).has_value());
+
+                THEN("a third one should evict the oldest") {
+                    auto evictedRepair = buffer.insert(message, unreachableHop, 600);
+                    REQUIRE(evictedRepair.has_value());
+                    REQUIRE(evictedRepair->deadline == 1000);
+                    REQUIRE(buffer.size() == 2);
+                }
+
+                THEN("taking all of them should empty the buffer") {
+                    vector<PendingRepair> repairs = buffer.takeAll();
+                    REQUIRE(repairs.size() == 2);
+                    REQUIRE(repairs[1].deadline == 1500);
+                    REQUIRE(buffer.empty());
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
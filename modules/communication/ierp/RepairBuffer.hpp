@@ -0,0 +1,55 @@
+#ifndef PROTOMESH_REPAIRBUFFER_HPP
+#define PROTOMESH_REPAIRBUFFER_HPP
+
+#include <deque>
+#include <vector>
+#include <optional>
+
+#include "uuid.hpp"
+#include "Message.hpp"
+
+/// Amount of messages a relay holds while attempting to repair their route
+#define REPAIR_BUFFER_SIZE 16
+/// Time in milliseconds a relay waits for a route to a later hop before reporting a delivery failure
+#define REPAIR_TIMEOUT 3000
+
+using namespace std;
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    class PendingRepair {
+    public:
+        Message message;
+        cryptography::UUID unreachableHop;
+        long deadline;
+
+        PendingRepair(Message message, cryptography::UUID unreachableHop, long deadline)
+                : message(std::move(message)), unreachableHop(unreachableHop), deadline(deadline) {};
+    };
+
+    /// Messages a relay was unable to forward and which are held until a route to one of
+    /// their remaining hops appears in the zone or the repair times out.
+    class RepairBuffer {
+        deque<PendingRepair> entries;
+        size_t capacity;
+        long timeout;
+
+    public:
+        explicit RepairBuffer(size_t capacity = REPAIR_BUFFER_SIZE, long timeout = REPAIR_TIMEOUT)
+                : capacity(capacity), timeout(timeout) {};
+
+        /// Holds the message and returns the oldest held one if it had to be evicted to make room
+        optional<PendingRepair> insert(Message message, cryptography::UUID unreachableHop, long currentTime);
+        /// Reinserts a repair that is still pending while retaining its deadline
+        optional<PendingRepair> insert(PendingRepair repair);
+
+        /// Removes and returns all held messages
+        vector<PendingRepair> takeAll();
+
+        bool empty() const { return this->entries.empty(); }
+        size_t size() const { return this->entries.size(); }
+    };
+
+}
+
+#endif //PROTOMESH_REPAIRBUFFER_HPP
@@ -8,7 +8,45 @@
 
 namespace ProtoMesh::communication::Routing::IERP {
 
+    void RouteCache::deleteStaleRoutes(cryptography::UUID destination) {
+        auto entry = routes.find(destination);
+        if (entry == routes.end()) return;
+
+        vector<RouteCacheEntry> &availableRoutes = entry->second;
+        long currentTime = this->timeProvider->millis();
+
+        availableRoutes.erase(remove_if(availableRoutes.begin(), availableRoutes.end(),
+                                        [currentTime](const RouteCacheEntry &route) {
+                                            return route.validUntil < currentTime;
+                                        }), availableRoutes.end());
+
+        if (availableRoutes.empty()) routes.erase(entry);
+    }
+
+    size_t RouteCache::deleteExpiredRoutes() {
+        long currentTime = this->timeProvider->millis();
+        size_t deletedRoutes = 0;
+
+        for (auto it = this->routes.begin(); it != this->routes.end();) {
+            vector<RouteCacheEntry> &availableRoutes = it->second;
+            size_t previousSize = availableRoutes.size();
+
+            availableRoutes.erase(remove_if(availableRoutes.begin(), availableRoutes.end(),
+                                            [currentTime](const RouteCacheEntry &route) {
+                                                return route.validUntil < currentTime;
+                                            }), availableRoutes.end());
+            deletedRoutes += previousSize - availableRoutes.size();
+
+            if (availableRoutes.empty()) it = this->routes.erase(it);
+            else ++it;
+        }
+
+        return deletedRoutes;
+    }
+
     Result<RouteCacheEntry, RouteCache::RouteCacheError> RouteCache::getRouteTo(cryptography::UUID uuid) {
+        this->deleteStaleRoutes(uuid);
+
         if (routes.find(uuid) != routes.end()) {
             vector<RouteCacheEntry> &availableRoutes = routes.at(uuid);
 
@@ -29,16 +67,82 @@ namespace ProtoMesh::communication::Routing::IERP {
             return Err(RouteCacheError::NO_ROUTE_AVAILABLE);
     }
 
-    void RouteCache::addRoute(cryptography::UUID destination, vector<cryptography::UUID> route) {
+    vector<RouteCacheEntry> RouteCache::getRoutesTo(cryptography::UUID uuid) {
+        this->deleteStaleRoutes(uuid);
+
+        auto entry = routes.find(uuid);
+        if (entry == routes.end()) return {};
+
+        return entry->second;
+    }
+
+    vector<RouteCacheEntry> RouteCache::getAllRoutes() {
+        long currentTime = this->timeProvider->millis();
+        vector<RouteCacheEntry> allRoutes;
+
+        for (const auto &entry : this->routes)
+            for (const RouteCacheEntry &route : entry.second)
+                if (route.validUntil >= currentTime) allRoutes.push_back(route);
+
+        return allRoutes;
+    }
+
+    size_t RouteCache::removeRoutesVia(cryptography::UUID a, cryptography::UUID b) {
+        size_t removedRoutes = 0;
+
+        for (auto it = this->routes.begin(); it != this->routes.end();) {
+            vector<RouteCacheEntry> &availableRoutes = it->second;
+            size_t previousSize = availableRoutes.size();
+
+            availableRoutes.erase(remove_if(availableRoutes.begin(), availableRoutes.end(),
+                                            [&a, &b](const RouteCacheEntry &entry) {
+                                                for (size_t i = 0; i + 1 < entry.route.size(); i++)
+                                                    if ((entry.route[i] == a && entry.route[i + 1] == b) ||
+                                                        (entry.route[i] == b && entry.route[i + 1] == a))
+                                                        return true;
+                                                return false;
+                                            }), availableRoutes.end());
+
+            removedRoutes += previousSize - availableRoutes.size();
+            it = availableRoutes.empty() ? this->routes.erase(it) : next(it);
+        }
+
+        return removedRoutes;
+    }
+
+    void RouteCache::addRoute(cryptography::UUID destination, vector<cryptography::UUID> route, long lifetime,
+                              bool learned) {
+        this->deleteStaleRoutes(destination);
+        long validUntil = this->timeProvider->millis() + lifetime;
 
         /// Check if we already have a route for this target
         if (routes.find(destination) != routes.end()) {
-            // Possibly add the new route entry
             vector<RouteCacheEntry> &availableRoutes = routes.at(destination);
-            availableRoutes.emplace_back(route, 0);
+
+            /// Refresh the lifetime if the route is already known
+            for (RouteCacheEntry &entry : availableRoutes) {
+                if (entry.route == route) {
+                    entry.validUntil = max(entry.validUntil, validUntil);
+                    entry.learned = entry.learned && learned;
+                    return;
+                }
+            }
+
+            if (availableRoutes.size() < this->maxRoutesPerDestination) {
+                availableRoutes.emplace_back(route, validUntil, learned);
+                return;
+            }
+
+            /// Replace the route that would expire first
+            auto oldest = min_element(availableRoutes.begin(), availableRoutes.end(),
+                                      [](const RouteCacheEntry &a, const RouteCacheEntry &b) {
+                                          return a.validUntil < b.validUntil;
+                                      });
+            if (oldest->validUntil < validUntil)
+                *oldest = RouteCacheEntry(route, validUntil, learned);
         } else {
             /// Insert the route
-            vector<RouteCacheEntry> availableRoutes({RouteCacheEntry(route, 0)});
+            vector<RouteCacheEntry> availableRoutes({RouteCacheEntry(route, validUntil, learned)});
             routes.insert({destination, availableRoutes});
         }
     }
@@ -48,7 +152,8 @@ namespace ProtoMesh::communication::Routing::IERP {
     SCENARIO("Discovered routes should be cached",
              "[unit_test][module][communication][routing][ierp]") {
         GIVEN("A RouteCache and a route") {
-            RouteCache routeCache;
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            RouteCache routeCache(timeProvider, 2);
             cryptography::UUID hop1; // us
             cryptography::UUID hop2;
             cryptography::UUID hop3; // destination
@@ -64,6 +169,58 @@ namespace ProtoMesh::communication::Routing::IERP {
                 THEN("retrieving the route should yield the original route") {
                     REQUIRE(routeCache.getRouteTo(hop3).unwrap().route == route);
                 }
+
+                AND_WHEN("the time advances beyond the lifetime of the route") {
+                    ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(ROUTE_CACHE_LIFETIME + 1);
+
+                    THEN("the route should've gone stale") {
+                        REQUIRE(routeCache.getRouteTo(hop3).isErr());
+                    }
+                }
+
+                AND_WHEN("the same route is added again with a shorter lifetime") {
+                    routeCache.addRoute(hop3, route, 1000);
+                    ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(2000);
+
+                    THEN("the original lifetime should be retained") {
+                        REQUIRE(routeCache.getRouteTo(hop3).isOk());
+                    }
+                }
+            }
+
+            WHEN("more routes than allowed are added for the same destination") {
+                cryptography::UUID hop4;
+                cryptography::UUID hop5;
+                routeCache.addRoute(hop3, {hop1, hop4, hop5, hop2, hop3}, 1000);
+                routeCache.addRoute(hop3, {hop1, hop4, hop3}, 2000);
+                routeCache.addRoute(hop3, route, 3000);
+
+                THEN("the route that would expire first should've been replaced") {
+                    ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(1500);
+                    REQUIRE(routeCache.getRouteTo(hop3).unwrap().route == route);
+
+                    AND_WHEN("the time advances beyond the lifetime of all routes") {
+                        ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(2000);
+
+                        THEN("no route should be available") {
+                            REQUIRE(routeCache.getRouteTo(hop3).isErr());
+                        }
+                    }
+                }
+            }
+
+            WHEN("two routes are cached and the link of one of them breaks") {
+                cryptography::UUID hop4;
+                vector<cryptography::UUID> alternativeRoute = {hop1, hop4, hop3};
+                routeCache.addRoute(hop3, route);
+                routeCache.addRoute(hop3, alternativeRoute);
+
+                REQUIRE(routeCache.removeRoutesVia(hop3, hop2) == 1);
+
+                THEN("only the alternative route should remain") {
+                    REQUIRE(routeCache.getRoutesTo(hop3).size() == 1);
+                    REQUIRE(routeCache.getRouteTo(hop3).unwrap().route == alternativeRoute);
+                }
             }
         }
     }
@@ -3,9 +3,15 @@
 
 #include <utility>
 
-#include <unordered_map>
 #include "asymmetric.hpp"
+#include "UUIDMap.hpp"
 #include "uuid.hpp"
+#include "RelativeTimeProvider.hpp"
+
+/// Time in milliseconds a route obtained through a route discovery stays valid
+#define ROUTE_CACHE_LIFETIME 60000
+/// Upper bound of routes that are kept per destination
+#define ROUTE_CACHE_MAX_ROUTES_PER_DESTINATION 4
 
 namespace ProtoMesh::communication::Routing::IERP {
 
@@ -13,21 +19,44 @@ namespace ProtoMesh::communication::Routing::IERP {
     public:
         long validUntil;
         vector<cryptography::UUID> route;
+        /// Whether or not the route has been learned from relayed traffic instead of a discovery of our own
+        bool learned;
 
-        RouteCacheEntry(vector<cryptography::UUID> route, long validUntil)
-                : validUntil(validUntil), route(std::move(route)) {}
+        RouteCacheEntry(vector<cryptography::UUID> route, long validUntil, bool learned = false)
+                : validUntil(validUntil), route(std::move(route)), learned(learned) {}
     };
 
     class RouteCache {
-        unordered_map<cryptography::UUID, vector<RouteCacheEntry>> routes;
+        cryptography::UUIDMap<vector<RouteCacheEntry>> routes;
+        REL_TIME_PROV_T timeProvider;
+        size_t maxRoutesPerDestination;
+
+        void deleteStaleRoutes(cryptography::UUID destination);
 
     public:
         enum class RouteCacheError {
             NO_ROUTE_AVAILABLE
         };
 
-        void addRoute(cryptography::UUID destination, vector<cryptography::UUID> route);
+        explicit RouteCache(REL_TIME_PROV_T timeProvider,
+                            size_t maxRoutesPerDestination = ROUTE_CACHE_MAX_ROUTES_PER_DESTINATION)
+                : timeProvider(std::move(timeProvider)), maxRoutesPerDestination(maxRoutesPerDestination) {};
+
+        /// Inserts the route or refreshes its lifetime if it is already known.
+        /// When the destination is at capacity the entry that expires first is replaced.
+        void addRoute(cryptography::UUID destination, vector<cryptography::UUID> route,
+                      long lifetime = ROUTE_CACHE_LIFETIME, bool learned = false);
         Result<RouteCacheEntry, RouteCacheError> getRouteTo(cryptography::UUID uuid);
+        /// All routes to the destination that have not yet expired
+        vector<RouteCacheEntry> getRoutesTo(cryptography::UUID uuid);
+        /// All routes that have not yet expired. Every route ends with its destination.
+        vector<RouteCacheEntry> getAllRoutes();
+        /// Expired routes are only skipped when looked up, this deletes them. Returns the amount of deleted routes.
+        size_t deleteExpiredRoutes();
+
+        /// Removes all routes that contain the link between both nodes (in either direction).
+        /// Returns the amount of removed routes.
+        size_t removeRoutesVia(cryptography::UUID a, cryptography::UUID b);
     };
 
 }
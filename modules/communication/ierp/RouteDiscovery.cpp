@@ -9,7 +9,21 @@
 namespace ProtoMesh::communication::Routing::IERP {
 
     void RouteDiscovery::addCoveredNodes(const vector<cryptography::UUID> &nodes) {
-        this->coveredNodes.insert(this->coveredNodes.end(), nodes.begin(), nodes.end());
+        for (auto &node : nodes) {
+            /// The filter has a constant size so it only takes nodes while its false positive rate is acceptable
+            if (this->version >= ROUTE_DISCOVERY_VERSION_FILTER &&
+                this->coveredNodesFilter.getFalsePositiveRate() < ROUTE_DISCOVERY_FILTER_MAX_FALSE_POSITIVE_RATE)
+                this->coveredNodesFilter.insert(node);
+            else
+                this->coveredNodes.push_back(node);
+        }
+    }
+
+    bool RouteDiscovery::isCovered(const cryptography::UUID &node) const {
+        if (this->version >= ROUTE_DISCOVERY_VERSION_FILTER && this->coveredNodesFilter.contains(node))
+            return true;
+
+        return find(this->coveredNodes.begin(), this->coveredNodes.end(), node) != this->coveredNodes.end();
     }
 
     void RouteDiscovery::addHop(cryptography::UUID hop) {
@@ -29,6 +43,14 @@ namespace ProtoMesh::communication::Routing::IERP {
         for (auto node : this->coveredNodes) coveredNodesList.push_back(node.toScheme());
         auto coveredNodesVector = builder.CreateVectorOfStructs(coveredNodesList);
 
+        /// Only serialize the filter when it is in use. Note that coveredNodes is always present so that
+        /// version 1 nodes are able to parse the datagram.
+        flatbuffers::Offset<flatbuffers::Vector<uint8_t>> coveredNodesFilterVector = 0;
+        if (this->version >= ROUTE_DISCOVERY_VERSION_FILTER) {
+            auto &filterBits = this->coveredNodesFilter.getBits();
+            coveredNodesFilterVector = builder.CreateVector(filterBits.data(), filterBits.size());
+        }
+
         vector<scheme::cryptography::UUID> routeEntries;
         for (auto hop : this->route) routeEntries.push_back(hop.toScheme());
         auto routeVector = builder.CreateVectorOfStructs(routeEntries);
@@ -38,7 +60,10 @@ namespace ProtoMesh::communication::Routing::IERP {
                                                            originKey,
                                                            &destinationID,
                                                            routeVector,
-                                                           sentTimestamp
+                                                           sentTimestamp,
+                                                           sequenceNumber,
+                                                           version,
+                                                           coveredNodesFilterVector
         );
 
         /// Convert it to a byte array
@@ -66,8 +91,9 @@ namespace ProtoMesh::communication::Routing::IERP {
         /// Deserialize the covered nodes list
         vector<cryptography::UUID> coveredNodes;
         auto coveredNodesBuffer = adv->coveredNodes();
-        for (uint i = 0; i < coveredNodesBuffer->Length(); i++)
-            coveredNodes.emplace_back(coveredNodesBuffer->Get(i));
+        if (coveredNodesBuffer)
+            for (uint i = 0; i < coveredNodesBuffer->Length(); i++)
+                coveredNodes.emplace_back(coveredNodesBuffer->Get(i));
 
         /// Deserialize origins public key
         auto originKeyBuffer = adv->origin();
@@ -85,7 +111,21 @@ namespace ProtoMesh::communication::Routing::IERP {
         for (uint i = 0; i < routeBuffer->Length(); i++)
             route.emplace_back(routeBuffer->Get(i));
 
-        return Ok(RouteDiscovery(originKey.unwrap(), destinationID, adv->sentTimestamp(), route, coveredNodes));
+        RouteDiscovery routeDiscovery(originKey.unwrap(), destinationID, adv->sentTimestamp(), route, {},
+                                      adv->sequenceNumber(), adv->version());
+        routeDiscovery.coveredNodes = coveredNodes;
+
+        /// Deserialize the covered nodes filter
+        if (routeDiscovery.version >= ROUTE_DISCOVERY_VERSION_FILTER) {
+            if (!adv->coveredNodesFilter())
+                return Err(DeserializationError::INVALID_BUFFER);
+
+            vector<uint8_t> filterBits(adv->coveredNodesFilter()->begin(), adv->coveredNodesFilter()->end());
+            if (!routeDiscovery.coveredNodesFilter.setBits(filterBits))
+                return Err(DeserializationError::INVALID_BUFFER);
+        }
+
+        return Ok(routeDiscovery);
     }
 
 #ifdef UNIT_TESTING
@@ -97,7 +137,7 @@ namespace ProtoMesh::communication::Routing::IERP {
             cryptography::UUID destination;
             cryptography::asymmetric::KeyPair keys(cryptography::asymmetric::generateKeyPair());
             REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
-            RouteDiscovery rd = RouteDiscovery::discover(destination, keys.pub, cryptography::UUID(), 0);
+            RouteDiscovery rd = RouteDiscovery::discover(destination, keys.pub, cryptography::UUID(), 0, 42);
 
             WHEN("a hop is added to the route") {
                 rd.addHop(cryptography::UUID());
@@ -124,6 +164,7 @@ namespace ProtoMesh::communication::Routing::IERP {
                         REQUIRE(rd.destination == deserializedRD.destination);
                         REQUIRE(rd.coveredNodes == deserializedRD.coveredNodes);
                         REQUIRE(rd.sentTimestamp == deserializedRD.sentTimestamp);
+                        REQUIRE(rd.sequenceNumber == deserializedRD.sequenceNumber);
                     }
                     THEN("both bytestreams should be equal") {
                         REQUIRE(reserializedRouteDiscovery == serializedRouteDiscovery);
@@ -136,6 +177,84 @@ namespace ProtoMesh::communication::Routing::IERP {
                 rd.addCoveredNodes({destination});
                 THEN("the list of covered nodes should grow") {
                     REQUIRE(rd.coveredNodes.size() > size);
+                    REQUIRE(rd.isCovered(destination));
+                }
+            }
+        }
+
+        GIVEN("A route discovery datagram encoding its covered nodes in a filter") {
+            cryptography::UUID origin;
+            cryptography::UUID destination;
+            cryptography::asymmetric::KeyPair keys(cryptography::asymmetric::generateKeyPair());
+            RouteDiscovery rd = RouteDiscovery::discover(destination, keys.pub, origin, 0, 1,
+                                                         ROUTE_DISCOVERY_VERSION_FILTER);
+            RouteDiscovery listRD = RouteDiscovery::discover(destination, keys.pub, origin, 0, 1,
+                                                             ROUTE_DISCOVERY_VERSION_LIST);
+
+            THEN("the origin should be covered") {
+                REQUIRE(rd.isCovered(origin));
+                REQUIRE(rd.coveredNodes.empty());
+            }
+
+            WHEN("30 covered nodes are added to both encodings") {
+                size_t initialSize = rd.serialize().size();
+                size_t initialListSize = listRD.serialize().size();
+
+                vector<cryptography::UUID> nodes;
+                for (uint32_t i = 0; i < 30; i++)
+                    nodes.push_back(cryptography::UUID::fromNumber(i));
+                rd.addCoveredNodes(nodes);
+                listRD.addCoveredNodes(nodes);
+
+                THEN("the size of the filter encoded datagram should remain constant") {
+                    REQUIRE(rd.serialize().size() == initialSize);
+                    REQUIRE(listRD.serialize().size() > initialListSize);
+                    REQUIRE(rd.serialize().size() < listRD.serialize().size());
+                }
+
+                AND_WHEN("it is deserialized again") {
+                    RouteDiscovery deserializedRD = RouteDiscovery::fromBuffer(rd.serialize()).unwrap();
+
+                    THEN("the version and covered nodes should be retained") {
+                        REQUIRE(deserializedRD.version == ROUTE_DISCOVERY_VERSION_FILTER);
+                        REQUIRE(deserializedRD.coveredNodesFilter == rd.coveredNodesFilter);
+                        for (auto node : nodes)
+                            REQUIRE(deserializedRD.isCovered(node));
+                    }
+                }
+            }
+
+            WHEN("more covered nodes are added than the filter can hold at a low false positive rate") {
+                vector<cryptography::UUID> nodes;
+                for (uint32_t i = 0; i < 200; i++)
+                    nodes.push_back(cryptography::UUID::fromNumber(i));
+                rd.addCoveredNodes(nodes);
+
+                size_t falsePositives = 0;
+                for (uint32_t i = 1000; i < 11000; i++)
+                    if (rd.isCovered(cryptography::UUID::fromNumber(i))) falsePositives++;
+
+                THEN("the remaining nodes should be listed explicitly") {
+                    REQUIRE(!rd.coveredNodes.empty());
+                    REQUIRE(rd.coveredNodes.size() < nodes.size());
+                    REQUIRE(rd.coveredNodesFilter.getFalsePositiveRate() >= ROUTE_DISCOVERY_FILTER_MAX_FALSE_POSITIVE_RATE);
+                }
+
+                THEN("all of them should be covered while the false positive rate stays low") {
+                    for (auto node : nodes)
+                        REQUIRE(rd.isCovered(node));
+                    REQUIRE(falsePositives <= 10000 * 2 * ROUTE_DISCOVERY_FILTER_MAX_FALSE_POSITIVE_RATE);
+                }
+
+                AND_WHEN("it is deserialized again") {
+                    RouteDiscovery deserializedRD = RouteDiscovery::fromBuffer(rd.serialize()).unwrap();
+
+                    THEN("both the filter and the listed nodes should be retained") {
+                        REQUIRE(deserializedRD.coveredNodesFilter == rd.coveredNodesFilter);
+                        REQUIRE(deserializedRD.coveredNodes == rd.coveredNodes);
+                        for (auto node : nodes)
+                            REQUIRE(deserializedRD.isCovered(node));
+                    }
                 }
             }
         }
@@ -7,15 +7,27 @@
 #include "RelativeTimeProvider.hpp"
 #include "uuid.hpp"
 #include "asymmetric.hpp"
+#include "CoveredNodesFilter.hpp"
 
 #include "flatbuffers/flatbuffers.h"
 #include "communication/ierp/routeDiscovery_generated.h"
 
+/// Route discoveries listing their covered nodes explicitly
+#define ROUTE_DISCOVERY_VERSION_LIST 1
+/// Route discoveries encoding their covered nodes in a constant size filter
+#define ROUTE_DISCOVERY_VERSION_FILTER 2
+/// Once the filter would skip more than this share of bordercast nodes that have not been covered yet,
+/// further covered nodes are listed explicitly even in ROUTE_DISCOVERY_VERSION_FILTER discoveries
+#define ROUTE_DISCOVERY_FILTER_MAX_FALSE_POSITIVE_RATE 0.01
+
 namespace ProtoMesh::communication::Routing::IERP {
 
     class RouteDiscovery : public Serializable<RouteDiscovery> {
     public:
+        uint8_t version;
+        /// All covered nodes in version 1, those that did not fit into the filter anymore in version 2
         vector<cryptography::UUID> coveredNodes;
+        CoveredNodesFilter coveredNodesFilter;
 
         cryptography::asymmetric::PublicKey origin;
         cryptography::UUID destination;
@@ -23,19 +35,24 @@ namespace ProtoMesh::communication::Routing::IERP {
         vector<cryptography::UUID> route;
 
         long sentTimestamp;
+        uint32_t sequenceNumber;
 
         RouteDiscovery(cryptography::asymmetric::PublicKey origin, cryptography::UUID destination, long sentTimestamp,
-                       vector<cryptography::UUID> route, vector<cryptography::UUID> coveredNodes)
-                : coveredNodes(std::move(coveredNodes)), origin(origin), destination(destination),
-                  route(std::move(route)), sentTimestamp(sentTimestamp) {}
+                       vector<cryptography::UUID> route, vector<cryptography::UUID> coveredNodes,
+                       uint32_t sequenceNumber = 0, uint8_t version = ROUTE_DISCOVERY_VERSION_LIST)
+                : version(version), origin(origin), destination(destination),
+                  route(std::move(route)), sentTimestamp(sentTimestamp), sequenceNumber(sequenceNumber) {
+            this->addCoveredNodes(coveredNodes);
+        }
 
         void addHop(cryptography::UUID hop);
         void addCoveredNodes(const vector<cryptography::UUID> &nodes);
+        bool isCovered(const cryptography::UUID &node) const;
 
         static inline RouteDiscovery
         discover(cryptography::UUID target, cryptography::asymmetric::PublicKey selfKey, cryptography::UUID self,
-                 long timestamp) {
-            return RouteDiscovery(selfKey, target, timestamp, {self}, {self});
+                 long timestamp, uint32_t sequenceNumber = 0, uint8_t version = ROUTE_DISCOVERY_VERSION_LIST) {
+            return RouteDiscovery(selfKey, target, timestamp, {self}, {self}, sequenceNumber, version);
         };
 
         /// Serializable overrides
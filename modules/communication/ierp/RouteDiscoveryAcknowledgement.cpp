@@ -0,0 +1,93 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "RouteDiscoveryAcknowledgement.hpp"
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    vector<uint8_t> RouteDiscoveryAcknowledgement::serialize() const {
+
+        using namespace scheme::communication::ierp;
+        flatbuffers::FlatBufferBuilder builder;
+
+        /// Serialize the route
+        vector<scheme::cryptography::UUID> routeEntries;
+        for (auto hop : this->route)
+            routeEntries.push_back(hop.toScheme());
+
+        auto routeVector = builder.CreateVectorOfStructs(routeEntries);
+
+        /// Serialize the public key
+        auto targetKey = this->targetKey.toBuffer(&builder);
+
+        auto acknowledgement = CreateRouteDiscoveryAcknowledgementDatagram(builder, routeVector, targetKey,
+                                                                           this->sentTimestamp);
+
+        /// Convert it to a byte array
+        builder.Finish(acknowledgement, RouteDiscoveryAcknowledgementDatagramIdentifier());
+        uint8_t *buf = builder.GetBufferPointer();
+
+        return {buf, buf + builder.GetSize()};
+    }
+
+    Result<RouteDiscoveryAcknowledgement, DeserializationError>
+    RouteDiscoveryAcknowledgement::fromBuffer(vector<uint8_t> buffer) {
+
+        using namespace scheme::communication::ierp;
+
+        /// Verify the buffer type
+        if (!flatbuffers::BufferHasIdentifier(buffer.data(), RouteDiscoveryAcknowledgementDatagramIdentifier()))
+            return Err(DeserializationError::INVALID_IDENTIFIER);
+
+        /// Verify buffer integrity
+        auto verifier = flatbuffers::Verifier(buffer.data(), buffer.size());
+        if (!VerifyRouteDiscoveryAcknowledgementDatagramBuffer(verifier))
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        auto acknowledgement = GetRouteDiscoveryAcknowledgementDatagram(buffer.data());
+        if (!acknowledgement->route() || acknowledgement->route()->Length() == 0 || !acknowledgement->targetKey())
+            return Err(DeserializationError::INVALID_BUFFER);
+
+        /// Deserialize route
+        vector<cryptography::UUID> route;
+        auto routeBuffer = acknowledgement->route();
+        for (uint i = 0; i < routeBuffer->Length(); i++)
+            route.emplace_back(routeBuffer->Get(i));
+
+        /// Deserialize public key
+        auto targetKey = cryptography::asymmetric::PublicKey::fromBuffer(acknowledgement->targetKey()->compressed());
+        if (targetKey.isErr())
+            return Err(DeserializationError::INVALID_PUB_KEY);
+
+        return Ok(RouteDiscoveryAcknowledgement(route, targetKey.unwrap(), acknowledgement->sentTimestamp()));
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Acknowledging a route discovery", "[unit_test][module][communication][routing][ierp]") {
+        GIVEN("An acknowledgement of a discovery that traversed one relay") {
+            cryptography::UUID origin;
+            cryptography::UUID relay;
+            cryptography::UUID target;
+            cryptography::asymmetric::KeyPair targetKeys = cryptography::asymmetric::generateKeyPair();
+
+            RouteDiscoveryAcknowledgement acknowledgement({origin, relay, target}, targetKeys.pub, 42);
+
+            WHEN("it is serialized and deserialized again") {
+                auto result = RouteDiscoveryAcknowledgement::fromBuffer(acknowledgement.serialize());
+
+                THEN("it should contain the same route, key and timestamp") {
+                    REQUIRE(result.isOk());
+                    REQUIRE(result.unwrap().route == acknowledgement.route);
+                    REQUIRE(result.unwrap().targetKey == targetKeys.pub);
+                    REQUIRE(result.unwrap().sentTimestamp == 42);
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
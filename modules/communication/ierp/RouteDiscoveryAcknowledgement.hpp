@@ -0,0 +1,39 @@
+#ifndef PROTOMESH_ROUTEDISCOVERYACKNOWLEDGEMENT_HPP
+#define PROTOMESH_ROUTEDISCOVERYACKNOWLEDGEMENT_HPP
+
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+#include "Serializable.hpp"
+#include "uuid.hpp"
+#include "asymmetric.hpp"
+
+#include "flatbuffers/flatbuffers.h"
+#include "communication/ierp/routeDiscoveryAcknowledgement_generated.h"
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    /// Answer of the destination of a route discovery which travels back to its origin.
+    /// Relays forward it as is.
+    class RouteDiscoveryAcknowledgement : public Serializable<RouteDiscoveryAcknowledgement> {
+    public:
+        /// Route of the discovery followed by the destination, i.e. it starts at the origin
+        vector<cryptography::UUID> route;
+        cryptography::asymmetric::PublicKey targetKey;
+        /// Sent timestamp of the route discovery
+        long sentTimestamp;
+
+        RouteDiscoveryAcknowledgement(vector<cryptography::UUID> route, cryptography::asymmetric::PublicKey targetKey,
+                                      long sentTimestamp)
+                : route(std::move(route)), targetKey(targetKey), sentTimestamp(sentTimestamp) {};
+
+        /// Serializable overrides
+        static Result<RouteDiscoveryAcknowledgement, DeserializationError> fromBuffer(vector<uint8_t> buffer);
+        vector<uint8_t> serialize() const override;
+    };
+
+}
+
+#endif //PROTOMESH_ROUTEDISCOVERYACKNOWLEDGEMENT_HPP
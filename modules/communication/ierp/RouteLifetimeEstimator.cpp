@@ -0,0 +1,110 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "RouteLifetimeEstimator.hpp"
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    void RouteLifetimeEstimator::recordRoundTripTime(long roundTripTime) {
+        if (roundTripTime < 0) return;
+
+        if (!this->hasSample) {
+            this->smoothedRoundTripTime = roundTripTime;
+            this->roundTripTimeVariation = roundTripTime / 2;
+            this->hasSample = true;
+            return;
+        }
+
+        /// RTTVAR = 3/4 * RTTVAR + 1/4 * |SRTT - R| and SRTT = 7/8 * SRTT + 1/8 * R
+        long deviation = this->smoothedRoundTripTime - roundTripTime;
+        this->roundTripTimeVariation = (3 * this->roundTripTimeVariation + (deviation < 0 ? -deviation : deviation)) / 4;
+        this->smoothedRoundTripTime = (7 * this->smoothedRoundTripTime + roundTripTime) / 8;
+    }
+
+    void RouteLifetimeEstimator::recordRoute(const vector<cryptography::UUID> &route, long currentTime) {
+        if (!this->lastRoute.empty()) {
+            if (route == this->lastRoute)
+                this->routeLifetime = min(this->routeLifetime * 2, (long) ROUTE_CACHE_MAX_LIFETIME);
+            else
+                this->routeLifetime = max(this->routeLifetime / 2, (long) ROUTE_CACHE_MIN_LIFETIME);
+        }
+
+        this->lastRoute = route;
+        this->lastDiscoveryTime = currentTime;
+    }
+
+    long RouteLifetimeEstimator::getDiscoveryTimeout() const {
+        if (!this->hasSample) return ROUTE_DISCOVERY_TIMEOUT;
+
+        long timeout = this->smoothedRoundTripTime + 4 * this->roundTripTimeVariation;
+        return min(max(timeout, (long) ROUTE_DISCOVERY_MIN_TIMEOUT), (long) ROUTE_DISCOVERY_MAX_TIMEOUT);
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Route lifetimes and discovery timeouts should adapt to the observed routes",
+             "[unit_test][module][communication][routing][ierp]") {
+        GIVEN("a route lifetime estimator") {
+            RouteLifetimeEstimator estimator;
+            cryptography::UUID self, a, b, destination;
+            vector<cryptography::UUID> route = {self, a, destination};
+            vector<cryptography::UUID> alternativeRoute = {self, b, destination};
+
+            THEN("the defaults should be used without any measurements") {
+                REQUIRE(estimator.getRouteLifetime() == ROUTE_CACHE_LIFETIME);
+                REQUIRE(estimator.getDiscoveryTimeout() == ROUTE_DISCOVERY_TIMEOUT);
+            }
+
+            WHEN("the same route is discovered repeatedly") {
+                for (int i = 0; i < 10; i++)
+                    estimator.recordRoute(route, i);
+
+                THEN("it should be cached for longer up to the maximum") {
+                    REQUIRE(estimator.getRouteLifetime() == ROUTE_CACHE_MAX_LIFETIME);
+                }
+            }
+
+            WHEN("the discovered route changes every time") {
+                for (int i = 0; i < 10; i++)
+                    estimator.recordRoute(i % 2 == 0 ? route : alternativeRoute, i);
+
+                THEN("it should be cached for a shorter time down to the minimum") {
+                    REQUIRE(estimator.getRouteLifetime() == ROUTE_CACHE_MIN_LIFETIME);
+                }
+            }
+
+            WHEN("a route is discovered") {
+                estimator.recordRoute(route, 1000);
+
+                THEN("the estimator should only expire once the destination has not been discovered for a while") {
+                    REQUIRE_FALSE(estimator.isExpired(1000 + ROUTE_CACHE_MAX_LIFETIME));
+                    REQUIRE(estimator.isExpired(1000 + ROUTE_LIFETIME_ESTIMATOR_EXPIRY));
+                }
+            }
+
+            WHEN("discoveries take a constant 400ms") {
+                for (int i = 0; i < 20; i++)
+                    estimator.recordRoundTripTime(400);
+
+                THEN("the timeout should converge towards the round trip time") {
+                    REQUIRE(estimator.getSmoothedRoundTripTime() == 400);
+                    REQUIRE(estimator.getDiscoveryTimeout() >= 400);
+                    REQUIRE(estimator.getDiscoveryTimeout() < 600);
+                }
+            }
+
+            WHEN("discoveries take a very long time") {
+                estimator.recordRoundTripTime(60000);
+
+                THEN("the timeout should be capped") {
+                    REQUIRE(estimator.getDiscoveryTimeout() == ROUTE_DISCOVERY_MAX_TIMEOUT);
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,54 @@
+#ifndef PROTOMESH_ROUTELIFETIMEESTIMATOR_HPP
+#define PROTOMESH_ROUTELIFETIMEESTIMATOR_HPP
+
+#include <vector>
+
+#include "uuid.hpp"
+#include "RouteCache.hpp"
+#include "PendingDiscovery.hpp"
+
+/// Bounds in milliseconds for the lifetime of a cached route
+#define ROUTE_CACHE_MIN_LIFETIME 15000
+#define ROUTE_CACHE_MAX_LIFETIME 240000
+/// Bounds in milliseconds for the time to wait for a route discovery acknowledgement
+#define ROUTE_DISCOVERY_MIN_TIMEOUT 200
+#define ROUTE_DISCOVERY_MAX_TIMEOUT 10000
+/// Time in milliseconds after the last discovery of a destination after which its estimator is discarded.
+/// Exceeds the maximum route lifetime so that routes rediscovered once they expired retain their history.
+#define ROUTE_LIFETIME_ESTIMATOR_EXPIRY (2 * ROUTE_CACHE_MAX_LIFETIME)
+
+using namespace std;
+
+namespace ProtoMesh::communication::Routing::IERP {
+
+    /// Adapts the lifetime of cached routes and the route discovery timeout for a single destination.
+    /// The round trip time of route discoveries is smoothed as in RFC 6298 to derive a timeout.
+    /// Routes that are rediscovered unchanged are cached for twice as long each time while
+    /// routes that changed since the last discovery (flapping) are cached for half as long.
+    class RouteLifetimeEstimator {
+        long smoothedRoundTripTime = 0;
+        long roundTripTimeVariation = 0;
+        bool hasSample = false;
+
+        vector<cryptography::UUID> lastRoute;
+        long routeLifetime = ROUTE_CACHE_LIFETIME;
+        long lastDiscoveryTime = 0;
+
+    public:
+        void recordRoundTripTime(long roundTripTime);
+        /// Records the route returned by a discovery at the given time and adjusts the route lifetime accordingly
+        void recordRoute(const vector<cryptography::UUID> &route, long currentTime);
+
+        /// Whether or not the destination has not been discovered for ROUTE_LIFETIME_ESTIMATOR_EXPIRY
+        bool isExpired(long currentTime) const {
+            return currentTime - this->lastDiscoveryTime >= ROUTE_LIFETIME_ESTIMATOR_EXPIRY;
+        }
+
+        long getRouteLifetime() const { return this->routeLifetime; }
+        long getSmoothedRoundTripTime() const { return this->smoothedRoundTripTime; }
+        long getDiscoveryTimeout() const;
+    };
+
+}
+
+#endif //PROTOMESH_ROUTELIFETIMEESTIMATOR_HPP
@@ -0,0 +1,235 @@
+#ifdef UNIT_TESTING
+
+#include "catch.hpp"
+
+#endif
+
+#include "CryptoService.hpp"
+
+namespace ProtoMesh::cryptography {
+
+    CryptoJob CryptoJob::sign(uint64_t tag, vector<uint8_t> text, PRIVATE_KEY_T privateKey) {
+        CryptoJob job(Type::SIGN, tag);
+        job.data = std::move(text);
+        job.privateKey = privateKey;
+        return job;
+    }
+
+    CryptoJob CryptoJob::verify(uint64_t tag, vector<uint8_t> text, SIGNATURE_T signature,
+                                asymmetric::PublicKey publicKey) {
+        CryptoJob job(Type::VERIFY, tag);
+        job.data = std::move(text);
+        job.signature = signature;
+        job.publicKey = publicKey;
+        return job;
+    }
+
+    CryptoJob CryptoJob::sharedSecret(uint64_t tag, asymmetric::PublicKey publicKey, PRIVATE_KEY_T privateKey) {
+        CryptoJob job(Type::SHARED_SECRET, tag);
+        job.publicKey = publicKey;
+        job.privateKey = privateKey;
+        return job;
+    }
+
+    CryptoJob CryptoJob::encrypt(uint64_t tag, vector<uint8_t> text, vector<uint8_t> key) {
+        CryptoJob job(Type::ENCRYPT, tag);
+        job.data = std::move(text);
+        job.key = std::move(key);
+        return job;
+    }
+
+    CryptoJob CryptoJob::decrypt(uint64_t tag, vector<uint8_t> ciphertext, vector<uint8_t> key) {
+        CryptoJob job(Type::DECRYPT, tag);
+        job.data = std::move(ciphertext);
+        job.key = std::move(key);
+        return job;
+    }
+
+    CryptoJob CryptoJob::decryptAndVerify(uint64_t tag, vector<uint8_t> ciphertext, SIGNATURE_T signature,
+                                          asymmetric::PublicKey sender, PRIVATE_KEY_T recipient) {
+        CryptoJob job(Type::DECRYPT_AND_VERIFY, tag);
+        job.data = std::move(ciphertext);
+        job.signature = signature;
+        job.publicKey = sender;
+        job.privateKey = recipient;
+        return job;
+    }
+
+    void CryptoCompletionQueue::push(CryptoCompletion completion) {
+        lock_guard<mutex> lock(this->completionsMutex);
+        this->completions.push_back(std::move(completion));
+    }
+
+    vector<CryptoCompletion> CryptoCompletionQueue::takeAll() {
+        lock_guard<mutex> lock(this->completionsMutex);
+        vector<CryptoCompletion> takenCompletions(make_move_iterator(this->completions.begin()),
+                                                  make_move_iterator(this->completions.end()));
+        this->completions.clear();
+        return takenCompletions;
+    }
+
+    CryptoService::CryptoService(size_t threadCount) {
+        for (size_t i = 0; i < max<size_t>(threadCount, 1); i++)
+            this->threads.emplace_back(&CryptoService::work, this);
+    }
+
+    CryptoService::~CryptoService() {
+        {
+            lock_guard<mutex> lock(this->jobsMutex);
+            this->running = false;
+        }
+        this->jobsCondition.notify_all();
+
+        for (thread &t : this->threads)
+            t.join();
+    }
+
+    void CryptoService::submit(vector<CryptoJob> jobs, shared_ptr<CryptoCompletionQueue> completions) {
+        if (jobs.empty()) return;
+        size_t jobCount = jobs.size();
+
+        {
+            lock_guard<mutex> lock(this->jobsMutex);
+            this->batches.emplace_back(Batch{std::move(jobs), std::move(completions)}, 0);
+        }
+
+        if (jobCount == 1) this->jobsCondition.notify_one();
+        else this->jobsCondition.notify_all();
+    }
+
+    void CryptoService::waitUntilIdle() {
+        unique_lock<mutex> lock(this->jobsMutex);
+        this->idleCondition.wait(lock, [this]() { return this->batches.empty() && this->activeJobs == 0; });
+    }
+
+    void CryptoService::work() {
+        unique_lock<mutex> lock(this->jobsMutex);
+
+        while (true) {
+            this->jobsCondition.wait(lock, [this]() { return !this->batches.empty() || !this->running; });
+            if (this->batches.empty()) return;
+
+            /// Take the next job of the oldest batch
+            auto &batch = this->batches.front();
+            CryptoJob job = std::move(batch.first.jobs[batch.second]);
+            shared_ptr<CryptoCompletionQueue> completions = batch.first.completions;
+            if (++batch.second == batch.first.jobs.size()) this->batches.pop_front();
+            this->activeJobs++;
+
+            lock.unlock();
+            completions->push(execute(job));
+            lock.lock();
+
+            if (--this->activeJobs == 0 && this->batches.empty())
+                this->idleCondition.notify_all();
+        }
+    }
+
+    CryptoCompletion CryptoService::execute(const CryptoJob &job) {
+        switch (job.type) {
+            case CryptoJob::Type::SIGN: {
+                SIGNATURE_T signature = asymmetric::sign(job.data, job.privateKey);
+                return CryptoCompletion(job.tag, job.type, true, vector<uint8_t>(signature.begin(), signature.end()));
+            }
+            case CryptoJob::Type::VERIFY: {
+                asymmetric::PublicKey publicKey = job.publicKey.value();
+                return CryptoCompletion(job.tag, job.type, asymmetric::verify(job.data, job.signature, &publicKey), {});
+            }
+            case CryptoJob::Type::SHARED_SECRET:
+                return CryptoCompletion(job.tag, job.type, true,
+                                        asymmetric::generateSharedSecret(job.publicKey.value(), job.privateKey));
+            case CryptoJob::Type::ENCRYPT: {
+                auto ciphertext = symmetric::encrypt(job.data, job.key);
+                if (ciphertext.isErr()) return CryptoCompletion(job.tag, job.type, false, {});
+
+                return CryptoCompletion(job.tag, job.type, true, ciphertext.unwrap());
+            }
+            case CryptoJob::Type::DECRYPT:
+                return CryptoCompletion(job.tag, job.type, true, symmetric::decrypt(job.data, job.key));
+            case CryptoJob::Type::DECRYPT_AND_VERIFY: {
+                asymmetric::PublicKey sender = job.publicKey.value();
+                vector<uint8_t> secret = asymmetric::generateSharedSecret(sender, job.privateKey);
+                vector<uint8_t> plaintext = symmetric::decrypt(job.data, secret);
+                bool valid = asymmetric::verify(plaintext, job.signature, &sender);
+
+                return CryptoCompletion(job.tag, job.type, valid, valid ? plaintext : vector<uint8_t>());
+            }
+        }
+
+        return CryptoCompletion(job.tag, job.type, false, {});
+    }
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Cryptographic jobs should be executed asynchronously", "[unit_test][module][cryptography]") {
+        GIVEN("a crypto service with two threads and two key pairs") {
+            CryptoService service(2);
+            auto completions = make_shared<CryptoCompletionQueue>();
+
+            asymmetric::KeyPair sender = asymmetric::generateKeyPair();
+            asymmetric::KeyPair recipient = asymmetric::generateKeyPair();
+            vector<uint8_t> text = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+            SIGNATURE_T signature = asymmetric::sign(text, sender.priv);
+            vector<uint8_t> secret = asymmetric::generateSharedSecret(recipient.pub, sender.priv);
+            vector<uint8_t> ciphertext = symmetric::encrypt(text, secret).unwrap();
+
+            /// Takes the completions ordered by their tag
+            auto takeCompletions = [&]() {
+                service.waitUntilIdle();
+                vector<CryptoCompletion> taken = completions->takeAll();
+                sort(taken.begin(), taken.end(), [](const CryptoCompletion &a, const CryptoCompletion &b) {
+                    return a.tag < b.tag;
+                });
+                return taken;
+            };
+
+            WHEN("a batch with one job of each type is submitted") {
+                service.submit({
+                        CryptoJob::sign(0, text, sender.priv),
+                        CryptoJob::verify(1, text, signature, sender.pub),
+                        CryptoJob::sharedSecret(2, sender.pub, recipient.priv),
+                        CryptoJob::encrypt(3, text, secret),
+                        CryptoJob::decrypt(4, ciphertext, secret),
+                        CryptoJob::decryptAndVerify(5, ciphertext, signature, sender.pub, recipient.priv)
+                }, completions);
+
+                vector<CryptoCompletion> taken = takeCompletions();
+
+                THEN("all of them should have completed with the same results as their synchronous counterparts") {
+                    REQUIRE(taken.size() == 6);
+
+                    SIGNATURE_T asynchronousSignature;
+                    copy(taken[0].result.begin(), taken[0].result.end(), asynchronousSignature.begin());
+                    REQUIRE(asymmetric::verify(text, asynchronousSignature, &sender.pub));
+
+                    REQUIRE(taken[1].success);
+                    REQUIRE(taken[2].result == secret);
+                    REQUIRE(symmetric::decrypt(taken[3].result, secret) == text);
+                    REQUIRE(taken[4].result == text);
+                    REQUIRE(taken[5].success);
+                    REQUIRE(taken[5].result == text);
+                }
+
+                THEN("the completions should only be delivered once") {
+                    REQUIRE(completions->takeAll().empty());
+                }
+            }
+
+            WHEN("a message with a signature of someone else is decrypted") {
+                SIGNATURE_T foreignSignature = asymmetric::sign(text, recipient.priv);
+                service.submit({CryptoJob::decryptAndVerify(0, ciphertext, foreignSignature, sender.pub, recipient.priv)},
+                               completions);
+
+                vector<CryptoCompletion> taken = takeCompletions();
+
+                THEN("the job should have failed without revealing the plaintext") {
+                    REQUIRE(taken.size() == 1);
+                    REQUIRE_FALSE(taken[0].success);
+                    REQUIRE(taken[0].result.empty());
+                }
+            }
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,119 @@
+#ifndef PROTOMESH_CRYPTOSERVICE_HPP
+#define PROTOMESH_CRYPTOSERVICE_HPP
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+#include "asymmetric.hpp"
+#include "symmetric.hpp"
+
+namespace ProtoMesh::cryptography {
+
+    class CryptoJob {
+    public:
+        enum class Type {
+            SIGN,
+            VERIFY,
+            SHARED_SECRET,
+            ENCRYPT,
+            DECRYPT,
+            /// Derives the shared secret, decrypts the ciphertext and verifies the signature of the plaintext
+            DECRYPT_AND_VERIFY
+        };
+
+        Type type;
+        /// Chosen by the submitter to match completions with their jobs
+        uint64_t tag;
+
+        /// Text to sign, verify or encrypt, or the ciphertext to decrypt
+        vector<uint8_t> data;
+        /// Symmetric key to encrypt or decrypt with
+        vector<uint8_t> key;
+        SIGNATURE_T signature{};
+        optional<asymmetric::PublicKey> publicKey;
+        PRIVATE_KEY_T privateKey{};
+
+        CryptoJob(Type type, uint64_t tag) : type(type), tag(tag) {};
+
+        static CryptoJob sign(uint64_t tag, vector<uint8_t> text, PRIVATE_KEY_T privateKey);
+        static CryptoJob verify(uint64_t tag, vector<uint8_t> text, SIGNATURE_T signature,
+                                asymmetric::PublicKey publicKey);
+        static CryptoJob sharedSecret(uint64_t tag, asymmetric::PublicKey publicKey, PRIVATE_KEY_T privateKey);
+        static CryptoJob encrypt(uint64_t tag, vector<uint8_t> text, vector<uint8_t> key);
+        static CryptoJob decrypt(uint64_t tag, vector<uint8_t> ciphertext, vector<uint8_t> key);
+        static CryptoJob decryptAndVerify(uint64_t tag, vector<uint8_t> ciphertext, SIGNATURE_T signature,
+                                          asymmetric::PublicKey sender, PRIVATE_KEY_T recipient);
+    };
+
+    class CryptoCompletion {
+    public:
+        uint64_t tag;
+        CryptoJob::Type type;
+        /// Whether or not the signature is valid when verifying, always true otherwise
+        bool success;
+        /// Signature, shared secret, ciphertext or plaintext depending on the type of the job
+        vector<uint8_t> result;
+
+        CryptoCompletion(uint64_t tag, CryptoJob::Type type, bool success, vector<uint8_t> result)
+                : tag(tag), type(type), success(success), result(std::move(result)) {};
+    };
+
+    /// Completed jobs waiting to be taken by the submitter
+    class CryptoCompletionQueue {
+        mutex completionsMutex;
+        deque<CryptoCompletion> completions;
+
+    public:
+        void push(CryptoCompletion completion);
+        /// Takes all completions without blocking
+        vector<CryptoCompletion> takeAll();
+    };
+
+    /// Executes cryptographic jobs on a pool of threads so that the submitter does not block on them.
+    /// Jobs are submitted in batches together with the queue their completions are delivered to,
+    /// which allows one service to be shared by multiple submitters. Completions may arrive in any order.
+    class CryptoService {
+        class Batch {
+        public:
+            vector<CryptoJob> jobs;
+            shared_ptr<CryptoCompletionQueue> completions;
+        };
+
+        mutex jobsMutex;
+        condition_variable jobsCondition;
+        condition_variable idleCondition;
+        /// Jobs of the front batch are taken one by one so that a batch is spread over all threads
+        deque<pair<Batch, size_t>> batches;
+        size_t activeJobs = 0;
+        bool running = true;
+
+        vector<thread> threads;
+
+        void work();
+
+    public:
+        explicit CryptoService(size_t threadCount = max(thread::hardware_concurrency(), 1u));
+        ~CryptoService();
+
+        CryptoService(const CryptoService &) = delete;
+        CryptoService &operator=(const CryptoService &) = delete;
+
+        void submit(vector<CryptoJob> jobs, shared_ptr<CryptoCompletionQueue> completions);
+
+        /// Blocks until all submitted jobs have been completed
+        void waitUntilIdle();
+
+        /// Executes the job on the calling thread
+        static CryptoCompletion execute(const CryptoJob &job);
+    };
+
+}
+
+#endif //PROTOMESH_CRYPTOSERVICE_HPP
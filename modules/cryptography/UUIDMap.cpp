@@ -0,0 +1,132 @@
+#include "UUIDMap.hpp"
+
+#ifdef UNIT_TESTING
+#include "catch.hpp"
+
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#endif
+
+namespace ProtoMesh::cryptography {
+
+#ifdef UNIT_TESTING
+
+    SCENARIO("Storing values by UUID in an open addressing map", "[unit_test][module][cryptography][uuid]") {
+        GIVEN("an empty map") {
+            UUIDMap<int> map;
+
+            THEN("it should not contain anything") {
+                REQUIRE(map.empty());
+                REQUIRE(map.find(UUID::fromNumber(1)) == map.end());
+                REQUIRE(map.begin() == map.end());
+            }
+
+            WHEN("a thousand sequential IDs are inserted") {
+                for (uint32_t i = 0; i < 1000; i++)
+                    REQUIRE(map.insert({UUID::fromNumber(i), (int) i}).second);
+
+                THEN("all of them should be retrievable") {
+                    REQUIRE(map.size() == 1000);
+                    for (uint32_t i = 0; i < 1000; i++)
+                        REQUIRE(map.at(UUID::fromNumber(i)) == (int) i);
+                    REQUIRE(map.find(UUID::fromNumber(1000)) == map.end());
+                }
+
+                THEN("inserting an existing ID again should keep the previous value") {
+                    auto result = map.insert({UUID::fromNumber(5), 42});
+                    REQUIRE_FALSE(result.second);
+                    REQUIRE(result.first->second == 5);
+                    REQUIRE(map.size() == 1000);
+                }
+
+                THEN("iterating should visit every entry exactly once") {
+                    long sum = 0;
+                    size_t visited = 0;
+                    for (auto &entry : map) {
+                        sum += entry.second;
+                        visited++;
+                    }
+                    REQUIRE(visited == 1000);
+                    REQUIRE(sum == 999 * 1000 / 2);
+                }
+
+                AND_WHEN("every odd entry is erased while iterating") {
+                    for (auto it = map.begin(); it != map.end();)
+                        it = it->second % 2 ? map.erase(it) : next(it);
+
+                    THEN("only the even entries should remain") {
+                        REQUIRE(map.size() == 500);
+                        for (uint32_t i = 0; i < 1000; i++)
+                            REQUIRE(map.count(UUID::fromNumber(i)) == (i % 2 ? 0 : 1));
+                    }
+                }
+
+                AND_WHEN("entries are erased by their ID") {
+                    REQUIRE(map.erase(UUID::fromNumber(10)) == 1);
+                    REQUIRE(map.erase(UUID::fromNumber(10)) == 0);
+
+                    THEN("the other entries should still be retrievable") {
+                        REQUIRE(map.size() == 999);
+                        for (uint32_t i = 0; i < 1000; i++)
+                            if (i != 10) REQUIRE(map.at(UUID::fromNumber(i)) == (int) i);
+                    }
+                }
+            }
+
+            WHEN("a value is accessed through the subscript operator") {
+                map[UUID::fromNumber(7)] += 3;
+                map[UUID::fromNumber(7)] += 4;
+
+                THEN("it should have been default constructed once") {
+                    REQUIRE(map.size() == 1);
+                    REQUIRE(map.at(UUID::fromNumber(7)) == 7);
+                }
+            }
+        }
+    }
+
+    /// Benchmarks are hidden and only run when their tag is passed explicitly, e.g. `unit_test [benchmark]`
+    template<class Map>
+    void benchmarkUUIDMap(const string &name, const vector<UUID> &keys) {
+        using namespace std::chrono;
+        Map map;
+
+        auto insertionStart = steady_clock::now();
+        for (size_t i = 0; i < keys.size(); i++)
+            map.insert({keys[i], i});
+        auto insertionTime = duration_cast<nanoseconds>(steady_clock::now() - insertionStart).count();
+
+        /// Look the keys up in a different order so that the allocation order of nodes doesn't help unordered_map
+        vector<UUID> lookupOrder(keys);
+        shuffle(lookupOrder.begin(), lookupOrder.end(), mt19937(42));
+
+        size_t found = 0;
+        auto lookupStart = steady_clock::now();
+        for (int round = 0; round < 10; round++)
+            for (const UUID &key : lookupOrder)
+                found += map.find(key) != map.end();
+        auto lookupTime = duration_cast<nanoseconds>(steady_clock::now() - lookupStart).count();
+
+        REQUIRE(found == keys.size() * 10);
+        WARN(name << " with " << keys.size() << " entries: "
+                  << insertionTime / keys.size() << "ns per insertion, "
+                  << lookupTime / (keys.size() * 10) << "ns per lookup");
+    }
+
+    SCENARIO("Benchmarking the UUID map against unordered_map", "[.][benchmark][cryptography][uuid]") {
+        for (uint32_t size : {1000, 10000, 100000}) {
+            vector<UUID> sequentialKeys;
+            vector<UUID> randomKeys(size);
+            for (uint32_t i = 0; i < size; i++)
+                sequentialKeys.push_back(UUID::fromNumber(i));
+
+            benchmarkUUIDMap<unordered_map<UUID, size_t>>("unordered_map (sequential IDs)", sequentialKeys);
+            benchmarkUUIDMap<UUIDMap<size_t>>("UUIDMap (sequential IDs)", sequentialKeys);
+            benchmarkUUIDMap<unordered_map<UUID, size_t>>("unordered_map (random IDs)", randomKeys);
+            benchmarkUUIDMap<UUIDMap<size_t>>("UUIDMap (random IDs)", randomKeys);
+        }
+    }
+
+#endif // UNIT_TESTING
+}
@@ -0,0 +1,256 @@
+#ifndef PROTOMESH_UUIDMAP_HPP
+#define PROTOMESH_UUIDMAP_HPP
+
+#include <vector>
+#include <optional>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+
+#include "uuid.hpp"
+
+/// Amount of buckets allocated by the first insertion
+#define UUID_MAP_INITIAL_CAPACITY 16
+/// Fill ratio in percent above which the table doubles its capacity
+#define UUID_MAP_MAX_LOAD 80
+/// Buckets past the end of the table an entry may be displaced into before the table grows
+#define UUID_MAP_OVERFLOW_BUCKETS 32
+
+using namespace std;
+
+namespace ProtoMesh::cryptography {
+
+    /// Open addressing hash map keyed by UUIDs (Robin Hood hashing with backward shift deletion).
+    /// Entries are stored inline in one contiguous table and placed by UUID::hash so that sequential IDs
+    /// like the ones created by UUID::fromNumber are spread evenly. The table does not wrap around,
+    /// entries are displaced into a few overflow buckets at the end instead. This keeps iteration stable
+    /// while erasing: erase(iterator) only ever shifts entries that have not been visited yet.
+    /// Mirrors the subset of the unordered_map interface used throughout the project.
+    template<typename V>
+    class UUIDMap {
+    public:
+        using key_type = UUID;
+        using mapped_type = V;
+        using value_type = pair<UUID, V>;
+        using size_type = size_t;
+
+    private:
+        /// Probe distance of every bucket plus one, zero marks empty buckets.
+        /// Kept apart from the entries so that probing only touches this compact array.
+        vector<uint8_t> distances;
+        vector<optional<value_type>> entries;
+        size_t occupied = 0;
+        size_t mask = 0;
+
+        size_t homeOf(const UUID &key) const { return key.hash() & this->mask; }
+
+        size_t indexOf(const UUID &key) const {
+            uint8_t distance = 1;
+            for (size_t index = this->homeOf(key); index < this->distances.size(); index++, distance++) {
+                /// A poorer entry would have been displaced by the key if it was present
+                if (this->distances[index] < distance) break;
+                if (this->entries[index]->first == key) return index;
+            }
+            return this->distances.size();
+        }
+
+        /// Places the entry without checking for duplicates and returns the bucket it ended up in.
+        /// Returns nullopt and leaves the entry that is still without a bucket in the parameter
+        /// if the end of the table or the maximum probe distance has been reached.
+        optional<size_t> tryPlace(value_type &carried) {
+            optional<size_t> placedAt;
+            uint8_t distance = 1;
+
+            for (size_t index = this->homeOf(carried.first); index < this->distances.size(); index++, distance++) {
+                if (distance == UINT8_MAX) break;
+
+                if (this->distances[index] == 0) {
+                    this->entries[index].emplace(std::move(carried));
+                    this->distances[index] = distance;
+                    return placedAt ? placedAt : index;
+                }
+
+                /// Take the bucket from entries that are closer to their home than the carried one
+                if (this->distances[index] < distance) {
+                    swap(carried, *this->entries[index]);
+                    swap(distance, this->distances[index]);
+                    if (!placedAt) placedAt = index;
+                }
+            }
+
+            return nullopt;
+        }
+
+        /// Places the entry and returns its bucket
+        size_t place(value_type entry) {
+            UUID key = entry.first;
+            optional<size_t> index = this->tryPlace(entry);
+            bool displaced = index.has_value();
+
+            while (!index) {
+                this->rehash(this->capacity() * 2);
+                index = this->tryPlace(entry);
+            }
+
+            this->occupied++;
+            /// The table has been rebuilt in the meantime if an entry displaced by ours found no bucket
+            return displaced || entry.first == key ? index.value() : this->indexOf(key);
+        }
+
+        void rehash(size_t newCapacity) {
+            if (newCapacity < UUID_MAP_INITIAL_CAPACITY) newCapacity = UUID_MAP_INITIAL_CAPACITY;
+
+            vector<uint8_t> previousDistances(newCapacity + UUID_MAP_OVERFLOW_BUCKETS, 0);
+            vector<optional<value_type>> previousEntries(newCapacity + UUID_MAP_OVERFLOW_BUCKETS);
+            swap(previousDistances, this->distances);
+            swap(previousEntries, this->entries);
+            this->mask = newCapacity - 1;
+            this->occupied = 0;
+
+            for (size_t index = 0; index < previousDistances.size(); index++)
+                if (previousDistances[index]) this->place(std::move(*previousEntries[index]));
+        }
+
+        template<bool Const>
+        class Iterator {
+            friend class UUIDMap;
+            template<bool> friend class Iterator;
+            using MapPointer = conditional_t<Const, const UUIDMap *, UUIDMap *>;
+            MapPointer map;
+            size_t index;
+
+            Iterator(MapPointer map, size_t index) : map(map), index(index) {
+                this->skipEmpty();
+            }
+
+            void skipEmpty() {
+                while (this->index < this->map->distances.size() && !this->map->distances[this->index]) this->index++;
+            }
+
+        public:
+            using iterator_category = forward_iterator_tag;
+            using value_type = UUIDMap::value_type;
+            using difference_type = ptrdiff_t;
+            using pointer = conditional_t<Const, const value_type *, value_type *>;
+            using reference = conditional_t<Const, const value_type &, value_type &>;
+
+            /// Allows converting iterators into const iterators
+            operator Iterator<true>() const { return Iterator<true>(this->map, this->index); }
+
+            reference operator*() const { return *this->map->entries[this->index]; }
+            pointer operator->() const { return &*this->map->entries[this->index]; }
+
+            Iterator &operator++() {
+                this->index++;
+                this->skipEmpty();
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                Iterator previous = *this;
+                ++(*this);
+                return previous;
+            }
+
+            bool operator==(const Iterator &other) const { return this->index == other.index; }
+            bool operator!=(const Iterator &other) const { return this->index != other.index; }
+        };
+
+    public:
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, this->distances.size()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, this->distances.size()); }
+
+        size_t size() const { return this->occupied; }
+        bool empty() const { return this->occupied == 0; }
+        /// Amount of buckets excluding the overflow buckets
+        size_t capacity() const { return this->distances.empty() ? 0 : this->mask + 1; }
+
+        iterator find(const UUID &key) { return iterator(this, this->indexOf(key)); }
+        const_iterator find(const UUID &key) const { return const_iterator(this, this->indexOf(key)); }
+        size_t count(const UUID &key) const { return this->indexOf(key) != this->distances.size() ? 1 : 0; }
+
+        V &at(const UUID &key) {
+            size_t index = this->indexOf(key);
+            if (index == this->distances.size()) throw out_of_range("UUIDMap::at");
+            return this->entries[index]->second;
+        }
+
+        const V &at(const UUID &key) const {
+            size_t index = this->indexOf(key);
+            if (index == this->distances.size()) throw out_of_range("UUIDMap::at");
+            return this->entries[index]->second;
+        }
+
+        V &operator[](const UUID &key) {
+            size_t index = this->indexOf(key);
+            if (index != this->distances.size()) return this->entries[index]->second;
+            return this->insert({key, V()}).first->second;
+        }
+
+        /// Inserts the entry unless the key is already present.
+        /// Returns an iterator to the entry with the key and whether or not the insertion took place.
+        pair<iterator, bool> insert(value_type entry) {
+            size_t index = this->indexOf(entry.first);
+            if (index != this->distances.size()) return {iterator(this, index), false};
+
+            if ((this->occupied + 1) * 100 > this->capacity() * UUID_MAP_MAX_LOAD)
+                this->rehash(this->capacity() * 2);
+
+            return {iterator(this, this->place(std::move(entry))), true};
+        }
+
+        template<typename... Args>
+        pair<iterator, bool> emplace(const UUID &key, Args &&... args) {
+            return this->insert(value_type(key, V(std::forward<Args>(args)...)));
+        }
+
+        /// Removes the entry and returns an iterator to the next one
+        iterator erase(const_iterator position) {
+            size_t index = position.index;
+            this->entries[index].reset();
+            this->distances[index] = 0;
+            this->occupied--;
+
+            /// Shift the following entries that are not in their home bucket back by one
+            for (size_t next = index + 1; next < this->distances.size() && this->distances[next] > 1; next++) {
+                this->entries[next - 1].emplace(std::move(*this->entries[next]));
+                this->distances[next - 1] = this->distances[next] - 1;
+                this->entries[next].reset();
+                this->distances[next] = 0;
+            }
+
+            return iterator(this, index);
+        }
+
+        iterator erase(iterator position) { return this->erase(const_iterator(position)); }
+
+        size_t erase(const UUID &key) {
+            size_t index = this->indexOf(key);
+            if (index == this->distances.size()) return 0;
+            this->erase(const_iterator(this, index));
+            return 1;
+        }
+
+        void clear() {
+            this->distances.clear();
+            this->entries.clear();
+            this->occupied = 0;
+            this->mask = 0;
+        }
+
+        /// Grows the table so that the given amount of entries fits without rehashing
+        void reserve(size_t entries) {
+            size_t requiredCapacity = UUID_MAP_INITIAL_CAPACITY;
+            while (requiredCapacity * UUID_MAP_MAX_LOAD < entries * 100) requiredCapacity *= 2;
+            if (requiredCapacity > this->capacity()) this->rehash(requiredCapacity);
+        }
+    };
+
+}
+
+#endif //PROTOMESH_UUIDMAP_HPP
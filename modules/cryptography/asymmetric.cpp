@@ -1,4 +1,5 @@
 #include "asymmetric.hpp"
+#include "uECC_vli.h"
 
 #ifdef UNIT_TESTING
 #include "catch.hpp"
@@ -6,6 +7,10 @@
 
 const struct uECC_Curve_t* ECC_CURVE = uECC_secp256k1();
 
+/// Scalars and coordinates in the native format of the micro-ecc VLI API
+#define VLI_WORDS (PRIV_KEY_SIZE / sizeof(uECC_word_t))
+#define VLI_T array<uECC_word_t, VLI_WORDS>
+
 namespace ProtoMesh::cryptography::asymmetric {
     bool verifyKeySize() {
         bool keySizeMatch = uECC_curve_private_key_size(ECC_CURVE) == PRIV_KEY_SIZE
@@ -92,6 +97,274 @@ namespace ProtoMesh::cryptography::asymmetric {
         return (bool) uECC_verify(pubKey->raw.data(), hash, sizeof(hash), signature.data(), ECC_CURVE);
     }
 
+    /// Elliptic curve arithmetic on top of the VLI API of micro-ecc which allows the inversions of a batch of
+    /// signatures to be shared. Points are kept in Jacobian coordinates (x = X / Z^2, y = Y / Z^3) so that they
+    /// can be added without inverting anything.
+    namespace {
+        class JacobianPoint {
+        public:
+            VLI_T x{};
+            VLI_T y{};
+            /// Zero for the point at infinity
+            VLI_T z{};
+
+            JacobianPoint() = default;
+            JacobianPoint(const VLI_T &x, const VLI_T &y) : x(x), y(y) { this->z[0] = 1; };
+
+            bool isInfinity() const { return uECC_vli_isZero(this->z.data(), VLI_WORDS); }
+        };
+
+        class BatchEntry {
+        public:
+            size_t index;
+            VLI_T r{};
+            /// The s value of the signature until it is inverted
+            VLI_T w{};
+            VLI_T e{};
+            VLI_T publicX{};
+            VLI_T publicY{};
+            /// Sum of the generator and the public key in affine coordinates once its z has been inverted
+            JacobianPoint sum;
+
+            explicit BatchEntry(size_t index) : index(index) {};
+        };
+
+        VLI_T modMult(const VLI_T &left, const VLI_T &right, const uECC_word_t *modulus) {
+            VLI_T result;
+            /// The curve specific reduction is only available for the field prime
+            if (modulus == uECC_curve_p(ECC_CURVE))
+                uECC_vli_modMult_fast(result.data(), left.data(), right.data(), ECC_CURVE);
+            else
+                uECC_vli_modMult(result.data(), left.data(), right.data(), modulus, VLI_WORDS);
+            return result;
+        }
+
+        VLI_T fieldMult(const VLI_T &left, const VLI_T &right) {
+            return modMult(left, right, uECC_curve_p(ECC_CURVE));
+        }
+
+        VLI_T fieldSquare(const VLI_T &value) {
+            VLI_T result;
+            uECC_vli_modSquare_fast(result.data(), value.data(), ECC_CURVE);
+            return result;
+        }
+
+        VLI_T fieldAdd(const VLI_T &left, const VLI_T &right) {
+            VLI_T result;
+            uECC_vli_modAdd(result.data(), left.data(), right.data(), uECC_curve_p(ECC_CURVE), VLI_WORDS);
+            return result;
+        }
+
+        VLI_T fieldSub(const VLI_T &left, const VLI_T &right) {
+            VLI_T result;
+            uECC_vli_modSub(result.data(), left.data(), right.data(), uECC_curve_p(ECC_CURVE), VLI_WORDS);
+            return result;
+        }
+
+        /// Only valid for curves with a = 0 like secp256k1 (dbl-2009-l)
+        JacobianPoint doublePoint(const JacobianPoint &point) {
+            if (point.isInfinity()) return point;
+
+            VLI_T xx = fieldSquare(point.x);
+            VLI_T yy = fieldSquare(point.y);
+            VLI_T yyyy = fieldSquare(yy);
+            VLI_T d = fieldSub(fieldSub(fieldSquare(fieldAdd(point.x, yy)), xx), yyyy);
+            d = fieldAdd(d, d);
+            VLI_T m = fieldAdd(fieldAdd(xx, xx), xx);
+            VLI_T eightYYYY = fieldAdd(yyyy, yyyy);
+            eightYYYY = fieldAdd(eightYYYY, eightYYYY);
+            eightYYYY = fieldAdd(eightYYYY, eightYYYY);
+            VLI_T yz = fieldMult(point.y, point.z);
+
+            JacobianPoint result;
+            result.x = fieldSub(fieldSquare(m), fieldAdd(d, d));
+            result.y = fieldSub(fieldMult(m, fieldSub(d, result.x)), eightYYYY);
+            result.z = fieldAdd(yz, yz);
+            return result;
+        }
+
+        /// Adds a point given in affine coordinates
+        JacobianPoint addAffinePoint(const JacobianPoint &point, const VLI_T &x, const VLI_T &y) {
+            if (point.isInfinity()) return JacobianPoint(x, y);
+
+            VLI_T zz = fieldSquare(point.z);
+            VLI_T h = fieldSub(fieldMult(x, zz), point.x);
+            VLI_T r = fieldSub(fieldMult(y, fieldMult(zz, point.z)), point.y);
+
+            if (uECC_vli_isZero(h.data(), VLI_WORDS)) {
+                if (uECC_vli_isZero(r.data(), VLI_WORDS)) return doublePoint(point);
+                return JacobianPoint();
+            }
+
+            VLI_T hh = fieldSquare(h);
+            VLI_T hhh = fieldMult(hh, h);
+            VLI_T v = fieldMult(point.x, hh);
+
+            JacobianPoint result;
+            result.x = fieldSub(fieldSub(fieldSquare(r), hhh), fieldAdd(v, v));
+            result.y = fieldSub(fieldMult(r, fieldSub(v, result.x)), fieldMult(point.y, hhh));
+            result.z = fieldMult(point.z, h);
+            return result;
+        }
+
+        /// Inverts all values using a single inversion and three multiplications per value (Montgomery's trick).
+        /// None of the values may be zero.
+        void invertAll(const vector<VLI_T *> &values, const uECC_word_t *modulus) {
+            if (values.empty()) return;
+
+            /// The product of the first i + 1 values
+            vector<VLI_T> products(values.size());
+            products[0] = *values[0];
+            for (size_t i = 1; i < values.size(); i++)
+                products[i] = modMult(products[i - 1], *values[i], modulus);
+
+            VLI_T inverse;
+            uECC_vli_modInv(inverse.data(), products.back().data(), modulus, VLI_WORDS);
+
+            /// inverse is the inverse of the product of the first i + 1 values
+            for (size_t i = values.size() - 1; i > 0; i--) {
+                VLI_T value = *values[i];
+                *values[i] = modMult(inverse, products[i - 1], modulus);
+                inverse = modMult(inverse, value, modulus);
+            }
+            *values[0] = inverse;
+        }
+
+        /// The integer uECC_verify derives from the hash that verify passes to it
+        VLI_T hashToInteger(const vector<uint8_t> &text) {
+            HASH hashVec = ProtoMesh::cryptography::hash::sha512Vec(text);
+            VLI_T e{};
+            uECC_vli_bytesToNative(e.data(), hashVec.data(), sizeof(uint8_t *));
+            return e;
+        }
+
+        /// Whether the affine x coordinate of the point is congruent to r modulo the curve order
+        bool matchesR(const JacobianPoint &point, const VLI_T &r) {
+            if (point.isInfinity()) return false;
+
+            /// x = X / Z^2 lies below the field prime which is less than twice the order, so x is either r or r + n
+            VLI_T zz = fieldSquare(point.z);
+            if (uECC_vli_equal(fieldMult(r, zz).data(), point.x.data(), VLI_WORDS)) return true;
+
+            VLI_T rPlusN;
+            if (uECC_vli_add(rPlusN.data(), r.data(), uECC_curve_n(ECC_CURVE), VLI_WORDS)) return false;
+            if (uECC_vli_cmp(uECC_curve_p(ECC_CURVE), rPlusN.data(), VLI_WORDS) != 1) return false;
+
+            return uECC_vli_equal(fieldMult(rPlusN, zz).data(), point.x.data(), VLI_WORDS);
+        }
+
+        /// Verifies the signed texts at the given indices the same way uECC_verify does, except that the inversions
+        /// of all of them (s, the z of G + Q) are shared and the result is compared in Jacobian coordinates.
+        void verifyIndices(const vector<SignedText> &signedTexts, const vector<size_t> &indices, vector<bool> &results) {
+            auto verifySeparately = [&signedTexts, &results](size_t index) {
+                PublicKey publicKey = signedTexts[index].publicKey;
+                results[index] = verify(signedTexts[index].text, signedTexts[index].signature, &publicKey);
+            };
+
+            /// The point doubling above requires a = 0 and a single signature gains nothing from being batched
+            if (ECC_CURVE != uECC_secp256k1() || indices.size() < 2) {
+                for (size_t index : indices) verifySeparately(index);
+                return;
+            }
+
+            const uECC_word_t *order = uECC_curve_n(ECC_CURVE);
+            const uECC_word_t *generator = uECC_curve_G(ECC_CURVE);
+            VLI_T generatorX, generatorY;
+            copy(generator, generator + VLI_WORDS, generatorX.begin());
+            copy(generator + VLI_WORDS, generator + 2 * VLI_WORDS, generatorY.begin());
+
+            vector<BatchEntry> entries;
+            for (size_t index : indices) {
+                const SignedText &signedText = signedTexts[index];
+                BatchEntry entry(index);
+                uECC_vli_bytesToNative(entry.r.data(), signedText.signature.data(), PRIV_KEY_SIZE);
+                uECC_vli_bytesToNative(entry.w.data(), signedText.signature.data() + PRIV_KEY_SIZE, PRIV_KEY_SIZE);
+                uECC_vli_bytesToNative(entry.publicX.data(), signedText.publicKey.raw.data(), PRIV_KEY_SIZE);
+                uECC_vli_bytesToNative(entry.publicY.data(), signedText.publicKey.raw.data() + PRIV_KEY_SIZE,
+                                       PRIV_KEY_SIZE);
+
+                /// r and s have to lie within [1, n - 1]
+                if (uECC_vli_isZero(entry.r.data(), VLI_WORDS) || uECC_vli_isZero(entry.w.data(), VLI_WORDS) ||
+                    uECC_vli_cmp(order, entry.r.data(), VLI_WORDS) != 1 ||
+                    uECC_vli_cmp(order, entry.w.data(), VLI_WORDS) != 1) {
+                    results[index] = false;
+                    continue;
+                }
+
+                /// Leave the edge cases of invalid keys and G + Q being the point at infinity to micro-ecc
+                array<uECC_word_t, 2 * VLI_WORDS> publicKey;
+                copy(entry.publicX.begin(), entry.publicX.end(), publicKey.begin());
+                copy(entry.publicY.begin(), entry.publicY.end(), publicKey.begin() + VLI_WORDS);
+                entry.sum = addAffinePoint(JacobianPoint(generatorX, generatorY), entry.publicX, entry.publicY);
+                if (!uECC_valid_point(publicKey.data(), ECC_CURVE) || entry.sum.isInfinity()) {
+                    verifySeparately(index);
+                    continue;
+                }
+
+                entry.e = hashToInteger(signedText.text);
+                entries.push_back(entry);
+            }
+
+            /// Share the inversions of s modulo n and of the z of G + Q modulo p among all signatures
+            vector<VLI_T *> sValues, sumZValues;
+            for (BatchEntry &entry : entries) {
+                sValues.push_back(&entry.w);
+                sumZValues.push_back(&entry.sum.z);
+            }
+            invertAll(sValues, order);
+            invertAll(sumZValues, uECC_curve_p(ECC_CURVE));
+
+            for (BatchEntry &entry : entries) {
+                VLI_T zz = fieldSquare(entry.sum.z);
+                VLI_T sumX = fieldMult(entry.sum.x, zz);
+                VLI_T sumY = fieldMult(entry.sum.y, fieldMult(zz, entry.sum.z));
+
+                VLI_T u1 = modMult(entry.e, entry.w, order);
+                VLI_T u2 = modMult(entry.r, entry.w, order);
+
+                /// Shamir's trick: u1 * G + u2 * Q in a single pass over the bits of both scalars
+                JacobianPoint point;
+                int bits = max(uECC_vli_numBits(u1.data(), VLI_WORDS), uECC_vli_numBits(u2.data(), VLI_WORDS));
+                for (int bit = bits - 1; bit >= 0; bit--) {
+                    point = doublePoint(point);
+
+                    bool generatorBit = uECC_vli_testBit(u1.data(), bit) != 0;
+                    bool publicKeyBit = uECC_vli_testBit(u2.data(), bit) != 0;
+                    if (generatorBit && publicKeyBit) point = addAffinePoint(point, sumX, sumY);
+                    else if (generatorBit) point = addAffinePoint(point, generatorX, generatorY);
+                    else if (publicKeyBit) point = addAffinePoint(point, entry.publicX, entry.publicY);
+                }
+
+                results[entry.index] = matchesR(point, entry.r);
+            }
+        }
+    }
+
+    vector<bool> verifyBatch(const vector<SignedText> &signedTexts) {
+        /// Sort the entries so that identical ones are adjacent
+        auto triple = [&signedTexts](size_t i) {
+            return tie(signedTexts[i].signature, signedTexts[i].publicKey.raw, signedTexts[i].text);
+        };
+
+        vector<size_t> order(signedTexts.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&triple](size_t a, size_t b) { return triple(a) < triple(b); });
+
+        vector<size_t> distinct;
+        for (size_t i = 0; i < order.size(); i++)
+            if (i == 0 || triple(order[i - 1]) != triple(order[i]))
+                distinct.push_back(order[i]);
+
+        vector<bool> results(signedTexts.size(), false);
+        verifyIndices(signedTexts, distinct, results);
+
+        for (size_t i = 1; i < order.size(); i++)
+            if (triple(order[i - 1]) == triple(order[i]))
+                results[order[i]] = results[order[i - 1]];
+
+        return results;
+    }
+
     SHARED_KEY_T generateSharedSecret(PublicKey publicKey, PRIVATE_KEY_T privateKey) {
         uint8_t sharedSecret[32] = {0};
         uECC_shared_secret(publicKey.raw.data(), privateKey.data(), sharedSecret, ECC_CURVE);
@@ -186,6 +459,44 @@ namespace ProtoMesh::cryptography::asymmetric {
                     alteredSig[0] /= 2;
                     REQUIRE_FALSE(verify(msg, alteredSig, &pair.pub));
                 }
+
+                THEN("it should be verifiable along with valid, invalid and duplicate signatures") {
+                    vector<uint8_t> otherMsg = {6,7,8,9,10};
+                    SIGNATURE_T otherSig(sign(otherMsg, pair2.priv));
+
+                    vector<bool> results = verifyBatch({
+                            {msg, sig, pair.pub},
+                            {otherMsg, otherSig, pair2.pub},
+                            {otherMsg, sig, pair.pub},
+                            {msg, sig, pair2.pub},
+                            {msg, sig, pair.pub}
+                    });
+
+                    REQUIRE(results == vector<bool>({true, true, false, false, true}));
+                    REQUIRE(verifyBatch({}).empty());
+                }
+
+                THEN("a batch of many signatures should yield the same results as verifying them one by one") {
+                    vector<SignedText> signedTexts;
+                    for (uint8_t i = 0; i < 16; i++) {
+                        KeyPair signer = i % 2 ? pair : pair2;
+                        vector<uint8_t> text = {i, 1, 2};
+                        SIGNATURE_T signature = sign(text, signer.priv);
+
+                        if (i % 3 == 0) signature[5] ^= 1;
+                        if (i % 5 == 0) text.push_back(0);
+                        signedTexts.push_back({text, signature, signer.pub});
+                    }
+                    signedTexts.push_back({msg, SIGNATURE_T{}, pair.pub});
+
+                    vector<bool> results = verifyBatch(signedTexts);
+
+                    for (size_t i = 0; i < signedTexts.size(); i++) {
+                        PublicKey publicKey = signedTexts[i].publicKey;
+                        REQUIRE(results[i] == verify(signedTexts[i].text, signedTexts[i].signature, &publicKey));
+                    }
+                    REQUIRE(count(results.begin(), results.end(), true) == 8);
+                }
             }
         }
     }
@@ -10,6 +10,8 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include <numeric>
+#include <tuple>
 #include "flatbuffers/flatbuffers.h"
 #include "result.h"
 #include "uECC.h"
@@ -99,6 +101,18 @@ namespace ProtoMesh::cryptography::asymmetric {
     SIGNATURE_T sign(vector<uint8_t> text, PRIVATE_KEY_T privKey);
     bool verify(vector<uint8_t> text, SIGNATURE_T signature, PublicKey* pubKey);
 
+    struct SignedText {
+    public:
+        vector<uint8_t> text;
+        SIGNATURE_T signature;
+        PublicKey publicKey;
+    };
+
+    /// Returns whether each one of the signatures is valid, an invalid one only affects its own result.
+    /// The modular inversions are shared among all of them (Montgomery's trick) and identical entries,
+    /// e.g. copies of a message that arrived over multiple paths, are only verified once.
+    vector<bool> verifyBatch(const vector<SignedText> &signedTexts);
+
     SHARED_KEY_T generateSharedSecret(PublicKey publicKey, PRIVATE_KEY_T privateKey);
 }
 
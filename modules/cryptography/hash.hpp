@@ -29,6 +29,16 @@ namespace ProtoMesh::cryptography::hash {
     string sha512(vector<uint8_t> message);
     HASH sha512Vec(vector<uint8_t> message);
 
+    /// Finalizer of MurmurHash3 (fmix64) which spreads every input bit across the whole output
+    inline uint64_t mix(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
     inline void hash_combine(std::size_t &seed) {}
 
     template<typename T, typename... Rest>
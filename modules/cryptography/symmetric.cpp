@@ -7,9 +7,13 @@
 #include "symmetric.hpp"
 
 #include <utility>
+#include <mutex>
 
 namespace ProtoMesh::cryptography::symmetric {
 
+    /// lib/AES keeps the expanded key and the chaining state in globals so only one buffer can be processed at a time
+    static mutex aesMutex;
+
     Result<vector<uint8_t>, AESError> encrypt(vector<uint8_t> text, vector<uint8_t> key, vector<uint8_t> iv) {
         /// Prepare the IV
         if (iv.size() < IV_SIZE)
@@ -28,7 +32,10 @@ namespace ProtoMesh::cryptography::symmetric {
         buffer.resize(text.size(), 0);
 
         /// Encrypt the text
-        AES_CBC_encrypt_buffer(buffer.data(), text.data(), static_cast<uint32_t>(text.size()), key.data(), iv.data());
+        {
+            lock_guard<mutex> lock(aesMutex);
+            AES_CBC_encrypt_buffer(buffer.data(), text.data(), static_cast<uint32_t>(text.size()), key.data(), iv.data());
+        }
 
         /// Append the IV to the buffer
         buffer.insert(buffer.end(),std::make_move_iterator(iv.begin()), std::make_move_iterator(iv.end()));
@@ -59,7 +66,10 @@ namespace ProtoMesh::cryptography::symmetric {
         vector<uint8_t> buffer = {0};
         buffer.resize(ciphertext.size(), 0);
 
-        AES_CBC_decrypt_buffer(buffer.data(), ciphertext.data(), static_cast<uint32_t>(ciphertext.size()), key.data(), iv.data());
+        {
+            lock_guard<mutex> lock(aesMutex);
+            AES_CBC_decrypt_buffer(buffer.data(), ciphertext.data(), static_cast<uint32_t>(ciphertext.size()), key.data(), iv.data());
+        }
 
         /// Remove any additional padding by looking at the last byte and checking if the last n bytes are equal to zero
         uint8_t paddingSize = buffer.back();
@@ -74,6 +74,21 @@ namespace ProtoMesh::cryptography {
                 }
             }
         }
+
+        GIVEN("Two sequentially numbered UUIDs") {
+            UUID uuid1 = UUID::fromNumber(1);
+            UUID uuid2 = UUID::fromNumber(2);
+
+            THEN("their hashes should differ") {
+                REQUIRE(uuid1.hash() != uuid2.hash());
+                REQUIRE((uuid1.hash() & 0xFF) != (uuid2.hash() & 0xFF));
+            }
+
+            THEN("hashing with a different seed should yield a different hash") {
+                REQUIRE(uuid1.hash(0) != uuid1.hash(1));
+                REQUIRE(uuid1.hash(1) == UUID::fromNumber(1).hash(1));
+            }
+        }
     }
 #endif // UNIT_TESTING
 
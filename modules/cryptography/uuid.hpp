@@ -30,6 +30,13 @@ namespace ProtoMesh::cryptography {
         explicit UUID(const scheme::cryptography::UUID *id);
 
         scheme::cryptography::UUID toScheme() const;
+
+        /// Well distributed 64-bit hash of all 128 bits. Different seeds yield independent hashes.
+        inline uint64_t hash(uint64_t seed = 0) const {
+            uint64_t high = ((uint64_t) a << 32) | b;
+            uint64_t low = ((uint64_t) c << 32) | d;
+            return ProtoMesh::cryptography::hash::mix(ProtoMesh::cryptography::hash::mix(high ^ seed) ^ low);
+        }
         explicit operator string() const;
 
         inline tuple <uint32_t, uint32_t, uint32_t, uint32_t> tie() const { return std::tie(a, b, c, d); }
@@ -0,0 +1,312 @@
+#ifdef UNIT_TESTING
+
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include "catch.hpp"
+
+#endif
+
+#include "EventLoop.hpp"
+
+#ifdef __linux__
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+/// epoll event data of the wake descriptor while transports are identified by their index
+#define EVENT_LOOP_WAKE_EVENT UINT64_MAX
+/// Offset of the epoll event data of the timers
+#define EVENT_LOOP_TIMER_EVENT (1ull << 32)
+
+namespace ProtoMesh {
+
+    EventLoop::EventLoop(shared_ptr<communication::Network> network)
+            : network(std::move(network)), epollDescriptor(epoll_create1(EPOLL_CLOEXEC)),
+              wakeDescriptor(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), stopRequested(false) {
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = EVENT_LOOP_WAKE_EVENT;
+        epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, this->wakeDescriptor, &event);
+    }
+
+    EventLoop::~EventLoop() {
+        for (Timer &timer : this->timers)
+            close(timer.fileDescriptor);
+
+        close(this->wakeDescriptor);
+        close(this->epollDescriptor);
+    }
+
+    Result<void, EventLoop::EventLoopError> EventLoop::addTransport(TRANSMISSION_HANDLER_T transport) {
+        int fileDescriptor = transport->fileDescriptor();
+        if (fileDescriptor < 0) return Err(EventLoopError::NOT_POLLABLE);
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = this->transports.size();
+        if (epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) < 0)
+            return Err(EventLoopError::SYSTEM_ERROR);
+
+        this->transports.push_back(std::move(transport));
+        return Ok();
+    }
+
+    Result<void, EventLoop::EventLoopError> EventLoop::addTimer(chrono::milliseconds interval, function<void()> callback) {
+        int fileDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fileDescriptor < 0) return Err(EventLoopError::SYSTEM_ERROR);
+
+        /// An interval of zero would disarm the timer
+        auto milliseconds = max<chrono::milliseconds::rep>(interval.count(), 1);
+        itimerspec specification{};
+        specification.it_interval.tv_sec = milliseconds / 1000;
+        specification.it_interval.tv_nsec = (milliseconds % 1000) * 1000000;
+        specification.it_value = specification.it_interval;
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = EVENT_LOOP_TIMER_EVENT + this->timers.size();
+
+        if (timerfd_settime(fileDescriptor, 0, &specification, nullptr) < 0 ||
+            epoll_ctl(this->epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) < 0) {
+            close(fileDescriptor);
+            return Err(EventLoopError::SYSTEM_ERROR);
+        }
+
+        this->timers.push_back(Timer{fileDescriptor, std::move(callback)});
+        return Ok();
+    }
+
+    size_t EventLoop::receiveFrom(communication::transmission::TransmissionHandler &transport, size_t offset) {
+        if (this->receiveBuffers.size() < offset + EVENT_LOOP_RECEIVE_BUDGET)
+            this->receiveBuffers.resize(offset + EVENT_LOOP_RECEIVE_BUDGET);
+
+        return transport.recvBatch(this->receiveBuffers.data() + offset, EVENT_LOOP_RECEIVE_BUDGET, 0);
+    }
+
+    void EventLoop::transmit(const Datagrams &datagrams) {
+        if (datagrams.empty()) return;
+
+        /// The transport a neighbor is reachable over is unknown thus everything is sent on all of them
+        for (TRANSMISSION_HANDLER_T &transport : this->transports)
+            transport->sendBatch(datagrams);
+    }
+
+    size_t EventLoop::runOnce(int timeout) {
+        epoll_event events[EVENT_LOOP_MAX_EVENTS];
+        int eventCount = epoll_wait(this->epollDescriptor, events, EVENT_LOOP_MAX_EVENTS, timeout);
+        /// Interrupted by a signal
+        if (eventCount < 0) return 0;
+
+        size_t received = 0;
+        vector<size_t> expiredTimers;
+        for (int i = 0; i < eventCount; i++) {
+            uint64_t source = events[i].data.u64;
+
+            if (source == EVENT_LOOP_WAKE_EVENT) {
+                eventfd_t value;
+                eventfd_read(this->wakeDescriptor, &value);
+            } else if (source >= EVENT_LOOP_TIMER_EVENT) {
+                uint64_t expirations;
+                if (read(this->timers[source - EVENT_LOOP_TIMER_EVENT].fileDescriptor, &expirations,
+                         sizeof(expirations)) == sizeof(expirations))
+                    expiredTimers.push_back(source - EVENT_LOOP_TIMER_EVENT);
+            } else {
+                received += this->receiveFrom(*this->transports[source], received);
+            }
+        }
+
+        /// Everything received from all transports is processed at once so that signatures are verified as a batch
+        if (received > 0)
+            this->transmit(this->network->processDatagrams(this->receiveBuffers, received));
+
+        for (size_t timer : expiredTimers)
+            this->timers[timer].callback();
+
+        this->network->processCryptoCompletions();
+        this->transmit(this->network->drainOutgoingQueue());
+
+        return received;
+    }
+
+    void EventLoop::run() {
+        while (!this->stopRequested.exchange(false))
+            this->runOnce(-1);
+    }
+
+    void EventLoop::stop() {
+        this->stopRequested.store(true);
+        eventfd_write(this->wakeDescriptor, 1);
+    }
+
+#ifdef UNIT_TESTING
+
+    /// Transport over one end of a local datagram socket pair
+    class SocketPairTransport : public communication::transmission::TransmissionHandler {
+        int socket;
+
+    public:
+        explicit SocketPairTransport(int socket) : socket(socket) {};
+        ~SocketPairTransport() { close(this->socket); }
+
+        void send(vector<uint8_t> message) override {
+            ::send(this->socket, message.data(), message.size(), MSG_DONTWAIT);
+        }
+
+        communication::transmission::ReceiveResult recv(vector<uint8_t> *buffer, unsigned int timeout_ms) override {
+            using communication::transmission::ReceiveResult;
+
+            pollfd descriptor{this->socket, POLLIN, 0};
+            if (poll(&descriptor, 1, timeout_ms) <= 0)
+                return timeout_ms > 0 ? ReceiveResult::Timeout : ReceiveResult::NoData;
+
+            buffer->resize(UINT16_MAX);
+            ssize_t size = ::recv(this->socket, buffer->data(), buffer->size(), MSG_DONTWAIT);
+            buffer->resize(size < 0 ? 0 : size_t(size));
+
+            return size < 0 ? ReceiveResult::NoData : ReceiveResult::OK;
+        }
+
+        int fileDescriptor() override { return this->socket; }
+    };
+
+    /// Sends the datagram over the socket and waits for room in its buffer if necessary
+    void sendOver(int socket, const Datagram &datagram) {
+        while (send(socket, datagram.data(), datagram.size(), MSG_DONTWAIT) < 0) {
+            pollfd descriptor{socket, POLLOUT, 0};
+            poll(&descriptor, 1, 100);
+        }
+    }
+
+    SCENARIO("An event loop should serve transports and timers", "[integration_test][module][integration]") {
+        GIVEN("a device whose event loop serves one end of a socket pair with a neighbor on the other end") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            cryptography::UUID deviceID;
+            cryptography::asymmetric::KeyPair deviceKeys = cryptography::asymmetric::generateKeyPair();
+            auto network = make_shared<communication::Network>(deviceID, deviceKeys, timeProvider);
+            EventLoop loop(network);
+
+            int sockets[2];
+            REQUIRE(socketpair(AF_UNIX, SOCK_DGRAM, 0, sockets) == 0);
+            REQUIRE(loop.addTransport(make_shared<SocketPairTransport>(sockets[0])).isOk());
+            int peer = sockets[1];
+
+            THEN("transports without a file descriptor should be rejected") {
+                auto result = loop.addTransport(make_shared<communication::transmission::NetworkStub>());
+                REQUIRE(result.unwrapErr() == EventLoop::EventLoopError::NOT_POLLABLE);
+            }
+
+            WHEN("two neighbors advertise themselves and send messages to the device and through it to each other") {
+                vector<cryptography::UUID> neighbors(2);
+                vector<cryptography::asymmetric::KeyPair> neighborKeys;
+                vector<Datagram> datagrams;
+                for (size_t i = 0; i < neighbors.size(); i++) {
+                    neighborKeys.push_back(cryptography::asymmetric::generateKeyPair());
+                    datagrams.push_back(Routing::IARP::Advertisement::build(neighbors[i], neighborKeys[i]).serialize());
+                }
+
+                vector<Datagram> payloads;
+                vector<SIGNATURE_T> relayedMessages;
+                for (uint8_t i = 0; i < 8; i++) {
+                    Datagram payload(16, i);
+                    payloads.push_back(payload);
+                    datagrams.push_back(communication::Message::build(payload, {neighbors[0], deviceID}, deviceKeys.pub,
+                                                                      neighborKeys[0]).serialize());
+
+                    auto relayedMessage = communication::Message::build(payload, {neighbors[0], deviceID, neighbors[1]},
+                                                                        neighborKeys[1].pub, neighborKeys[0]);
+                    relayedMessages.push_back(relayedMessage.signature);
+                    datagrams.push_back(relayedMessage.serialize());
+                }
+
+                thread sender([&]() {
+                    for (const Datagram &datagram : datagrams)
+                        sendOver(peer, datagram);
+                });
+
+                size_t received = 0;
+                while (received < datagrams.size())
+                    received += loop.runOnce(1000);
+                sender.join();
+
+                THEN("the payloads should have been received in the order they have been sent") {
+                    REQUIRE(network->drainIncomingBuffer() == payloads);
+                }
+
+                THEN("the relayed messages should have been sent back over the socket") {
+                    vector<SIGNATURE_T> forwardedMessages;
+                    Datagram buffer(UINT16_MAX);
+                    ssize_t size;
+                    while ((size = recv(peer, buffer.data(), buffer.size(), MSG_DONTWAIT)) > 0) {
+                        auto message = communication::Message::fromBuffer(Datagram(buffer.begin(), buffer.begin() + size));
+                        if (message.isOk()) forwardedMessages.push_back(message.unwrap().signature);
+                    }
+
+                    REQUIRE(forwardedMessages == relayedMessages);
+                }
+            }
+
+            WHEN("a timer is added") {
+                size_t expirations = 0;
+                REQUIRE(loop.addTimer(chrono::milliseconds(1), [&expirations]() { expirations++; }).isOk());
+
+                THEN("it should wake up the loop repeatedly") {
+                    while (expirations < 3)
+                        REQUIRE(loop.runOnce(1000) == 0);
+                }
+            }
+
+            WHEN("the loop is stopped from another thread") {
+                thread stopper([&loop]() { loop.stop(); });
+                loop.run();
+                stopper.join();
+
+                THEN("it should have returned") {
+                    SUCCEED();
+                }
+            }
+
+            close(peer);
+        }
+    }
+
+    SCENARIO("Benchmarking the datagram throughput of the event loop", "[.][benchmark][integration]") {
+        REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+        auto network = make_shared<communication::Network>(cryptography::UUID(),
+                                                           cryptography::asymmetric::generateKeyPair(), timeProvider);
+        EventLoop loop(network);
+
+        int sockets[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_DGRAM, 0, sockets) == 0);
+        REQUIRE(loop.addTransport(make_shared<SocketPairTransport>(sockets[0])).isOk());
+
+        /// Plain payloads only measure the loop itself and not the cryptography
+        const size_t count = 100000;
+        thread sender([&]() {
+            for (size_t i = 0; i < count; i++)
+                sendOver(sockets[1], Datagram(64, (uint8_t) i));
+        });
+
+        using namespace std::chrono;
+        auto start = steady_clock::now();
+        size_t received = 0;
+        size_t delivered = 0;
+        while (received < count) {
+            received += loop.runOnce(1000);
+            delivered += network->drainIncomingBuffer().size();
+        }
+        auto duration = duration_cast<microseconds>(steady_clock::now() - start).count();
+        sender.join();
+        close(sockets[1]);
+
+        REQUIRE(delivered == count);
+        WARN(count * 1000000 / duration << " datagrams per second");
+    }
+
+#endif // UNIT_TESTING
+}
+
+#endif // __linux__
@@ -0,0 +1,91 @@
+#ifndef PROTOMESH_EVENTLOOP_HPP
+#define PROTOMESH_EVENTLOOP_HPP
+
+#ifdef __linux__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include <TransmissionHandler.hpp>
+#include <Network.hpp>
+#include "result.h"
+
+using namespace std;
+
+/// Maximum amount of events that are handled per wakeup
+#define EVENT_LOOP_MAX_EVENTS 64
+/// Maximum amount of datagrams received from one transport per wakeup so that the others are not starved.
+/// Remaining datagrams are received during the next wakeup.
+#define EVENT_LOOP_RECEIVE_BUDGET 256
+
+namespace ProtoMesh {
+
+    /// Serves any amount of transports and periodic timers on the calling thread (Linux only).
+    /// Sleeps in epoll until a transport is readable, a timer expires or stop is called. Every wakeup:
+    ///  1. receives everything the ready transports hold (up to the budget) and processes it as one batch
+    ///  2. fires the expired timers
+    ///  3. sends the responses together with everything the network queued in the meantime on all transports
+    class EventLoop {
+        class Timer {
+        public:
+            int fileDescriptor;
+            function<void()> callback;
+        };
+
+        shared_ptr<communication::Network> network;
+
+        int epollDescriptor;
+        /// Written by stop to wake up the loop
+        int wakeDescriptor;
+        atomic<bool> stopRequested;
+
+        vector<TRANSMISSION_HANDLER_T> transports;
+        /// Received datagrams of all transports, reused by every wakeup
+        vector<Datagram> receiveBuffers;
+        /// Callbacks may add timers while they are called
+        deque<Timer> timers;
+
+        size_t receiveFrom(communication::transmission::TransmissionHandler &transport, size_t offset);
+        void transmit(const Datagrams &datagrams);
+
+    public:
+        enum class EventLoopError {
+            /// The transport does not provide a file descriptor
+            NOT_POLLABLE,
+            /// The kernel refused to create or register a file descriptor
+            SYSTEM_ERROR
+        };
+
+        explicit EventLoop(shared_ptr<communication::Network> network);
+        ~EventLoop();
+
+        EventLoop(const EventLoop &) = delete;
+        EventLoop &operator=(const EventLoop &) = delete;
+
+        /// Transports and timers may only be added before the loop runs or from the thread running it
+        Result<void, EventLoopError> addTransport(TRANSMISSION_HANDLER_T transport);
+
+        /// The callback is called on the thread running the loop once every interval.
+        /// Expirations that are missed while the loop is busy are coalesced into a single call.
+        Result<void, EventLoopError> addTimer(chrono::milliseconds interval, function<void()> callback);
+
+        /// Waits at most timeout milliseconds (-1 for no limit) for events and handles them.
+        /// Returns the amount of received datagrams.
+        size_t runOnce(int timeout);
+
+        /// Handles events until stop is called
+        void run();
+
+        /// Thread-safe. Makes the current or next call of run return.
+        void stop();
+    };
+
+}
+
+#endif // __linux__
+
+#endif //PROTOMESH_EVENTLOOP_HPP
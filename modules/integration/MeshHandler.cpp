@@ -10,9 +10,30 @@ namespace ProtoMesh {
 
     MeshHandler::MeshHandler(cryptography::UUID deviceID, cryptography::asymmetric::KeyPair deviceKeys,
                              TRANSMISSION_HANDLER_T transmissionHandler, REL_TIME_PROV_T timeProvider)
-            : transmissionHandler(std::move(transmissionHandler)), timeProvider(std::move(timeProvider)), network(make_shared<communication::Network>(deviceID, deviceKeys, timeProvider)) {
+            : transmissionHandler(std::move(transmissionHandler)), timeProvider(std::move(timeProvider)), network(make_shared<communication::Network>(deviceID, deviceKeys, this->timeProvider)) {}
 
+#ifdef __linux__
+    Result<void, EventLoop::EventLoopError> MeshHandler::prepareEventLoop() {
+        if (this->eventLoop) return Ok();
+
+        auto loop = make_shared<EventLoop>(this->network);
+
+        /// Handlers without a file descriptor can only be served by tick
+        auto transport = loop->addTransport(this->transmissionHandler);
+        if (transport.isErr() && transport.unwrapErr() != EventLoop::EventLoopError::NOT_POLLABLE)
+            return transport;
+
+        /// Advertisements, retries and the expiry of routing state are scheduled by the network itself
+        shared_ptr<communication::Network> network = this->network;
+        auto timer = loop->addTimer(chrono::milliseconds(NETWORK_TIMER_RESOLUTION), [network]() {
+            network->processTimers();
+        });
+        if (timer.isErr()) return timer;
+
+        this->eventLoop = std::move(loop);
+        return Ok();
     }
+#endif
 
     MeshHandler MeshHandler::generateNew(TRANSMISSION_HANDLER_T transmissionHandler, REL_TIME_PROV_T timeProvider) {
         return MeshHandler(cryptography::UUID(),
@@ -42,5 +63,24 @@ namespace ProtoMesh {
             // ((DummyRelativeTimeProvider *) timeProvider.get())->turnTheClockBy(20000);
         }
     }
+
+#ifdef __linux__
+    SCENARIO("A mesh handler should report transports its event loop can not serve",
+             "[integration_test][module][integration]") {
+        GIVEN("a mesh handler whose own transmission handler has no file descriptor") {
+            REL_TIME_PROV_T timeProvider(new DummyRelativeTimeProvider(0));
+            TRANSMISSION_HANDLER_T transmissionHandler(new communication::transmission::NetworkStub());
+            MeshHandler handler = MeshHandler::generateNew(transmissionHandler, timeProvider);
+
+            WHEN("another transport without a file descriptor is added") {
+                auto result = handler.addTransport(make_shared<communication::transmission::NetworkStub>());
+
+                THEN("it should be rejected while the event loop itself has been created") {
+                    REQUIRE(result.unwrapErr() == EventLoop::EventLoopError::NOT_POLLABLE);
+                }
+            }
+        }
+    }
+#endif
 #endif // UNIT_TESTING
 }
\ No newline at end of file
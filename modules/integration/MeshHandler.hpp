@@ -11,10 +11,14 @@
 #include <Network.hpp>
 
 #include "Device.hpp"
+#include "EventLoop.hpp"
 #include "delegates/DeviceHandlerDelegate.hpp"
 
 using namespace std;
 
+/// Maximum amount of received datagrams that are processed within one tick
+#define MESH_HANDLER_TICK_BATCH_SIZE 64
+
 namespace ProtoMesh {
 
     class MeshHandler {
@@ -22,6 +26,21 @@ namespace ProtoMesh {
         REL_TIME_PROV_T timeProvider;
 
         shared_ptr<communication::Network> network;
+#ifdef __linux__
+        shared_ptr<EventLoop> eventLoop;
+#endif
+
+        /// Reused by every tick
+        vector<vector<uint8_t>> receiveBuffers = vector<vector<uint8_t>>(MESH_HANDLER_TICK_BATCH_SIZE);
+
+        void transmit(const Datagrams &datagrams) {
+            if (!datagrams.empty()) this->transmissionHandler->sendBatch(datagrams);
+        }
+
+#ifdef __linux__
+        /// Creates the event loop unless it exists already
+        Result<void, EventLoop::EventLoopError> prepareEventLoop();
+#endif
 
     public:
         /// Constructors
@@ -30,11 +49,53 @@ namespace ProtoMesh {
 
         /// Loop functions
         void tick(unsigned int timeout) {
-            vector<uint8_t> buffer;
-            this->transmissionHandler->recv(&buffer, timeout);
-            if (!buffer.empty()) {
-                this->network->processDatagram(buffer);
+            /// Take whatever else has been received in the meantime so that the messages can be verified as a batch
+            size_t count = this->transmissionHandler->recvBatch(this->receiveBuffers.data(), this->receiveBuffers.size(),
+                                                                timeout);
+            if (count > 0) {
+                this->transmit(this->network->processDatagrams(this->receiveBuffers, count));
             }
+            this->network->processCryptoCompletions();
+            this->network->processTimers();
+            this->transmit(this->network->drainOutgoingQueue());
+        }
+
+#ifdef __linux__
+        /// Event loop (Linux only)
+        /// Serves the transmission handler of this mesh handler and any additional transports without busy-polling.
+        /// Transports have to provide a file descriptor (see TransmissionHandler::fileDescriptor).
+        /// The loop is created by the first call to addTransport or run so that handlers served by tick don't hold
+        /// its descriptors.
+        Result<void, EventLoop::EventLoopError> addTransport(TRANSMISSION_HANDLER_T transport) {
+            auto loop = this->prepareEventLoop();
+            if (loop.isErr()) return Err(loop.unwrapErr());
+
+            return this->eventLoop->addTransport(std::move(transport));
+        }
+
+        /// Blocks until stop is called from any thread. Returns right away if the loop could not be created.
+        Result<void, EventLoop::EventLoopError> run() {
+            auto loop = this->prepareEventLoop();
+            if (loop.isErr()) return Err(loop.unwrapErr());
+
+            this->eventLoop->run();
+            return Ok();
+        }
+
+        /// Thread-safe once run or addTransport has been called, does nothing before
+        void stop() { if (this->eventLoop) this->eventLoop->stop(); }
+#endif
+
+        /// Persistence
+        /// The snapshot should be written to persistent storage periodically (see NETWORK_SNAPSHOT_INTERVAL)
+        /// and on shutdown. Times are absolute timestamps in seconds (e.g. UNIX time).
+        vector<uint8_t> createSnapshot(uint64_t currentTime) {
+            return this->network->createSnapshot(currentTime);
+        }
+
+        Result<void, communication::Network::SnapshotRestoreError>
+        restoreSnapshot(communication::NetworkSnapshot snapshot, uint64_t currentTime) {
+            return this->network->restoreSnapshot(std::move(snapshot), currentTime);
         }
 
         /// Delegates